@@ -0,0 +1,422 @@
+/*
+    bscore.c:
+
+    Copyright (C) 2026 The Csound Developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"                                 /*   BSCORE.C  */
+#include "corfile.h"
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Binary sorted score.
+ *
+ * The file holds what rdscor() returns for a sorted and warped score,
+ * one record per EVTBLK, so that a score produced once by the sorter
+ * can be played any number of times without being parsed again.
+ *
+ *   header   BSCORE_HDR
+ *   records  from evtoff to stroff, each 8-byte aligned:
+ *              BSCORE_REC
+ *              double p2orig, p3orig
+ *              double p[1..np]
+ *              double extra[nextra]      (overflow block, see rdscor)
+ *              uint32 strings[scnt]      (offsets into the string table)
+ *   strings  strsize bytes of NUL-terminated strings from stroff,
+ *            each stored once however many events use it
+ *
+ * P-fields are always doubles, so a file can be read by float and double
+ * builds alike; a string p-field is stored as a NaN carrying the index
+ * of the string within the event.  The file is in the byte order of the
+ * machine that wrote it, and is rejected elsewhere.
+ */
+
+#define BSCORE_MAGIC    "CSBSCORE"
+#define BSCORE_VERSION  1
+#define BSCORE_ENDIAN   0x01020304
+#define BSCORE_STRTAG   0x7ff8c5b000000000ULL
+#define BSCORE_STRMASK  0xffffffff00000000ULL
+
+typedef struct {
+    char      magic[8];
+    uint32_t  version;
+    uint32_t  endian;
+    uint64_t  nevents;
+    uint64_t  evtoff;
+    uint64_t  stroff;
+    uint64_t  strsize;
+} BSCORE_HDR;
+
+typedef struct {
+    char      opcod;
+    uint8_t   pad;
+    uint16_t  scnt;
+    int16_t   pcnt;
+    uint16_t  np;
+    uint32_t  nextra;
+    uint32_t  pad2;
+} BSCORE_REC;
+
+typedef struct {
+    const unsigned char *base;    /* whole file */
+    size_t    size;
+    const unsigned char *evt, *evtend, *rp;
+    const char *str;
+    uint64_t  strsize;
+    uint64_t  nevents, nread;
+    int       mapped;
+    char      *name;
+} BSCORE;
+
+#define BSCORE_ALIGN(n) (((n) + 7) & ~((size_t) 7))
+
+static MYFLT bscore_getflt(const unsigned char *p)
+{
+    union { double d; uint64_t i; } v;
+    memcpy(&v, p, sizeof(double));
+    if (UNLIKELY((v.i & BSCORE_STRMASK) == BSCORE_STRTAG)) {
+      union { MYFLT d; int32 i; } ch;
+      ch.d = SSTRCOD; ch.i += (int32) (v.i & 0xffff);
+      return ch.d;
+    }
+    return (MYFLT) v.d;
+}
+
+static void bscore_free(CSOUND *csound, BSCORE *b)
+{
+#if !defined(WIN32)
+    if (b->mapped) {
+      munmap((void*) b->base, b->size);
+    }
+    else
+#endif
+    csound->Free(csound, (void*) b->base);
+    csound->Free(csound, b->name);
+    csound->Free(csound, b);
+}
+
+/* Open 'name', looked up in the current directory and then SSDIR and
+   SFDIR, as a binary score.  Returns NOTOK, leaving the text path to
+   handle the file, if it is not one; a damaged binary score is fatal. */
+
+int bscore_open(CSOUND *csound, const char *name)
+{
+    BSCORE      *b;
+    BSCORE_HDR  hdr;
+    FILE        *f;
+    char        *path;
+    size_t      size;
+
+    if (name == NULL ||
+        (path = csoundFindInputFile(csound, name, "SFDIR;SSDIR")) == NULL)
+      return NOTOK;
+    f = fopen(path, "rb");
+    csound->Free(csound, path);
+    if (f == NULL)
+      return NOTOK;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        memcmp(hdr.magic, BSCORE_MAGIC, 8) != 0) {
+      fclose(f);
+      return NOTOK;
+    }
+    if (UNLIKELY(hdr.endian != BSCORE_ENDIAN || hdr.version != BSCORE_VERSION))
+      csoundDie(csound, Str("%s: binary score version %u or byte order "
+                            "not supported"), name, (unsigned) hdr.version);
+    fseek(f, 0L, SEEK_END);
+    size = (size_t) ftell(f);
+    if (UNLIKELY(hdr.evtoff < sizeof(hdr) || hdr.stroff < hdr.evtoff ||
+                 hdr.stroff + hdr.strsize != (uint64_t) size)) {
+      fclose(f);
+      csoundDie(csound, Str("%s: binary score is truncated or damaged"), name);
+    }
+    b = (BSCORE*) csound->Calloc(csound, sizeof(BSCORE));
+    b->size = size;
+#if !defined(WIN32)
+    {
+      void *m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+      if (m != MAP_FAILED) {
+        b->base = (const unsigned char*) m;
+        b->mapped = 1;
+#if defined(MADV_SEQUENTIAL)
+        madvise(m, size, MADV_SEQUENTIAL);
+#endif
+      }
+    }
+#endif
+    if (!b->mapped) {
+      unsigned char *buf = (unsigned char*) csound->Malloc(csound, size);
+      fseek(f, 0L, SEEK_SET);
+      if (UNLIKELY(fread(buf, 1, size, f) != size)) {
+        fclose(f);
+        csoundDie(csound, Str("%s: cannot read binary score"), name);
+      }
+      b->base = buf;
+    }
+    fclose(f);
+    b->evt = b->rp = b->base + hdr.evtoff;
+    b->evtend = b->base + hdr.stroff;
+    b->str = (const char*) (b->base + hdr.stroff);
+    b->strsize = hdr.strsize;
+    b->nevents = hdr.nevents;
+    b->name = cs_strdup(csound, (char*) name);
+    if (UNLIKELY(b->strsize > 0 && b->str[b->strsize - 1] != '\0')) {
+      bscore_free(csound, b);
+      csoundDie(csound, Str("%s: binary score is truncated or damaged"), name);
+    }
+    if (csound->bscore != NULL)
+      bscore_close(csound);
+    csound->bscore = b;
+    csound->Message(csound, Str("using binary score %s (%llu events)\n"),
+                    name, (unsigned long long) b->nevents);
+    return OK;
+}
+
+void bscore_close(CSOUND *csound)
+{
+    if (csound->bscore != NULL) {
+      bscore_free(csound, (BSCORE*) csound->bscore);
+      csound->bscore = NULL;
+    }
+}
+
+void bscore_rewind(CSOUND *csound)
+{
+    BSCORE *b = (BSCORE*) csound->bscore;
+    b->rp = b->evt;
+    b->nread = 0;
+}
+
+/* The binary counterpart of rdscor(): fill e with the next event. */
+
+int bscore_read(CSOUND *csound, EVTBLK *e)
+{
+    BSCORE      *b = (BSCORE*) csound->bscore;
+    BSCORE_REC  r;
+    const unsigned char *p = b->rp;
+    size_t      len;
+    int         i, np;
+
+    e->pinstance = NULL;
+    if (p >= b->evtend)
+      return 0;
+    if (UNLIKELY((size_t) (b->evtend - p) < sizeof(r)))
+      goto damaged;
+    memcpy(&r, p, sizeof(r));
+    np = r.np;
+    len = sizeof(r) + (2 + np + (size_t) r.nextra) * sizeof(double) +
+          r.scnt * sizeof(uint32_t);
+    if (UNLIKELY(np > PMAX || (size_t) (b->evtend - p) < len))
+      goto damaged;
+    p += sizeof(r);
+    e->opcod = r.opcod;
+    e->p2orig = bscore_getflt(p); p += sizeof(double);
+    e->p3orig = bscore_getflt(p); p += sizeof(double);
+    for (i = 1; i <= np; i++, p += sizeof(double))
+      e->p[i] = bscore_getflt(p);
+    if (e->c.extra != NULL && e->pcnt >= PMAX)
+      csound->Free(csound, e->c.extra);
+    e->c.extra = NULL;
+    if (r.nextra) {
+      e->c.extra = (MYFLT*) csound->Malloc(csound, sizeof(MYFLT) * r.nextra);
+      for (i = 0; i < (int) r.nextra; i++, p += sizeof(double))
+        e->c.extra[i] = bscore_getflt(p);
+    }
+    e->pcnt = r.pcnt;
+    e->strarg = NULL; e->scnt = 0;
+    if (r.scnt) {
+      const unsigned char *q = p;
+      char    *s;
+      size_t  n = 0;
+      for (i = 0; i < r.scnt; i++, q += sizeof(uint32_t)) {
+        uint32_t off;
+        memcpy(&off, q, sizeof(off));
+        if (UNLIKELY(off >= b->strsize))
+          goto damaged;
+        n += strlen(b->str + off) + 1;
+      }
+      s = e->strarg = (char*) csound->Malloc(csound, n);
+      for (i = 0; i < r.scnt; i++, p += sizeof(uint32_t)) {
+        uint32_t off;
+        memcpy(&off, p, sizeof(off));
+        n = strlen(b->str + off) + 1;
+        memcpy(s, b->str + off, n);
+        s += n;
+      }
+      e->scnt = r.scnt;
+    }
+    b->rp += BSCORE_ALIGN(len);
+    b->nread++;
+    if (!csound->csoundIsScorePending_ && e->opcod == 'i') {
+      e->opcod = 'f'; e->p[1] = FL(0.0); e->pcnt = 2; e->scnt = 0;
+    }
+    return 1;
+
+ damaged:
+    csound->Warning(csound, Str("%s: binary score damaged after event %llu"),
+                    b->name, (unsigned long long) b->nread);
+    b->rp = b->evtend;
+    return 0;
+}
+
+/* Writer: string table with de-duplication */
+
+typedef struct {
+    CSOUND    *csound;
+    char      *buf;
+    size_t    len, size;
+    uint32_t  *hash;              /* offset + 1, 0 for empty */
+    size_t    hsize, count;
+} BSCORE_STRTAB;
+
+static uint32_t bscore_hashstr(const char *s)
+{
+    uint32_t h = 2166136261U;
+    while (*s) { h ^= (unsigned char) *s++; h *= 16777619U; }
+    return h;
+}
+
+static uint32_t bscore_intern(BSCORE_STRTAB *t, const char *s)
+{
+    CSOUND    *csound = t->csound;
+    size_t    i, n;
+
+    if (t->count * 2 >= t->hsize) {       /* grow and rehash */
+      size_t    nsize = t->hsize ? t->hsize * 2 : 256;
+      uint32_t  *nh = (uint32_t*) csound->Calloc(csound,
+                                                 nsize * sizeof(uint32_t));
+      for (i = 0; i < t->hsize; i++) {
+        if (t->hash[i]) {
+          size_t j = bscore_hashstr(t->buf + t->hash[i] - 1) & (nsize - 1);
+          while (nh[j]) j = (j + 1) & (nsize - 1);
+          nh[j] = t->hash[i];
+        }
+      }
+      csound->Free(csound, t->hash);
+      t->hash = nh; t->hsize = nsize;
+    }
+    i = bscore_hashstr(s) & (t->hsize - 1);
+    while (t->hash[i]) {
+      if (strcmp(t->buf + t->hash[i] - 1, s) == 0)
+        return t->hash[i] - 1;
+      i = (i + 1) & (t->hsize - 1);
+    }
+    n = strlen(s) + 1;
+    if (t->len + n > t->size) {
+      t->size = (t->len + n) * 2;
+      t->buf = (char*) csound->ReAlloc(csound, t->buf, t->size);
+    }
+    memcpy(t->buf + t->len, s, n);
+    t->hash[i] = (uint32_t) t->len + 1;
+    t->count++;
+    t->len += n;
+    return (uint32_t) (t->len - n);
+}
+
+static void bscore_putflt(MYFLT x, FILE *out)
+{
+    union { double d; uint64_t i; } v;
+    if (ISSTRCOD(x)) {
+      union { MYFLT d; int32 i; } ch;
+      ch.d = x;
+      v.i = BSCORE_STRTAG | (uint64_t) (ch.i & 0xffff);
+    }
+    else v.d = (double) x;
+    fwrite(&v, sizeof(double), 1, out);
+}
+
+/* Write the sorted score left in csound->scstr by scsortstr() to out,
+   which must be seekable, as a binary score.  Returns 0 on success. */
+
+int bscore_write(CSOUND *csound, FILE *out)
+{
+    BSCORE_HDR    hdr;
+    BSCORE_STRTAB tab;
+    EVTBLK        *e;
+    int           i, ret = 0;
+    static const char zeros[8] = { 0 };
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, BSCORE_MAGIC, 8);
+    hdr.version = BSCORE_VERSION;
+    hdr.endian = BSCORE_ENDIAN;
+    hdr.evtoff = sizeof(hdr);
+    if (UNLIKELY(fwrite(&hdr, sizeof(hdr), 1, out) != 1))
+      return NOTOK;
+    memset(&tab, 0, sizeof(tab));
+    tab.csound = csound;
+    e = (EVTBLK*) csound->Calloc(csound, sizeof(EVTBLK));
+    csound->warped = 0;
+    corfile_rewind(csound->scstr);
+    while (rdscor(csound, e)) {
+      BSCORE_REC  r;
+      int         np = e->pcnt < PMAX ? e->pcnt : PMAX;
+      size_t      len;
+      memset(&r, 0, sizeof(r));
+      r.opcod = e->opcod;
+      r.pcnt = e->pcnt;
+      r.np = (uint16_t) (np > 0 ? np : 0);
+      r.nextra = (e->pcnt >= PMAX && e->c.extra != NULL) ?
+                 (uint32_t) e->c.extra[0] + 1 : 0;
+      r.scnt = (uint16_t) (e->strarg != NULL ? e->scnt : 0);
+      fwrite(&r, sizeof(r), 1, out);
+      bscore_putflt(e->p2orig, out);
+      bscore_putflt(e->p3orig, out);
+      for (i = 1; i <= r.np; i++)
+        bscore_putflt(e->p[i], out);
+      for (i = 0; i < (int) r.nextra; i++)
+        bscore_putflt(e->c.extra[i], out);
+      if (r.scnt) {
+        char *s = e->strarg;
+        for (i = 0; i < r.scnt; i++) {
+          uint32_t off = bscore_intern(&tab, s);
+          fwrite(&off, sizeof(off), 1, out);
+          s += strlen(s) + 1;
+        }
+        csound->Free(csound, e->strarg);
+        e->strarg = NULL;
+      }
+      len = sizeof(r) + (2 + r.np + (size_t) r.nextra) * sizeof(double) +
+            r.scnt * sizeof(uint32_t);
+      fwrite(zeros, 1, BSCORE_ALIGN(len) - len, out);
+      hdr.nevents++;
+      if (e->opcod == 'e')
+        break;
+    }
+    if (e->pcnt >= PMAX)
+      csound->Free(csound, e->c.extra);
+    csound->Free(csound, e);
+    hdr.stroff = (uint64_t) ftell(out);
+    hdr.strsize = tab.len;
+    if (tab.len)
+      fwrite(tab.buf, 1, tab.len, out);
+    csound->Free(csound, tab.buf);
+    csound->Free(csound, tab.hash);
+    if (UNLIKELY(fflush(out) != 0 || ferror(out) ||
+                 fseek(out, 0L, SEEK_SET) != 0 ||
+                 fwrite(&hdr, sizeof(hdr), 1, out) != 1))
+      ret = NOTOK;
+    fflush(out);
+    return ret;
+}
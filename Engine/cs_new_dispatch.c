@@ -117,6 +117,17 @@ static void dag_print_state(CSOUND *csound)
     }
 }
 
+/* Each deque must be able to hold every task, as one thread may end up
+   owning all the ready work in a cycle */
+static void dag_size_deques(CSOUND *csound)
+{
+    int i, max = csound->dag_task_max_size;
+    if (csound->dag_deques == NULL) return;
+    for (i=0; i<csound->oparms->numThreads; i++)
+      csound->dag_deques[i].tasks =
+        csound->ReAlloc(csound, csound->dag_deques[i].tasks, sizeof(taskID)*max);
+}
+
 /* For now allocate a fixed maximum number of tasks; FIXME */
 static void create_dag(CSOUND *csound)
 {
@@ -127,6 +138,7 @@ static void create_dag(CSOUND *csound)
     csound->dag_task_map    = csound->Calloc(csound, sizeof(INSDS*)*max);
     csound->dag_task_dep    = (char **)csound->Calloc(csound, sizeof(char*)*max);
     csound->dag_wlmm = (watchList *)csound->Calloc(csound, sizeof(watchList)*max);
+    dag_size_deques(csound);
 }
 
 static void recreate_dag(CSOUND *csound)
@@ -145,6 +157,7 @@ static void recreate_dag(CSOUND *csound)
       (char **)csound->ReAlloc(csound, csound->dag_task_dep, sizeof(char*)*max);
     csound->dag_wlmm        =
       (watchList *)csound->ReAlloc(csound, csound->dag_wlmm, sizeof(watchList)*max);
+    dag_size_deques(csound);
 }
 
 static INSTR_SEMANTICS *dag_get_info(CSOUND* csound, int insno)
@@ -183,11 +196,246 @@ static int dag_intersect(CSOUND *csound, struct set_t *current,
     return res;
 }
 
+/* The dependencies of an instance depend only on its instrument and on
+ * the instruments active before it, so they are cached at two levels:
+ * a memo of whether two instruments conflict, and the dependency
+ * triangles of recently seen sequences of active instruments.  When a
+ * single instance starts or ends the triangle is edited in place.
+ *
+ * The triangle is packed by rows: row j (j>0) holds j flags at
+ * offset j*(j-1)/2, flag k set if task j must wait for task k.
+ */
+#define TRI(j)            (((j)*((j)-1))/2)
+#define DAG_SIG_SLOTS     (16)    /* number of cached sequences */
+#define DAG_SIG_MAX       (2048)  /* longest sequence worth caching */
+#define DAG_MEMO_INIT     (256)   /* initial conflict memo size */
+
+typedef struct {
+    uint64_t  key;                /* (later<<32)|earlier, 0 if empty */
+    char      conflict;
+} DAG_MEMO;
+
+typedef struct {
+    uint32_t  hash;
+    int       n;                  /* 0 if slot empty */
+    unsigned long used;
+    int       *insno;
+    char      *dep;
+} DAG_SIG;
+
+typedef struct {
+    int       stale;              /* instruments recompiled */
+    DAG_MEMO  *memo;
+    int       memo_size, memo_used;
+    DAG_SIG   sig[DAG_SIG_SLOTS];
+    unsigned long clock;
+    char      *dep;               /* working triangle */
+    int       dep_max;            /* tasks it can hold */
+    int       *insno, *prev;      /* current and last built sequences */
+    int       num_prev;
+} DAG_CACHE;
+
+void dag_reinit(CSOUND *csound);
+
+/* Called when instruments are (re)defined */
+void dag_cache_invalidate(CSOUND *csound)
+{
+    if (csound->dag_cache != NULL) ((DAG_CACHE*)csound->dag_cache)->stale = 1;
+}
+
+static void dag_cache_flush(CSOUND *csound, DAG_CACHE *c)
+{
+    int i;
+    memset(c->memo, 0, sizeof(DAG_MEMO)*c->memo_size);
+    c->memo_used = 0;
+    for (i=0; i<DAG_SIG_SLOTS; i++) c->sig[i].n = 0;
+    c->num_prev = -1;
+    c->stale = 0;
+    IGN(csound);
+}
+
+static DAG_CACHE *dag_cache_get(CSOUND *csound)
+{
+    DAG_CACHE *c = (DAG_CACHE*)csound->dag_cache;
+    int max = csound->dag_task_max_size;
+    if (c == NULL) {
+      c = csound->dag_cache = csound->Calloc(csound, sizeof(DAG_CACHE));
+      c->memo_size = DAG_MEMO_INIT;
+      c->memo = csound->Calloc(csound, sizeof(DAG_MEMO)*c->memo_size);
+      c->num_prev = -1;
+    }
+    if (c->dep_max < max) {
+      c->dep = csound->ReAlloc(csound, c->dep, TRI(max));
+      c->insno = csound->ReAlloc(csound, c->insno, sizeof(int)*max);
+      c->prev = csound->ReAlloc(csound, c->prev, sizeof(int)*max);
+      c->dep_max = max;
+    }
+    if (c->stale) dag_cache_flush(csound, c);
+    return c;
+}
+
+static int dag_conflict_eval(CSOUND *csound, int earlier, int later)
+{
+    INSTR_SEMANTICS *current_instr = dag_get_info(csound, earlier);
+    INSTR_SEMANTICS *later_instr = dag_get_info(csound, later);
+    int cnt = 0;
+    return (dag_intersect(csound, current_instr->write,
+                          later_instr->read, cnt++)       ||
+            dag_intersect(csound, current_instr->read_write,
+                          later_instr->read, cnt++)       ||
+            dag_intersect(csound, current_instr->read,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->write,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->read_write,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->read,
+                          later_instr->read_write, cnt++) ||
+            dag_intersect(csound, current_instr->write,
+                          later_instr->read_write, cnt++));
+}
+
+static void dag_memo_insert(DAG_MEMO *memo, int size, uint64_t key, char val)
+{
+    int h = (int)((key * 0x9E3779B97F4A7C15ULL) >> 40) & (size-1);
+    while (memo[h].key != 0 && memo[h].key != key) h = (h+1) & (size-1);
+    memo[h].key = key;
+    memo[h].conflict = val;
+}
+
+/* Does an instance of instrument later depend on one of earlier? */
+static char dag_conflict(CSOUND *csound, DAG_CACHE *c, int earlier, int later)
+{
+    uint64_t key = ((uint64_t)(uint32_t)later<<32) | (uint32_t)earlier;
+    int h = (int)((key * 0x9E3779B97F4A7C15ULL) >> 40) & (c->memo_size-1);
+    char val;
+    while (c->memo[h].key != 0) {
+      if (c->memo[h].key == key) return c->memo[h].conflict;
+      h = (h+1) & (c->memo_size-1);
+    }
+    val = (char)(dag_conflict_eval(csound, earlier, later) != 0);
+    if (2*(c->memo_used+1) > c->memo_size) {    /* keep load under half */
+      DAG_MEMO *old = c->memo;
+      int i, size = c->memo_size;
+      c->memo_size *= 2;
+      c->memo = csound->Calloc(csound, sizeof(DAG_MEMO)*c->memo_size);
+      for (i=0; i<size; i++)
+        if (old[i].key != 0)
+          dag_memo_insert(c->memo, c->memo_size, old[i].key, old[i].conflict);
+      csound->Free(csound, old);
+    }
+    dag_memo_insert(c->memo, c->memo_size, key, val);
+    c->memo_used++;
+    return val;
+}
+
+static uint32_t dag_signature(int *insno, int n)
+{
+    uint32_t h = 2166136261u;           /* FNV-1a */
+    int i;
+    for (i=0; i<n; i++) {
+      h ^= (uint32_t)insno[i];
+      h *= 16777619u;
+    }
+    return h;
+}
+
+static int dag_sig_lookup(DAG_CACHE *c, int n, uint32_t hash)
+{
+    int i;
+    for (i=0; i<DAG_SIG_SLOTS; i++) {
+      DAG_SIG *e = &c->sig[i];
+      if (e->n == n && e->hash == hash &&
+          memcmp(e->insno, c->insno, sizeof(int)*n) == 0) {
+        memcpy(c->dep, e->dep, TRI(n));
+        e->used = ++c->clock;
+        return 1;
+      }
+    }
+    return 0;
+}
+
+static void dag_sig_store(CSOUND *csound, DAG_CACHE *c, int n, uint32_t hash)
+{
+    int i, victim = 0;
+    DAG_SIG *e;
+    if (n > DAG_SIG_MAX) return;
+    for (i=1; i<DAG_SIG_SLOTS; i++)           /* least recently used */
+      if (c->sig[i].used < c->sig[victim].used) victim = i;
+    e = &c->sig[victim];
+    e->insno = csound->ReAlloc(csound, e->insno, sizeof(int)*n);
+    e->dep = csound->ReAlloc(csound, e->dep, TRI(n)+1);
+    memcpy(e->insno, c->insno, sizeof(int)*n);
+    memcpy(e->dep, c->dep, TRI(n));
+    e->n = n;
+    e->hash = hash;
+    e->used = ++c->clock;
+}
+
+/* One instance started at position p: open up row and column p */
+static void dag_insert_task(CSOUND *csound, DAG_CACHE *c, int n, int p)
+{
+    char *dep = c->dep;
+    int j, k, x = c->insno[p];
+    for (j=n-1; j>p; j--) {       /* rows move up by j, disjoint from old */
+      char *to = dep+TRI(j), *from = dep+TRI(j-1);
+      memcpy(to+p+1, from+p, j-1-p);
+      memcpy(to, from, p);
+      to[p] = dag_conflict(csound, c, x, c->insno[j]);
+    }
+    for (k=0; k<p; k++)
+      dep[TRI(p)+k] = dag_conflict(csound, c, c->insno[k], x);
+}
+
+/* One instance ended at position p: close up row and column p */
+static void dag_remove_task(DAG_CACHE *c, int n, int p)
+{
+    char *dep = c->dep;
+    int j;
+    for (j=p; j<n; j++) {         /* rows move down, disjoint from old */
+      char *to = dep+TRI(j), *from = dep+TRI(j+1);
+      memcpy(to, from, p);
+      memcpy(to+p, from+p+1, j-p);
+    }
+}
+
+/* Try to reach the new sequence from the last one with a single edit */
+static int dag_update(CSOUND *csound, DAG_CACHE *c, int n)
+{
+    int i = 0, m = c->num_prev;
+    int *now = c->insno, *old = c->prev;
+    if (m < 0 || (n != m && n != m+1 && n != m-1)) return 0;
+    while (i < n && i < m && now[i] == old[i]) i++;
+    if (n == m) return (i == n);
+    if (n == m+1) {
+      if (memcmp(now+i+1, old+i, sizeof(int)*(m-i)) != 0) return 0;
+      dag_insert_task(csound, c, n, i);
+    }
+    else {
+      if (memcmp(now+i, old+i+1, sizeof(int)*(n-i)) != 0) return 0;
+      dag_remove_task(c, n, i);
+    }
+    return 1;
+}
+
+static void dag_fill(CSOUND *csound, DAG_CACHE *c, int n)
+{
+    int j, k;
+    for (j=1; j<n; j++) {
+      char *row = c->dep+TRI(j);
+      if (UNLIKELY(csound->oparms->odebug))
+        printf("\nWho does %d (instr %d) depend on?\n", j, c->insno[j]);
+      for (k=0; k<j; k++)
+        row[k] = dag_conflict(csound, c, c->insno[k], c->insno[j]);
+    }
+}
+
 void dag_build(CSOUND *csound, INSDS *chain)
 {
     INSDS *save = chain;
     INSDS **task_map;
-    int i;
+    DAG_CACHE *c;
+    int i, n, *swap;
 
     //printf("DAG BUILD***************************************\n");
     csound->dag_num_active = 0;
@@ -202,73 +450,33 @@ void dag_build(CSOUND *csound, INSDS *chain)
     }
     if (csound->dag_task_status == NULL)
       create_dag(csound); /* Should move elsewhere */
-    else {
-      memset((void*)csound->dag_task_watch, '\0',
-             sizeof(watchList*)*csound->dag_task_max_size);
-      for (i=0; i<csound->dag_task_max_size; i++) {
-        if (csound->dag_task_dep[i]) {
-          csound->dag_task_dep[i]= NULL;
-        }
-        csound->dag_wlmm[i].id = INVALID;
-      }
-    }
+    n = csound->dag_num_active;
+    c = dag_cache_get(csound);
     task_map = csound->dag_task_map;
-    for (i=0; i<csound->dag_num_active; i++) {
-      csound->dag_task_status[i].s = AVAILABLE;
-      csound->dag_wlmm[i].id=i;
+    for (i=0, chain=save; i<n; i++, chain=chain->nxtact) {
+      task_map[i] = chain;
+      c->insno[i] = chain->insno;
     }
     csound->dag_changed = 0;
     if (UNLIKELY(csound->oparms->odebug))
-      printf("dag_num_active = %d\n", csound->dag_num_active);
-    i = 0; chain = save;
-    while (chain != NULL) {     /* for each instance check against later */
-      int j = i+1;              /* count of instance */
-      if (UNLIKELY(csound->oparms->odebug))
-        printf("\nWho depends on %d (instr %d)?\n", i, chain->insno);
-      INSDS *next = chain->nxtact;
-      INSTR_SEMANTICS *current_instr = dag_get_info(csound, chain->insno);
-      //csp_set_print(csound, current_instr->read);
-      //csp_set_print(csound, current_instr->write);
-      while (next) {
-        INSTR_SEMANTICS *later_instr = dag_get_info(csound, next->insno);
-        int cnt = 0;
-        if (UNLIKELY(csound->oparms->odebug)) printf("%d ", j);
-        //csp_set_print(csound, later_instr->read);
-        //csp_set_print(csound, later_instr->write);
-        //csp_set_print(csound, later_instr->read_write);
-        if (dag_intersect(csound, current_instr->write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->read_write, cnt++) ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->read_write, cnt++)) {
-          char *tt = csound->dag_task_dep[j];
-          if (tt==NULL) {
-            /* get dep vector if missing and set watch first time */
-            tt = csound->dag_task_dep[j] =
-              (char*)csound->Calloc(csound, sizeof(char)*(j+1));
-            csound->dag_task_status[j].s = WAITING;
-            csound->dag_wlmm[j].next = csound->dag_task_watch[i];
-            csound->dag_wlmm[j].id = j;
-            csound->dag_task_watch[i] = &(csound->dag_wlmm[j]);
-            //printf("set watch %d to %d\n", j, i);
-          }
-          tt[i] = 1;
-          //printf("-yes ");
-        }
-        j++; next = next->nxtact;
+      printf("dag_num_active = %d\n", n);
+    if (!dag_update(csound, c, n)) {
+      uint32_t hash = dag_signature(c->insno, n);
+      if (!dag_sig_lookup(c, n, hash)) {
+        dag_fill(csound, c, n);
+        dag_sig_store(csound, c, n, hash);
       }
-      task_map[i] = chain;
-      i++; chain = chain->nxtact;
     }
+    swap = c->prev; c->prev = c->insno; c->insno = swap;
+    c->num_prev = n;
+    /* rows without dependencies are left NULL */
+    csound->dag_task_dep[0] = NULL;
+    for (i=1; i<n; i++) {
+      char *row = c->dep+TRI(i);
+      csound->dag_task_dep[i] = memchr(row, 1, i) ? row : NULL;
+    }
+    for (; i<csound->dag_task_max_size; i++) csound->dag_task_dep[i] = NULL;
+    dag_reinit(csound);
     if (UNLIKELY(csound->oparms->odebug)) dag_print_state(csound);
 }
 
@@ -324,14 +532,76 @@ void dag_reinit(CSOUND *csound)
                               __ATOMIC_SEQ_CST)
 #endif
 
+#if defined(_MSC_VER)
+#define ATOMIC_FENCE() MemoryBarrier()
+#else
+#define ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/* Spins before an idle thread yields its time slice */
+#define DAG_SPIN_LIMIT (256)
+
+static inline void dag_pause(int *spins)
+{
+    if (++(*spins) < DAG_SPIN_LIMIT) {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+      __builtin_ia32_pause();
+#endif
+    }
+    else {
+      *spins = 0;
+      csoundSleep(0);
+    }
+}
+
+/* Owner only: add a ready task at the bottom of the deque */
+static inline void deque_push(taskDeque *d, taskID t)
+{
+    int b = d->bottom;
+    d->tasks[b] = t;
+    ATOMIC_FENCE();
+    d->bottom = b+1;
+}
+
+/* Owner only: take the most recently pushed task */
+static inline taskID deque_pop(taskDeque *d)
+{
+    int b = d->bottom - 1, t;
+    taskID task;
+    d->bottom = b;
+    ATOMIC_FENCE();
+    t = d->top;
+    if (t > b) {                /* empty */
+      d->bottom = b+1;
+      return INVALID;
+    }
+    task = d->tasks[b];
+    if (t == b) {               /* last one, race any thief for it */
+      if (!ATOMIC_CAS(&(d->top), t, t+1)) task = INVALID;
+      d->bottom = b+1;
+    }
+    return task;
+}
+
+/* Any thread: take the oldest task from another thread's deque */
+static inline taskID deque_steal(taskDeque *d)
+{
+    int t = d->top, b;
+    taskID task;
+    ATOMIC_FENCE();
+    b = d->bottom;
+    if (t >= b) return INVALID;
+    task = d->tasks[t];
+    if (!ATOMIC_CAS(&(d->top), t, t+1)) return INVALID;
+    return task;
+}
+
 taskID dag_get_task(CSOUND *csound, int index, int numThreads, taskID next_task)
 {
-    int i;
-    int count_waiting = 0;
-    int active = csound->dag_num_active;
-    int start = (index * active) / numThreads;
+    int i, spins = 0;
+    taskDeque *deques = csound->dag_deques;
     volatile stateWithPadding *task_status = csound->dag_task_status;
-    enum state current_task_status;
+    taskID task;
 
     if (next_task != INVALID) {
       // Have forwarded one task from the previous one
@@ -340,46 +610,18 @@ taskID dag_get_task(CSOUND *csound, int index, int numThreads, taskID next_task)
       return next_task;
     }
 
-    //printf("**GetTask from %d\n", csound->dag_num_active);
-    i = start;
-    do {
-      current_task_status = ATOMIC_READ(task_status[i].s);
-
-      switch (current_task_status) {
-      case AVAILABLE :
-        // Need to CAS as the value may have changed
-        if (ATOMIC_CAS(&(task_status[i].s), current_task_status, INPROGRESS)) {
-          return (taskID)i;
-        }
-        break;
-
-      case WAITING :
-        //  printf("**%d waiting\n", i);
-        ++count_waiting;
-        break;
-
-      case INPROGRESS :
-        //  print(f"**%d active\n", i);
-        break;
-
-      case DONE :
-        //printf("**%d done\n", i);
-        break;
-
-      default :
-        // Enum corrupted!
-        //assert(0);
-        break;
+    while (1) {
+      task = deque_pop(&deques[index]);
+      for (i = 1; task == INVALID && i < numThreads; i++)
+        task = deque_steal(&deques[(index+i) % numThreads]);
+      if (task != INVALID) {
+        ATOMIC_WRITE(task_status[task].s,INPROGRESS);
+        return task;
       }
-
-      // Increment modulo active
-      i = (i+1 == active) ? 0 : i + 1;
-
-    } while (i != start);
-    //dag_print_state(csound);
-    if (count_waiting == 0) return (taskID)INVALID;
-    //printf("taskstodo=%d)\n", morework);
-    return (taskID)WAIT;
+      /* Nothing ready; finished only when every task is done */
+      if (ATOMIC_GET(csound->dag_remaining) == 0) return (taskID)INVALID;
+      dag_pause(&spins);
+    }
 }
 
 /* This static is OK as not written */
@@ -406,7 +648,7 @@ inline static int moveWatch(CSOUND *csound, watchList * volatile *w,
     return 1;
 }
 
-taskID dag_end_task(CSOUND *csound, taskID i)
+taskID dag_end_task(CSOUND *csound, int index, taskID i)
 {
     watchList *to_notify, *next;
     int canQueue;
@@ -494,14 +736,93 @@ taskID dag_end_task(CSOUND *csound, taskID i)
           next_task = j; // Forward directly to the thread to save re-dispatch
         } else {
           ATOMIC_WRITE(csound->dag_task_status[j].s, AVAILABLE);
+          deque_push(&csound->dag_deques[index], j); // others may steal it
         }
       }
       to_notify = next;
     }
+    ATOMIC_DECR(csound->dag_remaining);
     //dag_print_state(csound);
     return next_task;
 }
 
+void csp_dag_sched_alloc(CSOUND *csound, int numThreads)
+{
+    int i;
+    csound->dag_deques =
+      (taskDeque *)csound->Calloc(csound, sizeof(taskDeque)*numThreads);
+    csound->dag_wake = (void **)csound->Calloc(csound, sizeof(void*)*numThreads);
+    for (i=0; i<numThreads; i++) {
+      csound->dag_deques[i].tasks =
+        csound->Calloc(csound, sizeof(taskID)*csound->dag_task_max_size);
+      if (i > 0) csound->dag_wake[i] = csoundCreateThreadLock();
+    }
+}
+
+/* Called at cleanup: release the parked workers, join them and
+   destroy what csp_dag_sched_alloc() created */
+void dag_wake_workers(CSOUND *csound);
+
+void csp_barrier_dealloc(CSOUND *, void **);
+
+void csp_dag_sched_free(CSOUND *csound)
+{
+    THREADINFO *t;
+    int i;
+    if (csound->dag_wake == NULL) return;
+    csound->multiThreadedComplete = 1;
+    dag_wake_workers(csound);
+    for (t = csound->multiThreadedThreadInfo; t != NULL; t = t->next)
+      csoundJoinThread(t->threadId);
+    csound->multiThreadedThreadInfo = NULL;
+    for (i=0; i<csound->oparms->numThreads; i++) {
+      if (i > 0) csoundDestroyThreadLock(csound->dag_wake[i]);
+      csound->Free(csound, csound->dag_deques[i].tasks);
+    }
+    csound->Free(csound, csound->dag_wake);
+    csound->Free(csound, csound->dag_deques);
+    csound->dag_wake = NULL;
+    csound->dag_deques = NULL;
+    if (csound->barrier2 != NULL) {
+      csp_barrier_dealloc(csound, &csound->barrier2);
+      csound->barrier2 = NULL;
+    }
+}
+
+/* Called by the main thread with all workers parked: hand the initially
+   ready tasks out round-robin and open the next k-cycle */
+
+void dag_start_cycle(CSOUND *csound)
+{
+    int i, n = csound->oparms->numThreads, k = 0;
+    taskDeque *deques = csound->dag_deques;
+    for (i=0; i<n; i++) deques[i].top = deques[i].bottom = 0;
+    for (i=0; i<csound->dag_num_active; i++)
+      if (csound->dag_task_status[i].s == AVAILABLE) {
+        deque_push(&deques[k], i);
+        k = (k+1 == n) ? 0 : k + 1;
+      }
+    ATOMIC_SET(csound->dag_idle, 0);
+    ATOMIC_SET(csound->dag_remaining, csound->dag_num_active);
+    dag_wake_workers(csound);
+}
+
+void dag_wake_workers(CSOUND *csound)
+{
+    int i;
+    ATOMIC_INCR(csound->dag_cycle);
+    for (i=1; i<csound->oparms->numThreads; i++)
+      csoundNotifyThreadLock(csound->dag_wake[i]);
+}
+
+/* Workers leave promptly once the last task is done */
+void dag_end_cycle(CSOUND *csound)
+{
+    int spins = 0;
+    while (ATOMIC_GET(csound->dag_idle) < csound->oparms->numThreads-1)
+      dag_pause(&spins);
+}
+
 
 /* INV : Acyclic */
 /* INV : Each entry is read by a single thread,
@@ -411,7 +411,10 @@ void csp_orc_analyze_tree(CSOUND* csound, TREE* root)
         csp_orc_analyze_tree(csound, current->right);
 
         csp_orc_sa_instr_finalize(csound);
-
+        {
+          void dag_cache_invalidate(CSOUND *);
+          dag_cache_invalidate(csound);  /* cached dependencies now stale */
+        }
         break;
       case UDO_TOKEN:
         if (PARSER_DEBUG) csound->Message(csound, "UDO found\n");
@@ -951,9 +951,13 @@ void deleteVarPoolMemory(void *csound, CS_VAR_POOL *pool);
 /**
    This function deletes an inactive instrument which has been replaced
 */
+void instance_pool_release(CSOUND *csound, INSTRTXT *tp);
+
 void free_instrtxt(CSOUND *csound, INSTRTXT *instrtxt) {
   INSTRTXT *ip = instrtxt;
-  INSDS *active = ip->instance;
+  INSDS *active;
+  instance_pool_release(csound, ip);  /* instances built ahead */
+  active = ip->instance;
   while (active != NULL) { /* remove instance memory */
     INSDS *nxt = active->nxtinstance;
     if (active->fdchp != NULL)
@@ -1286,9 +1290,10 @@ void insert_instrtxt(CSOUND *csound, INSTRTXT *instrtxt, int32 instrNum,
       csound->Warning(csound, Str("instr %" PRIi32 " redefined, "
                                   "replacing previous definition"),
                       instrNum);
-    /* inherit active & maxalloc flags */
+    /* inherit active, maxalloc & asyncinit flags */
     instrtxt->active = engineState->instrtxtp[instrNum]->active;
     instrtxt->maxalloc = engineState->instrtxtp[instrNum]->maxalloc;
+    instrtxt->async_init = engineState->instrtxtp[instrNum]->async_init;
 
     /* here we should move the old instrument definition into a deadpool
        which will be checked for active instances and freed when there are no
@@ -114,7 +114,7 @@ char * get_boolean_arg(CSOUND *csound, TYPE_TABLE* typeTable, int type)
 static TREE *create_empty_token(CSOUND *csound)
 {
   TREE *ans;
-  ans = (TREE*)csound->Malloc(csound, sizeof(TREE));
+  ans = (TREE*)tree_alloc(csound, sizeof(TREE));
   if (UNLIKELY(ans==NULL)) {
     /* fprintf(stderr, "Out of memory\n"); */
     exit(1);
@@ -135,7 +135,7 @@ static TREE *create_empty_token(CSOUND *csound)
 static TREE *create_minus_token(CSOUND *csound)
 {
   TREE *ans;
-  ans = (TREE*)csound->Malloc(csound, sizeof(TREE));
+  ans = (TREE*)tree_alloc(csound, sizeof(TREE));
   if (UNLIKELY(ans==NULL)) {
     /* fprintf(stderr, "Out of memory\n"); */
     exit(1);
@@ -997,7 +997,7 @@ void handle_negative_number(CSOUND* csound, TREE* root)
   if (root->type == S_UMINUS &&
       (root->right->type == INTEGER_TOKEN || root->right->type == NUMBER_TOKEN)) {
     int len = strlen(root->right->value->lexeme);
-    char* negativeNumber = csound->Malloc(csound, len + 3);
+    char* negativeNumber = tree_alloc(csound, len + 3);
     negativeNumber[0] = '-';
     strcpy(negativeNumber + 1, root->right->value->lexeme);
     negativeNumber[len + 2] = '\0';
@@ -1039,7 +1039,7 @@ static void collapse_last_assigment(CSOUND* csound, TREE* anchor,
       (!strcmp(tmp1, tmp2))) {
     a->left = b->left;
     a->next = NULL;
-    csound->Free(csound, b);
+    tree_free(csound, b);
   }
   csound->Free(csound, tmp1);
   csound->Free(csound, tmp2);
@@ -1088,7 +1088,7 @@ TREE* expand_statement(CSOUND* csound, TREE* current, TYPE_TABLE* typeTable)
                                     typeTable);
       }
       nextArg = currentArg->next;
-      csound->Free(csound, currentArg);
+      tree_free(csound, currentArg);
 
       /* Set as anchor if necessary */
 
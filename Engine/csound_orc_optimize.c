@@ -26,11 +26,12 @@
 #include "csound_orc.h"
 extern void print_tree(CSOUND *csound, char*, TREE *l);
 extern void delete_tree(CSOUND *csound, TREE *l);
+extern OENTRY* find_opcode(CSOUND *, char *);
 
 static TREE * create_fun_token(CSOUND *csound, TREE *right, char *fname)
 {
     TREE *ans;
-    ans = (TREE*)csound->Malloc(csound, sizeof(TREE));
+    ans = (TREE*)tree_alloc(csound, sizeof(TREE));
     if (UNLIKELY(ans == NULL)) exit(1);
     ans->type = T_FUNCTION;
     ans->value = make_token(csound, fname);
@@ -157,10 +158,10 @@ static TREE* remove_excess_assigns(CSOUND *csound, TREE* root)
             printf("passes test2\n");
             print_tree(csound, "optimise assignment\n", current);
           }
-          csound->Free(csound, current->left->value);
+          tree_free(csound, current->left->value);
           current->left->value = nxt->left->value;
           current->next = nxt->next;
-          csound->Free(csound,nxt);
+          tree_free(csound, nxt);
           if (PARSER_DEBUG) print_tree(csound, "change to\n", current);
         }
       }
@@ -250,11 +251,11 @@ TREE* constant_fold(CSOUND *csound, TREE* root)
           current->type = NUMBER_TOKEN;
           current->value->fvalue = lval;
           snprintf(buf, 60, "%.20g", lval);
-          csound->Free(csound, current->value->lexeme);
-          current->value->lexeme = cs_strdup(csound, buf);
-          csound->Free(csound, current->left);
-          csound->Free(csound, current->right->value);
-          csound->Free(csound, current->right);
+          tree_free(csound, current->value->lexeme);
+          current->value->lexeme = tree_strdup(csound, buf);
+          tree_free(csound, current->left);
+          tree_free(csound, current->right->value);
+          tree_free(csound, current->right);
           current->right = current->left = NULL;
         }
         else                    /* X op 0 */
@@ -275,7 +276,7 @@ TREE* constant_fold(CSOUND *csound, TREE* root)
                 current->value = current->left->value;
                 current->right = current->left->right;
                 current->left = current->left->left;
-                csound->Free(csound, tmp);
+                tree_free(csound, tmp);
                 //print_tree(csound, "X op 0 -> X\n", current);
               }
               break;
@@ -347,7 +348,7 @@ TREE* constant_fold(CSOUND *csound, TREE* root)
                   current->value = current->left->value;
                   current->right = current->left->right;
                   current->left = current->left->left;
-                  csound->Free(csound, tmp);
+                  tree_free(csound, tmp);
                   //print_tree(csound, "X op 1 -> X\n", current);
                 }
               }
@@ -404,9 +405,9 @@ TREE* constant_fold(CSOUND *csound, TREE* root)
           current->type = NUMBER_TOKEN;
           current->value->fvalue = lval;
           snprintf(buf, 60, "%.20g", lval);
-          csound->Free(csound, current->value->lexeme);
-          current->value->lexeme = cs_strdup(csound, buf);
-          csound->Free(csound, current->right);
+          tree_free(csound, current->value->lexeme);
+          current->value->lexeme = tree_strdup(csound, buf);
+          tree_free(csound, current->right);
           current->right = NULL;
         }
         break;
@@ -419,6 +420,220 @@ TREE* constant_fold(CSOUND *csound, TREE* root)
     return root;
 }
 
+/* Expression fusion
+
+   The expression expander turns  a1 = (a2*k1 + a3*k2) * 0.5  into
+   ##mul.ak, ##mul.ak, ##add.aa, ##mul.ak, each writing a whole block to
+   a synthetic #a temporary that the next one reads back.  Here every
+   tree of such pure elementwise a-rate opcodes is folded into a single
+   ##fused opcode (see aops.c), which takes the leaves as arguments and
+   the tree as a postfix program in its first argument. */
+
+#define FUSE_MAXOPS     32      /* FUSED_MAXOPS in aops.h */
+#define FUSE_MAXARGS    (VARGMAX - 1)
+
+static const struct {
+    const char *opname;
+    char       code;
+} fuse_ops[] = {
+    { "##add.aa", '+' }, { "##add.ak", '+' }, { "##add.ka", '+' },
+    { "##sub.aa", '-' }, { "##sub.ak", '-' }, { "##sub.ka", '-' },
+    { "##mul.aa", '*' }, { "##mul.ak", '*' }, { "##mul.ka", '*' },
+    { "##div.aa", '/' }, { "##div.ak", '/' }, { "##div.ka", '/' },
+    { "##mod.aa", '%' }, { "##mod.ak", '%' }, { "##mod.ka", '%' },
+    { "abs.a", 'A' },    { "exp.a", 'E' },    { "log.a", 'L' },
+    { "sqrt.a", 'Q' },   { "sin.a", 'S' },    { "cos.a", 'C' },
+    { "tan.a", 'T' },    { "sininv.a", 'I' }, { "cosinv.a", 'O' },
+    { "taninv.a", 'N' }, { "sinh.a", 'X' },   { "cosh.a", 'Y' },
+    { "tanh.a", 'H' },   { "log10.a", 'G' },  { "log2.a", 'B' },
+    { NULL, '\0' }
+};
+
+typedef struct {
+    CSOUND  *csound;
+    TREE    **nodes;            /* statements of one body, in order */
+    char    *absorbed;
+    int     count;
+    CS_HASH_TABLE *uses;        /* #a temporary -> times it appears */
+    char    prog[2 * FUSE_MAXARGS + FUSE_MAXOPS + 3];
+    int     plen, nops, nargs, ndropped;
+    TREE    *args[FUSE_MAXARGS];
+    TREE    *dropped[FUSE_MAXOPS];  /* temporaries read by fused nodes */
+} FUSE_CTX;
+
+static char fuse_code(TREE *t)
+{
+    OENTRY *ep;
+    int    i;
+
+    if (t->type != T_OPCODE || t->markup == NULL ||
+        t->left == NULL || t->left->next != NULL)
+      return '\0';
+    ep = (OENTRY *) t->markup;
+    for (i = 0; fuse_ops[i].opname != NULL; i++)
+      if (strcmp(ep->opname, fuse_ops[i].opname) == 0)
+        return fuse_ops[i].code;
+    return '\0';
+}
+
+/* counts the #a temporaries of a body once, before anything is fused */
+static void fuse_count_uses(CSOUND *csound, CS_HASH_TABLE *uses, TREE *t)
+{
+    for ( ; t != NULL; t = t->next) {
+      if (t->value != NULL && t->value->lexeme != NULL &&
+          t->value->lexeme[0] == '#' && t->value->lexeme[1] == 'a') {
+        intptr_t n = (intptr_t) cs_hash_table_get(csound, uses,
+                                                  t->value->lexeme);
+        cs_hash_table_put(csound, uses, t->value->lexeme, (void *) (n + 1));
+      }
+      fuse_count_uses(csound, uses, t->left);
+      fuse_count_uses(csound, uses, t->right);
+    }
+}
+
+/* index of the statement defining temporary name for statement i, if it
+   can be moved down to i: only opcodes writing other temporaries may lie
+   in between */
+static int fuse_find_def(FUSE_CTX *c, int i, const char *name)
+{
+    int j;
+    for (j = i - 1; j >= 0; j--) {
+      TREE *t = c->nodes[j], *out;
+      if (t->type != T_OPCODE || t->left == NULL) return -1;
+      if (t->left->next == NULL &&
+          strcmp(t->left->value->lexeme, name) == 0)
+        return j;
+      for (out = t->left; out != NULL; out = out->next)
+        if (out->value->lexeme[0] != '#') return -1;
+    }
+    return -1;
+}
+
+/* appends the postfix program of statement i, absorbing the statements
+   that compute its #a arguments; 0 if a limit was hit */
+static int fuse_emit(FUSE_CTX *c, int i)
+{
+    TREE   *t = c->nodes[i], *arg;
+    OENTRY *ep = (OENTRY *) t->markup;
+    int    n, j;
+
+    if (++c->nops > FUSE_MAXOPS) return 0;
+    for (arg = t->right, n = 0; arg != NULL; arg = arg->next, n++) {
+      char *name = arg->value->lexeme;
+      if (name[0] == '#' && name[1] == 'a' &&
+          c->ndropped < FUSE_MAXOPS &&
+          (j = fuse_find_def(c, i, name)) >= 0 &&
+          !c->absorbed[j] && fuse_code(c->nodes[j]) &&
+          (intptr_t) cs_hash_table_get(c->csound, c->uses, name) == 2) {
+        c->absorbed[j] = 1;
+        c->dropped[c->ndropped++] = arg;
+        if (!fuse_emit(c, j)) return 0;
+      }
+      else {
+        if (c->nargs >= FUSE_MAXARGS) return 0;
+        c->args[c->nargs++] = arg;
+        c->prog[c->plen++] = (ep->intypes[n] == 'a' ? 'a' : 'k');
+      }
+    }
+    c->prog[c->plen++] = fuse_code(t);
+    return 1;
+}
+
+static void fuse_free_node(CSOUND *csound, TREE *t)
+{
+    if (t->value != NULL) {
+      tree_free(csound, t->value->lexeme);
+      tree_free(csound, t->value);
+    }
+    tree_free(csound, t);
+}
+
+/* replaces statement i and the statements it absorbed by one ##fused */
+static void fuse_rewrite(CSOUND *csound, FUSE_CTX *c, int i, OENTRY *fused,
+                         const char *before)
+{
+    TREE *t = c->nodes[i], *prog;
+    char *buf;
+    int  j;
+
+    for (j = 0; j < c->count; j++)
+      if (c->absorbed[j] && before[j] == 0) {
+        fuse_free_node(csound, c->nodes[j]->left);
+        fuse_free_node(csound, c->nodes[j]);
+        c->nodes[j] = NULL;
+      }
+    for (j = 0; j < c->ndropped; j++) {
+      /* written and read only here, now gone */
+      cs_hash_table_put(csound, c->uses, c->dropped[j]->value->lexeme, NULL);
+      fuse_free_node(csound, c->dropped[j]);
+    }
+    buf = csound->Malloc(csound, c->plen + 3);
+    buf[0] = '"';
+    memcpy(buf + 1, c->prog, c->plen);
+    buf[c->plen + 1] = '"';
+    buf[c->plen + 2] = '\0';
+    prog = make_leaf(csound, t->line, t->locn, STRING_TOKEN,
+                     make_token(csound, buf));
+    csound->Free(csound, buf);
+    for (j = 0; j < c->nargs; j++)
+      c->args[j]->next = (j + 1 < c->nargs ? c->args[j + 1] : NULL);
+    prog->next = c->args[0];
+    tree_free(csound, t->value->lexeme);
+    t->value->lexeme = tree_strdup(csound, "##fused");
+    t->value->optype = NULL;
+    t->markup = fused;
+    t->right = prog;
+}
+
+static TREE *fuse_expressions(CSOUND *csound, TREE *body)
+{
+    FUSE_CTX c;
+    OENTRY   *fused = find_opcode(csound, "##fused");
+    TREE     *t, *last;
+    char     *before;
+    int      i;
+
+    if (fused == NULL) return body;
+    memset(&c, 0, sizeof(FUSE_CTX));
+    c.csound = csound;
+    for (t = body; t != NULL; t = t->next) c.count++;
+    if (c.count < 2) return body;
+    c.uses = cs_hash_table_create(csound);
+    fuse_count_uses(csound, c.uses, body);
+    c.nodes = (TREE **) csound->Malloc(csound, c.count * sizeof(TREE *));
+    c.absorbed = (char *) csound->Calloc(csound, 2 * c.count);
+    before = c.absorbed + c.count;
+    for (i = 0, t = body; t != NULL; t = t->next) c.nodes[i++] = t;
+
+    /* parents come after their operands, so walk backwards */
+    for (i = c.count - 1; i >= 0; i--) {
+      if (c.nodes[i] == NULL || c.absorbed[i] || !fuse_code(c.nodes[i]))
+        continue;
+      memcpy(before, c.absorbed, c.count);
+      c.plen = c.nops = c.nargs = c.ndropped = 0;
+      if (fuse_emit(&c, i) && c.nops > 1) {
+        c.prog[c.plen] = '\0';
+        if (UNLIKELY(PARSER_DEBUG))
+          csound->Message(csound, "fused %d opcodes at line %d: %s\n",
+                          c.nops, c.nodes[i]->line, c.prog);
+        fuse_rewrite(csound, &c, i, fused, before);
+      }
+      else memcpy(c.absorbed, before, c.count);
+    }
+
+    for (i = 0, body = last = NULL; i < c.count; i++) {
+      if (c.nodes[i] == NULL) continue;
+      if (last == NULL) body = c.nodes[i];
+      else last->next = c.nodes[i];
+      last = c.nodes[i];
+    }
+    if (last != NULL) last->next = NULL;
+    cs_hash_table_free(csound, c.uses);
+    csound->Free(csound, c.absorbed);
+    csound->Free(csound, c.nodes);
+    return body;
+}
+
 
 /* Optimizes tree (expressions, etc.) */
 TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
@@ -435,8 +650,10 @@ TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
       root = root->next;
     }
     //#ifdef JPFF
-    return remove_excess_assigns(csound,original);
-    //#else
-    //return original;
+    original = remove_excess_assigns(csound,original);
     //#endif
+    for (root = original; root != NULL; root = root->next)
+      if (root->type == INSTR_TOKEN || root->type == UDO_TOKEN)
+        root->right = fuse_expressions(csound, root->right);
+    return original;
 }
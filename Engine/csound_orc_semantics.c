@@ -1895,7 +1895,7 @@ TREE* verify_tree(CSOUND * csound, TREE *root, TYPE_TABLE* typeTable)
           }
           current->type = NUMBER_TOKEN;
           current->value->fvalue = lval;
-          csound->Free(csound, current->left); csound->Free(csound, current->right);
+          tree_free(csound, current->left); tree_free(csound, current->right);
         }
         break;
       case ENDIN_TOKEN:
@@ -2030,12 +2030,86 @@ TREE* appendToTree(CSOUND * csound, TREE *first, TREE *newlast)
 }
 
 
+/* Tree arenas.  Between tree_arena_begin() and tree_arena_end() the
+   nodes, tokens and lexemes of the tree being built come from one arena
+   (see marena_alloc), and tree_free() on them does nothing.  The arena
+   is then kept against the root of the finished tree, and goes in one
+   step when that root is given to csoundDeleteTree().  Setting the
+   environment variable CSOUND_TREE_ARENA to 0 allocates each piece with
+   csound->Calloc() as before, for comparison. */
+
+typedef struct tree_arena_s {
+    void                *arena;
+    TREE                *root;
+    struct tree_arena_s *nxt;
+} TREE_ARENA;
+
+void tree_arena_begin(CSOUND *csound)
+{
+    const char *s = getenv("CSOUND_TREE_ARENA");
+    /* left behind by a parser error that jumped out */
+    if (UNLIKELY(csound->tree_arena != NULL))
+      marena_free(csound, csound->tree_arena);
+    csound->tree_arena = (s != NULL && strcmp(s, "0") == 0) ?
+      NULL : marena_create(csound);
+}
+
+/* keep the arena for root, or drop it if root is NULL */
+void tree_arena_end(CSOUND *csound, TREE *root)
+{
+    void *arena = csound->tree_arena;
+    csound->tree_arena = NULL;
+    if (arena == NULL)
+      return;
+    if (root != NULL) {
+      TREE_ARENA *t = (TREE_ARENA*) csound->Malloc(csound, sizeof(TREE_ARENA));
+      t->arena = arena;
+      t->root = root;
+      t->nxt = (TREE_ARENA*) csound->tree_arenas;
+      csound->tree_arenas = t;
+    }
+    else marena_free(csound, arena);
+}
+
+/* zeroed */
+void *tree_alloc(CSOUND *csound, size_t size)
+{
+    if (csound->tree_arena != NULL)
+      return marena_alloc(csound, csound->tree_arena, size);
+    return csound->Calloc(csound, size);
+}
+
+char *tree_strdup(CSOUND *csound, const char *str)
+{
+    size_t  len = strlen(str) + 1;
+    char    *s = (char*) tree_alloc(csound, len);
+    memcpy(s, str, len);
+    return s;
+}
+
+static int tree_owned(CSOUND *csound, void *p)
+{
+    TREE_ARENA *t;
+    if (csound->tree_arena != NULL && marena_owns(csound->tree_arena, p))
+      return 1;
+    for (t = (TREE_ARENA*) csound->tree_arenas; t != NULL; t = t->nxt)
+      if (marena_owns(t->arena, p))
+        return 1;
+    return 0;
+}
+
+void tree_free(CSOUND *csound, void *p)
+{
+    if (p != NULL && !tree_owned(csound, p))
+      csound->Free(csound, p);
+}
+
 /* USED BY PARSER TO ASSEMBLE TREE NODES */
 TREE* make_node(CSOUND *csound, int line, int locn, int type,
                 TREE* left, TREE* right)
 {
     TREE *ans;
-    ans = (TREE*)csound->Malloc(csound, sizeof(TREE));
+    ans = (TREE*)tree_alloc(csound, sizeof(TREE));
     if (UNLIKELY(ans==NULL)) {
       /* fprintf(stderr, "Out of memory\n"); */
       exit(1);
@@ -2058,7 +2132,7 @@ TREE* make_node(CSOUND *csound, int line, int locn, int type,
 TREE* make_leaf(CSOUND *csound, int line, int locn, int type, ORCTOKEN *v)
 {
     TREE *ans;
-    ans = (TREE*)csound->Calloc(csound, sizeof(TREE));
+    ans = (TREE*)tree_alloc(csound, sizeof(TREE));
     if (UNLIKELY(ans==NULL)) {
       /* fprintf(stderr, "Out of memory\n"); */
       exit(1);
@@ -2092,11 +2166,11 @@ void delete_tree(CSOUND *csound, TREE *l)
       if (l->value) {
         if (l->value->lexeme) {
           //printf("Free %p %p (%s)\n", l, l->value, l->value->lexeme);
-          csound->Free(csound, l->value->lexeme);
+          tree_free(csound, l->value->lexeme);
           //l->value->lexeme = NULL;
         }
         //printf("Free val %p\n", l->value);
-        csound->Free(csound, l->value);
+        tree_free(csound, l->value);
         //l->value = NULL;
       }
       // printf("left %p right %p\n", l->left, l->right);
@@ -2106,13 +2180,23 @@ void delete_tree(CSOUND *csound, TREE *l)
       //l->right = NULL;
       l = l->next;
       //printf("Free old %p next: %p\n", old, l);
-      csound->Free(csound, old);
+      tree_free(csound, old);
     }
 }
 
 PUBLIC void csoundDeleteTree(CSOUND *csound, TREE *tree)
 {
+  TREE_ARENA **pp, *t;
   //printf("Tree %p\n", tree);
+  for (pp = (TREE_ARENA**) &csound->tree_arenas; (t = *pp) != NULL;
+       pp = &t->nxt) {
+    if (t->root == tree) {      /* the whole tree is in the arena */
+      *pp = t->nxt;
+      marena_free(csound, t->arena);
+      csound->Free(csound, t);
+      return;
+    }
+  }
   delete_tree(csound, tree);
 }
 
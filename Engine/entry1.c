@@ -196,6 +196,8 @@ OENTRY opcodlst_1[] = {
   { "##mul.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   mulaa   },
   { "##div.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   divaa   },
   { "##mod.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   modaa   },
+  { "##fused",   S(FUSED),0,  3,      "a",    "SM",
+    (SUBR) fused_init, (SUBR) fused_perf },
   { "##addin.i", S(ASSIGN),0, 1,      "i",    "i",    addin,  NULL    },
   { "##addin.k", S(ASSIGN),0, 2,      "k",    "k",    NULL,   addin   },
   { "##addin.K", S(ASSIGN),0, 2,      "a",    "k",    NULL,   addinak },
@@ -437,21 +439,21 @@ OENTRY opcodlst_1[] = {
      { "oscil.aa", S(POSC),TR, 3, "a", "aajo", posc_set,  poscaa },
      { "oscil3.kk",  S(POSC),TR,  7, "s", "kkjo", posc_set, kposc3, posc3 },
   */
-  { "oscili.a",S(OSC),TR,   3,      "a",    "kkjo", oscset, osckki  },
-  { "oscili.kk",S(OSC),TR,   3,      "k",   "kkjo", oscset, koscli, NULL  },
-  { "oscili.ka",S(OSC),TR,   3,      "a",   "kajo", oscset,   osckai  },
-  { "oscili.ak",S(OSC),TR,   3,      "a",   "akjo", oscset,   oscaki  },
-  { "oscili.aa",S(OSC),TR,   3,      "a",   "aajo", oscset,   oscaai  },
+  { "oscili.a",S(OSC),TR,   3,      "a",    "kkjoo", oscseti, osckki  },
+  { "oscili.kk",S(OSC),TR,   3,      "k",   "kkjoo", oscseti, koscli, NULL  },
+  { "oscili.ka",S(OSC),TR,   3,      "a",   "kajoo", oscseti, osckai  },
+  { "oscili.ak",S(OSC),TR,   3,      "a",   "akjoo", oscseti, oscaki  },
+  { "oscili.aa",S(OSC),TR,   3,      "a",   "aajoo", oscseti, oscaai  },
   { "oscili.aA",S(OSC),0,   3,      "a",   "kki[]o", oscsetA, osckki  },
   { "oscili.kkA",S(OSC),0,   3,      "k",  "kki[]o", oscsetA, koscli, NULL  },
   { "oscili.kaA",S(OSC),0,   3,      "a",  "kai[]o", oscsetA,   osckai  },
   { "oscili.akA",S(OSC),0,   3,      "a",  "aki[]o", oscsetA,   oscaki  },
   { "oscili.aaA",S(OSC),0,   3,      "a",  "aai[]o", oscsetA,   oscaai  },
-  { "oscil3.a",S(OSC),TR,   3,      "a",    "kkjo", oscset, osckk3  },
-  { "oscil3.kk",S(OSC),TR,   3,      "k",   "kkjo", oscset, koscl3, NULL  },
-  { "oscil3.ka",S(OSC),TR,   3,      "a",   "kajo", oscset,   oscka3  },
-  { "oscil3.ak",S(OSC),TR,   3,      "a",   "akjo", oscset,   oscak3  },
-  { "oscil3.aa",S(OSC),TR,   3,      "a",   "aajo", oscset,   oscaa3  },
+  { "oscil3.a",S(OSC),TR,   3,      "a",    "kkjoo", oscseti, osckk3  },
+  { "oscil3.kk",S(OSC),TR,   3,      "k",   "kkjoo", oscseti, koscl3, NULL  },
+  { "oscil3.ka",S(OSC),TR,   3,      "a",   "kajoo", oscseti, oscka3  },
+  { "oscil3.ak",S(OSC),TR,   3,      "a",   "akjoo", oscseti, oscak3  },
+  { "oscil3.aa",S(OSC),TR,   3,      "a",   "aajoo", oscseti, oscaa3  },
   { "oscil3.aA",S(OSC),0,   3,      "a",   "kki[]o", oscsetA, osckk3 },
   { "oscil3.kkA",S(OSC),0,   3,      "k",  "kki[]o", oscsetA, koscl3, NULL },
   { "oscil3.kaA",S(OSC),0,   3,      "a",  "kai[]o", oscsetA, oscka3 },
@@ -765,6 +767,8 @@ OENTRY opcodlst_1[] = {
   { "limit.a",  S(LIMIT),0, 2, "a",     "akk",  NULL,  (SUBR)limit },
   { "prealloc", S(AOP),0,   1, "",      "iio",  (SUBR)prealloc, NULL, NULL  },
    { "prealloc", S(AOP),0,   1, "",      "Sio",  (SUBR)prealloc_S, NULL, NULL  },
+  { "asyncinit", S(AOP),0,  1, "",      "ip",   (SUBR)asyncinit, NULL, NULL  },
+  { "asyncinit", S(AOP),0,  1, "",      "Sp",   (SUBR)asyncinit_S, NULL, NULL  },
   /* opcode   dspace      thread  outarg  inargs  isub    ksub    asub    */
   { "inh",    S(INH),0,     2,      "aaaaaa","",    NULL,   inh     },
   { "ino",    S(INO),0,     2,      "aaaaaaaa","",  NULL,   ino     },
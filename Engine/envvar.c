@@ -1165,10 +1165,14 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
     default:                                  /* low level I/O */
       *((int*) fd) = tmp_fd;
     }
-    /* link into chain of open files */
+    /* link into chain of open files; GEN routines may open files on
+       the table generation threads, see hfgens_async() */
+    csoundSpinLock(&csound->spinlock1);
+    p->nxt = (CSFILE*) csound->open_files;
     if (csound->open_files != NULL)
       ((CSFILE*) csound->open_files)->prv = p;
     csound->open_files = (void*) p;
+    csoundSpinUnLock(&csound->spinlock1);
     /* notify the host if it asked */
     if (csound->FileOpenCallback_ != NULL) {
       int writing = (type == CSFILE_SND_W || type == CSFILE_FD_W ||
@@ -1258,9 +1262,12 @@ void *csoundCreateFileHandle(CSOUND *csound,
       return NULL;
     }
     /* link into chain of open files */
+    csoundSpinLock(&csound->spinlock1);
+    p->nxt = (CSFILE*) csound->open_files;
     if (csound->open_files != NULL)
       ((CSFILE*) csound->open_files)->prv = p;
     csound->open_files = (void*) p;
+    csoundSpinUnLock(&csound->spinlock1);
     /* return with opaque file handle */
     p->cb = NULL;
     return (void*) p;
@@ -1304,12 +1311,14 @@ int csoundFileClose(CSOUND *csound, void *fd)
         break;
       }
       /* unlink from chain of open files */
+      csoundSpinLock(&csound->spinlock1);
       if (p->prv == NULL)
         csound->open_files = (void*) p->nxt;
       else
         p->prv->nxt = p->nxt;
       if (p->nxt != NULL)
         p->nxt->prv = p->prv;
+      csoundSpinUnLock(&csound->spinlock1);
       if (p->buf != NULL) csound->Free(csound, p->buf);
       p->bufsize = 0;
       csound->DestroyCircularBuffer(csound, p->cb);
@@ -1332,12 +1341,14 @@ int csoundFileClose(CSOUND *csound, void *fd)
         break;
       }
       /* unlink from chain of open files */
+      csoundSpinLock(&csound->spinlock1);
       if (p->prv == NULL)
         csound->open_files = (void*) p->nxt;
       else
         p->prv->nxt = p->nxt;
       if (p->nxt != NULL)
         p->nxt->prv = p->prv;
+      csoundSpinUnLock(&csound->spinlock1);
     }
     /* free allocated memory */
     csound->Free(csound, fd);
@@ -111,7 +111,12 @@ typedef struct namedgen {
 
 CS_NOINLINE int  fterror(const FGDATA *, const char *, ...);
 static CS_NOINLINE void ftresdisp(const FGDATA *, FUNC *);
-static CS_NOINLINE FUNC *ftalloc(const FGDATA *);
+static void ftdisplay(CSOUND *, FUNC *, int, int32);
+static CS_NOINLINE FUNC *ftalloc(FGDATA *);
+static int  ftgen_async_pending(CSOUND *, int);
+static void ftgen_async_retire(CSOUND *, void *);
+static void ftfree(CSOUND *, FUNC *);
+static void ftmipmap_drop(CSOUND *, int);
 
 static int GENUL(FGDATA *ff, FUNC *ftp)
 {
@@ -123,144 +128,165 @@ static inline unsigned int isPowerOfTwo (unsigned int x) {
   return (x > 0) && !(x & (x - 1)) ? 1 : 0;
 }
 
-/**
- * Create ftable using evtblk data, and store pointer to new table in *ftpp.
- * If mode is zero, a zero table number is ignored, otherwise a new table
- * number is automatically assigned.
- * Returns zero on success.
- */
+/* extend flist to hold table fno; while tables are being built on the
+   generation threads the old list is kept until they are all published,
+   as GENs reading other tables may still hold it */
 
-int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
+static void flist_extend(CSOUND *csound, int fno)
+{
+    FUNC  **nn;
+    int   i, size;
+
+    for (size = csound->maxfnum; size < fno; size += MAXFNUM)
+      ;
+    if (csound->ftgen_async == NULL) {
+      nn = (FUNC**) csound->ReAlloc(csound,
+                                    csound->flist, (size + 1) * sizeof(FUNC*));
+    }
+    else {
+      nn = (FUNC**) csound->Malloc(csound, (size + 1) * sizeof(FUNC*));
+      memcpy(nn, csound->flist, (csound->maxfnum + 1) * sizeof(FUNC*));
+      ftgen_async_retire(csound, csound->flist);
+    }
+    for (i = csound->maxfnum + 1; i <= size; i++)
+      nn[i] = NULL;                             /*  Clear new section       */
+    if (csound->ft_mipmaps != NULL) {           /*  kept the same size      */
+      void  **mm = (void**) csound->ReAlloc(csound, csound->ft_mipmaps,
+                                            (size + 1) * sizeof(void*));
+      for (i = csound->maxfnum + 1; i <= size; i++)
+        mm[i] = NULL;
+      csound->ft_mipmaps = mm;
+    }
+    csound->flist = nn;
+    csound->maxfnum = size;
+}
+
+/* What hfgens() found out about the table to make before calling the GEN */
+
+typedef struct {
+    int32   genum;
+    int     lobits;
+    int     nonpowof2_flag;     /* gab: fixed for non-powoftwo function tables*/
+} FTPLAN;
+
+/* Checks the f event in evtblkp and works out the table number, GEN and
+   size.  Returns 1 if a table is to be made, 0 if there is nothing to do
+   (fno 0 in mode 0, or a deleted table) and -1 on errors. */
+
+static int ftgen_plan(CSOUND *csound, FGDATA *ff, FTPLAN *pl,
+                      const EVTBLK *evtblkp, int mode)
 {
     int32    genum, ltest;
-    int     lobits, msg_enabled, i;
+    int     lobits, msg_enabled;
     FUNC    *ftp;
-    FGDATA  ff;
     int nonpowof2_flag=0; /* gab: fixed for non-powoftwo function tables*/
 
-    *ftpp = NULL;
     if (UNLIKELY(csound->gensub == NULL)) {
       csound->gensub = (GEN*) csound->Malloc(csound, sizeof(GEN) * (GENMAX + 1));
       memcpy(csound->gensub, or_sub, sizeof(GEN) * (GENMAX + 1));
       csound->genmax = GENMAX + 1;
     }
     msg_enabled = csound->oparms->msglevel & 7;
-    memset(&ff, '\0', sizeof(ff)); /* for Valgrind */
-    ff.csound = csound;
-    memcpy((char*) &(ff.e), (char*) evtblkp,
+    memset(ff, '\0', sizeof(FGDATA)); /* for Valgrind */
+    ff->csound = csound;
+    memcpy((char*) &(ff->e), (char*) evtblkp,
            (size_t) ((char*) &(evtblkp->p[2]) - (char*) evtblkp));
-    ff.fno = (int) MYFLT2LRND(ff.e.p[1]);
-    if (!ff.fno) {
+    ff->fno = (int) MYFLT2LRND(ff->e.p[1]);
+    if (!ff->fno) {
       if (!mode)
         return 0;                               /*  fno = 0: return,        */
-      ff.fno = FTAB_SEARCH_BASE;
+      ff->fno = FTAB_SEARCH_BASE;
       do {                                      /*      or automatic number */
-        ++ff.fno;
-      } while (ff.fno <= csound->maxfnum && csound->flist[ff.fno] != NULL);
-      ff.e.p[1] = (MYFLT) (ff.fno);
-    }
-    else if (ff.fno < 0) {                      /*  fno < 0: remove         */
-      ff.fno = -(ff.fno);
-      if (UNLIKELY(ff.fno > csound->maxfnum ||
-                   (ftp = csound->flist[ff.fno]) == NULL)) {
-        return fterror(&ff, Str("ftable does not exist"));
-      }
-      csound->flist[ff.fno] = NULL;
-      csound->Free(csound, (void*) ftp);
+        ++ff->fno;
+      } while (ff->fno <= csound->maxfnum &&
+               (csound->flist[ff->fno] != NULL ||
+                ftgen_async_pending(csound, ff->fno)));
+      ff->e.p[1] = (MYFLT) (ff->fno);
+    }
+    else if (ff->fno < 0) {                     /*  fno < 0: remove         */
+      ff->fno = -(ff->fno);
+      if (UNLIKELY(ff->fno > csound->maxfnum ||
+                   (ftp = csound->flist[ff->fno]) == NULL)) {
+        return fterror(ff, Str("ftable does not exist"));
+      }
+      csound->flist[ff->fno] = NULL;
+      ftmipmap_drop(csound, ff->fno);
+      ftfree(csound, ftp);
       if (UNLIKELY(msg_enabled))
-        csoundMessage(csound, Str("ftable %d now deleted\n"), ff.fno);
+        csoundMessage(csound, Str("ftable %d now deleted\n"), ff->fno);
       return 0;
     }
-    if (UNLIKELY(ff.fno > csound->maxfnum)) {   /* extend list if necessary */
-      FUNC  **nn;
-      int   size;
-      for (size = csound->maxfnum; size < ff.fno; size += MAXFNUM)
-        ;
-      nn = (FUNC**) csound->ReAlloc(csound,
-                                    csound->flist, (size + 1) * sizeof(FUNC*));
-      csound->flist = nn;
-      for (i = csound->maxfnum + 1; i <= size; i++)
-        csound->flist[i] = NULL;                /*  Clear new section       */
-      csound->maxfnum = size;
-    }
-    if (UNLIKELY(ff.e.pcnt <= 4)) {             /*  chk minimum arg count   */
-      return fterror(&ff, Str("insufficient gen arguments"));
+    if (UNLIKELY(ff->fno > csound->maxfnum))    /* extend list if necessary */
+      flist_extend(csound, ff->fno);
+    if (UNLIKELY(ff->e.pcnt <= 4)) {            /*  chk minimum arg count   */
+      return fterror(ff, Str("insufficient gen arguments"));
     }
-    if (UNLIKELY(ff.e.pcnt>PMAX)) {
+    if (UNLIKELY(ff->e.pcnt>PMAX)) {
       //#ifdef BETA
       csound->DebugMsg(csound, "T%d/%d(%d): x=%p memcpy from %p to %p length %zu\n",
-              (int)evtblkp->p[1], (int)evtblkp->p[4], ff.e.pcnt, evtblkp->c.extra,
-              &(ff.e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * PMAX);
+              (int)evtblkp->p[1], (int)evtblkp->p[4], ff->e.pcnt, evtblkp->c.extra,
+              &(ff->e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * PMAX);
       //#endif
-      memcpy(&(ff.e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * (PMAX-2));
-      ff.e.c.extra =
+      memcpy(&(ff->e.p[2]), &(evtblkp->p[2]), sizeof(MYFLT) * (PMAX-2));
+      ff->e.c.extra =
         (MYFLT*)csound->Malloc(csound,sizeof(MYFLT) * (evtblkp->c.extra[0]+1));
-      memcpy(ff.e.c.extra, evtblkp->c.extra,
+      memcpy(ff->e.c.extra, evtblkp->c.extra,
              sizeof(MYFLT) * (evtblkp->c.extra[0]+1));
     }
     else
-      memcpy(&(ff.e.p[2]), &(evtblkp->p[2]),
-             sizeof(MYFLT) * ((int) ff.e.pcnt - 1));
-    if (isstrcod(ff.e.p[4])) {
+      memcpy(&(ff->e.p[2]), &(evtblkp->p[2]),
+             sizeof(MYFLT) * ((int) ff->e.pcnt - 1));
+    if (isstrcod(ff->e.p[4])) {
       /* A named gen given so search the list of extra gens */
       NAMEDGEN *n = (NAMEDGEN*) csound->namedgen;
       while (n) {
-        if (strcmp(n->name, ff.e.strarg) == 0) {    /* Look up by name */
-          ff.e.p[4] = genum = n->genum;
+        if (strcmp(n->name, ff->e.strarg) == 0) {    /* Look up by name */
+          ff->e.p[4] = genum = n->genum;
           break;
         }
         n = n->next;                            /*  and round again         */
       }
       if (UNLIKELY(n == NULL)) {
-        return fterror(&ff, Str("Named gen \"%s\" not defined"), ff.e.strarg);
+        return fterror(ff, Str("Named gen \"%s\" not defined"), ff->e.strarg);
       }
     }
     else {
-      genum = (int32) MYFLT2LRND(ff.e.p[4]);
+      genum = (int32) MYFLT2LRND(ff->e.p[4]);
       if (genum < 0)
         genum = -genum;
       if (UNLIKELY(!genum || genum > csound->genmax)) { /*   & legal gen number x*/
-        return fterror(&ff, Str("illegal gen number"));
+        return fterror(ff, Str("illegal gen number"));
       }
     }
-    ff.flen = (int32) MYFLT2LRND(ff.e.p[3]);
-    if (!ff.flen) {
+    pl->genum = genum;
+    ff->flen = (int32) MYFLT2LRND(ff->e.p[3]);
+    if (!ff->flen) {
       /* defer alloc to gen01|gen23|gen28 */
-      ff.guardreq = 1;
+      ff->guardreq = 1;
       if (UNLIKELY(genum != 1 && genum != 2 && genum != 23 &&
                    genum != 28 && genum != 49 && genum<=GENMAX)) {
-        return fterror(&ff, Str("deferred size for GENs 1, 2, 23, 28 or 49 only"));
-      }
-      if (UNLIKELY(msg_enabled))
-        csoundMessage(csound, Str("ftable %d:\n"), ff.fno);
-      i = (*csound->gensub[genum])(&ff, NULL);
-      ftp = csound->flist[ff.fno];
-      if (i != 0) {
-        csound->flist[ff.fno] = NULL;
-        csound->Free(csound, ftp);
-        return -1;
+        return fterror(ff, Str("deferred size for GENs 1, 2, 23, 28 or 49 only"));
       }
-      *ftpp = ftp;
-      return 0;
+      return 1;
     }
     /* if user flen given */
-    if (ff.flen < 0L || !isPowerOfTwo(ff.flen&~1)) {
+    if (ff->flen < 0L || !isPowerOfTwo(ff->flen&~1)) {
       /* gab for non-pow-of-two-length    */
-      ff.guardreq = 1;
-      if (ff.flen<0) ff.flen = -(ff.flen);             /* gab: fixed */
-      if (!(ff.flen & (ff.flen - 1L)) || ff.flen > MAXLEN)
+      ff->guardreq = 1;
+      if (ff->flen<0) ff->flen = -(ff->flen);             /* gab: fixed */
+      if (!(ff->flen & (ff->flen - 1L)) || ff->flen > MAXLEN)
         goto powOfTwoLen;
       lobits = 0;                       /* Hope this is not needed! */
       nonpowof2_flag = 1; /* gab: fixed for non-powoftwo function tables*/
     }
     else {
-      ff.guardreq = ff.flen & 01;       /*  set guard request flg   */
-      ff.flen &= -2L;                   /*  flen now w/o guardpt    */
+      ff->guardreq = ff->flen & 01;     /*  set guard request flg   */
+      ff->flen &= -2L;                  /*  flen now w/o guardpt    */
  powOfTwoLen:
-      if (UNLIKELY(ff.flen <= 0L || ff.flen > MAXLEN)) {
-        return fterror(&ff, Str("illegal table length"));
+      if (UNLIKELY(ff->flen <= 0L || ff->flen > MAXLEN)) {
+        return fterror(ff, Str("illegal table length"));
       }
-      for (ltest = ff.flen, lobits = 0;
+      for (ltest = ff->flen, lobits = 0;
            (ltest & MAXLEN) == 0L;
            lobits++, ltest <<= 1)
         ;
@@ -269,46 +295,461 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
         //csound->Warning(csound, Str("table %d size not power of two"), ff.fno);
         lobits = 0;
         nonpowof2_flag = 1;
-        ff.guardreq = 1;
+        ff->guardreq = 1;
       }
     }
-    ftp = ftalloc(&ff);                 /*  alloc ftable space now  */
-    ftp->lenmask  = ((ff.flen & (ff.flen - 1L)) ?
-                     0L : (ff.flen - 1L));      /*  init hdr w powof2 data  */
-    ftp->lobits   = lobits;
-    i = (1 << lobits);
+    pl->lobits = lobits;
+    pl->nonpowof2_flag = nonpowof2_flag;
+    return 1;
+}
+
+/* Runs the GEN planned by ftgen_plan().  The table goes to flist, or for
+   ff->async to ff->async_ftp only. */
+
+static int ftgen_make(FGDATA *ff, const FTPLAN *pl, FUNC **ftpp)
+{
+    CSOUND  *csound = ff->csound;
+    FUNC    *ftp;
+    int     i, msg_enabled = csound->oparms->msglevel & 7;
+
+    if (!ff->flen) {                    /*  deferred size           */
+      if (UNLIKELY(msg_enabled))
+        csoundMessage(csound, Str("ftable %d:\n"), ff->fno);
+      i = (*csound->gensub[pl->genum])(ff, NULL);
+      ftp = ff->async ? ff->async_ftp : csound->flist[ff->fno];
+      if (i != 0) {
+        if (!ff->async)
+          csound->flist[ff->fno] = NULL;
+        else if (ftp != NULL)
+          csound->Free(csound, ftp->ftable);
+        csound->Free(csound, ftp);
+        ff->async_ftp = NULL;
+        return -1;
+      }
+      *ftpp = ftp;
+      return 0;
+    }
+    ftp = ftalloc(ff);                  /*  alloc ftable space now  */
+    ftp->lenmask  = ((ff->flen & (ff->flen - 1L)) ?
+                     0L : (ff->flen - 1L));     /*  init hdr w powof2 data  */
+    ftp->lobits   = pl->lobits;
+    i = (1 << pl->lobits);
     ftp->lomask   = (int32) (i - 1);
     ftp->lodiv    = FL(1.0) / (MYFLT) i;        /*    & other useful vals   */
     ftp->nchanls  = 1;                          /*    presume mono for now  */
     ftp->gen01args.sample_rate = csound->esr;  /* set table SR to esr */
-    ftp->flenfrms = ff.flen;
-    if (nonpowof2_flag)
+    ftp->flenfrms = ff->flen;
+    if (pl->nonpowof2_flag)
       ftp->lenmask = 0xFFFFFFFF; /* gab: fixed for non-powoftwo function tables */
 
     if (UNLIKELY(msg_enabled))
-      csoundMessage(csound, Str("ftable %d:\n"), ff.fno);
-    if ((*csound->gensub[genum])(&ff, ftp) != 0) {
-      csound->flist[ff.fno] = NULL;
+      csoundMessage(csound, Str("ftable %d:\n"), ff->fno);
+    if ((*csound->gensub[pl->genum])(ff, ftp) != 0) {
+      if (!ff->async)
+        csound->flist[ff->fno] = NULL;
+      else
+        csound->Free(csound, ftp->ftable);
       csound->Free(csound, ftp);
+      ff->async_ftp = NULL;
       return -1;
     }
     /* VL 11.01.05 for deferred GEN01, it's called in gen01raw */
-    ftresdisp(&ff, ftp);                        /* rescale and display      */
+    ftresdisp(ff, ftp);                         /* rescale and display      */
     *ftpp = ftp;
     /* keep original arguments, from GEN number  */
-    ftp->argcnt = ff.e.pcnt - 3;
+    ftp->argcnt = ff->e.pcnt - 3;
     {  /* Note this does not handle extended args -- JPff */
       int size=ftp->argcnt;
       if (UNLIKELY(size>PMAX-4)) size=PMAX-4;
       /* printf("size = %d -> %d ftp->args = %p\n", */
       /*        size, sizeof(MYFLT)*size, ftp->args); */
-      memcpy(ftp->args, &(ff.e.p[4]), sizeof(MYFLT)*size); /* is this right? */
+      memcpy(ftp->args, &(ff->e.p[4]), sizeof(MYFLT)*size); /* is this right? */
       /*for (k=0; k < size; k++)
         csound->Message(csound, "%f\n", ftp->args[k]);*/
     }
     return 0;
 }
 
+/**
+ * Create ftable using evtblk data, and store pointer to new table in *ftpp.
+ * If mode is zero, a zero table number is ignored, otherwise a new table
+ * number is automatically assigned.
+ * Returns zero on success.
+ */
+
+int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
+{
+    FGDATA  ff;
+    FTPLAN  pl;
+    int     i;
+
+    *ftpp = NULL;
+    if ((i = ftgen_plan(csound, &ff, &pl, evtblkp, mode)) != 1)
+      return i;
+    return ftgen_make(&ff, &pl, ftpp);
+}
+
+/* Asynchronous table generation.
+
+   hfgens_async() checks the event and reserves the table number on the
+   calling thread, as hfgens() does, then queues the GEN for the table
+   generation threads, which build the table into a FUNC of its own.
+   ftgen_async_publish(), called by sensevents() every k-cycle, puts
+   finished tables into flist in the order they were asked for.  A table
+   replacing one of the same size is copied into the old FUNC, so opcodes
+   holding it see the new data, as with hfgens().  Until then flist holds
+   the previous version of the table, if any; csoundFTReady() tells when
+   it is done.  GENs reading other tables see them as they are when the
+   GEN runs; flist arrays and tables replaced meanwhile are kept until
+   every queued table is published.  A GEN that fails on a generation
+   thread, even by csoundDie(), only leaves its table unmade.  GENs using
+   the FFT, whose tables are set up on first use and not shared safely,
+   and named GENs, which may, are run on the calling thread instead and
+   published in turn with the others. */
+
+#define FTGEN_THREADS   (2)
+
+typedef struct ftjob_ {
+    struct ftjob_ *nxt;         /* queue */
+    struct ftjob_ *anxt;        /* all jobs not yet published */
+    FGDATA  ff;
+    FTPLAN  pl;
+    FUNC    *ftp;               /* the table built */
+    int     err, done;
+} FTJOB;
+
+typedef struct {
+    void    *lock, *cond;
+    void    *threads[FTGEN_THREADS];
+    int     nthreads;
+    int     running;
+    volatile int ndone;
+    FTJOB   *qhead, *qtail;
+    FTJOB   *jobs;
+    CONS_CELL *retired;         /* flist arrays and tables replaced */
+} FTGEN_ASYNC;
+
+/* non-zero for GENs that can run on a generation thread */
+
+static int ftgen_async_safe(int32 genum)
+{
+    switch (genum) {
+    case 30: case 31: case 32: case 33: case 53:    /* csound->RealFFT() */
+      return 0;
+    }
+    return (genum <= GENMAX);
+}
+
+/* a GEN that dies (csoundDie(), out of memory) on a generation thread
+   only fails its job */
+
+static int ftgen_async_make(CSOUND *csound, void *p)
+{
+    FTJOB   *j = (FTJOB*) p;
+    (void) csound;
+    return ftgen_make(&j->ff, &j->pl, &j->ftp);
+}
+
+static uintptr_t ftgen_async_thread(void *p)
+{
+    CSOUND      *csound = (CSOUND*) p;
+    FTGEN_ASYNC *fa = (FTGEN_ASYNC*) csound->ftgen_async;
+    FTJOB       *j;
+
+    csoundLockMutex(fa->lock);
+    while (fa->running) {
+      if ((j = fa->qhead) == NULL) {
+        csoundCondWait(fa->cond, fa->lock);
+        continue;
+      }
+      if ((fa->qhead = j->nxt) == NULL)
+        fa->qtail = NULL;
+      csoundUnlockMutex(fa->lock);
+      j->err = csoundRunCaught(csound, ftgen_async_make, j);
+      if (UNLIKELY(j->err != 0 && j->ff.async_ftp != NULL)) {
+        /* left behind by a GEN that did not return */
+        csound->Free(csound, j->ff.async_ftp->ftable);
+        csound->Free(csound, j->ff.async_ftp);
+        j->ff.async_ftp = NULL;
+        j->ftp = NULL;
+      }
+      csoundLockMutex(fa->lock);
+      j->done = 1;
+      ATOMIC_INCR(fa->ndone);
+    }
+    csoundUnlockMutex(fa->lock);
+    return 0;
+}
+
+static FTGEN_ASYNC *ftgen_async_get(CSOUND *csound)
+{
+    FTGEN_ASYNC *fa = (FTGEN_ASYNC*) csound->ftgen_async;
+    int         i;
+
+    if (fa != NULL)
+      return fa;
+    fa = (FTGEN_ASYNC*) csound->Calloc(csound, sizeof(FTGEN_ASYNC));
+    fa->lock = csoundCreateMutex(0);
+    fa->cond = csoundCreateCondVar();
+    fa->running = 1;
+    csound->ftgen_async = fa;
+#ifndef __EMSCRIPTEN__
+    for (i = 0; i < FTGEN_THREADS; i++)
+      if ((fa->threads[i] = csoundCreateThread(ftgen_async_thread,
+                                               (void*) csound)) == NULL)
+        break;
+    fa->nthreads = i;
+#else
+    (void) i;
+#endif
+    return fa;
+}
+
+static void ftgen_async_free_job(CSOUND *csound, FTJOB *j)
+{
+    if (j->ftp != NULL) {
+      csound->Free(csound, j->ftp->ftable);
+      csound->Free(csound, j->ftp);
+    }
+    if (j->ff.e.pcnt > PMAX && j->ff.e.c.extra != NULL)
+      csound->Free(csound, j->ff.e.c.extra);
+    if (j->ff.e.strarg != NULL)
+      csound->Free(csound, j->ff.e.strarg);
+    csound->Free(csound, j);
+}
+
+static int ftgen_async_pending(CSOUND *csound, int fno)
+{
+    FTGEN_ASYNC *fa = (FTGEN_ASYNC*) csound->ftgen_async;
+    FTJOB       *j;
+
+    if (fa == NULL)
+      return 0;
+    csoundLockMutex(fa->lock);
+    for (j = fa->jobs; j != NULL && j->ff.fno != fno; j = j->anxt)
+      ;
+    csoundUnlockMutex(fa->lock);
+    return (j != NULL);
+}
+
+/* keeps p, an flist array or a table, until no job is left */
+
+static void ftgen_async_retire(CSOUND *csound, void *p)
+{
+    FTGEN_ASYNC *fa = (FTGEN_ASYNC*) csound->ftgen_async;
+
+    csoundLockMutex(fa->lock);
+    fa->retired = cs_cons(csound, p, fa->retired);
+    csoundUnlockMutex(fa->lock);
+}
+
+/* frees a table taken out of flist; GENs running on the generation
+   threads may still be reading it, so it is retired while there are */
+
+static void ftfree(CSOUND *csound, FUNC *ftp)
+{
+    FTGEN_ASYNC *fa = (FTGEN_ASYNC*) csound->ftgen_async;
+
+    if (fa != NULL) {
+      csoundLockMutex(fa->lock);
+      if (fa->jobs != NULL) {
+        if (ftp->ftable != NULL)
+          fa->retired = cs_cons(csound, ftp->ftable, fa->retired);
+        fa->retired = cs_cons(csound, ftp, fa->retired);
+        ftp = NULL;
+      }
+      csoundUnlockMutex(fa->lock);
+    }
+    if (ftp != NULL) {
+      csound->Free(csound, ftp->ftable);
+      csound->Free(csound, ftp);
+    }
+}
+
+/* called with the lock held, when no job is left */
+
+static void ftgen_async_free_retired(CSOUND *csound, FTGEN_ASYNC *fa)
+{
+    CONS_CELL *c;
+
+    for (c = fa->retired; c != NULL; c = c->next)
+      csound->Free(csound, c->value);
+    cs_cons_free(csound, fa->retired);
+    fa->retired = NULL;
+}
+
+/* puts a finished table in flist */
+
+static void ftgen_async_install(CSOUND *csound, FTJOB *j)
+{
+    FUNC    *ftp = j->ftp, *old;
+    int     fno = j->ff.fno;
+
+    if (j->err != 0 || ftp == NULL)
+      return;                           /* fterror() has reported it */
+    if (UNLIKELY(fno > csound->maxfnum))
+      flist_extend(csound, fno);
+    old = csound->flist[fno];
+    ftmipmap_drop(csound, fno);
+    if (old != NULL && old->flen == ftp->flen) {
+      MYFLT *tab = old->ftable;
+      memcpy(tab, ftp->ftable, sizeof(MYFLT) * (ftp->flen + 1));
+      *old = *ftp;
+      old->ftable = tab;
+      ftp = old;
+    }
+    else {
+      if (old != NULL) {
+        csound->Warning(csound, Str("replacing previous ftable %d"), fno);
+        if (UNLIKELY(csound->actanchor.nxtact != NULL)) {
+          csound->Warning(csound, Str("ftable %d relocating due to size change"
+                                      "\n         currently active instruments "
+                                      "may find this disturbing"), fno);
+        }
+        ftfree(csound, old);
+      }
+      csound->flist[fno] = ftp;
+      j->ftp = NULL;
+    }
+    if (csound->oparms->displays)
+      ftdisplay(csound, ftp, fno, ftp->flen);
+}
+
+/**
+ * Like hfgens(), but the GEN runs on a table generation thread and the
+ * table replaces flist[fno] once it is built, at the start of a later
+ * k-cycle.  Returns the table number, 0 if there is nothing to make
+ * (fno 0 in mode 0, or a deleted table) and -1 on errors found before
+ * the GEN is run.
+ */
+
+int hfgens_async(CSOUND *csound, const EVTBLK *evtblkp, int mode)
+{
+    FTGEN_ASYNC *fa;
+    FTJOB       *j, **pp;
+    int         i;
+
+    j = (FTJOB*) csound->Calloc(csound, sizeof(FTJOB));
+    if ((i = ftgen_plan(csound, &j->ff, &j->pl, evtblkp, mode)) != 1) {
+      if (j->ff.e.pcnt > PMAX && j->ff.e.c.extra != NULL)
+        csound->Free(csound, j->ff.e.c.extra);
+      csound->Free(csound, j);
+      return i;
+    }
+    if (!j->ff.flen && j->pl.genum > GENMAX) {
+      /* named GENs with deferred size allocate through flist */
+      FUNC  *ftp;
+      i = ftgen_make(&j->ff, &j->pl, &ftp);
+      i = (i == 0 ? j->ff.fno : -1);
+      if (j->ff.e.pcnt > PMAX && j->ff.e.c.extra != NULL)
+        csound->Free(csound, j->ff.e.c.extra);
+      csound->Free(csound, j);
+      return i;
+    }
+    /* the caller's strings may be gone by the time the GEN runs */
+    if (j->ff.e.strarg != NULL)
+      j->ff.e.strarg = cs_strdup(csound, j->ff.e.strarg);
+    j->ff.async = 1;
+    fa = ftgen_async_get(csound);
+    if (fa->nthreads == 0 || !ftgen_async_safe(j->pl.genum)) {
+      j->err = ftgen_make(&j->ff, &j->pl, &j->ftp);
+      j->done = 1;
+      ATOMIC_INCR(fa->ndone);
+    }
+    csoundLockMutex(fa->lock);
+    for (pp = &fa->jobs; *pp != NULL; pp = &((*pp)->anxt))
+      ;
+    *pp = j;
+    if (!j->done) {
+      if (fa->qtail != NULL)
+        fa->qtail->nxt = j;
+      else
+        fa->qhead = j;
+      fa->qtail = j;
+      csoundCondSignal(fa->cond);
+    }
+    csoundUnlockMutex(fa->lock);
+    return j->ff.fno;
+}
+
+/* called by sensevents() at the start of each k-cycle */
+
+void ftgen_async_publish(CSOUND *csound)
+{
+    FTGEN_ASYNC *fa = (FTGEN_ASYNC*) csound->ftgen_async;
+    FTJOB       *j, *k, **pp, *ready = NULL, **rlast = &ready;
+
+    if (LIKELY(fa == NULL || ATOMIC_GET(fa->ndone) == 0))
+      return;
+    csoundLockMutex(fa->lock);
+    for (pp = &fa->jobs; (j = *pp) != NULL; ) {
+      for (k = fa->jobs; k != j && k->ff.fno != j->ff.fno; k = k->anxt)
+        ;
+      if (!j->done || k != j) {         /* or an earlier one for fno */
+        pp = &(j->anxt);
+        continue;
+      }
+      *pp = j->anxt;
+      j->anxt = NULL;
+      *rlast = j;
+      rlast = &(j->anxt);
+      ATOMIC_DECR(fa->ndone);
+    }
+    csoundUnlockMutex(fa->lock);
+    while ((j = ready) != NULL) {
+      ready = j->anxt;
+      ftgen_async_install(csound, j);
+      ftgen_async_free_job(csound, j);
+    }
+    csoundLockMutex(fa->lock);
+    if (fa->jobs == NULL)
+      ftgen_async_free_retired(csound, fa);
+    csoundUnlockMutex(fa->lock);
+}
+
+/* called by csoundCleanup(): joins the threads and drops unpublished
+   tables */
+
+void ftgen_async_stop(CSOUND *csound)
+{
+    FTGEN_ASYNC *fa = (FTGEN_ASYNC*) csound->ftgen_async;
+    FTJOB       *j;
+    int         i;
+
+    if (fa == NULL)
+      return;
+    csoundLockMutex(fa->lock);
+    fa->running = 0;
+    for (i = 0; i < fa->nthreads; i++)
+      csoundCondSignal(fa->cond);
+    csoundUnlockMutex(fa->lock);
+    for (i = 0; i < fa->nthreads; i++)
+      csoundJoinThread(fa->threads[i]);
+    while ((j = fa->jobs) != NULL) {
+      fa->jobs = j->anxt;
+      ftgen_async_free_job(csound, j);
+    }
+    ftgen_async_free_retired(csound, fa);
+    csoundDestroyCondVar(fa->cond);
+    csoundDestroyMutex(fa->lock);
+    csound->Free(csound, fa);
+    csound->ftgen_async = NULL;
+}
+
+/**
+ * Returns 1 if table fno exists and no new version of it is being made
+ * by hfgens_async(), 0 while one is, and -1 if there is no such table.
+ */
+
+int csoundFTReady(CSOUND *csound, int fno)
+{
+    if (ftgen_async_pending(csound, fno))
+      return 0;
+    if (fno > 0 && fno <= csound->maxfnum && csound->flist[fno] != NULL)
+      return 1;
+    return -1;
+}
+
 /**
  * Allocates space for 'tableNum' with a length (not including the guard
  * point) of 'len' samples. The table data is not cleared to zero.
@@ -318,22 +759,15 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
 int csoundFTAlloc(CSOUND *csound, int tableNum, int len)
 {
     int   i, size;
-    FUNC  **nn, *ftp;
+    FUNC  *ftp;
 
     if (UNLIKELY(tableNum <= 0 || len <= 0 || len > (int) MAXLEN))
       return -1;
-    if (UNLIKELY(tableNum > csound->maxfnum)) { /* extend list if necessary     */
-      for (size = csound->maxfnum; size < tableNum; size += MAXFNUM)
-        ;
-      nn = (FUNC**) csound->ReAlloc(csound,
-                                    csound->flist, (size + 1) * sizeof(FUNC*));
-      csound->flist = nn;
-      for (i = csound->maxfnum + 1; i <= size; i++)
-        csound->flist[i] = NULL;            /* Clear new section            */
-      csound->maxfnum = size;
-    }
+    if (UNLIKELY(tableNum > csound->maxfnum)) /* extend list if necessary   */
+      flist_extend(csound, tableNum);
     /* allocate space for table */
     size = (int) (len * (int) sizeof(MYFLT));
+    ftmipmap_drop(csound, tableNum);
     ftp = csound->flist[tableNum];
     if (ftp == NULL) {
       csound->flist[tableNum] = (FUNC*) csound->Malloc(csound, sizeof(FUNC));
@@ -385,12 +819,163 @@ int csoundFTDelete(CSOUND *csound, int tableNum)
     ftp = csound->flist[tableNum];
     if (UNLIKELY(ftp == NULL))
       return -1;
+    ftmipmap_drop(csound, tableNum);
     csound->flist[tableNum] = NULL;
     csound->Free(csound, ftp);
 
     return 0;
 }
 
+/* Band-limited copies of a table for the oscillators.  Level k keeps the
+   harmonics below flen / 2^(k+1), so it can be read at up to 2^k table
+   samples per output sample without aliasing; level 0 is the table
+   itself.  Every level has the length of the table, so an oscillator
+   only has to swap the data pointer.  All the levels are made, from the
+   spectrum of the table, when the set is first asked for, which the
+   oscillators do at init, so that the performance threads do not run
+   (and set up) FFTs.  The set is thrown away when the table is
+   reallocated or deleted; tables changed in place (tablew and friends)
+   keep their old levels.  Only power of two tables are done.  A set
+   made again for a table is kept with the new one, as other threads may
+   still be reading its levels, until the table is released. */
+
+#define FTMIP_MAXLEVELS (32)
+
+typedef struct ftmipmap_ {
+    FUNC    *ftp;               /* table the levels were made from  */
+    MYFLT   *ftable;
+    uint32_t flen;
+    int     nlevels;
+    MYFLT   *level[FTMIP_MAXLEVELS];
+    struct ftmipmap_ *replaced; /* earlier sets for the same table  */
+} FTMIPMAP;
+
+static void ftmipmap_free(CSOUND *csound, FTMIPMAP *m)
+{
+    FTMIPMAP  *nxt;
+    int       k;
+
+    for ( ; m != NULL; m = nxt) {
+      nxt = m->replaced;
+      for (k = 1; k < m->nlevels; k++)
+        if (m->level[k] != NULL)
+          csound->Free(csound, m->level[k]);
+      csound->Free(csound, m);
+    }
+}
+
+static void ftmipmap_drop(CSOUND *csound, int fno)
+{
+    FTMIPMAP  **mm = (FTMIPMAP**) csound->ft_mipmaps, *m;
+
+    if (mm == NULL || fno < 1 || fno > csound->maxfnum)
+      return;
+    csoundSpinLock(&csound->ft_mipmap_lock);
+    m = mm[fno];
+    mm[fno] = NULL;
+    csoundSpinUnLock(&csound->ft_mipmap_lock);
+    if (m != NULL)
+      ftmipmap_free(csound, m);
+}
+
+/* level k made from spec, the spectrum of the table */
+
+static MYFLT *ftmipmap_level(CSOUND *csound, const MYFLT *spec,
+                             uint32_t flen, int k)
+{
+    uint32_t  i, nh = flen >> (k + 1);
+    MYFLT     *buf, scl;
+
+    buf = (MYFLT*) csound->Malloc(csound, (flen + 1) * sizeof(MYFLT));
+    memcpy(buf, spec, 2 * nh * sizeof(MYFLT));
+    buf[1] = FL(0.0);                   /* Nyquist */
+    for (i = 2 * nh; i < flen; i++)
+      buf[i] = FL(0.0);
+    csound->InverseRealFFT(csound, buf, (int) flen);
+    scl = csound->GetInverseRealFFTScale(csound, (int) flen);
+    if (scl != FL(1.0))
+      for (i = 0; i < flen; i++)
+        buf[i] *= scl;
+    buf[flen] = buf[0];                 /* guard point */
+    return buf;
+}
+
+static FTMIPMAP *ftmipmap_new(CSOUND *csound, FUNC *ftp)
+{
+    FTMIPMAP  **mm, *m, *old;
+    MYFLT     *spec;
+    uint32_t  n;
+    int       k;
+
+    if (csound->ft_mipmaps == NULL) {
+      mm = (FTMIPMAP**) csound->Calloc(csound, (csound->maxfnum + 1)
+                                               * sizeof(FTMIPMAP*));
+      csoundSpinLock(&csound->ft_mipmap_lock);
+      if (csound->ft_mipmaps == NULL) {
+        csound->ft_mipmaps = mm;
+        mm = NULL;
+      }
+      csoundSpinUnLock(&csound->ft_mipmap_lock);
+      if (mm != NULL)
+        csound->Free(csound, mm);
+    }
+    m = (FTMIPMAP*) csound->Calloc(csound, sizeof(FTMIPMAP));
+    m->ftp = ftp;
+    m->ftable = ftp->ftable;
+    m->flen = ftp->flen;
+    for (n = m->flen; n > 1 && m->nlevels < FTMIP_MAXLEVELS; n >>= 1)
+      m->nlevels++;                     /* the last level is DC only */
+    spec = (MYFLT*) csound->Malloc(csound, m->flen * sizeof(MYFLT));
+    memcpy(spec, ftp->ftable, m->flen * sizeof(MYFLT));
+    csound->RealFFT(csound, spec, (int) m->flen);
+    m->level[0] = ftp->ftable;
+    for (k = 1; k < m->nlevels; k++)
+      m->level[k] = ftmipmap_level(csound, spec, m->flen, k);
+    csound->Free(csound, spec);
+    mm = (FTMIPMAP**) csound->ft_mipmaps;
+    csoundSpinLock(&csound->ft_mipmap_lock);
+    old = mm[ftp->fno];
+    if (old != NULL && old->ftp == ftp && old->ftable == ftp->ftable &&
+        old->flen == ftp->flen) {       /* made by another thread */
+      csoundSpinUnLock(&csound->ft_mipmap_lock);
+      ftmipmap_free(csound, m);
+      return old;
+    }
+    m->replaced = old;                  /* freed with the table */
+    mm[ftp->fno] = m;
+    csoundSpinUnLock(&csound->ft_mipmap_lock);
+    return m;
+}
+
+/**
+ * Returns the data of table 'ftp' band-limited for reading 'step' table
+ * samples per output sample, or ftp->ftable if no band-limiting is
+ * needed or the table is not a power of two table from the table list.
+ * A negative step only makes the levels, at init.
+ */
+
+MYFLT *csoundFTMipmap(CSOUND *csound, FUNC *ftp, MYFLT step)
+{
+    FTMIPMAP  *m = NULL;
+    MYFLT     s;
+    int       k, fno = (int) ftp->fno;
+
+    if ((step >= FL(0.0) && step <= FL(1.0)) ||
+        ftp->flen < 4 || (ftp->flen & (ftp->flen - 1)) ||
+        fno < 1 || fno > csound->maxfnum || csound->flist[fno] != ftp)
+      return ftp->ftable;
+    if (csound->ft_mipmaps != NULL)
+      m = ((FTMIPMAP**) csound->ft_mipmaps)[fno];
+    if (m == NULL || m->ftp != ftp || m->ftable != ftp->ftable ||
+        m->flen != ftp->flen)
+      m = ftmipmap_new(csound, ftp);    /* replaced since init */
+    if (step < FL(0.0))
+      return ftp->ftable;
+    for (k = 1, s = FL(2.0); s < step && k < m->nlevels - 1; k++)
+      s += s;
+    return m->level[k];
+}
+
 /* read ftable values directly from p-args */
 
 static int gen02(FGDATA *ff, FUNC *ftp)
@@ -2292,6 +2877,18 @@ CS_NOINLINE int fterror(const FGDATA *ff, const char *s, ...)
     return -1;
 }
 
+static void ftdisplay(CSOUND *csound, FUNC *ftp, int fno, int32 flen)
+{
+    WINDAT  dwindow;
+    char    strmsg[64];
+
+    memset(&dwindow, 0, sizeof(WINDAT));
+    snprintf(strmsg, 64, Str("ftable %d:"), fno);
+    if (csound->csoundMakeGraphCallback_ == NULL) dispinit(csound);
+    dispset(csound, &dwindow, ftp->ftable, flen, strmsg, 0, "ftable");
+    display(csound, &dwindow);
+}
+
 /* set guardpt, rescale the function, and display it */
 
 static CS_NOINLINE void ftresdisp(const FGDATA *ff, FUNC *ftp)
@@ -2299,8 +2896,6 @@ static CS_NOINLINE void ftresdisp(const FGDATA *ff, FUNC *ftp)
     CSOUND  *csound = ff->csound;
     MYFLT   *fp, *finp = &ftp->ftable[ff->flen];
     MYFLT   abs, maxval;
-    WINDAT  dwindow;
-    char    strmsg[64];
 
     if (!ff->guardreq)                      /* if no guardpt yet, do it */
       ftp->ftable[ff->flen] = ftp->ftable[0];
@@ -2315,14 +2910,9 @@ static CS_NOINLINE void ftresdisp(const FGDATA *ff, FUNC *ftp)
         for (fp=ftp->ftable; fp<=finp; fp++)
           *fp /= maxval;
     }
-    if (!csound->oparms->displays)
-      return;
-    memset(&dwindow, 0, sizeof(WINDAT));
-    snprintf(strmsg, 64, Str("ftable %d:"), (int) ff->fno);
-    if (csound->csoundMakeGraphCallback_ == NULL) dispinit(csound);
-    dispset(csound, &dwindow, ftp->ftable, (int32) (ff->flen),
-              strmsg, 0, "ftable");
-    display(csound, &dwindow);
+    if (!csound->oparms->displays || ff->async)
+      return;                               /* async: when it is published */
+    ftdisplay(csound, ftp, ff->fno, ff->flen);
 }
 
 static void generate_sine_tab(CSOUND *csound)
@@ -2356,16 +2946,29 @@ static void generate_sine_tab(CSOUND *csound)
 /* alloc ftable space for fno (or replace one) */
 /*  set ftp to point to that structure         */
 
-static CS_NOINLINE FUNC *ftalloc(const FGDATA *ff)
+static CS_NOINLINE FUNC *ftalloc(FGDATA *ff)
 {
     CSOUND  *csound = ff->csound;
-    FUNC    *ftp = csound->flist[ff->fno];
+    FUNC    *ftp;
+
+    if (ff->async) {                  /* hfgens_async(): not in flist yet */
+      if ((ftp = ff->async_ftp) != NULL) {
+        csound->Free(csound, ftp->ftable);
+        csound->Free(csound, ftp);
+      }
+      ff->async_ftp = ftp = (FUNC*) csound->Calloc(csound, sizeof(FUNC));
+      ftp->ftable = (MYFLT*) csound->Calloc(csound, (1+ff->flen) * sizeof(MYFLT));
+      ftp->fno = (int32) ff->fno;
+      ftp->flen = ff->flen;
+      return ftp;
+    }
+    ftmipmap_drop(csound, ff->fno);
+    ftp = csound->flist[ff->fno];
 
     if (UNLIKELY(ftp != NULL)) {
       csound->Warning(csound, Str("replacing previous ftable %d"), ff->fno);
       if (ff->flen != (int32)ftp->flen) {       /* if redraw & diff len, */
-        csound->Free(csound, ftp->ftable);
-        csound->Free(csound, (void*) ftp);             /*   release old space   */
+        ftfree(csound, ftp);                    /*   release old space   */
         csound->flist[ff->fno] = ftp = NULL;
         if (UNLIKELY(csound->actanchor.nxtact != NULL)) { /*   & chk for danger */
           csound->Warning(csound, Str("ftable %d relocating due to size change"
@@ -41,10 +41,17 @@ static  void    schedofftim(CSOUND *, INSDS *);
 void    beatexpire(CSOUND *, double);
 void    timexpire(CSOUND *, double);
 static  void    instance(CSOUND *, int);
+static  void    instance_ensure(CSOUND *, INSTRTXT *, int);
+static  void    instance_pool_update(CSOUND *, INSTRTXT *, int);
+void    instance_pool_release(CSOUND *, INSTRTXT *);
 extern int argsRequired(char* argString);
 static int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn,
                        MEVENT *mep);
 static int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp);
+static int insert_event_done(CSOUND *, INSDS *, EVTBLK *, int, int, int);
+static int async_init_pending(CSOUND *);
+static int async_init_queue(CSOUND *, INSDS *, EVTBLK *, OPDS *, int);
+static int async_init_cancel(CSOUND *, INSDS *);
 
 static void print_messages(CSOUND *csound, int attr, const char *str){
 #if defined(WIN32)
@@ -102,11 +109,19 @@ static void no_op(CSOUND *csound, int attr,
 };
 
 
- /* do init pass for this instr */
-static int init_pass(CSOUND *csound, INSDS *ip) {
-  int error = 0;
-  if(csound->oparms->realtime)
-    csoundLockMutex(csound->init_pass_threadlock);
+ /* do init pass for this instr, with evt as init_event, and return the
+    init errors it raised; both are set and read under the lock */
+static int init_pass(CSOUND *csound, INSDS *ip, EVTBLK *evt) {
+  int error = 0, nerr, saved;
+  /* with --realtime or an init worker, init passes run on two threads;
+     the lock is not held by the worker here, see async_init_pending() */
+  void *lock = (csound->oparms->realtime || csound->async_init != NULL) ?
+    csound->init_pass_threadlock : NULL;
+  if (lock)
+    csoundLockMutex(lock);
+  saved = csound->inerrcnt;
+  csound->inerrcnt = 0;
+  csound->init_event = evt;
   csound->curip = ip;
   csound->ids = (OPDS *)ip;
   csound->mode = 1;
@@ -117,17 +132,22 @@ static int init_pass(CSOUND *csound, INSDS *ip) {
     error = (*csound->ids->iopadr)(csound, csound->ids);
   }
   csound->mode = 0;
-  if(csound->oparms->realtime)
-    csoundUnlockMutex(csound->init_pass_threadlock);
-  return error;
+  INS_OPRUNS(ip)->stale = 1;  /* rebuild the flat chain after init */
+  nerr = (error != 0 && csound->inerrcnt == 0) ? 1 : csound->inerrcnt;
+  csound->inerrcnt = saved + nerr;
+  if (lock)
+    csoundUnlockMutex(lock);
+  return nerr;
 }
 
 int rireturn(CSOUND *csound, void *p);
 /* do reinit pass */
 static int reinit_pass(CSOUND *csound, INSDS *ip, OPDS *ids) {
   int error = 0;
-  if(csound->oparms->realtime) {
-    csoundLockMutex(csound->init_pass_threadlock);
+  void *lock = (csound->oparms->realtime || csound->async_init != NULL) ?
+    csound->init_pass_threadlock : NULL;
+  if (lock) {
+    csoundLockMutex(lock);
   }
   csound->curip = ip;
   csound->ids = ids;
@@ -140,11 +160,12 @@ static int reinit_pass(CSOUND *csound, INSDS *ip, OPDS *ids) {
     error = (*csound->ids->iopadr)(csound, csound->ids);
   }
   csound->mode = 0;
+  INS_OPRUNS(ip)->stale = 1;
 
   ATOMIC_SET8(ip->actflg, 1);
   csound->reinitflag = ip->reinitflag = 0;
-  if(csound->oparms->realtime)
-    csoundUnlockMutex(csound->init_pass_threadlock);
+  if (lock)
+    csoundUnlockMutex(lock);
   return error;
 }
 
@@ -197,7 +218,7 @@ uintptr_t event_insert_thread(void *p) {
           INSDS *ip = inst[rp].ip;
           ATOMIC_SET(ip->init_done, 0);
           csoundSpinLock(&csound->alloc_spinlock);
-          init_pass(csound, ip);
+          init_pass(csound, ip, csound->init_event);
           csoundSpinUnLock(&csound->alloc_spinlock);
           ATOMIC_SET(ip->init_done, 1);
         }
@@ -374,7 +395,7 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
         else
           csound->Message(csound, Str("new alloc for instr %d:\n"), insno);
       }
-      instance(csound, insno);
+      instance_ensure(csound, tp, insno);
       tp->isNew=0;
     }
 
@@ -395,6 +416,7 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
     /* Add an active instrument */
     tp->active++;
     tp->instcnt++;
+    instance_pool_update(csound, tp, insno);
     csound->dag_changed++;      /* Need to remake DAG */
     nxtp = &(csound->actanchor);    /* now splice into activ lst */
     while ((prvp = nxtp) && (nxtp = prvp->nxtact) != NULL) {
@@ -474,18 +496,30 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
   ip->opcod_iobufs = NULL;
   ip->strarg       = newevtp->strarg;  /* copy strarg so it does not get lost */
 
-  // current event needs to be reset here
-  csound->init_event = newevtp;
-  error = init_pass(csound, ip);
+  if (csound->async_init != NULL &&
+      ((tp->async_init && !tie) || async_init_pending(csound)) &&
+      async_init_queue(csound, ip, newevtp, NULL, tie ? 2 : 0))
+    return 0;                   /* finished by async_init_collect() */
+  error = init_pass(csound, ip, newevtp);
   if(error == 0)
     ATOMIC_SET(ip->init_done, 1);
-  if (UNLIKELY(csound->inerrcnt || ip->p3.value == FL(0.0))) {
+  return insert_event_done(csound, ip, newevtp, tie, error, 0);
+}
+
+/* the rest of a note-on, once its init pass has run with nerr errors */
+static int insert_event_done(CSOUND *csound, INSDS *ip, EVTBLK *newevtp,
+                             int tie, int nerr, int late)
+{
+  OPARMS    *O = csound->oparms;
+  int       insno = ip->insno;
+
+  if (UNLIKELY(nerr || ip->p3.value == FL(0.0))) {
     xturnoff_now(csound, ip);
-    return csound->inerrcnt;
+    return nerr;
   }
 
-  /* new code for sample-accurate timing, not for tied notes */
-  if (O->sampleAccurate && !tie) {
+  /* new code for sample-accurate timing, not for tied or late notes */
+  if (O->sampleAccurate && !tie && !late) {
     int64_t start_time_samps, start_time_kcycles;
     double duration_samps;
     start_time_samps = (int64_t) (ip->p2.value * csound->esr);
@@ -538,7 +572,7 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
                       "Calling schedofftim line %d; offtime= %lf (%lf)\n",
                       __LINE__, ip->offtim, ip->offtim*csound->ekr);
 #endif
-    if(csound->oparms->realtime) // compensate for possible late starts
+    if(csound->oparms->realtime || late) // compensate for late starts
       {
         double p2 = (double) ip->p2.value + csound->timeOffs;
         ip->offtim += (csound->icurTime/csound->esr - p2);
@@ -565,6 +599,311 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
 }
 
 
+/* Asynchronous init passes (asyncinit).
+
+   A note-on of an instrument marked with asyncinit is split in two.
+   insert_event() takes the instance, links it into the active list and
+   fills in its p-fields on the performance thread as usual, but leaves
+   init_done at 0, so kperf passes over it, and queues the init pass for
+   the init worker thread.  async_init_collect(), called by sensevents()
+   at each k-boundary, picks up the init passes the worker has finished,
+   in order, and completes those notes (turnoff on error, turnoff time,
+   instance handle) and sets init_done, so that they are performed from
+   that k-cycle on.  A note thus starts one k-cycle after its time at
+   best; one that had to wait longer for its init pass is reported, and
+   counted in the late_init field of csoundGetEventQueueStats().
+
+   Init passes share engine state (curip, ids, init_event, inerrcnt), so
+   the worker runs each pass under init_pass_threadlock, and puts that
+   state back and leaves its error count in the queue entry afterwards.
+   The performance thread never waits for that lock: while the worker
+   has a pass to run, any other init pass (note-on, tie, MIDI note-on,
+   reinit) is queued behind it as well, pausing its instance until it is
+   collected; otherwise the worker neither holds the lock nor takes it,
+   and the pass runs at once.  Only a note-on that finds the queue full
+   waits.  With --realtime, all init passes already run on the event
+   insert thread and asyncinit has no effect.
+*/
+#define ASYNC_INIT_QUEUE  64
+
+typedef struct {
+  INSDS         *ip;            /* NULL once dropped, see xturnoff() */
+  OPDS          *ids;           /* reinit: the pass starts after it */
+  EVTBLK        evt;            /* the event, for init_event */
+  EVTBLK        *evtp;          /* &evt, or NULL if there was none */
+  int64_t       kcnt;           /* k-cycle the pass was due in */
+  int           type;           /* as in ALLOC_DATA: 0 note, 1 MIDI note,
+                                   2 tie, 3 reinit */
+  int           nerr;           /* init errors */
+  volatile int  cancelled;      /* turned off meanwhile, by the perf thread */
+  volatile int  done;           /* set by the worker */
+} ASYNC_INIT;
+
+typedef struct {
+  void          *thread;
+  void          *wake;          /* notified when a pass is queued */
+  volatile int  running;
+  volatile int  wp;             /* passes queued, by the perf thread */
+  int           rp;             /* passes collected, by the perf thread */
+  uint64_t      late;
+  ASYNC_INIT    q[ASYNC_INIT_QUEUE];
+} ASYNC_INIT_WORKER;
+
+/* the init pass of e, run by the worker through csoundRunCaught() */
+static int async_init_pass(CSOUND *csound, void *p)
+{
+  ASYNC_INIT  *e = (ASYNC_INIT *) p;
+  int         error = 0;
+
+  csound->init_event = e->evtp;
+  csound->curip = e->ip;
+  csound->ids = e->type == 3 ? e->ids : (OPDS *) e->ip;
+  csound->mode = 1;
+  while (error == 0 && (csound->ids = csound->ids->nxti) != NULL &&
+         (e->type != 3 || csound->ids->iopadr != (SUBR) rireturn)) {
+    csound->op = csound->ids->optext->t.oentry->opname;
+    if (UNLIKELY(csound->oparms->odebug))
+      csound->Message(csound, "init %s:\n", csound->op);
+    error = (*csound->ids->iopadr)(csound, csound->ids);
+  }
+  INS_OPRUNS(e->ip)->stale = 1;
+  return error;
+}
+
+static uintptr_t async_init_thread(void *p)
+{
+  CSOUND            *csound = (CSOUND *) p;
+  ASYNC_INIT_WORKER *w = (ASYNC_INIT_WORKER *) csound->async_init;
+  int               wr = 0;
+
+  for (;;) {
+    ASYNC_INIT  *e;
+    INSDS       *curip;
+    OPDS        *ids;
+    EVTBLK      *init_event;
+    int         mode, inerrcnt, error;
+    if (wr == ATOMIC_GET(w->wp)) {
+      /* drain the queue before stopping */
+      if (!ATOMIC_GET(w->running))
+        break;
+      csoundWaitThreadLockNoTimeout(w->wake);
+      continue;
+    }
+    e = &w->q[wr % ASYNC_INIT_QUEUE];
+    if (!ATOMIC_GET(e->cancelled)) {
+      csoundLockMutex(csound->init_pass_threadlock);
+      curip = csound->curip;
+      ids = csound->ids;
+      init_event = csound->init_event;
+      mode = csound->mode;
+      inerrcnt = csound->inerrcnt;
+      csound->inerrcnt = 0;
+      /* an exitnow or csoundDie() in the pass fails this note only */
+      error = csoundRunCaught(csound, async_init_pass, e);
+      e->nerr = (error != 0 && csound->inerrcnt == 0) ? 1 : csound->inerrcnt;
+      csound->curip = curip;
+      csound->ids = ids;
+      csound->init_event = init_event;
+      csound->mode = mode;
+      csound->inerrcnt = inerrcnt;
+      csoundUnlockMutex(csound->init_pass_threadlock);
+    }
+    /* after the unlock: see async_init_pending() */
+    ATOMIC_SET(e->done, 1);
+    wr++;
+  }
+  return (uintptr_t) NULL;
+}
+
+/* started by asyncinit, unless there is one already or in --realtime */
+static void async_init_start(CSOUND *csound)
+{
+  ASYNC_INIT_WORKER *w;
+
+  if (csound->async_init != NULL || csound->oparms->realtime)
+    return;
+  w = (ASYNC_INIT_WORKER *) csound->Calloc(csound, sizeof(ASYNC_INIT_WORKER));
+  w->wake = csoundCreateThreadLock();
+  csoundWaitThreadLock(w->wake, 0);
+  w->running = 1;
+  /* recursive: an init pass can take it again, e.g. with compileorc */
+  csound->init_pass_threadlock = csoundCreateMutex(1);
+  csound->async_init = w;
+  w->thread = csoundCreateThread(async_init_thread, (void *) csound);
+  if (UNLIKELY(w->thread == NULL)) {
+    csound->async_init = NULL;
+    csoundDestroyMutex(csound->init_pass_threadlock);
+    csound->init_pass_threadlock = NULL;
+    csoundDestroyThreadLock(w->wake);
+    csound->Free(csound, w);
+    csound->Warning(csound, Str("asyncinit: cannot start the init worker, "
+                                "init passes will not be offloaded"));
+  }
+}
+
+/* called by csoundCleanup(), before the notes are turned off */
+void async_init_stop(CSOUND *csound)
+{
+  ASYNC_INIT_WORKER *w = (ASYNC_INIT_WORKER *) csound->async_init;
+
+  if (w == NULL)
+    return;
+  ATOMIC_SET(w->running, 0);
+  csoundNotifyThreadLock(w->wake);
+  csoundJoinThread(w->thread);
+  csoundDestroyThreadLock(w->wake);
+  csoundDestroyMutex(csound->init_pass_threadlock);
+  csound->init_pass_threadlock = NULL;
+  /* the notes still queued are turned off with the others */
+  csound->async_init = NULL;
+  csound->Free(csound, w);
+}
+
+/* 1 if the worker has a pass still to run, so may hold the init lock;
+   if not, it does not take it again before the next async_init_queue() */
+static int async_init_pending(CSOUND *csound)
+{
+  ASYNC_INIT_WORKER *w = (ASYNC_INIT_WORKER *) csound->async_init;
+  int               wp = w->wp;
+
+  return wp != w->rp &&
+    !ATOMIC_GET(w->q[(wp - 1) % ASYNC_INIT_QUEUE].done);
+}
+
+/* queue a pass of ip of the given type for the worker, pausing ip until
+   it is collected; 0 if the queue is full */
+static int async_init_queue(CSOUND *csound, INSDS *ip, EVTBLK *evt,
+                            OPDS *ids, int type)
+{
+  ASYNC_INIT_WORKER *w = (ASYNC_INIT_WORKER *) csound->async_init;
+  int               wp = w->wp;
+  ASYNC_INIT        *e;
+
+  if (wp - w->rp >= ASYNC_INIT_QUEUE)
+    return 0;
+  e = &w->q[wp % ASYNC_INIT_QUEUE];
+  ATOMIC_SET(ip->init_done, 0);
+  e->ip = ip;
+  e->ids = ids;
+  if (evt != NULL)
+    e->evt = *evt;
+  e->evtp = evt != NULL ? &e->evt : NULL;
+  e->kcnt = csound->global_kcounter;
+  e->type = type;
+  e->nerr = 0;
+  e->cancelled = 0;
+  e->done = 0;
+  ATOMIC_SET(w->wp, wp + 1);
+  csoundNotifyThreadLock(w->wake);
+  return 1;
+}
+
+/* reinit with an init worker, called by reinit(): queued behind the
+   worker's passes, with ip paused until then, if it has any left */
+int async_init_reinit(CSOUND *csound, INSDS *ip, OPDS *ids)
+{
+  if (async_init_pending(csound) &&
+      async_init_queue(csound, ip, NULL, ids, 3)) {
+    ATOMIC_SET8(ip->actflg, 0);
+    return NOTOK;
+  }
+  reinit_pass(csound, ip, ids);
+  return OK;
+}
+
+/* called by sensevents() at each k-boundary: start the notes whose init
+   pass has been done */
+void async_init_collect(CSOUND *csound)
+{
+  ASYNC_INIT_WORKER *w = (ASYNC_INIT_WORKER *) csound->async_init;
+
+  if (w == NULL)
+    return;
+  while (w->rp != ATOMIC_GET(w->wp)) {
+    ASYNC_INIT  *e = &w->q[w->rp % ASYNC_INIT_QUEUE];
+    INSDS       *ip = e->ip;
+    int64_t     kwait;
+    if (!ATOMIC_GET(e->done))
+      break;                    /* in order, as they were due */
+    w->rp++;
+    if (ip == NULL)             /* dropped by xturnoff() */
+      continue;
+    e->ip = NULL;
+    if (e->cancelled) {         /* turned off while the worker had it */
+      xturnoff_now(csound, ip);
+      continue;
+    }
+    kwait = csound->global_kcounter - e->kcnt;
+    if (UNLIKELY(kwait > 1)) {
+      char *name = csound->engineState.instrtxtp[ip->insno]->insname;
+      w->late++;
+      if (name)
+        csound->Warning(csound, Str("instr %s started %d k-cycles late, "
+                                    "waiting for its init pass"),
+                        name, (int) kwait);
+      else
+        csound->Warning(csound, Str("instr %d started %d k-cycles late, "
+                                    "waiting for its init pass"),
+                        (int) ip->insno, (int) kwait);
+    }
+    if (e->type == 3) {         /* reinit, as in event_insert_thread() */
+      ATOMIC_SET8(ip->actflg, 1);
+      csound->reinitflag = ip->reinitflag = 0;
+      ATOMIC_SET(ip->init_done, 1);
+      continue;
+    }
+    csound->inerrcnt += e->nerr;
+    if (e->nerr == 0) {
+      ATOMIC_SET(ip->init_done, 1);
+    }
+    else
+      csound->Message(csound,
+                      Str(" - note deleted.  i%d had %d init errors\n"),
+                      (int) ip->insno, e->nerr);
+    if (e->type == 1) {         /* the rest of insert_midi() */
+      if (e->nerr)
+        xturnoff_now(csound, ip);
+      else
+        csound->tieflag = csound->reinitflag = ip->tieflag = ip->reinitflag = 0;
+    }
+    else
+      insert_event_done(csound, ip, &e->evt, e->type == 2, e->nerr, 1);
+  }
+}
+
+/* ip is being turned off: drop the passes queued for it.  Returns 0 if
+   there were none, 1 if they were all done, so that ip is turned off
+   now, or 2 if the worker has one left, in which case it is marked and
+   async_init_collect() turns ip off once the worker is done with it */
+static int async_init_cancel(CSOUND *csound, INSDS *ip)
+{
+  ASYNC_INIT_WORKER *w = (ASYNC_INIT_WORKER *) csound->async_init;
+  int               i, found = 0;
+
+  for (i = w->rp; i != w->wp; i++) {
+    ASYNC_INIT *e = &w->q[i % ASYNC_INIT_QUEUE];
+    if (e->ip != ip)
+      continue;
+    if (ATOMIC_GET(e->done)) {
+      e->ip = NULL;
+      if (found == 0)
+        found = 1;
+    }
+    else {
+      ATOMIC_SET(e->cancelled, 1);
+      found = 2;
+    }
+  }
+  return found;
+}
+
+uint64_t async_init_late(CSOUND *csound)
+{
+  ASYNC_INIT_WORKER *w = (ASYNC_INIT_WORKER *) csound->async_init;
+  return w != NULL ? w->late : 0;
+}
+
+
 /* insert a MIDI instr copy into active list */
 /*  then run an init pass                    */
 int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep) {
@@ -615,6 +954,7 @@ int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
   }
   tp->active++;
   tp->instcnt++;
+  instance_pool_update(csound, tp, insno);
   csound->dag_changed++;      /* Need to remake DAG */
   if (UNLIKELY(O->odebug)) {
     char *name = csound->engineState.instrtxtp[insno]->insname;
@@ -634,7 +974,7 @@ int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
       else
         csound->Message(csound, Str("new MIDI alloc for instr %d:\n"), insno);
     }
-    instance(csound, insno);
+    instance_ensure(csound, tp, insno);
     tp->isNew = 0;
   }
   /* pop from free instance chain */
@@ -799,14 +1139,16 @@ int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
     }
   }
 
-  csound->init_event = csound->currevent;
-  error = init_pass(csound, ip);
+  if (csound->async_init != NULL && async_init_pending(csound) &&
+      async_init_queue(csound, ip, csound->currevent, NULL, 1))
+    return 0;                   /* finished by async_init_collect() */
+  error = init_pass(csound, ip, csound->currevent);
   if(error == 0)
     ATOMIC_SET(ip->init_done, 1);
 
-  if (UNLIKELY(csound->inerrcnt)) {
+  if (UNLIKELY(error)) {
     xturnoff_now(csound, ip);
-    return csound->inerrcnt;
+    return error;
   }
   ip->tieflag = ip->reinitflag = 0;
   csound->tieflag = csound->reinitflag = 0;
@@ -959,6 +1301,13 @@ void xturnoff(CSOUND *csound, INSDS *ip)  /* turnoff a particular insalloc  */
 
   if (UNLIKELY(ip->relesing))
     return;                             /* already releasing: nothing to do */
+  if (UNLIKELY(csound->async_init != NULL && !ATOMIC_GET(ip->init_done))) {
+    int queued = async_init_cancel(csound, ip);
+    if (queued == 2)
+      return;                           /* turned off once collected */
+    if (queued)
+      ip->xtratim = 0;                  /* never started: no release */
+  }
 
   chn = ip->m_chnbp;
   if (chn != NULL) {                    /* if this was a MIDI note */
@@ -1048,6 +1397,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
       do {
         if (!ip->actflg) {
           cnt++;
+          txtp->allocated--;
           if (ip->opcod_iobufs && ip->insno > csound->engineState.maxinsno)
             csound->Free(csound, ip->opcod_iobufs);   /* IV - Nov 10 2002 */
           if (ip->fdchp != NULL)
@@ -1078,6 +1428,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
     }
 
     txtp->act_instance = NULL;                /* no free instances */
+    instance_pool_release(csound, txtp);      /* nor any built ahead */
   }
   /* check current items in deadpool to see if they need deleting */
   {
@@ -1198,7 +1549,7 @@ int csoundPerfError(CSOUND *csound, OPDS *h, const char *s, ...)
   }
   else
     snprintf(buf, 512, Str("PERF ERROR in instr %d (opcode %s) line %d: "),
-             ip->insno, csound->op, t.linenum);
+             ip->insno, t.opcod, t.linenum);
   va_start(args, s);
   csoundErrMsgV(csound, buf, s, args);
   va_end(args);
@@ -1231,13 +1582,15 @@ int subinstrset_(CSOUND *csound, SUBINST *p, int instno)
   if (!(pip->reinitflag | pip->tieflag) || p->ip == NULL) {
     /* get instance */
     if (csound->engineState.instrtxtp[instno]->act_instance == NULL)
-      instance(csound, instno);
+      instance_ensure(csound, csound->engineState.instrtxtp[instno], instno);
     p->ip = csound->engineState.instrtxtp[instno]->act_instance;
     csound->engineState.instrtxtp[instno]->act_instance = p->ip->nxtact;
     p->ip->insno = (int16) instno;
     p->ip->actflg++;                  /*    and mark the instr active */
     csound->engineState.instrtxtp[instno]->active++;
     csound->engineState.instrtxtp[instno]->instcnt++;
+    instance_pool_update(csound, csound->engineState.instrtxtp[instno],
+                         instno);
     p->ip->p1.value = (MYFLT) instno;
     /* VL 21-10-16: iobufs are not used here and
        are causing trouble elsewhere. Commenting
@@ -1428,7 +1781,7 @@ int useropcdset(CSOUND *csound, UOPCODE *p)
                                  instno, inm->name);
       }
       if (!tp->act_instance)
-        instance(csound, instno);
+        instance_ensure(csound, tp, instno);
       lcurip = tp->act_instance;            /* use free instance, and */
       tp->act_instance = lcurip->nxtact;    /* remove from chain      */
       if (lcurip->opcod_iobufs==NULL)
@@ -1437,6 +1790,7 @@ int useropcdset(CSOUND *csound, UOPCODE *p)
       lcurip->actflg++;                     /*    and mark the instr active */
       tp->active++;
       tp->instcnt++;
+      instance_pool_update(csound, tp, instno);
       /* link into deact chain */
       lcurip->opcod_deact = parent_ip->opcod_deact;
       lcurip->subins_deact = NULL;
@@ -2342,14 +2696,16 @@ int findLabelMemOffset(CSOUND* csound, INSTRTXT* ip, char* labelName) {
 /* create instance of an instr template */
 /*   allocates and sets up all pntrs    */
 
-static void instance(CSOUND *csound, int insno)
+/* build a new instance of instrument tp in one block; this does not
+   touch the instrument's chains, so it can run on the pool thread */
+static INSDS *instance_alloc(CSOUND *csound, INSTRTXT *tp, int insno, int udo)
 {
-  INSTRTXT  *tp;
   INSDS     *ip;
   OPTXT     *optxt;
   OPDS      *opds, *prvids, *prvpds;
   const OENTRY  *ep;
-  int       i, n, pextent, pextra, pextrab;
+  int       i, n, pextent, pextra, pextrab, nops;
+  size_t    opslen;
   char      *nxtopds, *opdslim;
   MYFLT     **argpp, *lclbas;
   CS_VAR_MEM *lcloffbas; // start of pfields
@@ -2361,7 +2717,6 @@ static void instance(CSOUND *csound, int insno)
   int       argStringCount;
   CS_VARIABLE* current;
 
-  tp = csound->engineState.instrtxtp[insno];
   n = 3;
   if (O->midiKey>n) n = O->midiKey;
   if (O->midiKeyCps>n) n = O->midiKeyCps;
@@ -2371,35 +2726,26 @@ static void instance(CSOUND *csound, int insno)
   if (O->midiVelocityAmp>n) n = O->midiVelocityAmp;
   pextra = n-3;
   pextrab = ((i = tp->pmax - 3L) > 0 ? (int) i * sizeof(CS_VAR_MEM) : 0);
+  /* bound on the perf chain length, for the flat copy kperf runs */
+  for (nops = 0, optxt = tp->nxtop; optxt != NULL; optxt = optxt->nxtop)
+    nops++;
   /* alloc new space,  */
   pextent = sizeof(INSDS) + pextrab + pextra*sizeof(CS_VAR_MEM);
-  ip =
-    (INSDS*) csound->Calloc(csound,
-                            (size_t) pextent + tp->varPool->poolSize +
-                            (tp->varPool->varCount *
-                             CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
-                            (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
-                            tp->opdstot);
+  opslen = (size_t) pextent + tp->varPool->poolSize +
+    (tp->varPool->varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
+    (tp->varPool->varCount * sizeof(CS_VARIABLE*)) + tp->opdstot;
+  opslen = (opslen + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+  ip = (INSDS*) csound->Calloc(csound, opslen + sizeof(OPRUNS) +
+                               nops * sizeof(OPDS*));
+  tp->perf_offset = opslen;     /* the same for every instance of tp */
   ip->csound = csound;
   ip->m_chnbp = (MCHNBLK*) NULL;
   ip->instr = tp;
-  /* IV - Oct 26 2002: replaced with faster version (no search) */
-  ip->prvinstance = tp->lst_instance;
-  if (tp->lst_instance)
-    tp->lst_instance->nxtinstance = ip;
-  else
-    tp->instance = ip;
-  tp->lst_instance = ip;
-  /* link into free instance chain */
-  ip->nxtact = tp->act_instance;
-  tp->act_instance = ip;
   ip->insno = insno;
-  if (UNLIKELY(csound->oparms->odebug))
-    csoundMessage(csound,"instance(): tp->act_instance = %p\n",
-                  tp->act_instance);
-
+  INS_OPRUNS(ip)->max = nops;
+  INS_OPRUNS(ip)->stale = 1;
 
-  if (insno > csound->engineState.maxinsno) {
+  if (udo) {
     //      size_t pcnt = (size_t) tp->opcode_info->perf_incnt;
     //      pcnt += (size_t) tp->opcode_info->perf_outcnt;
     OPCODINFO* info = tp->opcode_info;
@@ -2411,6 +2757,7 @@ static void instance(CSOUND *csound, int insno)
   /* gbloffbas = csound->globalVarPool; */
   lcloffbas = (CS_VAR_MEM*)&ip->p0;
   lclbas = (MYFLT*) ((char*) ip + pextent);   /* split local space */
+  ip->lclbas = lclbas;
   initializeVarPool((void *)csound, lclbas, tp->varPool);
 
   opMemStart = nxtopds = (char*) lclbas + tp->varPool->poolSize +
@@ -2551,25 +2898,320 @@ static void instance(CSOUND *csound, int insno)
 
   }
 
-  /* VL 13-12-13: point the memory to the local ksmps & kr variables,
-     and initialise them */
+  /* VL 13-12-13: initialise the local ksmps & kr variables,
+     instance_link() points the variables at them */
   CS_VARIABLE* var = csoundFindVariableWithName(csound,
                                                 ip->instr->varPool, "ksmps");
   if (var) {
     char* temp = (char*)(lclbas + var->memBlockIndex);
-    var->memBlock = (CS_VAR_MEM*)(temp - CS_VAR_TYPE_OFFSET);
-    var->memBlock->value = csound->ksmps;
+    ((CS_VAR_MEM*)(temp - CS_VAR_TYPE_OFFSET))->value = csound->ksmps;
   }
   var = csoundFindVariableWithName(csound, ip->instr->varPool, "kr");
   if (var) {
     char* temp = (char*)(lclbas + var->memBlockIndex);
-    var->memBlock = (CS_VAR_MEM*)(temp - CS_VAR_TYPE_OFFSET);
-    var->memBlock->value = csound->ekr;
+    ((CS_VAR_MEM*)(temp - CS_VAR_TYPE_OFFSET))->value = csound->ekr;
   }
 
   if (UNLIKELY(nxtopds > opdslim))
     csoundDie(csound, Str("inconsistent opds total"));
+  return ip;
+}
+
+/* add a built instance to the instrument's chains, as a free instance */
+static void instance_link(CSOUND *csound, INSTRTXT *tp, INSDS *ip)
+{
+  CS_VARIABLE *var;
+
+  /* IV - Oct 26 2002: replaced with faster version (no search) */
+  ip->prvinstance = tp->lst_instance;
+  ip->nxtinstance = NULL;
+  if (tp->lst_instance)
+    tp->lst_instance->nxtinstance = ip;
+  else
+    tp->instance = ip;
+  tp->lst_instance = ip;
+  /* link into free instance chain */
+  ip->nxtact = tp->act_instance;
+  tp->act_instance = ip;
+  tp->allocated++;
+  if (UNLIKELY(csound->oparms->odebug))
+    csoundMessage(csound,"instance(): tp->act_instance = %p\n",
+                  tp->act_instance);
+
+  /* VL 13-12-13: point the memory to the local ksmps & kr variables */
+  var = csoundFindVariableWithName(csound, tp->varPool, "ksmps");
+  if (var) {
+    char* temp = (char*)(ip->lclbas + var->memBlockIndex);
+    var->memBlock = (CS_VAR_MEM*)(temp - CS_VAR_TYPE_OFFSET);
+  }
+  var = csoundFindVariableWithName(csound, tp->varPool, "kr");
+  if (var) {
+    char* temp = (char*)(ip->lclbas + var->memBlockIndex);
+    var->memBlock = (CS_VAR_MEM*)(temp - CS_VAR_TYPE_OFFSET);
+  }
+}
+
+static void instance(CSOUND *csound, int insno)
+{
+  INSTRTXT  *tp = csound->engineState.instrtxtp[insno];
+  instance_link(csound, tp,
+                instance_alloc(csound, tp, insno,
+                               insno > csound->engineState.maxinsno));
+}
+
+/* Instance pool: note-ons take free instances from the instrument's
+   act_instance chain and only call instance() when it is empty.  To keep
+   that allocation off the performance thread, each instrument keeps the
+   most instances it has had active at once (active_hw); when the
+   instances it owns fall short of that plus some headroom, a request is
+   queued for the pool thread, which builds instances with
+   instance_alloc() and leaves them on tp->warm.  The performance thread
+   links the warm chain in when it next runs out of free instances.
+
+   pool->busy is held by the pool thread while it works on an instrument,
+   so instance_pool_release() can wait for it before freeing one;
+   pool->lock guards the request queue and the warm chains.  Should
+   instance_alloc() fail on the pool thread, the instance is dropped and
+   no more requests are queued, so note-ons allocate synchronously and
+   report the error on the performance thread.
+*/
+#define POOL_REQUESTS   64
+
+typedef struct {
+  INSTRTXT  *tp;
+  int       insno, udo;
+} POOL_REQUEST;
+
+typedef struct {
+  void          *thread;
+  void          *wake;
+  void          *busy;
+  spin_lock_t   lock;
+  volatile int  running;
+  volatile int  failed;
+  int           rp, items;
+  POOL_REQUEST  req[POOL_REQUESTS];
+} INSDS_POOL;
+
+typedef struct {
+  POOL_REQUEST  r;
+  INSDS         *ip;
+} POOL_BUILD;
+
+/* free an instance that was never activated */
+static void instance_free(CSOUND *csound, INSDS *ip)
+{
+  if (ip->fdchp != NULL)
+    fdchclose(csound, ip);
+  if (ip->auxchp != NULL)
+    auxchfree(csound, ip);
+  free_instr_var_memory(csound, ip);
+  if (ip->opcod_iobufs != NULL)
+    csound->Free(csound, ip->opcod_iobufs);
+  csound->Free(csound, ip);
+}
+
+static int instance_pool_build(CSOUND *csound, void *p)
+{
+  POOL_BUILD  *b = (POOL_BUILD *) p;
+  b->ip = instance_alloc(csound, b->r.tp, b->r.insno, b->r.udo);
+  return OK;
+}
+
+static uintptr_t instance_pool_thread(void *p)
+{
+  CSOUND      *csound = (CSOUND *) p;
+  INSDS_POOL  *pool = (INSDS_POOL *) csound->insds_pool;
+
+  while (ATOMIC_GET(pool->running)) {
+    csoundWaitThreadLockNoTimeout(pool->wake);
+    for (;;) {
+      POOL_REQUEST  r;
+      int           n;
+      csoundLockMutex(pool->busy);
+      csoundSpinLock(&pool->lock);
+      r.tp = NULL;
+      while (pool->items > 0 && r.tp == NULL) {
+        r = pool->req[pool->rp];
+        pool->rp = (pool->rp + 1) % POOL_REQUESTS;
+        pool->items--;
+      }
+      if (r.tp != NULL)
+        r.tp->pool_queued = 0;
+      n = r.tp != NULL ? r.tp->warm_pending : 0;
+      csoundSpinUnLock(&pool->lock);
+      if (r.tp == NULL) {
+        csoundUnlockMutex(pool->busy);
+        break;
+      }
+      while (n-- > 0 && ATOMIC_GET(pool->running)) {
+        POOL_BUILD  b;
+        INSDS       *ip;
+        b.r = r;
+        if (UNLIKELY(csoundRunCaught(csound, instance_pool_build, &b) != OK)) {
+          ATOMIC_SET(pool->failed, 1);
+          csoundSpinLock(&pool->lock);
+          r.tp->warm_pending = 0;
+          csoundSpinUnLock(&pool->lock);
+          break;
+        }
+        ip = b.ip;
+        csoundSpinLock(&pool->lock);
+        ip->nxtact = r.tp->warm;
+        r.tp->warm = ip;
+        r.tp->warm_count++;
+        r.tp->warm_pending--;
+        r.tp->pool_warmed++;
+        csoundSpinUnLock(&pool->lock);
+      }
+      csoundUnlockMutex(pool->busy);
+    }
+  }
+  return (uintptr_t) NULL;
+}
 
+/* called by musmon() when performance starts */
+void instance_pool_start(CSOUND *csound)
+{
+  INSDS_POOL  *pool;
+
+  if (csound->insds_pool != NULL)
+    return;
+  pool = (INSDS_POOL *) csound->Calloc(csound, sizeof(INSDS_POOL));
+  pool->wake = csoundCreateThreadLock();
+  pool->busy = csoundCreateMutex(0);
+  csoundSpinLockInit(&pool->lock);
+  pool->running = 1;
+  csound->insds_pool = pool;
+  pool->thread = csoundCreateThread(instance_pool_thread, (void *) csound);
+  if (UNLIKELY(pool->thread == NULL)) {
+    csoundDestroyThreadLock(pool->wake);
+    csoundDestroyMutex(pool->busy);
+    csound->Free(csound, pool);
+    csound->insds_pool = NULL;
+  }
+}
+
+/* called by csoundCleanup(), before orcompact() */
+void instance_pool_stop(CSOUND *csound)
+{
+  INSDS_POOL  *pool = (INSDS_POOL *) csound->insds_pool;
+
+  if (pool == NULL)
+    return;
+  ATOMIC_SET(pool->running, 0);
+  csoundNotifyThreadLock(pool->wake);
+  csoundJoinThread(pool->thread);
+  csoundDestroyThreadLock(pool->wake);
+  csoundDestroyMutex(pool->busy);
+  csound->Free(csound, pool);
+  csound->insds_pool = NULL;
+}
+
+/* free the instances built ahead for tp and drop its requests;
+   called by orcompact() and before an instrument is freed */
+void instance_pool_release(CSOUND *csound, INSTRTXT *tp)
+{
+  INSDS_POOL  *pool = (INSDS_POOL *) csound->insds_pool;
+  INSDS       *ip;
+
+  if (pool != NULL) {
+    int i;
+    csoundLockMutex(pool->busy);
+    csoundSpinLock(&pool->lock);
+    for (i = 0; i < pool->items; i++) {
+      POOL_REQUEST *r = &pool->req[(pool->rp + i) % POOL_REQUESTS];
+      if (r->tp == tp) r->tp = NULL;
+    }
+  }
+  ip = tp->warm;
+  tp->warm = NULL;
+  tp->warm_count = tp->warm_pending = tp->pool_queued = 0;
+  if (pool != NULL) {
+    csoundSpinUnLock(&pool->lock);
+    csoundUnlockMutex(pool->busy);
+  }
+  while (ip != NULL) {
+    INSDS *nxt = ip->nxtact;
+    instance_free(csound, ip);
+    ip = nxt;
+  }
+}
+
+/* make sure tp has a free instance to pop: link in the warm chain
+   if the pool thread has built any, otherwise allocate one here */
+static void instance_ensure(CSOUND *csound, INSTRTXT *tp, int insno)
+{
+  INSDS_POOL  *pool = (INSDS_POOL *) csound->insds_pool;
+  INSDS       *ip = NULL;
+
+  if (pool != NULL && tp->warm != NULL) {
+    csoundSpinLock(&pool->lock);
+    ip = tp->warm;
+    tp->warm = NULL;
+    tp->warm_count = 0;
+    csoundSpinUnLock(&pool->lock);
+  }
+  if (ip == NULL) {
+    instance(csound, insno);
+    tp->pool_misses++;
+    return;
+  }
+  while (ip != NULL) {
+    INSDS *nxt = ip->nxtact;
+    instance_link(csound, tp, ip);
+    ip = nxt;
+  }
+}
+
+/* called after each activation: keep the high-water mark and ask
+   the pool thread to top up the instances tp owns */
+static void instance_pool_update(CSOUND *csound, INSTRTXT *tp, int insno)
+{
+  INSDS_POOL  *pool = (INSDS_POOL *) csound->insds_pool;
+  int         want;
+
+  if (tp->active > tp->active_hw)
+    tp->active_hw = tp->active;
+  if (pool == NULL || ATOMIC_GET(pool->failed))
+    return;
+  want = tp->active_hw + (tp->active_hw >> 2) + 1 - tp->allocated;
+  if (LIKELY(want <= tp->warm_count + tp->warm_pending))
+    return;
+  csoundSpinLock(&pool->lock);
+  want -= tp->warm_count + tp->warm_pending;
+  if (want > 0 && !tp->pool_queued && pool->items < POOL_REQUESTS) {
+    POOL_REQUEST *r =
+      &pool->req[(pool->rp + pool->items++) % POOL_REQUESTS];
+    r->tp = tp;
+    r->insno = insno;
+    r->udo = insno > csound->engineState.maxinsno;
+    tp->pool_queued = 1;
+  }
+  if (want > 0 && tp->pool_queued)
+    tp->warm_pending += want;
+  else want = 0;
+  csoundSpinUnLock(&pool->lock);
+  if (want > 0)
+    csoundNotifyThreadLock(pool->wake);
+}
+
+PUBLIC int csoundGetInstrumentPoolStats(CSOUND *csound, int insno,
+                                        CS_INSTR_POOL_STATS *stats)
+{
+  INSTRTXT  *tp;
+
+  memset(stats, 0, sizeof(CS_INSTR_POOL_STATS));
+  if (UNLIKELY(insno < 1 || insno > csound->engineState.maxinsno ||
+               (tp = csound->engineState.instrtxtp[insno]) == NULL))
+    return CSOUND_ERROR;
+  stats->allocated = tp->allocated;
+  stats->active = tp->active;
+  stats->high_water = tp->active_hw;
+  stats->warm = tp->warm_count;
+  stats->misses = tp->pool_misses;
+  stats->warmed = tp->pool_warmed;
+  return CSOUND_SUCCESS;
 }
 
 int prealloc_(CSOUND *csound, AOP *p, int instname)
@@ -2605,6 +3247,37 @@ int prealloc_S(CSOUND *csound, AOP *p){
   return prealloc_(csound,p,1);
 }
 
+/* asyncinit insno[, iflag]: run the init pass of the notes of insno on
+   the init worker, see async_init_collect() */
+static int asyncinit_(CSOUND *csound, AOP *p, int instname)
+{
+    int     n;
+
+    if (instname)
+      n = (int) strarg2insno(csound, ((STRINGDAT*)p->r)->data, 1);
+    else {
+      if (csound->ISSTRCOD(*p->r))
+        n = (int) strarg2insno(csound, get_arg_string(csound,*p->r), 1);
+      else n = *p->r;
+    }
+    if (UNLIKELY(n == NOT_AN_INSTRUMENT ||
+                 n < 1 || n > csound->engineState.maxinsno ||
+                 csound->engineState.instrtxtp[n] == NULL))
+      return csound->InitError(csound, Str("asyncinit: unknown instrument"));
+    csound->engineState.instrtxtp[n]->async_init = (*p->a != FL(0.0));
+    if (*p->a != FL(0.0))
+      async_init_start(csound);
+    return OK;
+}
+
+int asyncinit(CSOUND *csound, AOP *p){
+  return asyncinit_(csound,p,0);
+}
+
+int asyncinit_S(CSOUND *csound, AOP *p){
+  return asyncinit_(csound,p,1);
+}
+
 int delete_instr(CSOUND *csound, DELETEIN *p)
 {
   int       n;
@@ -2646,6 +3319,7 @@ int delete_instr(CSOUND *csound, DELETEIN *p)
     csound->Free(csound, active);
     active = nxt;
   }
+  instance_pool_release(csound, ip);
   csound->engineState.instrtxtp[n] = NULL;
   /* Now patch it out */
   for (txtp = &(csound->engineState.instxtanchor);
@@ -24,9 +24,17 @@
 
 #include "csoundCore.h"                 /*              MEMALLOC.C      */
 
+#if defined(linux)||defined(__HAIKU__)|| defined(__EMSCRIPTEN__)||defined(__CYGWIN__)
+#define PTHREAD_SPINLOCK_INITIALIZER 0
+#endif
+
 /* This code wraps malloc etc with maintaining a list of allocated memory
    so it can be freed on a reset.  It would not be necessary with a zoned
    allocator.
+   Small blocks come from size classes carved out of large chunks, which
+   are freed in bulk on reset; each thread keeps a short free list per
+   class so that most allocations and frees take no lock at all.  Only
+   blocks too large for a class are individually chained.
 */
 #if defined(BETA) && !defined(MEMDEBUG)
 #define MEMDEBUG  1
@@ -43,16 +51,71 @@ typedef struct memAllocBlock_s {
     void                    *ptr;       /* pointer to allocated area    */
 #endif
     struct memAllocBlock_s  *prv;       /* previous structure in chain  */
-    struct memAllocBlock_s  *nxt;       /* next structure in chain      */
+    struct memAllocBlock_s  *nxt;       /* next in chain or free list   */
+    size_t                  cls;        /* size class or MEM_LARGE      */
 } memAllocBlock_t;
 
-#define HDR_SIZE    (((int) sizeof(memAllocBlock_t) + 7) & (~7))
+#define HDR_SIZE    (((int) sizeof(memAllocBlock_t) + 15) & (~15))
 #define ALLOC_BYTES(n)  ((size_t) HDR_SIZE + (size_t) (n))
 #define DATA_PTR(p) ((void*) ((unsigned char*) (p) + (int) HDR_SIZE))
 #define HDR_PTR(p)  ((memAllocBlock_t*) ((unsigned char*) (p) - (int) HDR_SIZE))
 
 #define MEMALLOC_DB (csound->memalloc_db)
 
+#define MEM_LARGE       ((size_t) -1)
+#define MEM_NCLASSES    20
+#define MEM_MAX_POOLED  16384
+#define MEM_CHUNK       (256*1024)  /* bytes carved into blocks at once */
+#define MEM_BATCH_BYTES (32*1024)   /* bytes moved to a thread at once */
+#define MEM_TCACHE_SLOTS 4          /* instances cached per thread */
+
+static const size_t mem_class_size[MEM_NCLASSES] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024,
+    1536, 2048, 3072, 4096, 6144, 8192, 12288, 16384
+};
+
+typedef struct memChunk_s {
+    struct memChunk_s       *nxt;
+} memChunk_t;
+
+#define CHUNK_HDR   (((int) sizeof(memChunk_t) + 15) & (~15))
+
+typedef struct memPool_s {
+    unsigned long           id;         /* unique, never reused         */
+    CSOUND                  *csound;
+    memAllocBlock_t         *free[MEM_NCLASSES];
+    memChunk_t              *chunks;
+    unsigned char           *cur, *end; /* unused part of last chunk    */
+    CS_MEMORY_STATS         stats;
+    struct memPool_s        *nxt;       /* list of live pools           */
+} memPool_t;
+
+#define MEM_POOL    ((memPool_t*) csound->mem_pool)
+
+/* live pools; this lock is only ever taken on its own, never while
+   holding the global csound lock or a pool's memlock */
+static spin_lock_t   mem_pools_lock = SPINLOCK_INIT;
+static memPool_t     *mem_pools = NULL;
+static unsigned long mem_pool_ids = 0;
+static int           mem_pools_dead = 0;  /* pools released so far */
+
+#if defined(_MSC_VER)
+#define MEM_TLS __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define MEM_TLS __thread
+#endif
+
+#ifdef MEM_TLS
+typedef struct memThreadCache_s {
+    unsigned long           id;         /* pool served, 0 if none       */
+    memAllocBlock_t         *free[MEM_NCLASSES];
+    int                     count[MEM_NCLASSES];
+} memThreadCache_t;
+
+static MEM_TLS memThreadCache_t mem_tcache[MEM_TCACHE_SLOTS];
+static MEM_TLS int              mem_tcache_dead;
+#endif
+
 static void memdie(CSOUND *csound, size_t nbytes)
 {
     csound->ErrorMsg(csound, Str("memory allocate failure for %zd"),
@@ -60,9 +123,191 @@ static void memdie(CSOUND *csound, size_t nbytes)
     csound->LongJmp(csound, CSOUND_MEMORY);
 }
 
+static inline int mem_class(size_t size)
+{
+    int c = 0;
+    if (size > MEM_MAX_POOLED) return -1;
+    while (mem_class_size[c] < size) c++;
+    return c;
+}
+
+/* number of blocks of a class moved between a thread and the pool */
+static inline int mem_batch(int cls)
+{
+    int n = (int) (MEM_BATCH_BYTES / mem_class_size[cls]);
+    return (n < 2 ? 2 : n > 32 ? 32 : n);
+}
+
+static memPool_t *mem_pool(CSOUND *csound)
+{
+    memPool_t *pool = MEM_POOL;
+    if (LIKELY(pool != NULL)) return pool;
+    if (UNLIKELY((pool = (memPool_t*) calloc(1, sizeof(memPool_t))) == NULL))
+      memdie(csound, sizeof(memPool_t));
+    pool->csound = csound;
+    csoundSpinLock(&mem_pools_lock);
+    if (csound->mem_pool == NULL) {
+      pool->id = ++mem_pool_ids;
+      pool->nxt = mem_pools;
+      mem_pools = pool;
+      csound->mem_pool = pool;
+    }
+    else {                              /* lost a race to another thread */
+      free(pool);
+      pool = MEM_POOL;
+    }
+    csoundSpinUnLock(&mem_pools_lock);
+    return pool;
+}
+
+/* Fill a list with up to n blocks of class cls from the pool, carving
+   new ones as needed.  Called with the memory lock held. */
+static int mem_take(CSOUND *csound, memPool_t *pool, int cls, int n,
+                    memAllocBlock_t **list)
+{
+    size_t bytes = ALLOC_BYTES(mem_class_size[cls]);
+    int got = 0;
+    while (got < n && pool->free[cls] != NULL) {
+      memAllocBlock_t *p = pool->free[cls];
+      pool->free[cls] = p->nxt;
+      p->nxt = *list;
+      *list = p;
+      got++;
+    }
+    while (got < n) {
+      memAllocBlock_t *p;
+      if ((size_t) (pool->end - pool->cur) < bytes) {
+        memChunk_t *c;
+        if (got > 0) break;
+        if (UNLIKELY((c = (memChunk_t*) malloc(MEM_CHUNK)) == NULL))
+          return -1;
+        c->nxt = pool->chunks;
+        pool->chunks = c;
+        pool->cur = (unsigned char*) c + CHUNK_HDR;
+        pool->end = (unsigned char*) c + MEM_CHUNK;
+        pool->stats.system_allocs++;
+        pool->stats.pool_bytes += MEM_CHUNK;
+      }
+      p = (memAllocBlock_t*) pool->cur;
+      pool->cur += bytes;
+      p->cls = (size_t) cls;
+      p->prv = NULL;
+      p->nxt = *list;
+      *list = p;
+      got++;
+    }
+    pool->stats.pool_refills++;
+    return got;
+}
+
+#ifdef MEM_TLS
+/* The calling thread's cache for pool, or NULL if all slots serve other
+   live instances; the caller then goes to the pool under its memlock.
+   Slots are never evicted from a live pool, so a thread serving many
+   instances does not keep moving blocks around. */
+static memThreadCache_t *mem_tcache_get(memPool_t *pool)
+{
+    memThreadCache_t *tc;
+    memPool_t *pp;
+    int i, dead;
+    for (i = 0; i < MEM_TCACHE_SLOTS; i++)
+      if (mem_tcache[i].id == pool->id) return &mem_tcache[i];
+    dead = ATOMIC_GET(mem_pools_dead);
+    if (dead != mem_tcache_dead) {
+      /* some pool went away: drop slots that served it, their blocks
+         were freed with its chunks */
+      mem_tcache_dead = dead;
+      csoundSpinLock(&mem_pools_lock);
+      for (i = 0; i < MEM_TCACHE_SLOTS; i++) {
+        if (mem_tcache[i].id == 0) continue;
+        for (pp = mem_pools; pp != NULL && pp->id != mem_tcache[i].id;
+             pp = pp->nxt)
+          ;
+        if (pp == NULL) mem_tcache[i].id = 0;
+      }
+      csoundSpinUnLock(&mem_pools_lock);
+    }
+    for (i = 0; i < MEM_TCACHE_SLOTS; i++)
+      if (mem_tcache[i].id == 0) break;
+    if (i == MEM_TCACHE_SLOTS) return NULL;
+    tc = &mem_tcache[i];
+    memset(tc, 0, sizeof(memThreadCache_t));
+    tc->id = pool->id;
+    return tc;
+}
+#endif
+
+static void *mem_pool_alloc(CSOUND *csound, int cls)
+{
+    memPool_t *pool = mem_pool(csound);
+    memAllocBlock_t *p = NULL;
+    int n;
+#ifdef MEM_TLS
+    memThreadCache_t *tc = mem_tcache_get(pool);
+    if (LIKELY(tc != NULL)) {
+      if (UNLIKELY(tc->free[cls] == NULL)) {
+        CSOUND_MEM_SPINLOCK
+        n = mem_take(csound, pool, cls, mem_batch(cls), &tc->free[cls]);
+        CSOUND_MEM_SPINUNLOCK
+        if (UNLIKELY(n < 0)) memdie(csound, mem_class_size[cls]);
+        tc->count[cls] = n;
+      }
+      p = tc->free[cls];
+      tc->free[cls] = p->nxt;
+      tc->count[cls]--;
+    }
+    else
+#endif
+    {
+      CSOUND_MEM_SPINLOCK
+      n = mem_take(csound, pool, cls, 1, &p);
+      CSOUND_MEM_SPINUNLOCK
+      if (UNLIKELY(n < 0)) memdie(csound, mem_class_size[cls]);
+    }
+#ifdef MEMDEBUG
+    p->magic = MEMALLOC_MAGIC;
+    p->ptr = DATA_PTR(p);
+#endif
+    p->nxt = NULL;
+    return DATA_PTR(p);
+}
+
+static void mem_pool_free(CSOUND *csound, memAllocBlock_t *p)
+{
+    memPool_t *pool = MEM_POOL;
+    int cls = (int) p->cls;
+#ifdef MEM_TLS
+    memThreadCache_t *tc = mem_tcache_get(pool);
+    if (LIKELY(tc != NULL)) {
+      p->nxt = tc->free[cls];
+      tc->free[cls] = p;
+      if (UNLIKELY(++tc->count[cls] > 2*mem_batch(cls))) {
+        /* hand a batch back so other threads can use it */
+        int n = mem_batch(cls);
+        CSOUND_MEM_SPINLOCK
+        while (n--) {
+          p = tc->free[cls];
+          tc->free[cls] = p->nxt;
+          p->nxt = pool->free[cls];
+          pool->free[cls] = p;
+          tc->count[cls]--;
+        }
+        CSOUND_MEM_SPINUNLOCK
+      }
+      return;
+    }
+#endif
+    CSOUND_MEM_SPINLOCK
+    p->nxt = pool->free[cls];
+    pool->free[cls] = p;
+    CSOUND_MEM_SPINUNLOCK
+}
+
 void *mmalloc(CSOUND *csound, size_t size)
 {
     void  *p;
+    int   cls;
+    memPool_t *pool;
 
 #ifdef MEMDEBUG
     if (UNLIKELY(size == (size_t) 0)) {
@@ -71,6 +316,9 @@ void *mmalloc(CSOUND *csound, size_t size)
       return NULL;
     }
 #endif
+    if ((cls = mem_class(size)) >= 0)
+      return mem_pool_alloc(csound, cls);
+    pool = mem_pool(csound);
     /* allocate memory */
     if (UNLIKELY((p = malloc(ALLOC_BYTES(size))) == NULL)) {
         memdie(csound, size);     /* does a long jump */
@@ -80,12 +328,14 @@ void *mmalloc(CSOUND *csound, size_t size)
     ((memAllocBlock_t*) p)->magic = MEMALLOC_MAGIC;
     ((memAllocBlock_t*) p)->ptr = DATA_PTR(p);
 #endif
+    ((memAllocBlock_t*) p)->cls = MEM_LARGE;
     CSOUND_MEM_SPINLOCK
     ((memAllocBlock_t*) p)->prv = (memAllocBlock_t*) NULL;
     ((memAllocBlock_t*) p)->nxt = (memAllocBlock_t*) MEMALLOC_DB;
     if (MEMALLOC_DB != NULL)
       ((memAllocBlock_t*) MEMALLOC_DB)->prv = (memAllocBlock_t*) p;
     MEMALLOC_DB = (void*) p;
+    pool->stats.system_allocs++;
     CSOUND_MEM_SPINUNLOCK
     /* return with data pointer */
     return DATA_PTR(p);
@@ -101,6 +351,8 @@ void *mmallocDebug(CSOUND *csound, size_t size, char *file, int line)
 void *mcalloc(CSOUND *csound, size_t size)
 {
     void  *p;
+    int   cls;
+    memPool_t *pool;
 
 #ifdef MEMDEBUG
     if (UNLIKELY(size == (size_t) 0)) {
@@ -109,6 +361,9 @@ void *mcalloc(CSOUND *csound, size_t size)
       return NULL;
     }
 #endif
+    if ((cls = mem_class(size)) >= 0)
+      return memset(mem_pool_alloc(csound, cls), 0, size);
+    pool = mem_pool(csound);
     /* allocate memory */
     if (UNLIKELY((p = calloc(ALLOC_BYTES(size), (size_t) 1)) == NULL)) {
       memdie(csound, size);     /* does longjump */
@@ -118,12 +373,14 @@ void *mcalloc(CSOUND *csound, size_t size)
     ((memAllocBlock_t*) p)->magic = MEMALLOC_MAGIC;
     ((memAllocBlock_t*) p)->ptr = DATA_PTR(p);
 #endif
+    ((memAllocBlock_t*) p)->cls = MEM_LARGE;
     CSOUND_MEM_SPINLOCK
     ((memAllocBlock_t*) p)->prv = (memAllocBlock_t*) NULL;
     ((memAllocBlock_t*) p)->nxt = (memAllocBlock_t*) MEMALLOC_DB;
     if (MEMALLOC_DB != NULL)
       ((memAllocBlock_t*) MEMALLOC_DB)->prv = (memAllocBlock_t*) p;
     MEMALLOC_DB = (void*) p;
+    pool->stats.system_allocs++;
     CSOUND_MEM_SPINUNLOCK
     /* return with data pointer */
     return DATA_PTR(p);
@@ -157,6 +414,10 @@ void mfree(CSOUND *csound, void *p)
     }
     pp->magic = 0;
  #endif
+    if (pp->cls != MEM_LARGE) {
+      mem_pool_free(csound, pp);
+      return;
+    }
     CSOUND_MEM_SPINLOCK
     /* unlink from chain */
     {
@@ -171,6 +432,7 @@ void mfree(CSOUND *csound, void *p)
     //csound->Message(csound, "free\n");
     /* free memory */
     free((void*) pp);
+    MEM_POOL->stats.system_frees++;
     CSOUND_MEM_SPINUNLOCK
 }
 
@@ -184,6 +446,7 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
 {
     memAllocBlock_t *pp;
     void            *p;
+    int             failed = 0;
 
     if (UNLIKELY(oldp == NULL))
       return mmalloc(csound, size);
@@ -192,6 +455,7 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
       return NULL;
     }
     pp = HDR_PTR(oldp);
+    (void) mem_pool(csound);
 #ifdef MEMDEBUG
     if (UNLIKELY(pp->magic != MEMALLOC_MAGIC || pp->ptr != oldp)) {
       csound->DebugMsg(csound, " *** internal error: mrealloc() called with invalid "
@@ -200,6 +464,30 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
       /* as a result of a bug */
       exit(-1);
     }
+#endif
+    if (pp->cls != MEM_LARGE) {
+      /* pooled blocks stay put while they fit, otherwise move */
+      size_t have = mem_class_size[pp->cls];
+      if (size <= have) return oldp;
+      p = mmalloc(csound, size);
+      memcpy(p, oldp, have);
+      mfree(csound, oldp);
+      return p;
+    }
+    /* unlink from chain while the block may move, as neighbours could be
+       freed meanwhile; it goes back in at the head */
+    CSOUND_MEM_SPINLOCK
+    {
+      memAllocBlock_t *prv = pp->prv, *nxt = pp->nxt;
+      if (nxt != NULL)
+        nxt->prv = prv;
+      if (prv != NULL)
+        prv->nxt = nxt;
+      else
+        MEMALLOC_DB = (void*)nxt;
+    }
+    CSOUND_MEM_SPINUNLOCK
+#ifdef MEMDEBUG
     /* mark old header as invalid */
     pp->magic = 0;
     pp->ptr = NULL;
@@ -208,32 +496,29 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
     p = realloc((void*) pp, ALLOC_BYTES(size));
     if (UNLIKELY(p == NULL)) {
 #ifdef MEMDEBUG
-      CSOUND_MEM_SPINLOCK
       /* alloc failed, restore original header */
       pp->magic = MEMALLOC_MAGIC;
       pp->ptr = oldp;
-      CSOUND_MEM_SPINUNLOCK
 #endif
-      memdie(csound, size);
-      return NULL;
+      p = pp;
+      failed = 1;
     }
     CSOUND_MEM_SPINLOCK
-    /* create new header and update chain pointers */
+    /* create new header and link into chain */
     pp = (memAllocBlock_t*) p;
 #ifdef MEMDEBUG
     pp->magic = MEMALLOC_MAGIC;
     pp->ptr = DATA_PTR(pp);
 #endif
-    {
-      memAllocBlock_t *prv = pp->prv, *nxt = pp->nxt;
-      if (nxt != NULL)
-        nxt->prv = pp;
-      if (prv != NULL)
-        prv->nxt = pp;
-      else
-        MEMALLOC_DB = (void*) pp;
-    }
+    pp->prv = (memAllocBlock_t*) NULL;
+    pp->nxt = (memAllocBlock_t*) MEMALLOC_DB;
+    if (MEMALLOC_DB != NULL)
+      ((memAllocBlock_t*) MEMALLOC_DB)->prv = pp;
+    MEMALLOC_DB = (void*) pp;
+    MEM_POOL->stats.system_allocs++;
     CSOUND_MEM_SPINUNLOCK
+    if (UNLIKELY(failed))
+      memdie(csound, size);
     /* return with data pointer */
     return DATA_PTR(pp);
 }
@@ -248,6 +533,7 @@ void *mreallocDebug(CSOUND *csound, void *oldp, size_t size, char *file, int lin
 void memRESET(CSOUND *csound)
 {
     memAllocBlock_t *pp, *nxtp;
+    memPool_t *pool = MEM_POOL;
 
     pp = (memAllocBlock_t*) MEMALLOC_DB;
     MEMALLOC_DB = NULL;
@@ -259,4 +545,119 @@ void memRESET(CSOUND *csound)
       free((void*) pp);
       pp = nxtp;
     }
+    if (pool != NULL) {
+      memPool_t **ppool;
+      memChunk_t *c = pool->chunks;
+      /* blocks still cached by threads are recognised as stale by id */
+      csoundSpinLock(&mem_pools_lock);
+      for (ppool = &mem_pools; *ppool != pool; ppool = &((*ppool)->nxt))
+        ;
+      *ppool = pool->nxt;
+      csoundSpinUnLock(&mem_pools_lock);
+      ATOMIC_INCR(mem_pools_dead);
+      while (c != NULL) {
+        memChunk_t *nxt = c->nxt;
+        free(c);
+        c = nxt;
+      }
+      free(pool);
+      csound->mem_pool = NULL;
+    }
+}
+
+/* Arenas: bump allocation for objects that all die together, such as the
+   nodes of a parse tree.  Nothing in an arena is freed on its own; the
+   whole arena goes at once with marena_free().  Chunks come from mmalloc()
+   so that a reset still reclaims an arena nobody freed. */
+
+#define ARENA_ALIGN(n)  (((n) + 15) & ~((size_t) 15))
+#define ARENA_FIRST     (16*1024)
+#define ARENA_MAX       (1024*1024)
+
+typedef struct memArenaChunk_s {
+    struct memArenaChunk_s  *nxt;
+    unsigned char           *end;
+} memArenaChunk_t;
+
+#define ARENA_HDR   ARENA_ALIGN(sizeof(memArenaChunk_t))
+
+typedef struct {
+    memArenaChunk_t         *chunks;    /* newest first                 */
+    unsigned char           *cur, *end; /* unused part of first chunk   */
+    size_t                  next;       /* size of the next chunk       */
+} memArena_t;
+
+void *marena_create(CSOUND *csound)
+{
+    memArena_t *a = (memArena_t*) mcalloc(csound, sizeof(memArena_t));
+    a->next = ARENA_FIRST;
+    return a;
+}
+
+/* zeroed, 16-byte aligned */
+void *marena_alloc(CSOUND *csound, void *arena, size_t size)
+{
+    memArena_t      *a = (memArena_t*) arena;
+    memArenaChunk_t *c;
+    unsigned char   *p;
+    size_t          n;
+
+    size = ARENA_ALIGN(size ? size : 1);
+    if (LIKELY((size_t) (a->end - a->cur) >= size)) {
+      p = a->cur;
+      a->cur += size;
+      return p;
+    }
+    if (size > a->next / 4) {
+      /* a large object gets a chunk to itself, behind the current one */
+      c = (memArenaChunk_t*) mcalloc(csound, ARENA_HDR + size);
+      c->end = (unsigned char*) c + ARENA_HDR + size;
+      if (a->chunks != NULL) {
+        c->nxt = a->chunks->nxt;
+        a->chunks->nxt = c;
+      }
+      else a->chunks = c;
+      return (unsigned char*) c + ARENA_HDR;
+    }
+    n = a->next;
+    if (a->next < ARENA_MAX) a->next *= 2;
+    c = (memArenaChunk_t*) mcalloc(csound, ARENA_HDR + n);
+    c->end = (unsigned char*) c + ARENA_HDR + n;
+    c->nxt = a->chunks;
+    a->chunks = c;
+    p = (unsigned char*) c + ARENA_HDR;
+    a->cur = p + size;
+    a->end = c->end;
+    return p;
+}
+
+/* whether p was returned by marena_alloc() on this arena */
+int marena_owns(void *arena, const void *p)
+{
+    memArenaChunk_t *c;
+    for (c = ((memArena_t*) arena)->chunks; c != NULL; c = c->nxt)
+      if ((const unsigned char*) p >= (unsigned char*) c + ARENA_HDR &&
+          (const unsigned char*) p < c->end)
+        return 1;
+    return 0;
+}
+
+void marena_free(CSOUND *csound, void *arena)
+{
+    memArena_t      *a = (memArena_t*) arena;
+    memArenaChunk_t *c = a->chunks, *nxt;
+    while (c != NULL) {
+      nxt = c->nxt;
+      mfree(csound, c);
+      c = nxt;
+    }
+    mfree(csound, a);
+}
+
+PUBLIC void csoundGetMemoryStats(CSOUND *csound, CS_MEMORY_STATS *stats)
+{
+    memPool_t *pool = mem_pool(csound);
+    CSOUND_MEM_SPINLOCK
+    *stats = pool->stats;
+    CSOUND_MEM_SPINUNLOCK
 }
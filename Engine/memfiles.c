@@ -30,8 +30,18 @@
 #include "pstream.h"
 #include "namedins.h"
 #include <sndfile.h>
+#include <stddef.h>
 #include <string.h>
 #include <inttypes.h>
+#include <sys/stat.h>
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
 
 static int Load_Het_File_(CSOUND *csound, const char *filnam,
                           char **allocp, int32 *len)
@@ -300,6 +310,321 @@ static int Load_File_(CSOUND *csound, const char *filnam,
     return 1;
 }
 
+/* Process-wide sample cache.
+ *
+ * Files are identified by their full path name, size and modification
+ * time, and loaded only once however many Csound instances ask for them.
+ * Raw files (ldmemfile2withCB() without a callback) are mapped read-only
+ * from disk; sound files (csoundLoadSoundFile()) are decoded once into an
+ * anonymous mapping that holds the whole SNDMEMFILE, samples included,
+ * and is then made read-only.  Each
+ * instance holds a reference until it is reset; entries nobody refers to
+ * stay resident for later loads until the idle budget is exceeded, and
+ * are then dropped least recently used first.
+ */
+
+#define SMPC_RAW        (0)
+#define SMPC_SND        (1)
+
+#define SMPC_LOADING    (0)
+#define SMPC_READY      (1)
+#define SMPC_STALE      (2)
+
+#define SMPC_HEAP       (0)
+#define SMPC_MMAP       (1)
+
+#define SMPC_BUCKETS    (256)
+
+typedef struct smpcache_ {
+    struct smpcache_ *nxt;      /* hash chain */
+    char        *path;
+    int         kind;
+    int         state;
+    int         maptype;
+    int         refcnt;
+    int64_t     fsize, mtime;
+    uint64_t    lastuse;
+    void        *base;          /* file data, or the SNDMEMFILE */
+    size_t      maplen;
+    size_t      length;         /* bytes of file data (SMPC_RAW) */
+    double      a4;             /* A4 of baseFreq, 0 if none (SMPC_SND) */
+} SMPCACHE;
+
+static SMPCACHE         *smpc_tab[SMPC_BUCKETS];
+static size_t           smpc_budget = (size_t) 256 << 20;
+static uint64_t         smpc_clock = 0;
+static CS_SAMPLE_CACHE_STATS smpc_stats;
+
+/* the entries are guarded by the global lock of csound.c; it is never
+   held while a file is read */
+extern void csoundLock(void);
+extern void csoundUnLock(void);
+
+static unsigned int smpc_hash(const char *s, int kind)
+{
+    uint32_t h = 2166136261U ^ (uint32_t) kind;
+    while (*s != '\0')
+      h = (h ^ (unsigned char) *(s++)) * 16777619U;
+    return (unsigned int) (h % SMPC_BUCKETS);
+}
+
+/* allocate n bytes that can later be made read-only */
+
+static void *smpc_alloc(SMPCACHE *e, size_t n)
+{
+#if !defined(WIN32) && defined(MAP_ANONYMOUS)
+    void *m = mmap(NULL, n, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m != MAP_FAILED) {
+      e->maptype = SMPC_MMAP;
+      e->maplen = n;
+      return (e->base = m);
+    }
+#endif
+    e->maptype = SMPC_HEAP;
+    e->maplen = n;
+    return (e->base = malloc(n));
+}
+
+static void smpc_protect(SMPCACHE *e)
+{
+#if !defined(WIN32)
+    if (e->maptype == SMPC_MMAP)
+      mprotect(e->base, e->maplen, PROT_READ);
+#else
+    (void) e;
+#endif
+}
+
+static void smpc_free(SMPCACHE *e)
+{
+    if (e->base != NULL) {
+#if !defined(WIN32)
+      if (e->maptype == SMPC_MMAP)
+        munmap(e->base, e->maplen);
+      else
+#endif
+        free(e->base);
+    }
+    free(e->path);
+    free(e);
+}
+
+static void smpc_unlink(SMPCACHE *e)
+{
+    SMPCACHE **pp = &smpc_tab[smpc_hash(e->path, e->kind)];
+    while (*pp != e)
+      pp = &((*pp)->nxt);
+    *pp = e->nxt;
+    if (e->state != SMPC_LOADING) {
+      smpc_stats.entries--;
+      smpc_stats.resident_bytes -= e->maplen;
+    }
+}
+
+/* drop idle entries, least recently used first, until within budget;
+   called with the lock held */
+
+static void smpc_trim(void)
+{
+    while (smpc_stats.resident_bytes > smpc_budget) {
+      SMPCACHE *e, *lru = NULL;
+      int     i;
+      for (i = 0; i < SMPC_BUCKETS; i++)
+        for (e = smpc_tab[i]; e != NULL; e = e->nxt)
+          if (e->refcnt == 0 && e->state != SMPC_LOADING &&
+              (lru == NULL || e->lastuse < lru->lastuse))
+            lru = e;
+      if (lru == NULL)
+        break;
+      smpc_unlink(lru);
+      smpc_stats.evictions++;
+      smpc_free(lru);
+    }
+}
+
+/* Look up a file, taking a reference.  On a miss a new entry is returned
+   in the loading state with *hit == 0: the caller loads it and then calls
+   smpc_ready() or smpc_fail().  Returns NULL if the file cannot be stat()ed.
+   Another instance loading the same file is waited for. */
+
+static SMPCACHE *smpc_acquire(const char *path, int kind, int *hit)
+{
+    struct stat st;
+    SMPCACHE    *e;
+    unsigned int h;
+
+    if (UNLIKELY(stat(path, &st) != 0))
+      return NULL;
+    h = smpc_hash(path, kind);
+    csoundLock();
+    for (;;) {
+      for (e = smpc_tab[h]; e != NULL; e = e->nxt) {
+        if (e->kind != kind || e->state == SMPC_STALE ||
+            strcmp(e->path, path) != 0)
+          continue;
+        if (e->fsize == (int64_t) st.st_size &&
+            e->mtime == (int64_t) st.st_mtime)
+          break;
+        /* the file changed on disk: keep the old data for its users only */
+        if (e->state == SMPC_READY)
+          e->state = SMPC_STALE;
+      }
+      if (e == NULL || e->state == SMPC_READY)
+        break;
+      csoundUnLock();
+      csoundSleep(1);
+      csoundLock();
+    }
+    if (e != NULL) {
+      e->refcnt++;
+      e->lastuse = ++smpc_clock;
+      smpc_stats.hits++;
+      *hit = 1;
+    }
+    else if ((e = (SMPCACHE*) calloc(1, sizeof(SMPCACHE))) != NULL &&
+             (e->path = strdup(path)) != NULL) {
+      e->kind = kind;
+      e->state = SMPC_LOADING;
+      e->refcnt = 1;
+      e->fsize = (int64_t) st.st_size;
+      e->mtime = (int64_t) st.st_mtime;
+      e->nxt = smpc_tab[h];
+      smpc_tab[h] = e;
+      smpc_stats.misses++;
+      *hit = 0;
+    }
+    else {
+      free(e);
+      e = NULL;
+    }
+    csoundUnLock();
+    return e;
+}
+
+static void smpc_ready(SMPCACHE *e)
+{
+    smpc_protect(e);
+    csoundLock();
+    e->state = SMPC_READY;
+    e->lastuse = ++smpc_clock;
+    smpc_stats.entries++;
+    smpc_stats.resident_bytes += e->maplen;
+    smpc_trim();
+    csoundUnLock();
+}
+
+static void smpc_fail(SMPCACHE *e)
+{
+    csoundLock();
+    smpc_unlink(e);
+    csoundUnLock();
+    smpc_free(e);
+}
+
+/* Drop the reference to the entry holding data 'p'.
+   Returns zero if p does not belong to the cache. */
+
+static int smpc_release(const void *p)
+{
+    SMPCACHE *e = NULL;
+    int     i;
+
+    if (p == NULL)
+      return 0;
+    csoundLock();
+    for (i = 0; i < SMPC_BUCKETS && e == NULL; i++)
+      for (e = smpc_tab[i]; e != NULL; e = e->nxt)
+        if (e->base == p && e->state != SMPC_LOADING)
+          break;
+    if (e != NULL && --(e->refcnt) == 0) {
+      e->lastuse = ++smpc_clock;
+      if (e->state == SMPC_STALE) {
+        smpc_unlink(e);
+        smpc_free(e);
+      }
+      else
+        smpc_trim();
+    }
+    csoundUnLock();
+    return (e != NULL);
+}
+
+/* map a raw file read-only; the byte after the end must read as zero */
+
+static int smpc_load_raw(SMPCACHE *e)
+{
+    FILE    *f;
+    size_t  len = (size_t) e->fsize;
+
+    if (UNLIKELY(len < 1))
+      return NOTOK;
+    e->length = len;
+#if !defined(WIN32)
+    if (len % (size_t) sysconf(_SC_PAGESIZE) != 0) {
+      int   fd = open(e->path, O_RDONLY);
+      if (fd >= 0) {
+        void *m = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (m != MAP_FAILED) {
+          e->base = m;
+          e->maplen = len;
+          e->maptype = SMPC_MMAP;
+          return OK;
+        }
+      }
+    }
+#endif
+    if (UNLIKELY((f = fopen(e->path, "rb")) == NULL))
+      return NOTOK;
+    if (UNLIKELY(smpc_alloc(e, len + 1) == NULL ||
+                 fread(e->base, 1, len, f) != len)) {
+      fclose(f);
+      return NOTOK;
+    }
+    fclose(f);
+    ((char*) e->base)[len] = '\0';
+    return OK;
+}
+
+/* non-zero if Load_File_() converts the file on loading */
+
+static int is_converted_file(const char *pathnam, int csFileType)
+{
+    FILE    *f;
+    char    buff[8];
+    int     n = 0;
+
+    if (csFileType != CSFTYPE_HETRO && csFileType != CSFTYPE_CVANAL &&
+        csFileType != CSFTYPE_LPC)
+      return 0;
+    if ((f = fopen(pathnam, "rb")) == NULL)
+      return 0;
+    memset(buff, 0, sizeof(buff));
+    if (fread(buff, 1, 6, f) == 6) {
+      n = ((csFileType == CSFTYPE_HETRO && strncmp(buff, "HETRO", 5) == 0) ||
+           (csFileType == CSFTYPE_CVANAL && strcmp(buff, "CVANAL") == 0) ||
+           (csFileType == CSFTYPE_LPC && strcmp(buff, "LPANAL") == 0));
+    }
+    fclose(f);
+    return n;
+}
+
+PUBLIC void csoundGetSampleCacheStats(CS_SAMPLE_CACHE_STATS *stats)
+{
+    csoundLock();
+    *stats = smpc_stats;
+    csoundUnLock();
+}
+
+PUBLIC void csoundSetSampleCacheBudget(size_t bytes)
+{
+    csoundLock();
+    smpc_budget = bytes;
+    smpc_trim();
+    csoundUnLock();
+}
+
 /* Backwards-compatible wrapper for ldmemfile2().
    Please use ldmemfile2() or ldmemfile2withCB() in all new code instead.
 MEMFIL *ldmemfile(CSOUND *csound, const char *filnam)
@@ -323,6 +648,9 @@ MEMFIL *ldmemfile2(CSOUND *csound, const char *filnam, int csFileType)
 
    Callback signature:     int myfunc(CSOUND* csound, MEMFIL* mfp)
    Callback return value:  OK (0) or NOTOK (-1)
+
+   Without a callback the data comes from the sample cache, is shared
+   with other Csound instances and must not be modified.
  */
 MEMFIL *ldmemfile2withCB(CSOUND *csound, const char *filnam, int csFileType,
                          int (*callback)(CSOUND*, MEMFIL*))
@@ -354,6 +682,27 @@ MEMFIL *ldmemfile2withCB(CSOUND *csound, const char *filnam, int csFileType,
       delete_memfile(csound, filnam);
       return NULL;
     }
+    if (callback == NULL && !is_converted_file(pathnam, csFileType)) {
+      SMPCACHE  *e;
+      int       hit;
+      if ((e = smpc_acquire(pathnam, SMPC_RAW, &hit)) != NULL) {
+        if (hit || smpc_load_raw(e) == OK) {
+          if (!hit)
+            smpc_ready(e);
+          csoundNotifyFileOpened(csound, pathnam, csFileType, 0, 0);
+          mfp->beginp = (char*) e->base;
+          mfp->endp = mfp->beginp + e->length;
+          mfp->length = (int32) e->length;
+          csoundMessage(csound, hit ?
+                        Str("file %s (%ld bytes) shared from memory\n") :
+                        Str("file %s (%ld bytes) loaded into memory\n"),
+                        pathnam, (long) e->length);
+          csound->Free(csound, pathnam);
+          return mfp;
+        }
+        smpc_fail(e);
+      }
+    }
     if (UNLIKELY(Load_File_(csound, pathnam, &allocp, &len, csFileType) != 0)) {
       /* loadfile */
       csoundMessage(csound, Str("cannot load %s, or SADIR undefined\n"),
@@ -388,11 +737,21 @@ void rlsmemfiles(CSOUND *csound)
 
     while (mfp != NULL) {
       nxt = mfp->next;
-      csound->Free(csound, mfp->beginp);       /*   free the space */
+      if (!smpc_release(mfp->beginp))
+        csound->Free(csound, mfp->beginp);     /*   free the space */
       csound->Free(csound, mfp);
       mfp = nxt;
     }
     csound->memfiles = NULL;
+    if (csound->sndmemfiles != NULL) {
+      CONS_CELL *values = cs_hash_table_values(csound, csound->sndmemfiles);
+      CONS_CELL *cell;
+      for (cell = values; cell != NULL; cell = cell->next)
+        smpc_release(cell->value);
+      cs_cons_free(csound, values);
+      cs_hash_table_free(csound, csound->sndmemfiles);
+      csound->sndmemfiles = NULL;
+    }
 }
 
 int delete_memfile(CSOUND *csound, const char *filnam)
@@ -413,7 +772,8 @@ int delete_memfile(CSOUND *csound, const char *filnam)
       csound->memfiles = mfp->next;
     else
       prv->next = mfp->next;
-    csound->Free(csound, mfp->beginp);
+    if (!smpc_release(mfp->beginp))
+      csound->Free(csound, mfp->beginp);
     csound->Free(csound, mfp);
     return 0;
 }
@@ -575,7 +935,8 @@ int PVOCEX_LoadFile(CSOUND *csound, const char *fname, PVOCEX_MEMFILE *p)
  * it is not NULL).
  * Multiple calls of csoundLoadSoundFile() with the same file name will
  * share the same SNDMEMFILE structure, and the file is loaded only once
- * from disk.
+ * from disk; other Csound instances loading the same file with the same
+ * A4 share the structure too, so it must not be modified.
  * The return value is NULL if an error occurs (the contents of sfinfo may
  * be undefined in this case).
  */
@@ -586,7 +947,11 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
     SNDFILE       *sf;
     void          *fd;
     SNDMEMFILE    *p = NULL;
+    SMPCACHE      *e = NULL;
     SF_INFO       tmp;
+    SNDMEMFILE    hdr;
+    size_t        nSamples, hdrlen, namelen;
+    int           hit = 0;
 
 
     if (UNLIKELY(fileName == NULL || fileName[0] == '\0'))
@@ -600,6 +965,27 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
       csound->sndmemfiles = cs_hash_table_create(csound);
     }
 
+    if (p == NULL && (sfinfo == NULL || sfinfo->format == 0)) {
+      /* files with a header may have been loaded by another instance;
+         raw files depend on sfinfo and are never shared */
+      char  *pathnam = csoundFindInputFile(csound, fileName, "SFDIR;SSDIR");
+      if (pathnam != NULL) {
+        e = smpc_acquire(pathnam, SMPC_SND, &hit);
+        csound->Free(csound, pathnam);
+      }
+      if (hit && e->a4 != 0.0 && e->a4 != csound->A4) {
+        /* base frequency for another A4: load a private copy */
+        smpc_release(e->base);
+        e = NULL;
+      }
+      else if (hit) {
+        p = (SNDMEMFILE*) e->base;
+        csoundNotifyFileOpened(csound, p->fullName,
+                               CSFTYPE_UNKNOWN_AUDIO, 0, 0);
+        cs_hash_table_put(csound, csound->sndmemfiles, (char*)fileName, p);
+      }
+    }
+
     if (p != NULL) {
       /* if file was loaded earlier: */
       if (sfinfo != NULL) {
@@ -619,20 +1005,36 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
     fd = csound->FileOpen2(csound, &sf, CSFILE_SND_R, fileName, sfinfo,
                             "SFDIR;SSDIR", CSFTYPE_UNKNOWN_AUDIO, 0);
     if (UNLIKELY(fd == NULL)) {
+      if (e != NULL)
+        smpc_fail(e);
       csound->ErrorMsg(csound,
                        Str("csoundLoadSoundFile(): failed to open '%s' %s"),
                        fileName, Str(sf_strerror(NULL)));
       return NULL;
     }
-    p = (SNDMEMFILE*)
-            csound->Malloc(csound, sizeof(SNDMEMFILE)
-                           + (size_t)  sfinfo->frames * sizeof(float));
+    if (e == NULL) {
+      /* not cacheable: a private entry that is freed when it is released */
+      e = (SMPCACHE*) calloc(1, sizeof(SMPCACHE));
+      if (UNLIKELY(e == NULL ||
+                   (e->path = strdup(csound->GetFileName(fd))) == NULL)) {
+        free(e);
+        csound->FileClose(csound, fd);
+        csound->ErrorMsg(csound, Str("csoundLoadSoundFile(): "
+                                     "not enough memory for '%s'"), fileName);
+        return NULL;
+      }
+      e->kind = SMPC_SND;
+      e->state = SMPC_LOADING;
+      e->refcnt = 1;
+      e->fsize = -1;
+      csoundLock();
+      e->nxt = smpc_tab[smpc_hash(e->path, SMPC_SND)];
+      smpc_tab[smpc_hash(e->path, SMPC_SND)] = e;
+      csoundUnLock();
+    }
     /* set parameters */
-    p->name = (char*) csound->Malloc(csound, strlen(fileName) + 1);
-    strcpy(p->name, fileName);
-    p->fullName = (char*) csound->Malloc(csound,
-                                         strlen(csound->GetFileName(fd)) + 1);
-    strcpy(p->fullName, csound->GetFileName(fd));
+    p = &hdr;
+    memset(p, 0, sizeof(SNDMEMFILE));
     p->sampleRate = (double) sfinfo->samplerate;
     p->nFrames = (size_t) sfinfo->frames;
     p->nChannels = sfinfo->channels;
@@ -661,27 +1063,49 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
           p->loopMode = 1;
         }
         p->baseFreq = pow(2.0, (double) (((int) lpd.basenote - 69) * 100
-                                         + (int) lpd.detune) / 1200.0) * csound->A4;
+                                         + (int) lpd.detune) / 1200.0)
+                      * csound->A4;
         p->scaleFac = pow(10.0, (double) lpd.gain * 0.05);
+        e->a4 = csound->A4;
       }
     }
-    if (UNLIKELY((size_t) sf_readf_float(sf, &(p->data[0]), (sf_count_t) p->nFrames)
+    /* the structure, its samples and then its name, in one mapping */
+    nSamples = p->nFrames * (size_t) p->nChannels;
+    hdrlen = offsetof(SNDMEMFILE, data) + (nSamples + 1) * sizeof(float);
+    namelen = strlen(csound->GetFileName(fd)) + 1;
+    if (UNLIKELY(smpc_alloc(e, hdrlen + namelen) == NULL)) {
+      csound->FileClose(csound, fd);
+      smpc_fail(e);
+      csound->ErrorMsg(csound, Str("csoundLoadSoundFile(): error reading '%s'"),
+                               fileName);
+      return NULL;
+    }
+    memcpy(e->base, p, offsetof(SNDMEMFILE, data));
+    p = (SNDMEMFILE*) e->base;
+    p->fullName = (char*) e->base + hdrlen;
+    memcpy(p->fullName, csound->GetFileName(fd), namelen);
+    p->name = p->fullName;
+    if (UNLIKELY((size_t) sf_readf_float(sf, p->data, (sf_count_t) p->nFrames)
                  != p->nFrames)) {
       csound->FileClose(csound, fd);
-      csound->Free(csound, p->name);
-      csound->Free(csound, p->fullName);
-      csound->Free(csound, p);
+      smpc_fail(e);
       csound->ErrorMsg(csound, Str("csoundLoadSoundFile(): error reading '%s'"),
                                fileName);
       return NULL;
     }
-    p->data[p->nFrames] = 0.0f;
+    p->data[nSamples] = 0.0f;
     csound->FileClose(csound, fd);
     csound->Message(csound, "%s '%s' (sr = %d Hz, %d %s, %" PRId64 " %s) %s",
                     Str("File"), p->fullName, sfinfo->samplerate,
                     sfinfo->channels, Str("channel(s)"), (int64_t)sfinfo->frames,
                     Str("sample frames"),
                     Str("loaded into memory\n"));
+    smpc_ready(e);
+    if (e->fsize < 0) {
+      csoundLock();
+      e->state = SMPC_STALE;
+      csoundUnLock();
+    }
 
     /* link into database */
     cs_hash_table_put(csound, csound->sndmemfiles, (char*)fileName, p);
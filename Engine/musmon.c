@@ -42,6 +42,12 @@ int     MIDIinsert(CSOUND *, int, MCHNBLK*, MEVENT*);
   void    m_chn_init_all(CSOUND *);
 //  char *  scsortstr(CSOUND *, CORFIL *);
   void    infoff(CSOUND*, MYFLT), orcompact(CSOUND*);
+  void    instance_pool_start(CSOUND *), instance_pool_stop(CSOUND *);
+  void    ftgen_async_publish(CSOUND *), ftgen_async_stop(CSOUND *);
+  void    rtcallback_halt(CSOUND *), rtcallback_free(CSOUND *);
+  void    async_init_collect(CSOUND *), async_init_stop(CSOUND *);
+  uint64_t async_init_late(CSOUND *);
+  void    csp_dag_sched_free(CSOUND *);
   void    beatexpire(CSOUND *, double), timexpire(CSOUND *, double);
   void    sfopenin(CSOUND *), sfopenout(CSOUND*), sfnopenout(CSOUND*);
   void    iotranset(CSOUND *), sfclosein(CSOUND*), sfcloseout(CSOUND*);
@@ -419,6 +425,10 @@ int musmon(CSOUND *csound)
     }
 #endif
 
+#ifndef __EMSCRIPTEN__
+    instance_pool_start(csound);    /* builds instances ahead of note-ons */
+#endif
+
     /* since we are running in components, we exit here to playevents later */
     return 0;
 }
@@ -438,46 +448,217 @@ static void deactivate_all_notes(CSOUND *csound)
     }
 }
 
-static void delete_pending_rt_events(CSOUND *csound)
+/* Real time event queue.  Events from insert_score_event_at_sample()
+   wait in a two-level timing wheel indexed by start k-cycle: one FIFO
+   slot per k-cycle of the current block of EVTQ_SLOTS cycles, one per
+   block for the next EVTQ_BLOCKS - 1 blocks, and a sorted overflow list
+   beyond that.  A block's events move down to the k-cycle slots when
+   performance reaches it, so scheduling and starting an event are O(1)
+   whatever the number of pending events, and events due at the same
+   k-cycle start in the order they were scheduled.  Events scheduled for
+   a k-cycle the queue has already passed are kept, sorted by time, in
+   csound->OrcTrigEvts and start first. */
+
+#define EVTQ_SLOTBITS (10)
+#define EVTQ_SLOTS    (1 << EVTQ_SLOTBITS)
+#define EVTQ_BLOCKS   (256)
+
+typedef struct {
+  EVTNODE   *head, *tail;
+} EVTQ_LIST;
+
+typedef struct {
+  EVTQ_LIST slot[EVTQ_SLOTS];     /* k-cycles of the current block */
+  EVTQ_LIST block[EVTQ_BLOCKS];   /* following blocks */
+  EVTNODE   *overflow;            /* later events, sorted */
+  uint32    base;                 /* no event in the wheel before this */
+  uint64_t  count, peak, scheduled, late;
+} EVTQUEUE;
+
+static inline void evtq_append(EVTQ_LIST *l, EVTNODE *e)
 {
-  EVTNODE *ep = csound->OrcTrigEvts;
+  e->nxt = NULL;
+  if (l->tail != NULL) l->tail->nxt = e;
+  else l->head = e;
+  l->tail = e;
+}
 
-  while (ep != NULL) {
-    EVTNODE *nxt = ep->nxt;
-    if (ep->evt.strarg != NULL) {
-      csound->Free(csound,ep->evt.strarg);
-      ep->evt.strarg = NULL;
+/* insert into a list sorted by time, after events at the same time */
+static void evtq_insert_sorted(EVTNODE **list, EVTNODE *e)
+{
+  EVTNODE *prv = *list;
+  if (prv == NULL || e->start_kcnt < prv->start_kcnt) {
+    e->nxt = prv;
+    *list = e;
+  }
+  else {
+    while (prv->nxt != NULL && e->start_kcnt >= prv->nxt->start_kcnt)
+      prv = prv->nxt;
+    e->nxt = prv->nxt;
+    prv->nxt = e;
+  }
+}
+
+static void evtq_place(CSOUND *csound, EVTQUEUE *q, EVTNODE *e)
+{
+  uint32 kcnt = e->start_kcnt;
+  uint32 ahead = (kcnt >> EVTQ_SLOTBITS) - (q->base >> EVTQ_SLOTBITS);
+
+  if (kcnt < q->base)
+    evtq_insert_sorted(&csound->OrcTrigEvts, e);
+  else if (ahead == 0)
+    evtq_append(&q->slot[kcnt & (EVTQ_SLOTS - 1)], e);
+  else if (ahead < EVTQ_BLOCKS)
+    evtq_append(&q->block[(kcnt >> EVTQ_SLOTBITS) & (EVTQ_BLOCKS - 1)], e);
+  else
+    evtq_insert_sorted(&q->overflow, e);
+}
+
+/* q->base has just moved into a new block: spread the block's events
+   over the k-cycle slots, and bring the block now in range in from the
+   overflow list */
+static void evtq_enter_block(EVTQUEUE *q)
+{
+  uint32    blk = q->base >> EVTQ_SLOTBITS;
+  EVTQ_LIST *l = &q->block[blk & (EVTQ_BLOCKS - 1)];
+  EVTNODE   *e = l->head, *nxt;
+
+  l->head = l->tail = NULL;
+  for ( ; e != NULL; e = nxt) {
+    nxt = e->nxt;
+    evtq_append(&q->slot[e->start_kcnt & (EVTQ_SLOTS - 1)], e);
+  }
+  while ((e = q->overflow) != NULL &&
+         (e->start_kcnt >> EVTQ_SLOTBITS) - blk < EVTQ_BLOCKS) {
+    q->overflow = e->nxt;
+    evtq_append(&q->block[(e->start_kcnt >> EVTQ_SLOTBITS) &
+                          (EVTQ_BLOCKS - 1)], e);
+  }
+}
+
+static void evtq_insert(CSOUND *csound, EVTNODE *e)
+{
+  EVTQUEUE *q = (EVTQUEUE*) csound->evt_queue;
+
+  if (UNLIKELY(q == NULL))
+    q = csound->evt_queue = csound->Calloc(csound, sizeof(EVTQUEUE));
+  if (q->count == 0)                      /* empty: restart at now */
+    q->base = (uint32) csound->global_kcounter;
+  evtq_place(csound, q, e);
+  q->scheduled++;
+  if (++q->count > q->peak)
+    q->peak = q->count;
+}
+
+/* the first event due by k-cycle now, or NULL; it stays queued until
+   evtq_pop() */
+static EVTNODE *evtq_due(CSOUND *csound, uint32 now)
+{
+  EVTQUEUE *q = (EVTQUEUE*) csound->evt_queue;
+  EVTNODE  *e;
+
+  if (q == NULL || q->count == 0)
+    return NULL;
+  if ((e = csound->OrcTrigEvts) == NULL) {
+    while ((e = q->slot[q->base & (EVTQ_SLOTS - 1)].head) == NULL) {
+      if (q->base >= now)
+        return NULL;
+      if ((++q->base & (EVTQ_SLOTS - 1)) == 0)
+        evtq_enter_block(q);
     }
-    /* push to stack of free event nodes */
-    ep->nxt = csound->freeEvtNodes;
-    csound->freeEvtNodes = ep;
-    ep = nxt;
   }
-  csound->OrcTrigEvts = NULL;
+  return (e->start_kcnt <= now ? e : NULL);
 }
 
-void delete_selected_rt_events(CSOUND *csound, int instr)
+static void evtq_pop(CSOUND *csound, EVTNODE *e)
 {
-  EVTNODE *ep = csound->OrcTrigEvts;
-  EVTNODE *last = NULL;
+  EVTQUEUE *q = (EVTQUEUE*) csound->evt_queue;
+
+  if (e == csound->OrcTrigEvts)
+    csound->OrcTrigEvts = e->nxt;
+  else {
+    EVTQ_LIST *l = &q->slot[q->base & (EVTQ_SLOTS - 1)];
+    if ((l->head = e->nxt) == NULL)
+      l->tail = NULL;
+  }
+  if (e->start_kcnt < (uint32) csound->global_kcounter)
+    q->late++;
+  q->count--;
+}
+
+/* drop the events of list *head that are for instrument instr, or all
+   of them if instr is 0; *tail, if given, is kept up to date */
+static uint64_t evtq_drop(CSOUND *csound, EVTNODE **head, EVTNODE **tail,
+                          int instr)
+{
+  EVTNODE  *ep = *head, *last = NULL;
+  uint64_t n = 0;
+
   while (ep != NULL) {
     EVTNODE *nxt = ep->nxt;
-    if (ep->evt.opcod=='i' && (int)(ep->evt.p[1]) == instr) {
-      // Found an event to cancel
+    if (instr == 0 ||
+        (ep->evt.opcod=='i' && (int)(ep->evt.p[1]) == instr)) {
       if (ep->evt.strarg != NULL) {
         // clearstring if necessary
         csound->Free(csound,ep->evt.strarg);
         ep->evt.strarg = NULL;
       }
-      if (last) last->nxt = nxt; else csound->OrcTrigEvts = nxt;
+      if (last) last->nxt = nxt; else *head = nxt;
       /* push to stack of free event nodes */
       ep->nxt = csound->freeEvtNodes;
       csound->freeEvtNodes = ep;
+      n++;
     }
     else last = ep;
     ep = nxt;
   }
-  //csound->OrcTrigEvts = NULL;
+  if (tail != NULL)
+    *tail = last;
+  return n;
+}
+
+static void evtq_drop_all(CSOUND *csound, int instr)
+{
+  EVTQUEUE *q = (EVTQUEUE*) csound->evt_queue;
+  uint64_t n;
+  int      i;
+
+  n = evtq_drop(csound, &csound->OrcTrigEvts, NULL, instr);
+  if (q == NULL)
+    return;
+  for (i = 0; i < EVTQ_SLOTS; i++)
+    if (q->slot[i].head != NULL)
+      n += evtq_drop(csound, &q->slot[i].head, &q->slot[i].tail, instr);
+  for (i = 0; i < EVTQ_BLOCKS; i++)
+    if (q->block[i].head != NULL)
+      n += evtq_drop(csound, &q->block[i].head, &q->block[i].tail, instr);
+  n += evtq_drop(csound, &q->overflow, NULL, instr);
+  q->count -= n;
+}
+
+PUBLIC void csoundGetEventQueueStats(CSOUND *csound,
+                                     CS_EVENT_QUEUE_STATS *stats)
+{
+  EVTQUEUE *q = (EVTQUEUE*) csound->evt_queue;
+
+  memset(stats, 0, sizeof(CS_EVENT_QUEUE_STATS));
+  if (q != NULL) {
+    stats->queued = q->count;
+    stats->peak_queued = q->peak;
+    stats->scheduled = q->scheduled;
+    stats->late = q->late;
+  }
+  stats->late_init = async_init_late(csound);
+}
+
+static void delete_pending_rt_events(CSOUND *csound)
+{
+  evtq_drop_all(csound, 0);
+}
+
+void delete_selected_rt_events(CSOUND *csound, int instr)
+{
+  evtq_drop_all(csound, instr);
 }
 
 static inline void cs_beep(CSOUND *csound)
@@ -511,6 +692,10 @@ PUBLIC int csoundCleanup(CSOUND *csound)
     }
     /* will not clean up more than once */
     csound->engineStatus &= ~(CS_STATE_CLN);
+    /* the audio callback may still be running k-cycles */
+    rtcallback_halt(csound);
+    /* finish the queued asyncinit passes */
+    async_init_stop(csound);
 
     deactivate_all_notes(csound);
 
@@ -528,7 +713,10 @@ PUBLIC int csoundCleanup(CSOUND *csound)
       csoundDestroyMutex(csound->init_pass_threadlock);
       csound->event_insert_thread = 0;
     }
+    instance_pool_stop(csound);
 #endif
+    ftgen_async_stop(csound);
+    csp_dag_sched_free(csound);
 
     while (csound->freeEvtNodes != NULL) {
       p = (void*) csound->freeEvtNodes;
@@ -539,6 +727,7 @@ PUBLIC int csoundCleanup(CSOUND *csound)
     orcompact(csound);
 
     corfile_rm(csound, &csound->scstr);
+    bscore_close(csound);
 
     /* print stats only if musmon was actually run */
     /* NOT SURE HOW   ************************** */
@@ -577,6 +766,7 @@ PUBLIC int csoundCleanup(CSOUND *csound)
       if (UNLIKELY(!csound->oparms->sfwrite))
         csound->Message(csound, Str("no sound written to disk\n"));
     }
+    rtcallback_free(csound);
     /* close any remote.c sockets */
     if (csound->remoteGlobals) remote_Cleanup(csound);
     if (UNLIKELY(csound->oparms->ringbell))
@@ -940,7 +1130,7 @@ static int process_rt_event(CSOUND *csound, int sensType)
       print_amp_values(csound, 0);
   }
   if (sensType == 4) {                  /* RM: Realtime orc event   */
-    EVTNODE *e = csound->OrcTrigEvts;
+    EVTNODE *e = evtq_due(csound, (uint32) csound->global_kcounter);
     /* RM: Events are sorted on insertion, so just check the first */
     evt = &(e->evt);
     insno = MYFLT2LONG(evt->p[1]);
@@ -951,8 +1141,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
         insSendevt(csound, evt, rfd);  /* RM: or send to single remote Csound */
       return 0;
     }
-    /* pop from the list */
-    csound->OrcTrigEvts = e->nxt;
+    /* pop from the queue */
+    evtq_pop(csound, e);
     retval = process_score_event(csound, evt, 1);
     if (evt->strarg != NULL) {
       csound->Free(csound, evt->strarg);
@@ -1000,6 +1190,8 @@ int sensevents(CSOUND *csound)
   if (UNLIKELY(data && data->status == CSDEBUG_STATUS_STOPPED)) {
     return 0; /* don't process events if we're in debug mode and stopped */
   }
+  ftgen_async_publish(csound);        /* tables built by hfgens_async() */
+  async_init_collect(csound);         /* notes initialised by asyncinit */
   if (UNLIKELY(csound->MTrkend && O->termifend)) {   /* end of MIDI file:  */
     deactivate_all_notes(csound);
     csound->Message(csound, Str("terminating.\n"));
@@ -1159,9 +1351,7 @@ int sensevents(CSOUND *csound)
     }
 
     /* check for pending real time events */
-    while (csound->OrcTrigEvts != NULL &&
-           csound->OrcTrigEvts->start_kcnt <=
-           (uint32) csound->global_kcounter) {
+    while (evtq_due(csound, (uint32) csound->global_kcounter) != NULL) {
 
       if ((retval = process_rt_event(csound, 4)) != 0){
         goto scode;
@@ -1287,7 +1477,7 @@ static inline uint64_t time2kcnt(CSOUND *csound, double tval)
 int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
 {
   double        start_time;
-  EVTNODE       *e, *prv;
+  EVTNODE       *e;
   CSOUND        *st = csound;
   MYFLT         *p;
   uint32        start_kcnt;
@@ -1420,18 +1610,7 @@ int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
   }
   /* queue new event */
   e->start_kcnt = start_kcnt;
-  prv = csound->OrcTrigEvts;
-  /* if list is empty, or at beginning of list: */
-  if (prv == NULL || start_kcnt < prv->start_kcnt) {
-    e->nxt = prv;
-    csound->OrcTrigEvts = e;
-  }
-  else {                                      /* otherwise sort by time */
-    while (prv->nxt != NULL && start_kcnt >= prv->nxt->start_kcnt)
-      prv = prv->nxt;
-    e->nxt = prv->nxt;
-    prv->nxt = e;
-  }
+  evtq_insert(csound, e);
   /* Make sure sensevents() looks for RT events */
   csound->oparms->RTevents = 1;
   return 0;
@@ -1489,7 +1668,9 @@ void musmon_rewind_score(CSOUND *csound)
   csound->advanceCnt = 0;
   if (csound->csoundScoreOffsetSeconds_ > FL(0.0))
     csoundSetScoreOffsetSeconds(csound, csound->csoundScoreOffsetSeconds_);
-  if (csound->scstr)
+  if (csound->bscore)
+    bscore_rewind(csound);
+  else if (csound->scstr)
     corfile_rewind(csound->scstr);
   else csound->Warning(csound, Str("cannot rewind score: no score in memory\n"));
 }
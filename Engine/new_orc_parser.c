@@ -65,6 +65,9 @@ extern void print_tree(CSOUND *, char *, TREE *);
 extern TREE* verify_tree(CSOUND *, TREE *, TYPE_TABLE*);
 extern TREE *csound_orc_expand_expressions(CSOUND *, TREE *);
 extern TREE* csound_orc_optimize(CSOUND *, TREE *);
+extern uint64_t orc_cache_key(CSOUND *, const char *, size_t);
+extern TREE *orc_cache_load(CSOUND *, uint64_t);
+extern void orc_cache_store(CSOUND *, uint64_t, TREE *);
 //extern void csp_orc_analyze_tree(CSOUND* csound, TREE* root);
 extern void csp_orc_sa_print_list(CSOUND*);
 
@@ -214,22 +217,34 @@ TREE *csoundParseOrc(CSOUND *csound, const char *str)
       TREE* newRoot;
       PARSE_PARM  pp;
       TYPE_TABLE* typeTable = NULL;
+      uint64_t    cache_key;
 
       /* Parse */
       memset(&pp, '\0', sizeof(PARSE_PARM));
       init_symbtab(csound);
+      tree_arena_begin(csound);
 
       csound_orcdebug = O->odebug;
       csound_orclex_init(&pp.yyscanner);
 
 
       csound_orcset_extra(&pp, pp.yyscanner);
-      csound_orc_scan_buffer(corfile_body(csound->expanded_orc),
-                             corfile_tell(csound->expanded_orc), pp.yyscanner);
-
-      //csound_orcset_lineno(csound->orcLineOffset, pp.yyscanner);
-      //printf("%p\n", astTree);
-      err = csound_orcparse(&pp, pp.yyscanner, csound, &astTree);
+      cache_key = orc_cache_key(csound, corfile_body(csound->expanded_orc),
+                                corfile_tell(csound->expanded_orc));
+      if ((astTree = orc_cache_load(csound, cache_key)) != NULL)
+        err = 0;
+      else {
+        csound_orc_scan_buffer(corfile_body(csound->expanded_orc),
+                               corfile_tell(csound->expanded_orc),
+                               pp.yyscanner);
+
+        //csound_orcset_lineno(csound->orcLineOffset, pp.yyscanner);
+        //printf("%p\n", astTree);
+        err = csound_orcparse(&pp, pp.yyscanner, csound, &astTree);
+        /* save before verify_tree() rewrites it */
+        if (cache_key && err == 0 && !csound->synterrcnt && astTree != NULL)
+          orc_cache_store(csound, cache_key, astTree);
+      }
       //printf("%p\n", astTree);
       //print_tree(csound, "AST - AFTER csound_orcparse()\n", astTree);
       //csp_orc_sa_cleanup(csound);
@@ -299,7 +314,10 @@ TREE *csoundParseOrc(CSOUND *csound, const char *str)
       csound_orclex_destroy(pp.yyscanner);
       if (UNLIKELY(err)) {
         csound->ErrorMsg(csound, Str("Stopping on parser failure"));
-        csoundDeleteTree(csound, astTree);
+        if (csound->tree_arena != NULL)
+          tree_arena_end(csound, NULL);         /* takes astTree with it */
+        else
+          csoundDeleteTree(csound, astTree);
         if (typeTable != NULL) {
           csoundFreeVarPool(csound, typeTable->globalPool);
           if (typeTable->instr0LocalPool != NULL) {
@@ -320,6 +338,7 @@ TREE *csoundParseOrc(CSOUND *csound, const char *str)
       newRoot = make_leaf(csound, 0, 0, 0, NULL);
       newRoot->markup = typeTable;
       newRoot->next = astTree;
+      tree_arena_end(csound, newRoot);
 
       /* if (str!=NULL){ */
       /*        if (typeTable != NULL) { */
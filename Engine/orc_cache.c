@@ -0,0 +1,418 @@
+/*
+    orc_cache.c:
+
+    Copyright (C) 2026 The Csound Developers
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"                                 /*  ORC_CACHE.C  */
+#include "csound_orc.h"
+
+#if !defined(WIN32)
+#include <unistd.h>
+#else
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#endif
+
+extern int add_udo_definition(CSOUND *, char *, char *, char *);
+
+static volatile long orcc_tmp_seq = 0;  /* temporary file names */
+
+/* Parsed orchestra cache (--orc-cache=DIR).
+ *
+ * The tree returned by csound_orcparse() for a preprocessed orchestra is
+ * written to DIR/<key>.orcc, and read back instead of running the lexer
+ * and parser the next time the same text is compiled.  The key hashes
+ * the preprocessed text, the symbol table the lexer classified words
+ * against (so a different set of plugin opcodes gives a different key)
+ * and the build, so a stale or foreign file is never used; it is simply
+ * missed.  Type checking and expansion still run on the loaded tree, as
+ * they fill in per-instance variable pools and opcode entries.
+ *
+ *   header   ORCC_HDR
+ *   nodes    nnodes ORCC_NODE in preorder (a node, its left subtree, its
+ *            right subtree, then its next); links are 1-based, 0 is NULL
+ *            and always point forward
+ *   tokens   ntokens ORCC_TOKEN, in the order the nodes use them
+ *   strings  strsize bytes of NUL-terminated lexemes; offsets are 1-based
+ *
+ * The file is in the byte order of the machine that wrote it.
+ */
+
+#define ORCC_MAGIC      "CSORCACH"
+#define ORCC_VERSION    1
+#define ORCC_ENDIAN     0x01020304
+
+typedef struct {
+    char      magic[8];
+    uint32_t  version;
+    uint32_t  endian;
+    uint64_t  key;
+    uint32_t  nnodes;
+    uint32_t  ntokens;
+    uint64_t  strsize;
+    char      build[64];
+} ORCC_HDR;
+
+typedef struct {
+    int32_t   type, rate, len, line;
+    uint64_t  locn;
+    uint32_t  token, left, right, next;
+} ORCC_NODE;
+
+typedef struct {
+    int32_t   type, value;
+    double    fvalue;
+    uint32_t  lexeme, optype;
+} ORCC_TOKEN;
+
+typedef struct {
+    CSOUND      *csound;
+    ORCC_NODE   *nodes;
+    ORCC_TOKEN  *tokens;
+    char        *str;
+    uint32_t    nnodes, ntokens, nsize, tsize;
+    size_t      strsize, ssize;
+} ORCC_WR;
+
+#define FNV_INIT  14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t orcc_hash(uint64_t h, const void *p, size_t n)
+{
+    const unsigned char *s = (const unsigned char*) p;
+    while (n--) { h ^= *s++; h *= FNV_PRIME; }
+    return h;
+}
+
+static void orcc_build(char *build)
+{
+    memset(build, 0, 64);
+    snprintf(build, 64, "%s %s %d %d", CS_PACKAGE_VERSION, CS_PACKAGE_DATE,
+             (int) T_HIGHEST, (int) sizeof(MYFLT));
+}
+
+static void orcc_name(CSOUND *csound, char *name, size_t n, uint64_t key)
+{
+    snprintf(name, n, "%s/%016llx.orcc",
+             csound->orc_cache, (unsigned long long) key);
+}
+
+/* Key for the preprocessed text in 'body'; 0 if the cache is not used.
+   Must be called after init_symbtab(). */
+
+uint64_t orc_cache_key(CSOUND *csound, const char *body, size_t len)
+{
+    CS_HASH_TABLE *symbtab = csound->symbtab;
+    uint64_t      h, syms = 0;
+    char          build[64];
+    int           i;
+
+    /* -j needs the dependency lists collected while parsing */
+    if (csound->orc_cache == NULL || *csound->orc_cache == '\0' ||
+        csound->oparms->numThreads > 1 || body == NULL)
+      return 0;
+    /* order independent, as the table is filled from another hash table */
+    for (i = 0; i < symbtab->table_size; i++) {
+      CS_HASH_TABLE_ITEM *item;
+      for (item = symbtab->buckets[i]; item != NULL; item = item->next) {
+        ORCTOKEN *tok = (ORCTOKEN*) item->value;
+        syms += orcc_hash(orcc_hash(FNV_INIT, item->key, strlen(item->key)),
+                          &tok->type, sizeof(int));
+      }
+    }
+    orcc_build(build);
+    h = orcc_hash(FNV_INIT, body, len);
+    h = orcc_hash(h, &len, sizeof(len));
+    h = orcc_hash(h, &syms, sizeof(syms));
+    h = orcc_hash(h, build, sizeof(build));
+    return h ? h : 1;
+}
+
+/* Writing */
+
+static uint32_t orcc_str(ORCC_WR *w, const char *s)
+{
+    CSOUND  *csound = w->csound;
+    size_t  n;
+
+    if (s == NULL)
+      return 0;
+    n = strlen(s) + 1;
+    if (w->strsize + n > w->ssize) {
+      w->ssize = (w->strsize + n) * 2;
+      w->str = (char*) csound->ReAlloc(csound, w->str, w->ssize);
+    }
+    memcpy(w->str + w->strsize, s, n);
+    w->strsize += n;
+    return (uint32_t) (w->strsize - n + 1);
+}
+
+static uint32_t orcc_node(ORCC_WR *w, TREE *t)
+{
+    CSOUND    *csound = w->csound;
+    ORCC_NODE *r;
+
+    if (w->nnodes == w->nsize) {
+      w->nsize = w->nsize ? w->nsize * 2 : 1024;
+      w->nodes = (ORCC_NODE*) csound->ReAlloc(csound, w->nodes,
+                                              w->nsize * sizeof(ORCC_NODE));
+    }
+    r = &w->nodes[w->nnodes];
+    memset(r, 0, sizeof(ORCC_NODE));
+    r->type = t->type;
+    r->rate = t->rate;
+    r->len = t->len;
+    r->line = t->line;
+    r->locn = t->locn;
+    if (t->value != NULL) {
+      ORCC_TOKEN *k;
+      if (w->ntokens == w->tsize) {
+        w->tsize = w->tsize ? w->tsize * 2 : 1024;
+        w->tokens = (ORCC_TOKEN*)
+          csound->ReAlloc(csound, w->tokens, w->tsize * sizeof(ORCC_TOKEN));
+      }
+      k = &w->tokens[w->ntokens++];
+      k->type = t->value->type;
+      k->value = t->value->value;
+      k->fvalue = t->value->fvalue;
+      k->lexeme = orcc_str(w, t->value->lexeme);
+      k->optype = orcc_str(w, t->value->optype);
+      r->token = w->ntokens;
+    }
+    return ++w->nnodes;
+}
+
+/* Append 't' and its successors in preorder; returns the index of 't' */
+
+static uint32_t orcc_put(ORCC_WR *w, TREE *t)
+{
+    uint32_t first = 0, prev = 0, i, j;
+    for ( ; t != NULL; t = t->next) {
+      i = orcc_node(w, t);
+      if (prev) w->nodes[prev - 1].next = i;
+      else first = i;
+      /* w->nodes may move while the children are added */
+      j = orcc_put(w, t->left);
+      w->nodes[i - 1].left = j;
+      j = orcc_put(w, t->right);
+      w->nodes[i - 1].right = j;
+      prev = i;
+    }
+    return first;
+}
+
+/* Save the tree just produced by the parser under 'key'.  Failure only
+   loses the cache entry, so it is reported but not an error. */
+
+void orc_cache_store(CSOUND *csound, uint64_t key, TREE *root)
+{
+    ORCC_WR   w;
+    ORCC_HDR  hdr;
+    FILE      *f;
+    char      name[1024], tmp[1100];
+    long      seq;
+    int       ok;
+
+    memset(&w, 0, sizeof(w));
+    w.csound = csound;
+    orcc_put(&w, root);
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, ORCC_MAGIC, 8);
+    hdr.version = ORCC_VERSION;
+    hdr.endian = ORCC_ENDIAN;
+    hdr.key = key;
+    hdr.nnodes = w.nnodes;
+    hdr.ntokens = w.ntokens;
+    hdr.strsize = w.strsize;
+    orcc_build(hdr.build);
+
+    orcc_name(csound, name, sizeof(name), key);
+    /* write aside and rename, so a reader never sees half a file; the
+       name is unique to the process and the call, as instances of one
+       process may store the same key at once */
+    seq = ATOMIC_INCR(orcc_tmp_seq);
+    snprintf(tmp, sizeof(tmp), "%s.%ld.%ld.tmp", name, (long) getpid(), seq);
+    if ((f = fopen(tmp, "wb")) != NULL) {
+      ok = (fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+            fwrite(w.nodes, sizeof(ORCC_NODE), w.nnodes, f) == w.nnodes &&
+            fwrite(w.tokens, sizeof(ORCC_TOKEN), w.ntokens, f) == w.ntokens &&
+            fwrite(w.str, 1, w.strsize, f) == w.strsize);
+      ok = (fclose(f) == 0) && ok;
+#if !defined(WIN32)
+      ok = ok && (rename(tmp, name) == 0);
+#else
+      ok = ok && MoveFileExA(tmp, name, MOVEFILE_REPLACE_EXISTING);
+#endif
+      if (!ok) remove(tmp);
+    }
+    else ok = 0;
+    if (UNLIKELY(!ok))
+      csound->Warning(csound, Str("cannot write orchestra cache %s"), name);
+    else if (UNLIKELY(csound->oparms->odebug))
+      csound->Message(csound, Str("orchestra cache: saved %s\n"), name);
+    csound->Free(csound, w.nodes);
+    csound->Free(csound, w.tokens);
+    csound->Free(csound, w.str);
+}
+
+/* Reading */
+
+static char *orcc_strdup(CSOUND *csound, const char *str, uint32_t off)
+{
+    if (off == 0)
+      return NULL;
+    return tree_strdup(csound, str + off - 1);
+}
+
+/* Check that the links make a tree of all the nodes, rooted at the first,
+   and that tokens and strings are in range */
+
+static int orcc_check(const ORCC_HDR *hdr, const ORCC_NODE *nodes,
+                      const ORCC_TOKEN *tokens, const char *str,
+                      unsigned char *seen)
+{
+    uint32_t  i, ntok = 0;
+
+    if (hdr->strsize && str[hdr->strsize - 1] != '\0')
+      return 0;
+    for (i = 0; i < hdr->ntokens; i++)
+      if (tokens[i].lexeme > hdr->strsize || tokens[i].optype > hdr->strsize)
+        return 0;
+    for (i = 1; i <= hdr->nnodes; i++) {
+      const ORCC_NODE *r = &nodes[i - 1];
+      const uint32_t  link[3] = { r->left, r->right, r->next };
+      int j;
+      if (r->token && r->token != ++ntok)
+        return 0;
+      for (j = 0; j < 3; j++) {
+        if (link[j] == 0) continue;
+        if (link[j] <= i || link[j] > hdr->nnodes || seen[link[j] - 1]++)
+          return 0;
+      }
+    }
+    if (ntok != hdr->ntokens)
+      return 0;
+    for (i = 1; i < hdr->nnodes; i++)
+      if (!seen[i]) return 0;
+    return 1;
+}
+
+static TREE *orcc_tree(CSOUND *csound, const ORCC_HDR *hdr,
+                       const ORCC_NODE *nodes, const ORCC_TOKEN *tokens,
+                       const char *str)
+{
+    TREE      **t;
+    TREE      *root;
+    uint32_t  i;
+
+    t = (TREE**) csound->Malloc(csound, hdr->nnodes * sizeof(TREE*));
+    for (i = 0; i < hdr->nnodes; i++) {
+      const ORCC_NODE *r = &nodes[i];
+      TREE *p = (TREE*) tree_alloc(csound, sizeof(TREE));
+      p->type = r->type;
+      p->rate = r->rate;
+      p->len = r->len;
+      p->line = r->line;
+      p->locn = r->locn;
+      if (r->token) {
+        const ORCC_TOKEN *k = &tokens[r->token - 1];
+        ORCTOKEN *v = (ORCTOKEN*) tree_alloc(csound, sizeof(ORCTOKEN));
+        v->type = k->type;
+        v->value = k->value;
+        v->fvalue = k->fvalue;
+        v->lexeme = orcc_strdup(csound, str, k->lexeme);
+        v->optype = orcc_strdup(csound, str, k->optype);
+        p->value = v;
+      }
+      t[i] = p;
+    }
+    for (i = 0; i < hdr->nnodes; i++) {
+      if (nodes[i].left)  t[i]->left = t[nodes[i].left - 1];
+      if (nodes[i].right) t[i]->right = t[nodes[i].right - 1];
+      if (nodes[i].next)  t[i]->next = t[nodes[i].next - 1];
+    }
+    root = t[0];
+    csound->Free(csound, t);
+    return root;
+}
+
+/* Load the tree cached under 'key', or NULL if there is none.  The opcode
+   definitions the parser makes as it meets each UDO are made again here,
+   in the same order, so the rest of the compiler sees the same state. */
+
+TREE *orc_cache_load(CSOUND *csound, uint64_t key)
+{
+    ORCC_HDR      hdr;
+    FILE          *f;
+    char          name[1024], build[64];
+    unsigned char *buf, *seen;
+    size_t        size;
+    TREE          *root = NULL, *t;
+    int           ok = 0;
+
+    if (key == 0)
+      return NULL;
+    orcc_name(csound, name, sizeof(name), key);
+    if ((f = fopen(name, "rb")) == NULL)
+      return NULL;
+    orcc_build(build);
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        memcmp(hdr.magic, ORCC_MAGIC, 8) != 0 ||
+        hdr.version != ORCC_VERSION || hdr.endian != ORCC_ENDIAN ||
+        hdr.key != key || memcmp(hdr.build, build, 64) != 0 ||
+        hdr.nnodes == 0) {
+      fclose(f);
+      return NULL;
+    }
+    size = (size_t) hdr.nnodes * sizeof(ORCC_NODE) +
+           (size_t) hdr.ntokens * sizeof(ORCC_TOKEN) + (size_t) hdr.strsize;
+    buf = (unsigned char*) csound->Malloc(csound, size + 1);
+    seen = (unsigned char*) csound->Calloc(csound, hdr.nnodes);
+    if (fread(buf, 1, size + 1, f) == size) {
+      const ORCC_NODE   *nodes = (const ORCC_NODE*) buf;
+      const ORCC_TOKEN  *tokens = (const ORCC_TOKEN*) (nodes + hdr.nnodes);
+      const char        *str = (const char*) (tokens + hdr.ntokens);
+      if (orcc_check(&hdr, nodes, tokens, str, seen)) {
+        root = orcc_tree(csound, &hdr, nodes, tokens, str);
+        ok = 1;
+      }
+    }
+    fclose(f);
+    csound->Free(csound, seen);
+    csound->Free(csound, buf);
+    if (UNLIKELY(!ok)) {
+      csound->Warning(csound, Str("ignoring damaged orchestra cache %s"), name);
+      return NULL;
+    }
+    for (t = root; t != NULL; t = t->next) {
+      TREE *ident = t->left;
+      if (t->type == UDO_TOKEN && ident != NULL && ident->value != NULL &&
+          ident->left != NULL && ident->left->value != NULL &&
+          ident->right != NULL && ident->right->value != NULL)
+        add_udo_definition(csound, ident->value->lexeme,
+                           ident->left->value->lexeme,
+                           ident->right->value->lexeme);
+    }
+    if (UNLIKELY(csound->oparms->odebug))
+      csound->Message(csound, Str("orchestra cache: loaded %s\n"), name);
+    return root;
+}
@@ -143,6 +143,8 @@ int rdscor(CSOUND *csound, EVTBLK *e) /* read next score-line from scorefile */
     MYFLT   *pp, *plim;
     int     c;
 
+    if (csound->bscore != NULL)           /* pre-sorted binary score */
+      return bscore_read(csound, e);
     e->pinstance = NULL;
     if (csound->scstr == NULL ||
         csound->scstr->body[0] == '\0') {   /* if no concurrent scorefile  */
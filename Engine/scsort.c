@@ -26,6 +26,7 @@
 #include <ctype.h>
 
 extern void sort(CSOUND*);
+extern void sort_threads(CSOUND*, int);
 extern void twarp(CSOUND*);
 extern void swritestr(CSOUND*, CORFIL *sco, int first);
 extern void sfree(CSOUND *csound);
@@ -85,3 +86,51 @@ char *scsortstr(CSOUND *csound, CORFIL *scin)
     }
 }
 
+/* As scsortstr() for a first score, but each section is written to outf
+   as soon as it is sorted, so the sorted score is never held in memory
+   as a whole, and sections are sorted on nthreads threads.  The output
+   is the same as that of scsortstr(). */
+
+int scsortfile(CSOUND *csound, CORFIL *scin, FILE *outf, int nthreads)
+{
+    int     n, started = 0;
+    CORFIL  *sco;
+
+    csound->scoreout = NULL;
+    sco = csound->scstr = corfile_create_w(csound);
+    csound->sectcnt = 0;
+    sread_initstr(csound, scin);
+
+    while ((n = sread(csound)) > 0) {
+      if (csound->frstbp->text[0] == 's') // ignore empty segment
+        continue;
+      sort_threads(csound, nthreads);
+      twarp(csound);
+      swritestr(csound, sco, 1);
+      /* an empty score becomes "f0 ..." below, so hold on to the output
+         until it is known to have more than its final "e" */
+      if (!started) {
+        int i = 0;
+        while (isspace(sco->body[i])) i++;
+        if (sco->body[i] == '\0' ||
+            (sco->body[i] == 'e' && sco->body[i+1] == '\n' &&
+             sco->body[i+2] != 'e'))
+          continue;
+        started = 1;
+      }
+      fputs(corfile_body(sco), outf);
+      corfile_reset(sco);
+    }
+    if (!started) {
+      int i = 0;
+      while (isspace(sco->body[i])) i++;
+      if (sco->body[i] == 'e' && sco->body[i+1] == '\n' && sco->body[i+2] != 'e')
+        corfile_reset(sco);
+      else started = 1;
+    }
+    fputs(corfile_body(sco), outf);
+    fputs(started ? "e\n" : "f0 800000000000.0\ne\n", outf);
+    sfree(csound);
+    corfile_rm(csound, &csound->scstr);
+    return ferror(outf) ? NOTOK : OK;
+}
@@ -85,7 +85,11 @@ static inline int ordering(SRTBLK *a, SRTBLK *b)
     }
     /* printf("(%p,%p)[%c,%c]{%d,%d} -> %d\n", */
     /*         a, b, ca, cb, a->lineno, b->lineno,  b->lineno > a->lineno); */
-    return (b->lineno > a->lineno);
+    if (b->lineno != a->lineno)
+      return (b->lineno > a->lineno);
+    /* same line (repeats, loops, wrapped line count): blocks of a section
+       are allocated in input order, so keep that order */
+    return (b >= a);
 }
 
 #define UP(IA,IB)   {temp=IA; IA+=(IB)+1;     IB=temp;}
@@ -231,8 +235,103 @@ static void smoothsort(SRTBLK *A[], const int N)
     /* element 0 processed */
 }
 
+#undef q
+#undef r
+#undef p
+#undef b
+#undef c
+#undef r1
+#undef b1
+#undef c1
 
-void sort(CSOUND *csound)
+
+/* Large sections can be sorted on several threads: the array is cut
+   into one run per thread, the runs are smoothsorted concurrently and
+   then merged.  As ordering() is a total order the result is the same
+   as sorting the whole array at once. */
+
+#define SORT_MINRUN   (16384)
+
+typedef struct {
+    SRTBLK  **A;
+    int     n;
+} SORT_RUN;
+
+static uintptr_t sort_run(void *p)
+{
+    SORT_RUN *run = (SORT_RUN*) p;
+    smoothsort(run->A, run->n);
+    return 0;
+}
+
+/* is the head of run i to be output before that of run j */
+#define RUN_FIRST(i, j) (ordering(*runs[i].A, *runs[j].A))
+
+static void sort_merge(CSOUND *csound, SRTBLK *A[], const int N, int nthreads)
+{
+    SORT_RUN  *runs;
+    void      **threads;
+    int       *heap;
+    SRTBLK    **B;
+    int       i, k, len, nheap;
+
+    if (nthreads > N / SORT_MINRUN)
+      nthreads = N / SORT_MINRUN;
+    if (nthreads < 2) {
+      smoothsort(A, N);
+      return;
+    }
+    runs = (SORT_RUN*) csound->Malloc(csound, nthreads * sizeof(SORT_RUN));
+    threads = (void**) csound->Malloc(csound, nthreads * sizeof(void*));
+    len = N / nthreads;
+    for (i = 0; i < nthreads; i++) {
+      runs[i].A = A + i * len;
+      runs[i].n = (i == nthreads - 1 ? N - i * len : len);
+    }
+    for (i = 1; i < nthreads; i++)
+      threads[i] = csoundCreateThread(sort_run, &runs[i]);
+    sort_run(&runs[0]);
+    for (i = 1; i < nthreads; i++) {
+      if (threads[i] != NULL)
+        csoundJoinThread(threads[i]);
+      else sort_run(&runs[i]);            /* could not start: do it here */
+    }
+    /* k-way merge through a binary heap of run indices */
+    heap = (int*) csound->Malloc(csound, nthreads * sizeof(int));
+    B = (SRTBLK**) csound->Malloc(csound, N * sizeof(SRTBLK*));
+    nheap = 0;
+    for (i = 0; i < nthreads; i++) {
+      int c = nheap++;
+      while (c > 0 && RUN_FIRST(i, heap[(c - 1) >> 1])) {
+        heap[c] = heap[(c - 1) >> 1];
+        c = (c - 1) >> 1;
+      }
+      heap[c] = i;
+    }
+    for (k = 0; k < N; k++) {
+      int top = heap[0], c = 0;
+      B[k] = *runs[top].A++;
+      if (--runs[top].n == 0)
+        top = heap[--nheap];
+      /* sift top down from the root */
+      while (1) {
+        int l = 2 * c + 1, m;
+        if (l >= nheap) break;
+        m = (l + 1 < nheap && RUN_FIRST(heap[l + 1], heap[l])) ? l + 1 : l;
+        if (RUN_FIRST(top, heap[m])) break;
+        heap[c] = heap[m];
+        c = m;
+      }
+      if (nheap > 0) heap[c] = top;
+    }
+    memcpy(A, B, N * sizeof(SRTBLK*));
+    csound->Free(csound, B);
+    csound->Free(csound, heap);
+    csound->Free(csound, threads);
+    csound->Free(csound, runs);
+}
+
+void sort_threads(CSOUND *csound, int nthreads)
 {
     SRTBLK *bp;
     SRTBLK **A;
@@ -284,9 +383,9 @@ void sort(CSOUND *csound)
         if (bp->text[0]=='x') i--; /* try to ignore x opcode */
       }
       if (LIKELY(A[n-1]->text[0]=='e' || A[n-1]->text[0]=='s'))
-        smoothsort(A, n-1);
+        sort_merge(csound, A, n-1, nthreads);
       else
-        smoothsort(A, n);
+        sort_merge(csound, A, n, nthreads);
       /* Relink list in order; first and last different */
       csound->frstbp = bp = A[0]; bp->prvblk = NULL; bp->nxtblk = A[1];
       for (i=1; i<n-1; i++ ) {
@@ -298,3 +397,8 @@ void sort(CSOUND *csound)
 
     }
 }
+
+void sort(CSOUND *csound)
+{
+    sort_threads(csound, 1);
+}
@@ -127,7 +127,8 @@ ORCTOKEN *add_token(CSOUND *csound, char *s, int type)
       a->type = type;
       return a;
     }
-    ans = new_token(csound, T_IDENT);
+    /* lives as long as the symbol table, not the tree being parsed */
+    ans = (ORCTOKEN*)csound->Calloc(csound, sizeof(ORCTOKEN));
     ans->lexeme = (char*)csound->Malloc(csound, 1+strlen(s));
     strcpy(ans->lexeme, s);
     ans->type = type;
@@ -184,7 +185,7 @@ ORCTOKEN *lookup_token(CSOUND *csound, char *s, void *yyscanner)
     if (udoflag == 0) {
       if (isUDOAnsList(s)) {
         ans = new_token(csound, UDO_ANS_TOKEN);
-        ans->lexeme = (char*)csound->Malloc(csound, 1+strlen(s));
+        ans->lexeme = (char*)tree_alloc(csound, 1+strlen(s));
         strcpy(ans->lexeme, s);
         return ans;
       }
@@ -194,7 +195,7 @@ ORCTOKEN *lookup_token(CSOUND *csound, char *s, void *yyscanner)
       if (UNLIKELY(csound->oparms->odebug)) printf("Found UDO Arg List\n");
       if (isUDOArgList(s)) {
         ans = new_token(csound, UDO_ARGS_TOKEN);
-        ans->lexeme = (char*)csound->Malloc(csound, 1+strlen(s));
+        ans->lexeme = (char*)tree_alloc(csound, 1+strlen(s));
         strcpy(ans->lexeme, s);
         return ans;
       }
@@ -203,16 +204,16 @@ ORCTOKEN *lookup_token(CSOUND *csound, char *s, void *yyscanner)
     a = cs_hash_table_get(csound, csound->symbtab, s);
 
     if (a != NULL) {
-      ans = (ORCTOKEN*)csound->Malloc(csound, sizeof(ORCTOKEN));
+      ans = (ORCTOKEN*)tree_alloc(csound, sizeof(ORCTOKEN));
       memcpy(ans, a, sizeof(ORCTOKEN));
       ans->next = NULL;
-      ans->lexeme = (char *)csound->Malloc(csound, strlen(a->lexeme) + 1);
+      ans->lexeme = (char *)tree_alloc(csound, strlen(a->lexeme) + 1);
       strcpy(ans->lexeme, a->lexeme);
       return ans;
     }
 
     ans = new_token(csound, T_IDENT);
-    ans->lexeme = (char*)csound->Malloc(csound, 1+strlen(s));
+    ans->lexeme = (char*)tree_alloc(csound, 1+strlen(s));
     strcpy(ans->lexeme, s);
 
     if (udoflag == -2 || namedInstrFlag == 1) {
@@ -560,8 +561,9 @@ int add_udo_definition(CSOUND *csound, char *opname,
     /* store the name in a linked list (note: must use csound->Calloc) */
     inm = (OPCODINFO *) csound->Calloc(csound, sizeof(OPCODINFO));
     inm->name = cs_strdup(csound, opname);
-    inm->intypes = intypes;
-    inm->outtypes = outtypes;
+    /* copies, as the tree these come from is freed after compilation */
+    inm->intypes = cs_strdup(csound, intypes);
+    inm->outtypes = cs_strdup(csound, outtypes);
     inm->in_arg_pool = csoundCreateVarPool(csound);
     inm->out_arg_pool = csoundCreateVarPool(csound);
 
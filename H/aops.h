@@ -88,6 +88,26 @@ typedef struct {
     MYFLT   *r, *a, *b, *def;
 } DIVZ;
 
+#define FUSED_MAXOPS    (32)
+#define FUSED_TILE      (64)
+
+typedef struct {
+    char    op;                 /* operator or function code */
+    char    ka, kb;             /* 'a' vector arg, 'k' scalar arg, 'r' register */
+    int32_t a, b;               /* arg or register indices */
+    int32_t dst;                /* register, or -1 for the result */
+} FUSEDOP;
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *r;
+    STRINGDAT *prog;
+    MYFLT   *args[VARGMAX];
+    FUSEDOP code[FUSED_MAXOPS];
+    int32_t ncode, nregs;
+    AUXCH   regs;
+} FUSED;
+
 typedef struct {
     OPDS    h;
     MYFLT   *r, *a;
@@ -200,3 +220,22 @@ int32_t monitor_opcode_init(CSOUND *csound, MONITOR_OPCODE *p);
 int32_t outRange_i(CSOUND *csound, OUTRANGE *p);
 int32_t outRange(CSOUND *csound, OUTRANGE *p);
 int32_t hw_channels(CSOUND *csound, ASSIGN *p);
+int32_t fused_init(CSOUND *csound, FUSED *p);
+int32_t fused_perf(CSOUND *csound, FUSED *p);
+
+/* block kernels of the SIMD set picked by aops_simd_init(), see aops.c */
+typedef void (*AOPS_KERNEL)(MYFLT *r, const MYFLT *a, const MYFLT *b,
+                            uint32_t n);
+typedef void (*AOPS_KERNEL1)(MYFLT *r, const MYFLT *a, uint32_t n);
+typedef MYFLT (*AOPS_REDUCE)(const MYFLT *a, uint32_t n);
+
+enum { AOPS_ADD, AOPS_SUB, AOPS_MUL, AOPS_DIV };
+
+typedef struct {
+    const char    *name;
+    AOPS_KERNEL   aa[4], ak[4], ka[4];
+    AOPS_KERNEL1  abs;
+    AOPS_REDUCE   sum, min, max;
+} AOPS_SIMD;
+
+const AOPS_SIMD *aops_simd_kernels(void);
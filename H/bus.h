@@ -64,6 +64,7 @@ typedef struct channelEntry_s {
     spin_lock_t lock;               /* Multi-thread protection */
     int32_t     type;
     int32_t     datasize;  /* size of allocated chn data */
+    int32_t     index;     /* bit in the changed-channel map, or -1 */
     char        name[1];
 } CHNENTRY;
 
@@ -74,6 +75,7 @@ typedef struct {
     MYFLT       *fp;
     spin_lock_t *lock;
     int32_t     pos;
+    int32_t     index;     /* of the control channel, see chn_mark_changed */
     char        chname[MAX_CHAN_NAME+1];
 } CHNGET;
 
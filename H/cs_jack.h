@@ -21,16 +21,13 @@
     02110-1301 USA
 */
 
+#ifdef LINUX
+#include <semaphore.h>
+#endif
+
 #define MAX_NAME_LEN    32      /* for client and port name */
 
 typedef struct RtJackBuffer_ {
-#ifdef LINUX
-    pthread_mutex_t csndLock;               /* signaled by process callback */
-    pthread_mutex_t jackLock;               /* signaled by audio thread     */
-#else
-    void    *csndLock;                      /* signaled by process callback */
-    void    *jackLock;                      /* signaled by audio thread     */
-#endif
     jack_default_audio_sample_t **inBufs;   /* 'nChannels' capture buffers  */
     jack_default_audio_sample_t **outBufs;  /* 'nChannels' playback buffers */
 } RtJackBuffer;
@@ -61,7 +58,18 @@ typedef struct RtJackGlobals_ {
     jack_port_t     **outPorts;         /* 'nChannels' ports for playback   */
     jack_default_audio_sample_t **outPortBufs;
     RtJackBuffer    **bufs;             /* 'nBuffers' I/O buffers           */
+    volatile int jackAvail;             /* buffers ready for JACK callback  */
+    volatile int csndAvail;             /* buffers ready for Csound thread  */
+    volatile int csndWaiting;           /* Csound thread sleeps on csndSem  */
+#ifdef LINUX
+    sem_t   csndSem;                    /* posted by process callback       */
+#else
+    void    *csndSem;                   /* posted by process callback       */
+#endif
+    CS_RTAUDIO_STATS *stats;            /* "_rtaudioStats" global           */
     int     xrunFlag;                   /* non-zero if an xrun has occured  */
+    int     callbackMode;               /* --rt-callback: perform in the    */
+                                        /*   process callback, no buffers   */
     jack_client_t   *listclient;
     int outDevNum, inDevNum;            /* select devs by number */
 } RtJackGlobals;
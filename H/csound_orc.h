@@ -57,6 +57,11 @@ TREE* make_leaf(CSOUND *, int, int, int, ORCTOKEN*);
 ORCTOKEN* make_int(CSOUND *,char *);
 ORCTOKEN* make_num(CSOUND *,char *);
 ORCTOKEN *make_token(CSOUND *csound, char *s);
+void tree_arena_begin(CSOUND *);
+void tree_arena_end(CSOUND *, TREE *);
+void *tree_alloc(CSOUND *, size_t);
+char *tree_strdup(CSOUND *, const char *);
+void tree_free(CSOUND *, void *);
 /*void instr0(CSOUND *, ORCTOKEN*, TREE*, TREE*);*/
 /* extern TREE* statement_list; */
 /* double get_num(TREE*); */
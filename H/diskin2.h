@@ -67,10 +67,7 @@ typedef struct {
     SNDFILE *sf;
     FDCH    fdch;
     AUXCH   auxData;            /* for dynamically allocated buffers */
-    AUXCH   auxData2;
-    MYFLT   *aOut_buf;
-    MYFLT   aOut_bufsize;
-    void    *cb;
+    void    *stream;            /* read-ahead ring when async */
     int     async;
 } DISKIN2;
 
@@ -109,10 +106,7 @@ typedef struct {
     SNDFILE *sf;
     FDCH    fdch;
     AUXCH   auxData;            /* for dynamically allocated buffers */
-    AUXCH   auxData2;
-  MYFLT *aOut_buf;
-  MYFLT aOut_bufsize;
-  void *cb;
+  void *stream;
   int  async;
 } DISKIN2_ARRAY;
 
@@ -179,7 +179,7 @@ int32_t ko1set(CSOUND *, void *);
 int32_t kosc1(CSOUND *, void *), kosc1i(CSOUND *, void *);
 int32_t oscnset(CSOUND *, void *), osciln(CSOUND *, void *);
 int32_t oscset(CSOUND *, void *), koscil(CSOUND *, void *);
-int32_t oscsetA(CSOUND *, void *);
+int32_t oscsetA(CSOUND *, void *), oscseti(CSOUND *, void *);
 int32_t osckk(CSOUND *, void *), oscka(CSOUND *, void *);
 int32_t oscak(CSOUND *, void *), oscaa(CSOUND *, void *);
 int32_t koscli(CSOUND *, void *), osckki(CSOUND *, void *);
@@ -330,6 +330,7 @@ int32_t phaser1set(CSOUND *, void *), phaser1(CSOUND *, void *);
 int32_t balnset(CSOUND *, void *), balance(CSOUND *, void *);
 int32_t prealloc(CSOUND *, void *);
 int32_t prealloc_S(CSOUND *, void *), active_alloc(CSOUND*, void*);
+int32_t asyncinit(CSOUND *, void *), asyncinit_S(CSOUND *, void *);
 int32_t cpsxpch(CSOUND *, void *), cps2pch(CSOUND *, void *);
 int32_t cpstmid(CSOUND *, void *);
 int32_t cpstun(CSOUND *, void *), cpstun_i(CSOUND *, void *);
@@ -93,6 +93,23 @@ extern "C" {
                          MYFLT *outbuf, MYFLT *buf1, MYFLT *buf2,
                          int FFTsize, MYFLT scaleFac);
 
+  /**
+   * Multiply two arrays (buf1 and buf2) of complex data in the format
+   * returned by csoundRealFFT(), and add the result to outbuf, which
+   * must not overlap either input.
+   * The arrays should contain 'FFTsize' MYFLT values.
+   */
+  void csoundRealFFTMultAcc(CSOUND *csound, MYFLT *outbuf,
+                            const MYFLT *buf1, const MYFLT *buf2,
+                            int FFTsize);
+
+  /**
+   * Multiply two arrays of 'n' interleaved complex values (real, imaginary)
+   * and add the result to outbuf, which must not overlap either input.
+   */
+  void csoundComplexMultAcc(CSOUND *csound, MYFLT *outbuf,
+                            const MYFLT *buf1, const MYFLT *buf2, int n);
+
   /**
    * Compute in-place real FFT, allowing non power of two FFT sizes.
    *
@@ -35,6 +35,35 @@
  */
 int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode);
 
+/**
+ * Like hfgens(), but the GEN runs on a table generation thread and the
+ * new table is put in the table list at the start of a later k-cycle;
+ * until then the previous version of the table, if any, stays in use.
+ * Returns the table number, 0 if there is nothing to make and -1 on
+ * errors found before the GEN is run.
+ */
+int hfgens_async(CSOUND *csound, const EVTBLK *evtblkp, int mode);
+
+/**
+ * Returns 1 if table 'tableNum' exists and no new version of it is being
+ * made by hfgens_async(), 0 while one is, and -1 if there is no such table.
+ */
+int csoundFTReady(CSOUND *csound, int tableNum);
+
+void ftgen_async_publish(CSOUND *csound);
+void ftgen_async_stop(CSOUND *csound);
+
+/**
+ * Returns the data of table 'ftp' band-limited for an oscillator reading
+ * 'step' table samples per output sample: a copy of the table without
+ * the harmonics that would alias, kept until the table is reallocated.
+ * Returns ftp->ftable when 'step' is not more than 1 or the table is not
+ * a power of two size table from the table list.  The copies are made
+ * by FFT, so oscillators ask with a negative 'step' at init, which makes
+ * them all then.
+ */
+MYFLT *csoundFTMipmap(CSOUND *csound, FUNC *ftp, MYFLT step);
+
 /**
  * Allocates space for 'tableNum' with a length (not including the guard
  * point) of 'len' samples. The table data is not cleared to zero.
@@ -38,6 +38,10 @@ void    *mmallocDebug(CSOUND *, size_t, char*, int);
 void    *mcallocDebug(CSOUND *, size_t, char*, int);
 void    *mreallocDebug(CSOUND *, void *, size_t, char*, int);
 void    mfreeDebug(CSOUND *, void *, char*, int);
+void    *marena_create(CSOUND *);
+void    *marena_alloc(CSOUND *, void *, size_t);
+int     marena_owns(void *, const void *);
+void    marena_free(CSOUND *, void *);
 char    *cs_strdup(CSOUND*, char*);
 char    *cs_strndup(CSOUND*, char*, size_t);
 void    csoundAuxAlloc(CSOUND *, size_t, AUXCH *), auxchfree(CSOUND *, INSDS *);
@@ -54,14 +58,20 @@ CS_PRINTF2  void    csoundDebugMsg(CSOUND *, const char *, ...);
 CS_PRINTF2  void    csoundErrorMsg(CSOUND *, const char *, ...);
 void    csoundErrMsgV(CSOUND *, const char *, const char *, va_list);
 CS_NORETURN void    csoundLongJmp(CSOUND *, int retval);
+int     csoundRunCaught(CSOUND *, int (*)(CSOUND *, void *), void *);
 TEXT    *getoptxt(CSOUND *, int *);
 void    reverbinit(CSOUND *);
 void    dispinit(CSOUND *);
 int     init0(CSOUND *);
 void    scsort(CSOUND *, FILE *, FILE *);
 char    *scsortstr(CSOUND *, CORFIL *);
+int     scsortfile(CSOUND *, CORFIL *, FILE *, int);
 int     scxtract(CSOUND *, CORFIL *, FILE *);
 int     rdscor(CSOUND *, EVTBLK *);
+int     bscore_open(CSOUND *, const char *);
+int     bscore_read(CSOUND *, EVTBLK *);
+void    bscore_rewind(CSOUND *), bscore_close(CSOUND *);
+int     bscore_write(CSOUND *, FILE *);
 int     musmon(CSOUND *);
 void    RTLineset(CSOUND *);
 FUNC    *csoundFTFind(CSOUND *, MYFLT *);
@@ -64,8 +64,9 @@ typedef struct  {
 
 typedef struct {
         OPDS    h;
-        MYFLT   *sr, *xamp, *xcps, *ifn, *iphs;
+        MYFLT   *sr, *xamp, *xcps, *ifn, *iphs, *iblim;
         int32   lphs;
+        int32   blim;
         FUNC    *ftp;
         FUNC    FF;
 } OSC;
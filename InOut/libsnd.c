@@ -60,157 +60,101 @@ static inline void alloc_globals(CSOUND *csound)
    audtran to flush when this happens.
 */
 
-static void spoutsf(CSOUND *csound)
+/* peak and out of range accounting for n samples of whole frames; the
+   inner loop has no branches so that it vectorizes, and the frame of a
+   new peak is only looked for when there is one */
+
+static inline void sfpeaks(CSOUND *csound, const MYFLT *sp, int n, int rng)
 {
-    uint32_t   chn = 0;
-    int     n;
-    int spoutrem = csound->nspout;
-    MYFLT   *sp = csound->spout;
-    MYFLT   absamp = FL(0.0);
-    uint32  nframes = csound->libsndStatics.nframes;
- nchk:
-    /* if nspout remaining > buf rem, prepare to send in parts */
-    if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem) {
-      n = (int) csound->libsndStatics.outbufrem;
-    }
-    spoutrem -= n;
-    csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen) {
-        *csound->libsndStatics.outbufp++ = (absamp * csound->dbfs_to_float);
-      }
-      if (absamp < FL(0.0)) {
-        absamp = -absamp;
+    int     nchnls = (int) csound->nchnls, nfrm = n / nchnls, chn, i;
+    MYFLT   e0dbfs = csound->e0dbfs;
+    uint32  nframes = STA(nframes);
+
+    for (chn = 0; chn < nchnls; chn++) {
+      const MYFLT *p = sp + chn;
+      MYFLT   mx = FL(0.0), a;
+      int32   cnt = 0;
+      for (i = 0; i < nfrm; i++) {
+        a = FABS(p[i * nchnls]);
+        mx = (a > mx ? a : mx);
+        cnt += (a > e0dbfs);
       }
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
+      if (mx > csound->maxamp[chn]) {       /*  maxamp this seg  */
+        for (i = 0; FABS(p[i * nchnls]) != mx; i++)
+          ;
+        csound->maxamp[chn] = mx;
+        csound->maxpos[chn] = nframes + (uint32) i;
       }
-      if (absamp > csound->e0dbfs) {        /* out of range?     */
-        csound->rngcnt[chn]++;              /*  report it        */
+      if (rng && cnt) {                     /* out of range?     */
+        csound->rngcnt[chn] += cnt;         /*  report it        */
         csound->rngflg = 1;
       }
-      if (csound->multichan) {
-        if (++chn >= csound->nchnls) {
-            chn = 0;
-            nframes++;
-        }
-      } else {
-        nframes++;
-      }
-    } while (--n);
-    if (!csound->libsndStatics.outbufrem) {
-      if (csound->libsndStatics.osfopen) {
-        csound->nrecs++;
-        csound->audtran(csound, csound->libsndStatics.outbuf,
-                        csound->libsndStatics.outbufsiz); /* Flush buffer */
-        csound->libsndStatics.outbufp = (MYFLT*) csound->libsndStatics.outbuf;
-      }
-      csound->libsndStatics.outbufrem = csound->oparms_.outbufsamps;
-      if (spoutrem) {
-        goto nchk;
-      }
     }
-    csound->libsndStatics.nframes = nframes;
+    STA(nframes) = nframes + (uint32) nfrm;
 }
 
-/* special version of spoutsf for "raw" floating point files */
-
-static void spoutsf_noscale(CSOUND *csound)
+static inline void spoutsf_(CSOUND *csound, MYFLT scl, int rng)
 {
-    uint32_t chn = 0;
-    int      n, spoutrem = csound->nspout;
-    MYFLT    *sp = csound->spout;
-    MYFLT    absamp = FL(0.0);
-    uint32   nframes = csound->libsndStatics.nframes;
-
+    int     n, i, spoutrem = csound->nspout;
+    MYFLT   *sp = csound->spout;
  nchk:
     /* if nspout remaining > buf rem, prepare to send in parts */
-    if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem)
-      n = (int)csound->libsndStatics.outbufrem;
+    if ((n = spoutrem) > (int) STA(outbufrem))
+      n = (int) STA(outbufrem);
     spoutrem -= n;
-    csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen)
-        *csound->libsndStatics.outbufp++ = absamp;
-      if (absamp < FL(0.0))
-        absamp = -absamp;
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (++chn >= csound->nchnls)
-        chn = 0, nframes++;
-    } while (--n);
-
-    if (!csound->libsndStatics.outbufrem) {
-      if (csound->libsndStatics.osfopen) {
+    STA(outbufrem) -= n;
+    if (STA(osfopen)) {
+      MYFLT *op = STA(outbufp);
+      for (i = 0; i < n; i++)
+        op[i] = sp[i] * scl;
+      STA(outbufp) += n;
+    }
+    sfpeaks(csound, sp, n, rng);
+    sp += n;
+    if (!STA(outbufrem)) {
+      if (STA(osfopen)) {
         csound->nrecs++;
-        csound->audtran(csound, csound->libsndStatics.outbuf,
-                        csound->libsndStatics.outbufsiz); /* Flush buffer */
-        csound->libsndStatics.outbufp = (MYFLT*) csound->libsndStatics.outbuf;
+        csound->audtran(csound, STA(outbuf), STA(outbufsiz)); /* Flush buffer */
+        STA(outbufp) = (MYFLT*) STA(outbuf);
       }
-      csound->libsndStatics.outbufrem = csound->oparms_.outbufsamps;
-      if (spoutrem) goto nchk;
+      STA(outbufrem) = csound->oparms_.outbufsamps;
+      if (spoutrem)
+        goto nchk;
     }
-    csound->libsndStatics.nframes = nframes;
 }
 
-/* diskfile write option for audtran's */
-/*      assigned during sfopenout()    */
+static void spoutsf(CSOUND *csound)
+{
+    spoutsf_(csound, csound->dbfs_to_float, 1);
+}
 
-static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+/* special version of spoutsf for "raw" floating point files */
+
+static void spoutsf_noscale(CSOUND *csound)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
+    spoutsf_(csound, FL(1.0), 0);
+}
 
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader((void *)STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", "\a");
-        break;
-    }
+/* in callback mode (--rt-callback) the driver callback reads spout and
+   fills spin itself, see csoundRtCallback(); only the peaks are kept */
+
+static void spoutsf_callback(CSOUND *csound)
+{
+    sfpeaks(csound, csound->spout, csound->nspout, 1);
 }
 
-static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void sndfilein_callback(CSOUND *csound)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int    dith;
+    (void) csound;
+}
+
+/* dither ahead of the conversion to 16 or 8 bit samples, with a
+   triangular or rectangular distribution */
+
+static void dither_tri(CSOUND *csound, MYFLT *buf, int m, MYFLT scl)
+{
+    int     n, dith = STA(dither);
 
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    dith = STA(dither);
     for (n=0; n<m; n++) {
       int   tmp = ((dith * 15625) + 1) & 0xFFFF;
       int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
@@ -218,71 +162,68 @@ static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
       dith = rnd;
       rnd = (rnd+tmp)>>1;           /* triangular distribution */
       result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
+      result /= scl;
       buf[n] += result;
     }
     STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
 }
 
-static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void dither_rect(CSOUND *csound, MYFLT *buf, int m, MYFLT scl)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
+    int     n, dith = STA(dither);
 
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    dith = STA(dither);
     for (n=0; n<m; n++) {
-      int   tmp = ((dith * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
+      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
       MYFLT result;
       dith = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
       result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
+      result /= scl;
       buf[n] += result;
     }
     STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
+}
+
+static void dither_16(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_tri(csound, buf, m, (MYFLT) 0x7fff);
+}
+
+static void dither_8(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_tri(csound, buf, m, (MYFLT) 0x7f);
+}
+
+static void dither_u16(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_rect(csound, buf, m, (MYFLT) 0x7fff);
+}
+
+static void dither_u8(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_rect(csound, buf, m, (MYFLT) 0x7f);
+}
+
+/* dither (if asked for), convert and write a buffer to the output
+   file; returns the number of bytes written */
+
+static int sfwrite_buf(CSOUND *csound, MYFLT *buf, int nbytes)
+{
+    int     n;
+
+    if (STA(dithfn) != NULL)
+      STA(dithfn)(csound, buf, nbytes / (int) sizeof(MYFLT));
+    n = (int) sf_write_MYFLT(STA(outfile), buf,
                              nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
+    if (UNLIKELY(csound->oparms->rewrt_hdr))
+      rewriteheader((void *)STA(outfile));
+    return n;
+}
+
+static void sfheartbeat(CSOUND *csound)
+{
+    int     n;
+
+    switch (csound->oparms->heartbeat) {
       case 1:
         csound->MessageS(csound, CSOUNDMSG_REALTIME,
                                  "%c\010", "|/-\\"[csound->nrecs & 3]);
@@ -298,118 +239,164 @@ static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
           if (n > 0) {
             memset(&(s[n]), '\b', n);
             s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
+            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  s);
           }
         }
         break;
       case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
+        csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", "\a");
         break;
     }
 }
 
-static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+/* diskfile write option for audtran's */
+/*      assigned during sfopenout()    */
+
+static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
     int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      dith =  rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
-      buf[n] += result;
-    }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    n = sfwrite_buf(csound, (MYFLT*) outbuf, nbytes);
     if (UNLIKELY(n < nbytes))
       sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  "\a");
-        break;
+    sfheartbeat(csound);
+}
+
+/* Sound file writer thread.
+
+   Unless --sf-write-queue is set below 2, output to a file or pipe goes
+   through a ring of that many buffers.  spoutsf() fills the buffer at
+   the head and writesf_async() queues it for a thread that dithers,
+   converts and writes it, so the performance thread only waits on the
+   disk when every buffer is queued.  The ring needs no lock: head is
+   only moved by the performance thread and tail by the writer, and the
+   count of queued buffers is changed atomically; the thread locks are
+   there to sleep on when the ring is full or empty.  A failed write is
+   reported on the performance thread by the next writesf_async(), or by
+   sfcloseout(). */
+
+typedef struct {
+    CSOUND  *csound;
+    void    *thread;
+    void    *filled, *freed;    /* notified on each put and get */
+    MYFLT   **buf;
+    int     *nbytes;
+    int     depth, head, tail;
+    volatile int count, quit;
+    int     nret, nput;         /* the first failed write */
+} SFWRITER;
+
+static uintptr_t sfwriter_thread(void *p)
+{
+    SFWRITER *w = (SFWRITER*) p;
+    CSOUND   *csound = w->csound;
+    int      n, nret, quit;
+
+    for (;;) {
+      quit = ATOMIC_GET(w->quit);
+      if (ATOMIC_GET(w->count) == 0) {
+        if (quit)
+          break;
+        csoundWaitThreadLockNoTimeout(w->filled);
+        continue;
+      }
+      n = w->nbytes[w->tail];
+      if (LIKELY(w->nput == 0)) {     /* after an error, just drain */
+        nret = sfwrite_buf(csound, w->buf[w->tail], n);
+        if (UNLIKELY(nret < n))
+          w->nret = nret, w->nput = n;
+      }
+      w->tail = (w->tail + 1) % w->depth;
+      ATOMIC_DECR(w->count);
+      csoundNotifyThreadLock(w->freed);
     }
+    return 0;
 }
 
-static void writesf_dither_u8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void sfwriter_free(CSOUND *csound, SFWRITER *w)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
+    int     i;
 
-    if (UNLIKELY(STA(outfile) == NULL))
+    csoundDestroyThreadLock(w->filled);
+    csoundDestroyThreadLock(w->freed);
+    for (i = 1; i < w->depth; i++)      /* buf[0] belongs to sfopenout() */
+      csound->Free(csound, w->buf[i]);
+    csound->Free(csound, w->buf);
+    csound->Free(csound, w->nbytes);
+    csound->Free(csound, w);
+}
+
+/* drains the ring and joins the thread; returns the bytes put of a
+   failed write, if any, with the bytes written in *nret */
+
+static int sfwriter_stop(CSOUND *csound, int *nret)
+{
+    SFWRITER *w = (SFWRITER*) STA(writer);
+    int      nput;
+
+    ATOMIC_SET(w->quit, 1);
+    csoundNotifyThreadLock(w->filled);
+    csoundJoinThread(w->thread);
+    *nret = w->nret;
+    nput = w->nput;
+    STA(outbufp) = STA(outbuf) = w->buf[0];
+    sfwriter_free(csound, w);
+    STA(writer) = NULL;
+    csound->audtran = writesf;
+    return nput;
+}
+
+static void writesf_async(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    SFWRITER *w = (SFWRITER*) STA(writer);
+    int      nret, nput;
+
+    (void) outbuf;                  /* always the buffer at the head */
+    if (UNLIKELY(w->nput != 0)) {
+      nput = sfwriter_stop(csound, &nret);
+      sndwrterr(csound, nret, nput);
       return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
     }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
+    w->nbytes[w->head] = nbytes;
+    w->head = (w->head + 1) % w->depth;
+    ATOMIC_INCR(w->count);
+    csoundNotifyThreadLock(w->filled);
+    while (ATOMIC_GET(w->count) == w->depth)
+      csoundWaitThreadLockNoTimeout(w->freed);
+    STA(outbuf) = w->buf[w->head];
+    sfheartbeat(csound);
+}
+
+static void sfwriter_start(CSOUND *csound)
+{
+    SFWRITER *w;
+    int      i, depth = csound->sfwrite_queue;
+
+    if (depth < 2)
+      return;
+    w = (SFWRITER*) csound->Calloc(csound, sizeof(SFWRITER));
+    w->csound = csound;
+    w->depth = depth;
+    w->buf = (MYFLT**) csound->Calloc(csound, depth * sizeof(MYFLT*));
+    w->nbytes = (int*) csound->Calloc(csound, depth * sizeof(int));
+    w->buf[0] = STA(outbuf);
+    for (i = 1; i < depth; i++)
+      w->buf[i] = (MYFLT*) csound->Malloc(csound, STA(outbufsiz));
+    w->filled = csoundCreateThreadLock();
+    w->freed = csoundCreateThreadLock();
+    csoundWaitThreadLock(w->filled, 0);     /* both start out taken */
+    csoundWaitThreadLock(w->freed, 0);
+#ifndef __EMSCRIPTEN__
+    w->thread = csoundCreateThread(sfwriter_thread, (void*) w);
+#endif
+    if (UNLIKELY(w->thread == NULL)) {   /* write on this thread then */
+      sfwriter_free(csound, w);
+      return;
     }
+    STA(writer) = w;
+    csound->audtran = writesf_async;
 }
 
 static int readsf(CSOUND *csound, MYFLT *inbuf, int inbufsize)
@@ -509,6 +496,8 @@ void sfopenin(CSOUND *csound)           /* init for continuous soundin */
           csoundDie(csound, Str("Failed to initialise real time audio input"));
         /*  & redirect audio gets  */
         csound->audrecv = csound->rtrecord_callback;
+        if (csound->rtcb != NULL)
+          csound->spinrecv = sndfilein_callback;
         STA(pipdevin) = 2;       /* no backward seeks !     */
         goto inset;             /* no header processing    */
       }
@@ -721,6 +710,11 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
           csoundDie(csound, Str("Failed to initialise real time audio output"));
         /*  & redirect audio puts  */
         csound->audtran = csound->rtplay_callback;
+        if (csound->rtcb != NULL) {
+          csound->spoutran = spoutsf_callback;
+          if (STA(pipdevin) == 2)
+            csound->spinrecv = sndfilein_callback;
+        }
         STA(outbufrem)  = parm.bufSamp_SW * parm.nChannels;
         STA(pipdevout)  = 2;      /* no backward seeks !   */
         if (O->realtime == 1)     /* set realtime priority mode */
@@ -729,23 +723,8 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
       }
       else if (strcmp(fName, "null") == 0) {
         STA(outfile) = NULL;
-        if (csound->dither_output && csound->oparms->outformat!=AE_FLOAT &&
-            csound->oparms->outformat!=AE_DOUBLE) {
-          if (csound->oparms->outformat==AE_SHORT)
-            if (csound->dither_output==1)
-              csound->audtran = writesf_dither_16;
-            else
-              csound->audtran = writesf_dither_u16;
-          else if (csound->oparms->outformat==AE_CHAR)
-            if (csound->dither_output==1)
-              csound->audtran = writesf_dither_8;
-            else
-              csound->audtran = writesf_dither_u8;
-          else
-            csound->audtran = writesf;
-        }
-        else
-          csound->audtran = writesf;
+        STA(dithfn) = NULL;
+        csound->audtran = writesf;
         goto outset;
       }
     }
@@ -824,17 +803,14 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
       csound->spoutran = spoutsf;       /* accumulate output */
     else
       csound->spoutran = spoutsf_noscale;
-    if (csound->dither_output && csound->oparms->outformat!=AE_FLOAT &&
-        csound->oparms->outformat!=AE_DOUBLE) {
-      if (csound->oparms->outformat==AE_SHORT)
-        csound->audtran = writesf_dither_16;
-      else if (csound->oparms->outformat==AE_CHAR)
-        csound->audtran = writesf_dither_8;
-      else
-        csound->audtran = writesf;
+    STA(dithfn) = NULL;
+    if (csound->dither_output) {
+      if (O->outformat == AE_SHORT)
+        STA(dithfn) = (csound->dither_output == 1 ? dither_16 : dither_u16);
+      else if (O->outformat == AE_CHAR)
+        STA(dithfn) = (csound->dither_output == 1 ? dither_8 : dither_u8);
     }
-    else
-      csound->audtran = writesf;
+    csound->audtran = writesf;
     /* Write any tags. */
     if ((s = csound->SF_id_title) != NULL && *s != '\0')
       sf_set_string(STA(outfile), SF_STR_TITLE, s);
@@ -883,6 +859,8 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
     }
     STA(osfopen)   = 1;
     STA(outbufrem) = O->outbufsamps;
+    if (STA(outfile) != NULL && STA(pipdevout) != 2)
+      sfwriter_start(csound);
 }
 
 void sfclosein(CSOUND *csound)
@@ -921,6 +899,11 @@ void sfcloseout(CSOUND *csound)
       csound->nrecs++;
       csound->audtran(csound, STA(outbuf), nb);
     }
+    if (STA(writer) != NULL) {
+      int nret, nput;
+      if (UNLIKELY((nput = sfwriter_stop(csound, &nret)) != 0))
+        sndwrterr(csound, nret, nput);
+    }
     if (STA(pipdevout) == 2 && (!STA(isfopen) || STA(pipdevin) != 2)) {
       /* close only if not open for input too */
       csound->rtclose_callback(csound);
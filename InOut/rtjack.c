@@ -25,6 +25,8 @@
 #include <jack/jack.h>
 #include <jack/midiport.h>
 #include <ctype.h>
+#include <errno.h>
+#include <time.h>
 #include <sys/time.h>
 
 /* no #ifdef, should always have these on systems where JACK is available */
@@ -81,96 +83,134 @@ static int listDevices(CSOUND *csound,
 
 #ifdef LINUX
 
-static inline int rtJack_CreateLock(CSOUND *csound, pthread_mutex_t *p)
+static inline int rtJack_CreateSem(CSOUND *csound, sem_t *p)
 {
     (void) csound;
-    return (pthread_mutex_init(p, (pthread_mutexattr_t*) NULL));
+    return (sem_init(p, 0, 0));
 }
 
-static inline void rtJack_Lock(CSOUND *csound, pthread_mutex_t *p)
+/* sem_post() does not block, so this is safe in the process callback */
+static inline void rtJack_Post(CSOUND *csound, sem_t *p)
 {
     (void) csound;
-    pthread_mutex_lock(p);
+    sem_post(p);
 }
 
-static inline int rtJack_LockTimeout(CSOUND *csound, pthread_mutex_t *p,
+static inline int rtJack_WaitTimeout(CSOUND *csound, sem_t *p,
                                      size_t milliseconds)
 {
-  IGN(csound);
-    struct timeval  tv;
     struct timespec ts;
-    register size_t n, s;
-    register int retval = pthread_mutex_trylock(p);
-    if (!retval)
-      return retval;
-    if (!milliseconds)
-      return retval;
-    gettimeofday(&tv, NULL);
-    s = milliseconds / (size_t) 1000;
-    n = milliseconds - (s * (size_t) 1000);
-    s += (size_t) tv.tv_sec;
-    n = (size_t) (((int) n * 1000 + (int) tv.tv_usec) * 1000);
-    ts.tv_nsec = (long) (n < (size_t) 1000000000 ? n : n - 1000000000);
-    ts.tv_sec = (time_t) (n < (size_t) 1000000000 ? s : s + 1);
-    return pthread_mutex_timedlock(p, &ts);
-}
-
-static inline int rtJack_TryLock(CSOUND *csound, pthread_mutex_t *p)
-{
-    (void) csound;
-    return (pthread_mutex_trylock(p));
-}
-
-static inline void rtJack_Unlock(CSOUND *csound, pthread_mutex_t *p)
-{
-    (void) csound;
-    pthread_mutex_unlock(p);
+    IGN(csound);
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t) (milliseconds / (size_t) 1000);
+    ts.tv_nsec += (long) (milliseconds % (size_t) 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(p, &ts) != 0) {
+      if (errno != EINTR)
+        return -1;
+    }
+    return 0;
 }
 
-static inline void rtJack_DestroyLock(CSOUND *csound, pthread_mutex_t *p)
+static inline void rtJack_DestroySem(CSOUND *csound, sem_t *p)
 {
     (void) csound;
-    pthread_mutex_unlock(p);
-    pthread_mutex_destroy(p);
+    sem_destroy(p);
 }
 
 #else   /* LINUX */
 
-static inline int rtJack_CreateLock(CSOUND *csound, void **p)
+static inline int rtJack_CreateSem(CSOUND *csound, void **p)
 {
     *p = csound->CreateThreadLock();
-    return (*p != NULL ? 0 : -1);
+    if (*p == NULL)
+      return -1;
+    csound->WaitThreadLock(*p, (size_t) 0);     /* start out taken */
+    return 0;
 }
 
-static inline void rtJack_Lock(CSOUND *csound, void **p)
+static inline void rtJack_Post(CSOUND *csound, void **p)
 {
-    csound->WaitThreadLockNoTimeout(*p);
+    csound->NotifyThreadLock(*p);
 }
 
-static inline int rtJack_LockTimeout(CSOUND *csound, void **p, size_t timeout)
+static inline int rtJack_WaitTimeout(CSOUND *csound, void **p,
+                                     size_t timeout)
 {
     return csound->WaitThreadLock(*p, timeout);
 }
 
+static inline void rtJack_DestroySem(CSOUND *csound, void **p)
+{
+    csound->DestroyThreadLock(*p);
+    *p = NULL;
+}
+
+#endif  /* LINUX */
+
+/* The process callback and the Csound thread share the nBuffers
+   buffers as a single producer, single consumer ring.  jackAvail counts
+   the buffers the Csound thread has handed to the callback (filled for
+   output, or emptied for input only), and csndAvail the ones the
+   callback has handed back.  Each side only takes from its own count
+   and gives to the other one, so the callback never waits: with no
+   buffer ready it outputs silence and counts an xrun.  The Csound
+   thread sleeps on csndSem, which the callback posts only when
+   csndWaiting asks it to. */
 
-static inline int rtJack_TryLock(CSOUND *csound, void **p)
+/* called by the process callback at the start of a buffer */
+static inline int rtJack_JackTake(RtJackGlobals *p)
 {
-    return (csound->WaitThreadLock(*p, (size_t) 0));
+    int n = ATOMIC_GET(p->jackAvail);
+
+    if (UNLIKELY(n == 0)) {
+      ATOMIC_INCR(p->stats->xruns);
+      return 0;
+    }
+    ATOMIC_DECR(p->jackAvail);
+    ATOMIC_SET(p->stats->fill, n - 1);
+    if (n - 1 < p->stats->min_fill)
+      ATOMIC_SET(p->stats->min_fill, n - 1);
+    return 1;
 }
 
-static inline void rtJack_Unlock(CSOUND *csound, void **p)
+/* called by the process callback when done with a buffer */
+static inline void rtJack_JackGive(RtJackGlobals *p)
 {
-    csound->NotifyThreadLock(*p);
+    ATOMIC_INCR(p->csndAvail);
+    if (ATOMIC_GET(p->csndWaiting)) {
+      ATOMIC_SET(p->csndWaiting, 0);
+      rtJack_Post(p->csound, &(p->csndSem));
+    }
 }
 
-static inline void rtJack_DestroyLock(CSOUND *csound, void **p)
+/* called by the Csound thread at the start of a buffer; waits for the
+   callback to hand one back, and returns non-zero after 'timeout' ms
+   or if the connection to JACK changed */
+static int rtJack_CsndTake(RtJackGlobals *p, size_t timeout)
 {
-    csound->NotifyThreadLock(*p);
-    csound->DestroyThreadLock(*p);
-    *p = NULL;
+    while (ATOMIC_GET(p->csndAvail) == 0) {
+      ATOMIC_SET(p->csndWaiting, 1);
+      if (ATOMIC_GET(p->csndAvail) != 0)
+        break;
+      if (p->jackState != 0 ||
+          rtJack_WaitTimeout(p->csound, &(p->csndSem), timeout) != 0)
+        return -1;
+      if (ATOMIC_GET(p->csndAvail) > 1)     /* missed a period asleep */
+        ATOMIC_INCR(p->stats->late_wakes);
+    }
+    ATOMIC_DECR(p->csndAvail);
+    return 0;
 }
 
-#endif  /* !LINUX */
+/* called by the Csound thread when done with a buffer */
+static inline void rtJack_CsndGive(RtJackGlobals *p)
+{
+    ATOMIC_INCR(p->jackAvail);
+}
 
 /* print error message, close connection, and terminate performance */
 
@@ -234,14 +274,8 @@ static void shutDownCallback(void *arg)
     RtJackGlobals *p = (RtJackGlobals*) arg;
 
     p->jackState = 2;
-    if (p->bufs != NULL) {
-      int   i;
-      for (i = 0; i < p->nBuffers; i++) {
-        if (p->bufs[i] != NULL &&
-            (p->bufs[i]->inBufs != NULL || p->bufs[i]->outBufs != NULL))
-          rtJack_Unlock(p->csound, &(p->bufs[i]->csndLock));
-      }
-    }
+    if (p->bufs != NULL)                /* wake the Csound thread */
+      rtJack_Post(p->csound, &(p->csndSem));
 }
 
 static inline size_t rtJack_AlignData(size_t ofs)
@@ -286,17 +320,13 @@ static void rtJack_AllocateBuffers(RtJackGlobals *p)
       p->bufs[i] = ptr;
       ptr = (void*) ((char*) ptr + (long) nBytesPerBuf);
     }
+    /* create semaphore for waking the Csound thread */
+    if (UNLIKELY(rtJack_CreateSem(csound, &(p->csndSem)) != 0)) {
+      csound->Free(csound, p->bufs);
+      p->bufs = NULL;
+      rtJack_Error(csound, CSOUND_MEMORY, Str("memory allocation failure"));
+    }
     for (i = (size_t) 0; i < (size_t) p->nBuffers; i++) {
-      /* create lock for signaling when the process callback is done */
-      /* with the buffer */
-      if (UNLIKELY(rtJack_CreateLock(csound, &(p->bufs[i]->csndLock)) != 0))
-        rtJack_Error(csound, CSOUND_MEMORY, Str("memory allocation failure"));
-      /* create lock for signaling when the Csound thread is done */
-      /* with the buffer */
-      if (UNLIKELY(rtJack_CreateLock(csound, &(p->bufs[i]->jackLock)) != 0)) {
-        rtJack_DestroyLock(csound, &(p->bufs[i]->csndLock));
-        rtJack_Error(csound, CSOUND_MEMORY, Str("memory allocation failure"));
-      }
       ptr = (void*) p->bufs[i];
       ptr = (void*) ((char*) ptr + (long) ofs2);
       /* set pointers to input/output buffers */
@@ -378,7 +408,7 @@ static void rtJack_RegisterPorts(RtJackGlobals *p)
 static void openJackStreams(RtJackGlobals *p)
 {
     char    buf[256];
-    int     i, j, k;
+    int     i, j;
     CSOUND *csound = p->csound;
 
     /* connect to JACK server */
@@ -422,27 +452,38 @@ static void openJackStreams(RtJackGlobals *p)
     if (p->bufs == NULL)
       rtJack_AllocateBuffers(p);
 
-    /* initialise ring buffers */
+    /* initialise ring buffers: all of them go to JACK first, */
+    /* as silence */
     p->csndBufCnt = 0;
     p->csndBufPos = 0;
     p->jackBufCnt = 0;
     p->jackBufPos = 0;
+    ATOMIC_SET(p->jackAvail, p->nBuffers);
+    ATOMIC_SET(p->csndAvail, 0);
+    ATOMIC_SET(p->csndWaiting, 0);
     for (i = 0; i < p->nBuffers; i++) {
-      rtJack_TryLock(p->csound, &(p->bufs[i]->csndLock));
-      rtJack_Unlock(p->csound, &(p->bufs[i]->jackLock));
       if (p->inputEnabled) {
-        for (j = 0; j < p->nChannels_i; j++) {
-          for (k = 0; k < p->bufSize; k++)
-            p->bufs[i]->inBufs[j][k] = (jack_default_audio_sample_t) 0;
-        }
+        for (j = 0; j < p->nChannels_i; j++)
+          memset(p->bufs[i]->inBufs[j], 0,
+                 sizeof(jack_default_audio_sample_t) * p->bufSize);
       }
       if (p->outputEnabled) {
-        for (j = 0; j < p->nChannels; j++) {
-          for (k = 0; k < p->bufSize; k++)
-            p->bufs[i]->outBufs[j][k] = (jack_default_audio_sample_t) 0;
-        }
+        for (j = 0; j < p->nChannels; j++)
+          memset(p->bufs[i]->outBufs[j], 0,
+                 sizeof(jack_default_audio_sample_t) * p->bufSize);
       }
     }
+    if (p->stats == NULL) {
+      csound->CreateGlobalVariable(csound, "_rtaudioStats",
+                                   sizeof(CS_RTAUDIO_STATS));
+      p->stats = (CS_RTAUDIO_STATS*)
+        csound->QueryGlobalVariable(csound, "_rtaudioStats");
+      if (UNLIKELY(p->stats == NULL))
+        rtJack_Error(csound, CSOUND_MEMORY, Str("memory allocation failure"));
+    }
+    memset(p->stats, 0, sizeof(CS_RTAUDIO_STATS));
+    p->stats->nbuffers = p->nBuffers;
+    p->stats->fill = p->stats->min_fill = p->nBuffers;
 
     /* output port buffer pointer cache is invalid initially */
     if (p->outputEnabled)
@@ -696,6 +737,7 @@ static int playopen_(CSOUND *csound, const csRtAudioParams *parm)
                      (size_t) p->nChannels* sizeof(jack_default_audio_sample_t*));
     if (UNLIKELY(p->outPortBufs == NULL))
       rtJack_Error(p->csound, CSOUND_MEMORY, Str("memory allocation failure"));
+    p->callbackMode = csound->RtCallbackMode(csound);
     /* activate client to start playback */
     openJackStreams(p);
 
@@ -722,21 +764,27 @@ static int processCallback(jack_nframes_t nframes, void *arg)
         p->outPortBufs[i] = (jack_default_audio_sample_t*)
           jack_port_get_buffer(p->outPorts[i], nframes);
     }
+    if (p->callbackMode) {
+      /* run the k-cycles here, on the port buffers */
+      p->csound->RtCallback(p->csound, (const float *const *)
+                            (p->inputEnabled ? p->inPortBufs : NULL), 1,
+                            p->outPortBufs, 1, (int) nframes);
+      return 0;
+    }
     i = 0;
     do {
       /* if starting new buffer: */
       if (p->jackBufPos == 0) {
         /* check for xrun: */
-        if (rtJack_TryLock(p->csound, &(p->bufs[p->jackBufCnt]->jackLock))
-            != 0) {
+        if (!rtJack_JackTake(p)) {
           p->xrunFlag = 1;
           /* yes, discard input and fill output with zero samples */
           if (p->outputEnabled) {
             for (j = 0; j < p->nChannels; j++)
-              for (k = i; k < (int) nframes; k++)
-                p->outPortBufs[j][k] = (jack_default_audio_sample_t) 0;
-            return 0;
+              memset(&(p->outPortBufs[j][i]), 0,
+                     sizeof(jack_default_audio_sample_t) * (nframes - i));
           }
+          return 0;
         }
       }
       /* copy audio data on each channel */
@@ -744,29 +792,23 @@ static int processCallback(jack_nframes_t nframes, void *arg)
       l = p->bufSize - p->jackBufPos;
       l = (l < k ? l : k);      /* number of frames to copy */
       if (p->inputEnabled) {
-        for (j = 0; j < p->nChannels_i; j++) {
-          jack_default_audio_sample_t   *srcp, *dstp;
-          srcp = &(p->inPortBufs[j][i]);
-          dstp = &(p->bufs[p->jackBufCnt]->inBufs[j][p->jackBufPos]);
-          for (k = 0; k < l; k++)
-            dstp[k] = srcp[k];
-        }
+        for (j = 0; j < p->nChannels_i; j++)
+          memcpy(&(p->bufs[p->jackBufCnt]->inBufs[j][p->jackBufPos]),
+                 &(p->inPortBufs[j][i]),
+                 sizeof(jack_default_audio_sample_t) * l);
       }
       if (p->outputEnabled) {
-        for (j = 0; j < p->nChannels; j++) {
-          jack_default_audio_sample_t   *srcp, *dstp;
-          srcp = &(p->bufs[p->jackBufCnt]->outBufs[j][p->jackBufPos]);
-          dstp = &(p->outPortBufs[j][i]);
-          for (k = 0; k < l; k++)
-            dstp[k] = srcp[k];
-        }
+        for (j = 0; j < p->nChannels; j++)
+          memcpy(&(p->outPortBufs[j][i]),
+                 &(p->bufs[p->jackBufCnt]->outBufs[j][p->jackBufPos]),
+                 sizeof(jack_default_audio_sample_t) * l);
       }
       p->jackBufPos += l;
       i += l;
       /* if done with a buffer, notify Csound thread and advance to next one */
       if (p->jackBufPos >= p->bufSize) {
         p->jackBufPos = 0;
-        rtJack_Unlock(p->csound, &(p->bufs[p->jackBufCnt]->csndLock));
+        rtJack_JackGive(p);
         if (++(p->jackBufCnt) >= p->nBuffers)
           p->jackBufCnt = 0;
       }
@@ -801,7 +843,7 @@ static CS_NOINLINE void rtJack_Restart(RtJackGlobals *p)
 static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
 {
     RtJackGlobals *p;
-    int           i, j, k, nframes, bufpos, bufcnt;
+    int           i, k, l, n, nch, nframes, bufpos, bufcnt;
 
     p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
     if (UNLIKELY(p==NULL)) rtJack_Abort(csound, 0);
@@ -813,16 +855,16 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
       else
         rtJack_Abort(csound, p->jackState);
     }
-    nframes = bytes_ / (p->nChannels_i * (int) sizeof(MYFLT));
+    nch = p->nChannels_i;
+    nframes = bytes_ / (nch * (int) sizeof(MYFLT));
     bufpos = p->csndBufPos;
     bufcnt = p->csndBufCnt;
-    for (i = j = 0; i < nframes; i++) {
+    for (i = 0; i < nframes; i += n) {
       if (bufpos == 0) {
         /* wait until there is enough data in ring buffer */
         /* VL 28.03.15 -- timeout after wait for 10 buffer
            lengths */
-        int ret = rtJack_LockTimeout(csound, &(p->bufs[bufcnt]->csndLock),
-                                     10000*(nframes/csound->GetSr(csound)));
+        int ret = rtJack_CsndTake(p, 10000*(nframes/csound->GetSr(csound)));
         if (ret) {
           memset(inbuf_, 0, bytes_);
           OPARMS oparms;
@@ -832,14 +874,21 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
           return bytes_;
         }
       }
-      /* copy audio data */
-      for (k = 0; k < p->nChannels_i; k++)
-        inbuf_[j++] = (MYFLT) p->bufs[bufcnt]->inBufs[k][i];
-      if (++bufpos >= p->bufSize) {
+      /* copy audio data, a channel at a time */
+      n = p->bufSize - bufpos;
+      n = (n < nframes - i ? n : nframes - i);
+      for (k = 0; k < nch; k++) {
+        const jack_default_audio_sample_t *src =
+          &(p->bufs[bufcnt]->inBufs[k][bufpos]);
+        MYFLT *dst = &(inbuf_[i * nch + k]);
+        for (l = 0; l < n; l++)
+          dst[l * nch] = (MYFLT) src[l];
+      }
+      if ((bufpos += n) >= p->bufSize) {
         bufpos = 0;
         /* notify JACK callback that this buffer has been consumed */
         if (!p->outputEnabled)
-          rtJack_Unlock(csound, &(p->bufs[bufcnt]->jackLock));
+          rtJack_CsndGive(p);
         /* advance to next buffer */
         if (++bufcnt >= p->nBuffers)
           bufcnt = 0;
@@ -865,7 +914,7 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
 static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
 {
     RtJackGlobals *p;
-    int           i, j, k, nframes;
+    int           i, k, l, n, nch, nframes;
 
     p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
     if (p == NULL)
@@ -877,22 +926,31 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
         rtJack_Abort(csound, p->jackState);
       return;
     }
-    nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
-    for (i = j = 0; i < nframes; i++) {
+    nch = p->nChannels;
+    nframes = bytes_ / (nch * (int) sizeof(MYFLT));
+    for (i = 0; i < nframes; i += n) {
       if (p->csndBufPos == 0) {
         /* wait until there is enough free space in ring buffer */
-        if (!p->inputEnabled)
-          /* **** COVERITY: claims this is a double lock **** */
-          rtJack_Lock(csound, &(p->bufs[p->csndBufCnt]->csndLock));
+        if (!p->inputEnabled) {
+          while (rtJack_CsndTake(p, (size_t) 1000) != 0)
+            if (p->jackState != 0)
+              return;
+        }
       }
-      /* copy audio data */
-      for (k = 0; k < p->nChannels; k++)
-        p->bufs[p->csndBufCnt]->outBufs[k][i] =
-          (jack_default_audio_sample_t) outbuf_[j++];
-      if (++(p->csndBufPos) >= p->bufSize) {
+      /* copy audio data, a channel at a time */
+      n = p->bufSize - p->csndBufPos;
+      n = (n < nframes - i ? n : nframes - i);
+      for (k = 0; k < nch; k++) {
+        const MYFLT *src = &(outbuf_[i * nch + k]);
+        jack_default_audio_sample_t *dst =
+          &(p->bufs[p->csndBufCnt]->outBufs[k][p->csndBufPos]);
+        for (l = 0; l < n; l++)
+          dst[l] = (jack_default_audio_sample_t) src[l * nch];
+      }
+      if ((p->csndBufPos += n) >= p->bufSize) {
         p->csndBufPos = 0;
         /* notify JACK callback that this buffer is now filled */
-        rtJack_Unlock(csound, &(p->bufs[p->csndBufCnt]->jackLock));
+        rtJack_CsndGive(p);
         /* advance to next buffer */
         if (++(p->csndBufCnt) >= p->nBuffers)
           p->csndBufCnt = 0;
@@ -909,19 +967,12 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
 static void rtJack_DeleteBuffers(RtJackGlobals *p)
 {
     RtJackBuffer  **bufs;
-    size_t        i;
 
     if (p->bufs == (RtJackBuffer**) NULL)
       return;
     bufs = p->bufs;
     p->bufs = (RtJackBuffer**) NULL;
-    for (i = (size_t) 0; i < (size_t) p->nBuffers; i++) {
-      if (bufs[i]->inBufs == (jack_default_audio_sample_t**) NULL &&
-          bufs[i]->outBufs == (jack_default_audio_sample_t**) NULL)
-        continue;
-      rtJack_DestroyLock(p->csound, &(bufs[i]->csndLock));
-      rtJack_DestroyLock(p->csound, &(bufs[i]->jackLock));
-    }
+    rtJack_DestroySem(p->csound, &(p->csndSem));
     p->csound->Free(p->csound,(void*) bufs);
 }
 
@@ -986,6 +1037,8 @@ static CS_NOINLINE void rtclose_(CSOUND *csound)
       csound->Free(csound,p.outPortBufs);
     /* free ring buffers */
     rtJack_DeleteBuffers(&p);
+    if (p.stats != NULL)
+      csound->DestroyGlobalVariable(csound, "_rtaudioStats");
     csound->DestroyGlobalVariable(csound, "_rtjackGlobals");
 }
 
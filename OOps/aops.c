@@ -276,9 +276,221 @@ int32_t modkk(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define KA(OPNAME,OP)                                  \
+/* SIMD kernels for the a-rate arithmetic opcodes
+
+   Each kernel computes r[i] = a[i] op b[i] for i < n, where either
+   operand may instead be a scalar (the _ak and _ka forms).  With GCC
+   and clang they are built once per instruction set from vector
+   extensions and target attributes, and aops_simd_init() installs the
+   widest set the CPU supports when the library is initialised; the
+   environment variable CSOUND_SIMD (scalar, sse2, avx2, avx512) can
+   lower the choice.  All variants do the same IEEE operations in the
+   same order as the plain loops, so the results are identical.
+
+   The reductions over n >= 1 values, used by the array opcodes, are the
+   exception: the vector sum adds in as many partial sums as there are
+   lanes, so it may round differently from the scalar one, and min and
+   max may return a zero of the other sign when the extreme is zero. */
+
+#define AOPS_BINOP_C(SFX, ATTR, NAME, OP)                               \
+  ATTR static void NAME##_aa_##SFX(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n) {        \
+    uint32_t i;                                                         \
+    for (i = 0; i < n; i++) r[i] = a[i] OP b[i];                        \
+  }                                                                     \
+  ATTR static void NAME##_ak_##SFX(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n) {        \
+    MYFLT y = *b; uint32_t i;                                           \
+    for (i = 0; i < n; i++) r[i] = a[i] OP y;                           \
+  }                                                                     \
+  ATTR static void NAME##_ka_##SFX(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n) {        \
+    MYFLT x = *a; uint32_t i;                                           \
+    for (i = 0; i < n; i++) r[i] = x OP b[i];                           \
+  }
+
+#define AOPS_KERNELS_C(SFX, ATTR)                                       \
+  AOPS_BINOP_C(SFX, ATTR, add, +)                                       \
+  AOPS_BINOP_C(SFX, ATTR, sub, -)                                       \
+  AOPS_BINOP_C(SFX, ATTR, mul, *)                                       \
+  AOPS_BINOP_C(SFX, ATTR, div, /)                                       \
+  ATTR static void abs_a_##SFX(MYFLT *r, const MYFLT *a, uint32_t n) {  \
+    uint32_t i;                                                         \
+    for (i = 0; i < n; i++) r[i] = FABS(a[i]);                          \
+  }                                                                     \
+  ATTR static MYFLT sum_a_##SFX(const MYFLT *a, uint32_t n) {           \
+    MYFLT s = a[0]; uint32_t i;                                         \
+    for (i = 1; i < n; i++) s += a[i];                                  \
+    return s;                                                           \
+  }                                                                     \
+  ATTR static MYFLT min_a_##SFX(const MYFLT *a, uint32_t n) {           \
+    MYFLT x = a[0]; uint32_t i;                                         \
+    for (i = 1; i < n; i++) if (a[i] < x) x = a[i];                     \
+    return x;                                                           \
+  }                                                                     \
+  ATTR static MYFLT max_a_##SFX(const MYFLT *a, uint32_t n) {           \
+    MYFLT x = a[0]; uint32_t i;                                         \
+    for (i = 1; i < n; i++) if (a[i] > x) x = a[i];                     \
+    return x;                                                           \
+  }
+
+#define AOPS_TABLE(SFX, NAME)                                           \
+  { NAME,                                                               \
+    { add_aa_##SFX, sub_aa_##SFX, mul_aa_##SFX, div_aa_##SFX },         \
+    { add_ak_##SFX, sub_ak_##SFX, mul_ak_##SFX, div_ak_##SFX },         \
+    { add_ka_##SFX, sub_ka_##SFX, mul_ka_##SFX, div_ka_##SFX },         \
+    abs_a_##SFX, sum_a_##SFX, min_a_##SFX, max_a_##SFX }
+
+AOPS_KERNELS_C(c, )
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__) ||   \
+                          defined(__aarch64__) || defined(__ARM_NEON))
+#define AOPS_VECTOR_EXT
+
+#ifdef USE_DOUBLE
+typedef int64_t aops_int;
+#else
+typedef int32_t aops_int;
+#endif
+
+/* V is a vector type with element alignment, so loads and stores need
+   no alignment; the tails run the scalar code */
+#define AOPS_BINOP_V(SFX, ATTR, V, NAME, OP)                            \
+  ATTR static void NAME##_aa_##SFX(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n) {        \
+    uint32_t i = 0, w = sizeof(V) / sizeof(MYFLT);                      \
+    for ( ; i + w <= n; i += w)                                         \
+      *(V *) &r[i] = *(const V *) &a[i] OP *(const V *) &b[i];          \
+    for ( ; i < n; i++) r[i] = a[i] OP b[i];                            \
+  }                                                                     \
+  ATTR static void NAME##_ak_##SFX(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n) {        \
+    uint32_t i = 0, w = sizeof(V) / sizeof(MYFLT);                      \
+    MYFLT y = *b;                                                       \
+    V vy;                                                               \
+    for (i = 0; i < w; i++) vy[i] = y;                                  \
+    for (i = 0; i + w <= n; i += w)                                     \
+      *(V *) &r[i] = *(const V *) &a[i] OP vy;                          \
+    for ( ; i < n; i++) r[i] = a[i] OP y;                               \
+  }                                                                     \
+  ATTR static void NAME##_ka_##SFX(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n) {        \
+    uint32_t i = 0, w = sizeof(V) / sizeof(MYFLT);                      \
+    MYFLT x = *a;                                                       \
+    V vx;                                                               \
+    for (i = 0; i < w; i++) vx[i] = x;                                  \
+    for (i = 0; i + w <= n; i += w)                                     \
+      *(V *) &r[i] = vx OP *(const V *) &b[i];                          \
+    for ( ; i < n; i++) r[i] = x OP b[i];                               \
+  }
+
+/* partial sums per lane; min and max keep a[0] in every lane to start
+   with, so that a NaN is ignored, or returned, as by the scalar loop */
+#define AOPS_REDUCE_V(SFX, ATTR, V, VI)                                 \
+  ATTR static MYFLT sum_a_##SFX(const MYFLT *a, uint32_t n) {           \
+    uint32_t i, j, w = sizeof(V) / sizeof(MYFLT);                       \
+    MYFLT s;                                                            \
+    V vs;                                                               \
+    if (n < 2 * w) {                                                    \
+      for (s = a[0], i = 1; i < n; i++) s += a[i];                      \
+      return s;                                                         \
+    }                                                                   \
+    vs = *(const V *) a;                                                \
+    for (i = w; i + w <= n; i += w) vs += *(const V *) &a[i];           \
+    for (s = vs[0], j = 1; j < w; j++) s += vs[j];                      \
+    for ( ; i < n; i++) s += a[i];                                      \
+    return s;                                                           \
+  }                                                                     \
+  AOPS_EXTREME_V(SFX, ATTR, V, VI, min, <)                              \
+  AOPS_EXTREME_V(SFX, ATTR, V, VI, max, >)
+
+#define AOPS_EXTREME_V(SFX, ATTR, V, VI, NAME, CMP)                     \
+  ATTR static MYFLT NAME##_a_##SFX(const MYFLT *a, uint32_t n) {        \
+    uint32_t i, j, w = sizeof(V) / sizeof(MYFLT);                       \
+    MYFLT x = a[0];                                                     \
+    V vx;                                                               \
+    for (j = 0; j < w; j++) vx[j] = x;                                  \
+    for (i = 0; i + w <= n; i += w) {                                   \
+      V v = *(const V *) &a[i];                                         \
+      VI m = v CMP vx;                                                  \
+      vx = (V) (((VI) v & m) | ((VI) vx & ~m));                         \
+    }                                                                   \
+    for (j = 0; j < w; j++) if (vx[j] CMP x) x = vx[j];                 \
+    for ( ; i < n; i++) if (a[i] CMP x) x = a[i];                       \
+    return x;                                                           \
+  }
+
+#define AOPS_KERNELS_V(SFX, ATTR, BYTES)                                \
+  typedef MYFLT aops_v_##SFX                                            \
+    __attribute__((vector_size(BYTES), aligned(sizeof(MYFLT)),          \
+                   __may_alias__));                                     \
+  typedef aops_int aops_vi_##SFX                                        \
+    __attribute__((vector_size(BYTES), aligned(sizeof(MYFLT)),          \
+                   __may_alias__));                                     \
+  AOPS_BINOP_V(SFX, ATTR, aops_v_##SFX, add, +)                         \
+  AOPS_BINOP_V(SFX, ATTR, aops_v_##SFX, sub, -)                         \
+  AOPS_BINOP_V(SFX, ATTR, aops_v_##SFX, mul, *)                         \
+  AOPS_BINOP_V(SFX, ATTR, aops_v_##SFX, div, /)                         \
+  ATTR static void abs_a_##SFX(MYFLT *r, const MYFLT *a, uint32_t n) {  \
+    uint32_t i = 0, w = sizeof(aops_v_##SFX) / sizeof(MYFLT);           \
+    aops_vi_##SFX m;                                                    \
+    for (i = 0; i < w; i++) m[i] = ~((aops_int) 1 << (sizeof(MYFLT)*8-1)); \
+    for (i = 0; i + w <= n; i += w)                                     \
+      *(aops_vi_##SFX *) &r[i] = *(const aops_vi_##SFX *) &a[i] & m;    \
+    for ( ; i < n; i++) r[i] = FABS(a[i]);                              \
+  }                                                                     \
+  AOPS_REDUCE_V(SFX, ATTR, aops_v_##SFX, aops_vi_##SFX)
+
+/* SSE2 on x86-64, NEON on ARM */
+AOPS_KERNELS_V(v128, , 16)
+#if defined(__x86_64__) || defined(__i386__)
+AOPS_KERNELS_V(avx2, __attribute__((target("avx2"))), 32)
+AOPS_KERNELS_V(avx512, __attribute__((target("avx512f"))), 64)
+#endif
+#endif  /* AOPS_VECTOR_EXT */
+
+static const AOPS_SIMD aops_simd_sets[] = {
+    AOPS_TABLE(c, "scalar"),
+#ifdef AOPS_VECTOR_EXT
+#if defined(__x86_64__) || defined(__i386__)
+    AOPS_TABLE(v128, "sse2"),
+    AOPS_TABLE(avx2, "avx2"),
+    AOPS_TABLE(avx512, "avx512"),
+#else
+    AOPS_TABLE(v128, "neon"),
+#endif
+#endif
+};
+
+static const AOPS_SIMD *aops_simd = &aops_simd_sets[0];
+
+/* called once from csoundInitialize() */
+void aops_simd_init(void)
+{
+    int n = (int) (sizeof(aops_simd_sets) / sizeof(AOPS_SIMD)), i;
+    const char *s = getenv("CSOUND_SIMD");
+#if defined(AOPS_VECTOR_EXT) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("sse2")) n = 1;
+    else if (!__builtin_cpu_supports("avx2")) n = 2;
+    else if (!__builtin_cpu_supports("avx512f")) n = 3;
+#endif
+    if (s != NULL) {
+      for (i = 0; i < n; i++)
+        if (strcmp(s, aops_simd_sets[i].name) == 0) break;
+      if (i < n) n = i + 1;
+    }
+    aops_simd = &aops_simd_sets[n - 1];
+}
+
+const AOPS_SIMD *aops_simd_kernels(void)
+{
+    return aops_simd;
+}
+
+#define KA(OPNAME,OP,K)                                \
   int32_t OPNAME(CSOUND *csound, AOP *p) {             \
-    uint32_t n, nsmps = CS_KSMPS;                      \
+    uint32_t nsmps = CS_KSMPS;                         \
     IGN(csound);                                       \
     if (LIKELY(nsmps!=1)) {                            \
       MYFLT   *r, a, *b;                               \
@@ -292,8 +504,8 @@ int32_t modkk(CSOUND *csound, AOP *p)
         nsmps -= early;                                \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));  \
       }                                                \
-      for (n=offset; n<nsmps; n++)                     \
-        r[n] = a OP b[n];                              \
+      if (LIKELY(nsmps > offset))                      \
+        aops_simd->ka[K](&r[offset], &a, &b[offset], nsmps-offset); \
       return OK;                                       \
     }                                                  \
     else {                                             \
@@ -303,10 +515,10 @@ int32_t modkk(CSOUND *csound, AOP *p)
   }
 
 
-KA(addka,+)
-KA(subka,-)
-KA(mulka,*)
-KA(divka,/)
+KA(addka,+,AOPS_ADD)
+KA(subka,-,AOPS_SUB)
+KA(mulka,*,AOPS_MUL)
+KA(divka,/,AOPS_DIV)
 
 int32_t modka(CSOUND *csound, AOP *p)
 {
@@ -329,9 +541,9 @@ int32_t modka(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define AK(OPNAME,OP)                           \
+#define AK(OPNAME,OP,K)                         \
   int32_t OPNAME(CSOUND *csound, AOP *p) {      \
-    uint32_t n, nsmps = CS_KSMPS;               \
+    uint32_t nsmps = CS_KSMPS;                  \
     IGN(csound);                                \
     if (LIKELY(nsmps != 1)) {                   \
       MYFLT   *r, *a, b;                        \
@@ -346,8 +558,8 @@ int32_t modka(CSOUND *csound, AOP *p)
         nsmps -= early;                         \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
       }                                         \
-      for (n=offset; n<nsmps; n++)              \
-        r[n] = a[n] OP b;                       \
+      if (LIKELY(nsmps > offset))               \
+        aops_simd->ak[K](&r[offset], &a[offset], &b, nsmps-offset); \
       return OK;                                \
     }                                           \
     else {                                      \
@@ -356,12 +568,12 @@ int32_t modka(CSOUND *csound, AOP *p)
     }                                           \
 }
 
-AK(addak,+)
-AK(subak,-)
-AK(mulak,*)
+AK(addak,+,AOPS_ADD)
+AK(subak,-,AOPS_SUB)
+AK(mulak,*,AOPS_MUL)
 //AK(divak,/)
 int32_t divak(CSOUND *csound, AOP *p) {
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
     MYFLT b = *p->b;
     if (LIKELY(nsmps != 1)) {
       MYFLT   *r, *a;
@@ -378,8 +590,8 @@ int32_t divak(CSOUND *csound, AOP *p) {
         nsmps -= early;
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        r[n] = a[n] / b;
+      if (LIKELY(nsmps > offset))
+        aops_simd->ak[AOPS_DIV](&r[offset], &a[offset], &b, nsmps-offset);
       return OK;
     }
     else {
@@ -412,11 +624,11 @@ int32_t modak(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define AA(OPNAME,OP)                           \
+#define AA(OPNAME,OP,K)                         \
   int32_t OPNAME(CSOUND *csound, AOP *p) {      \
   MYFLT   *r, *a, *b;                           \
   IGN(csound);                                  \
-  uint32_t n, nsmps = CS_KSMPS;                 \
+  uint32_t nsmps = CS_KSMPS;                    \
   if (LIKELY(nsmps!=1)) {                       \
     uint32_t offset = p->h.insdshead->ksmps_offset;  \
     uint32_t early  = p->h.insdshead->ksmps_no_end;  \
@@ -428,8 +640,8 @@ int32_t modak(CSOUND *csound, AOP *p)
       nsmps -= early;                           \
       memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
     }                                           \
-    for (n=offset; n<nsmps; n++)                \
-      r[n] = a[n] OP b[n];                      \
+    if (LIKELY(nsmps > offset))                 \
+      aops_simd->aa[K](&r[offset], &a[offset], &b[offset], nsmps-offset); \
     return OK;                                  \
   }                                             \
     else {                                      \
@@ -438,57 +650,13 @@ int32_t modak(CSOUND *csound, AOP *p)
     }                                           \
   }
 
-/* VL
-   experimental code using SSE for operations
-   needs memory alignment - 16 bytes
-*/
-#ifdef USE_SSE
-#include "emmintrin.h"
-#define AA_VEC(OPNAME,OP)                   \
-int32_t OPNAME(CSOUND *csound, AOP *p){     \
-  MYFLT   *r, *a, *b;                       \
-  __m128d va, vb;                           \
-  uint32_t n, nsmps = CS_KSMPS, end;        \
-  if (LIKELY(nsmps!=1)) {                   \
-  uint32_t offset = p->h.insdshead->ksmps_offset; \
-  uint32_t early  = p->h.insdshead->ksmps_no_end; \
-  r = p->r; a = p->a; b = p->b;             \
-  if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
-  if (UNLIKELY(early)) {                    \
-      nsmps -= early;                       \
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));  \
-  } \
-  end = nsmps; \
-  for (n=offset; n<end; n+=2) { \
-   va = _mm_loadu_pd(&a[n]); \
-   vb = _mm_loadu_pd(&b[n]); \
-   va = OP(va,vb);\
-   _mm_storeu_pd(&r[n],va); \
-  }     \
-  return OK; \
-  } \
-   else { \
-     *p->r = *p->a + *p->b;\
-      return OK; \
-   }             \
-} \
-
-AA_VEC(addaa,_mm_add_pd)
-AA_VEC(subaa,_mm_sub_pd)
-AA_VEC(mulaa,_mm_mul_pd)
-AA_VEC(divaa,_mm_div_pd)
-
-#else
-AA(addaa,+)
-AA(subaa,-)
-AA(mulaa,*)
-//AA(divaa,/)
-#endif
+AA(addaa,+,AOPS_ADD)
+AA(subaa,-,AOPS_SUB)
+AA(mulaa,*,AOPS_MUL)
 
 int32_t divaa(CSOUND *csound, AOP *p)
 {
     MYFLT   *r, *a, *b;
-    int     err = 0;
     IGN(csound);
     uint32_t n, nsmps = CS_KSMPS;
     if (LIKELY(nsmps!=1)) {
@@ -502,14 +670,14 @@ int32_t divaa(CSOUND *csound, AOP *p)
         nsmps -= early;
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++ ) {
-        MYFLT bb = b[n];
-        if (UNLIKELY(bb==FL(0.0) && err==0)) {
+      for (n=offset; n<nsmps; n++)
+        if (UNLIKELY(b[n]==FL(0.0))) {
           csound->Warning(csound, Str("Division by zero"));
-          err = 1;
+          break;
         }
-        r[n] = a[n] / bb;
-      }
+      if (LIKELY(nsmps > offset))
+        aops_simd->aa[AOPS_DIV](&r[offset], &a[offset], &b[offset],
+                                nsmps-offset);
       return OK;
     }
     else {
@@ -864,7 +1032,22 @@ int32_t atan21(CSOUND *csound, AOP *p)
       r[n] = LIBNAME(a[n]);                                             \
     return OK;                                                          \
   }
-LIBA(absa,FABS)
+int32_t absa(CSOUND *csound, EVAL *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nsmps = CS_KSMPS;
+    MYFLT   *r = p->r;
+    IGN(csound);
+    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    if (LIKELY(nsmps > offset))
+      aops_simd->abs(&r[offset], &p->a[offset], nsmps-offset);
+    return OK;
+}
 LIBA(expa,EXP)
 LIBA(loga,LOG)
 LIBA(sqrta,SQRT)
@@ -880,6 +1063,151 @@ LIBA(tanha,TANH)
 LIBA(log10a,LOG10)
 LIBA(log2a,LOG2)
 
+/* ##fused: a tree of elementwise a-rate arithmetic merged into one
+   opcode by the orchestra optimiser (fuse_expressions() in
+   csound_orc_optimize.c).  The program string is postfix: 'a' and 'k'
+   push the next argument as a vector or a scalar, "+-*%/" pop two
+   operands and the letters below pop one.  At init time it is turned
+   into register code; at perf time it runs FUSED_TILE samples at a
+   time so the intermediate values never leave the cache. */
+
+#define FUSED_FUNCTIONS "AELQSCTIONXYHGB"
+
+int32_t fused_init(CSOUND *csound, FUSED *p)
+{
+    const char *s = p->prog->data;
+    int32_t nargs = (int32_t) p->INOCOUNT - 1;
+    int32_t top = 0, narg = 0, nfree = 0;
+    int32_t stki[FUSED_MAXOPS + 1], freeregs[FUSED_MAXOPS];
+    char    stkk[FUSED_MAXOPS + 1];
+    FUSEDOP *c;
+
+    p->ncode = p->nregs = 0;
+    for ( ; *s != '\0'; s++) {
+      if (*s == 'a' || *s == 'k') {
+        if (UNLIKELY(narg >= nargs || top > FUSED_MAXOPS)) goto err;
+        stkk[top] = *s;
+        stki[top++] = narg++;
+        continue;
+      }
+      if (UNLIKELY(p->ncode >= FUSED_MAXOPS ||
+                   strchr("+-*/%" FUSED_FUNCTIONS, *s) == NULL)) goto err;
+      c = &p->code[p->ncode++];
+      c->op = *s;
+      c->kb = '\0';
+      c->b = 0;
+      if (strchr("+-*/%", *s) != NULL) {
+        if (UNLIKELY(top < 2)) goto err;
+        c->kb = stkk[--top];
+        c->b = stki[top];
+        if (c->kb == 'r') freeregs[nfree++] = c->b;
+      }
+      if (UNLIKELY(top < 1)) goto err;
+      c->ka = stkk[--top];
+      c->a = stki[top];
+      if (c->ka == 'r') freeregs[nfree++] = c->a;
+      c->dst = nfree > 0 ? freeregs[--nfree] : p->nregs++;
+      stkk[top] = 'r';
+      stki[top++] = c->dst;
+    }
+    if (UNLIKELY(top != 1 || p->ncode == 0 || narg != nargs)) goto err;
+    p->code[p->ncode - 1].dst = -1;
+    if (p->nregs > 0) {
+      size_t n = (size_t) p->nregs * FUSED_TILE * sizeof(MYFLT);
+      if (p->regs.auxp == NULL || p->regs.size < n)
+        csound->AuxAlloc(csound, n, &p->regs);
+    }
+    return OK;
+ err:
+    return csound->InitError(csound, Str("invalid fused expression '%s'"),
+                             p->prog->data);
+}
+
+#define FUSED_ARG(K, I)                                                 \
+    ((K) == 'r' ? &regs[(I) * FUSED_TILE] :                            \
+     (K) == 'a' ? p->args[I] + n : p->args[I])
+
+#define FUSED_BINOP(EXPR)                                               \
+    if (c->ka == 'k') {                                                 \
+      MYFLT x = *a;                                                     \
+      for (j = 0; j < len; j++) { MYFLT y = b[j]; d[j] = EXPR; }        \
+    }                                                                   \
+    else if (c->kb == 'k') {                                            \
+      MYFLT y = *b;                                                     \
+      for (j = 0; j < len; j++) { MYFLT x = a[j]; d[j] = EXPR; }        \
+    }                                                                   \
+    else                                                                \
+      for (j = 0; j < len; j++) { MYFLT x = a[j], y = b[j]; d[j] = EXPR; }
+
+#define FUSED_KERNEL(K)                                                 \
+    if (c->ka == 'k') aops_simd->ka[K](d, a, b, len);                   \
+    else if (c->kb == 'k') aops_simd->ak[K](d, a, b, len);              \
+    else aops_simd->aa[K](d, a, b, len)
+
+#define FUSED_FN(CODE, FN)                                              \
+    case CODE:                                                          \
+      for (j = 0; j < len; j++) d[j] = FN(a[j]);                        \
+      break;
+
+int32_t fused_perf(CSOUND *csound, FUSED *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t n, j, len, nsmps = CS_KSMPS;
+    MYFLT   *r = p->r, *regs = (MYFLT *) p->regs.auxp;
+    int32_t i, err = 0;
+
+    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    for (n = offset; n < nsmps; n += len) {
+      len = nsmps - n < FUSED_TILE ? nsmps - n : FUSED_TILE;
+      for (i = 0; i < p->ncode; i++) {
+        const FUSEDOP *c = &p->code[i];
+        MYFLT *d = c->dst < 0 ? &r[n] : &regs[c->dst * FUSED_TILE];
+        const MYFLT *a = FUSED_ARG(c->ka, c->a);
+        const MYFLT *b = FUSED_ARG(c->kb, c->b);
+        switch (c->op) {
+        case '+': FUSED_KERNEL(AOPS_ADD); break;
+        case '-': FUSED_KERNEL(AOPS_SUB); break;
+        case '*': FUSED_KERNEL(AOPS_MUL); break;
+        case '%': FUSED_BINOP(MOD(x, y)); break;
+        case '/':
+          /* warn as divak and divaa do; divka never did */
+          if (UNLIKELY(!err && c->ka != 'k')) {
+            uint32_t m = (c->kb == 'k' ? 1 : len);
+            for (j = 0; j < m; j++)
+              if (b[j] == FL(0.0)) {
+                csound->Warning(csound, Str("Division by zero"));
+                err = 1;
+                break;
+              }
+          }
+          FUSED_KERNEL(AOPS_DIV);
+          break;
+        case 'A': aops_simd->abs(d, a, len); break;
+        FUSED_FN('E', EXP)
+        FUSED_FN('L', LOG)
+        FUSED_FN('Q', SQRT)
+        FUSED_FN('S', SIN)
+        FUSED_FN('C', COS)
+        FUSED_FN('T', TAN)
+        FUSED_FN('I', ASIN)
+        FUSED_FN('O', ACOS)
+        FUSED_FN('N', ATAN)
+        FUSED_FN('X', SINH)
+        FUSED_FN('Y', COSH)
+        FUSED_FN('H', TANH)
+        FUSED_FN('G', LOG10)
+        FUSED_FN('B', LOG2)
+        }
+      }
+    }
+    return OK;
+}
+
 int32_t atan2aa(CSOUND *csound, AOP *p)
 {
     MYFLT   *r, *a, *b;
@@ -2144,12 +2472,13 @@ int32_t addina(CSOUND *csound, ASSIGN *p)
     MYFLT* val = p->a;
     MYFLT* ans = p->r;
     uint32_t    offset = p->h.insdshead->ksmps_offset;
-    uint32_t    nsmps = CS_KSMPS, n;
+    uint32_t    nsmps = CS_KSMPS;
     uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
     CSOUND_SPOUT_SPINLOCK
-    for (n=offset; n<early; n++)
-      ans[n] += val[n];
+    if (LIKELY(early > offset))
+      aops_simd->aa[AOPS_ADD](&ans[offset], &ans[offset], &val[offset],
+                              early-offset);
     CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
@@ -2159,13 +2488,13 @@ int32_t addinak(CSOUND *csound, ASSIGN *p)
     MYFLT val;
     MYFLT* ans = p->r;
     uint32_t    offset = p->h.insdshead->ksmps_offset;
-    uint32_t    nsmps = CS_KSMPS, n;
+    uint32_t    nsmps = CS_KSMPS;
     uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
     CSOUND_SPOUT_SPINLOCK
     val = *p->a;
-    for (n=offset; n<early; n++)
-      ans[n] += val;
+    if (LIKELY(early > offset))
+      aops_simd->ak[AOPS_ADD](&ans[offset], &ans[offset], &val, early-offset);
     CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
@@ -2191,12 +2520,13 @@ int32_t subina(CSOUND *csound, ASSIGN *p)
     MYFLT* val = p->a;
     MYFLT* ans = p->r;
     uint32_t    offset = p->h.insdshead->ksmps_offset;
-    uint32_t    nsmps = CS_KSMPS, n;
+    uint32_t    nsmps = CS_KSMPS;
     uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
     CSOUND_SPOUT_SPINLOCK
-    for (n=offset; n<early; n++)
-      ans[n] -= val[n];
+    if (LIKELY(early > offset))
+      aops_simd->aa[AOPS_SUB](&ans[offset], &ans[offset], &val[offset],
+                              early-offset);
     CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
@@ -2206,13 +2536,13 @@ int32_t subinak(CSOUND *csound, ASSIGN *p)
     MYFLT val;
     MYFLT* ans = p->r;
     uint32_t    offset = p->h.insdshead->ksmps_offset;
-    uint32_t    nsmps = CS_KSMPS, n;
+    uint32_t    nsmps = CS_KSMPS;
     uint32_t    early = nsmps-p->h.insdshead->ksmps_no_end;
 
     CSOUND_SPOUT_SPINLOCK
     val = *p->a;
-    for (n=offset; n<early; n++)
-      ans[n] -= val;
+    if (LIKELY(early > offset))
+      aops_simd->ak[AOPS_SUB](&ans[offset], &ans[offset], &val, early-offset);
     CSOUND_SPOUT_SPINUNLOCK
     return OK;
 }
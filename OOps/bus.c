@@ -333,6 +333,8 @@ static int32_t delete_channel_db(CSOUND *csound, void *p)
 
     cs_hash_table_mfree_complete(csound, csound->chn_db);
     csound->chn_db = NULL;
+    /* the index pages go with the memory chain */
+    csound->chn_index = NULL;
     return 0;
 }
 
@@ -344,6 +346,76 @@ static inline CHNENTRY *find_channel(CSOUND *csound, const char *name)
     return NULL;
 }
 
+/* Control channels are numbered as they are created, so that
+   the host can hold a handle to the entry itself and poll a
+   bitmap of the channels written by the orchestra.  Both the
+   entry table and the bitmap are kept in fixed pages which are
+   never moved, so readers on other threads need no lock.
+*/
+#define CHN_INDEX_PAGE   4096        /* channels per page */
+#define CHN_INDEX_PAGES  256
+
+typedef struct {
+    volatile int32_t  count;
+    CHNENTRY          **entry[CHN_INDEX_PAGES];
+    uint64_t          *changed[CHN_INDEX_PAGES];
+} CHN_INDEX;
+
+#if defined(MSVC)
+#  define CHN_BITS_OR(var, val)   InterlockedOr64((LONG64 *) &(var), (val))
+#  define CHN_BITS_AND(var, val)  InterlockedAnd64((LONG64 *) &(var), (val))
+#  define CHN_BITS_GET(var)       InterlockedOr64((LONG64 *) &(var), 0)
+#elif defined(HAVE_ATOMIC_BUILTIN)
+#  define CHN_BITS_OR(var, val)   __atomic_fetch_or(&(var), (val), __ATOMIC_RELEASE)
+#  define CHN_BITS_AND(var, val)  __atomic_fetch_and(&(var), (val), __ATOMIC_ACQ_REL)
+#  define CHN_BITS_GET(var)       __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#else
+#  define CHN_BITS_OR(var, val)   ((var) |= (val))
+#  define CHN_BITS_AND(var, val)  ((var) &= (val))
+#  define CHN_BITS_GET(var)       (var)
+#endif
+
+static int32_t chn_index_add(CSOUND *csound, CHNENTRY *pp)
+{
+    CHN_INDEX *t = (CHN_INDEX *) csound->chn_index;
+    int32_t   n, page;
+
+    if (t == NULL) {
+      t = (CHN_INDEX *) csound->Calloc(csound, sizeof(CHN_INDEX));
+      csound->chn_index = (void *) t;
+    }
+    n = t->count;
+    page = n / CHN_INDEX_PAGE;
+    if (UNLIKELY(page >= CHN_INDEX_PAGES))
+      return -1;                        /* not tracked */
+    if (t->entry[page] == NULL) {
+      t->changed[page] = (uint64_t *)
+        csound->Calloc(csound, CHN_INDEX_PAGE / 8);
+      t->entry[page] = (CHNENTRY **)
+        csound->Calloc(csound, CHN_INDEX_PAGE * sizeof(CHNENTRY *));
+    }
+    t->entry[page][n % CHN_INDEX_PAGE] = pp;
+    ATOMIC_SET(t->count, n + 1);
+    return n;
+}
+
+/* called by the k-rate and i-rate chnset when the value changes */
+static inline void chn_mark_changed(CSOUND *csound, int32_t index)
+{
+    CHN_INDEX *t = (CHN_INDEX *) csound->chn_index;
+    if (index >= 0) {
+      uint64_t *w = &t->changed[index / CHN_INDEX_PAGE]
+                               [(index % CHN_INDEX_PAGE) >> 6];
+      CHN_BITS_OR(*w, (uint64_t) 1 << (index & 63));
+    }
+}
+
+static inline int32_t channel_index(CSOUND *csound, const char *name)
+{
+    CHNENTRY *pp = find_channel(csound, name);
+    return pp != NULL ? pp->index : -1;
+}
+
 void set_channel_data_ptr(CSOUND *csound,
                           const char *name, void *ptr, int32_t newSize)
 {
@@ -412,6 +484,10 @@ static CS_NOINLINE int32_t create_new_channel(CSOUND *csound, const char *name,
     pp->hints.behav = 0;
     pp->type = type;
     strcpy(&(pp->name[0]), name);
+    if ((type & CSOUND_CHANNEL_TYPE_MASK) == CSOUND_CONTROL_CHANNEL)
+      pp->index = chn_index_add(csound, pp);
+    else
+      pp->index = -1;
 
     cs_hash_table_put(csound, csound->chn_db, (char*)name, pp);
 
@@ -473,6 +549,118 @@ PUBLIC int32_t *csoundGetChannelLock(CSOUND *csound,
     else return NULL;
 }
 
+PUBLIC CS_CHANNEL_HANDLE csoundGetChannelHandle(CSOUND *csound,
+                                                const char *name, int32_t type)
+{
+    MYFLT     *p;
+
+    if (UNLIKELY(name == NULL || name[0] == '\0'))
+        return NULL;
+    if (csoundGetChannelPtr(csound, &p, name, type) != CSOUND_SUCCESS)
+        return NULL;
+    return (CS_CHANNEL_HANDLE) find_channel(csound, name);
+}
+
+PUBLIC const char *csoundGetChannelHandleName(CS_CHANNEL_HANDLE h)
+{
+    return h != NULL ? &(h->name[0]) : NULL;
+}
+
+PUBLIC int32_t csoundGetControlChannels(CSOUND *csound,
+                                        const CS_CHANNEL_HANDLE *h,
+                                        MYFLT *values, int32_t n)
+{
+    int32_t   i, res = CSOUND_SUCCESS;
+    union {
+      MYFLT d;
+      MYFLT_INT_TYPE i;
+    } x;
+    IGN(csound);
+    for (i = 0; i < n; i++) {
+      CHNENTRY *pp = h[i];
+      if (UNLIKELY(pp == NULL || (pp->type & CSOUND_CHANNEL_TYPE_MASK)
+                   != CSOUND_CONTROL_CHANNEL)) {
+        values[i] = FL(0.0);
+        res = CSOUND_ERROR;
+        continue;
+      }
+#if defined(MSVC)
+      x.i = InterlockedExchangeAdd64((MYFLT_INT_TYPE *) pp->data, 0);
+#elif defined(HAVE_ATOMIC_BUILTIN)
+      x.i = __atomic_load_n((MYFLT_INT_TYPE *) pp->data, __ATOMIC_SEQ_CST);
+#else
+      csoundSpinLock(&pp->lock);
+      x.d = *(pp->data);
+      csoundSpinUnLock(&pp->lock);
+#endif
+      values[i] = x.d;
+    }
+    return res;
+}
+
+PUBLIC int32_t csoundSetControlChannels(CSOUND *csound,
+                                        const CS_CHANNEL_HANDLE *h,
+                                        const MYFLT *values, int32_t n)
+{
+    int32_t   i, res = CSOUND_SUCCESS;
+    union {
+      MYFLT d;
+      MYFLT_INT_TYPE i;
+    } x;
+    IGN(csound);
+    for (i = 0; i < n; i++) {
+      CHNENTRY *pp = h[i];
+      if (UNLIKELY(pp == NULL || (pp->type & CSOUND_CHANNEL_TYPE_MASK)
+                   != CSOUND_CONTROL_CHANNEL)) {
+        res = CSOUND_ERROR;
+        continue;
+      }
+      x.d = values[i];
+#if defined(MSVC)
+      InterlockedExchange64((MYFLT_INT_TYPE *) pp->data, x.i);
+#elif defined(HAVE_ATOMIC_BUILTIN)
+      __atomic_store_n((MYFLT_INT_TYPE *) pp->data, x.i, __ATOMIC_SEQ_CST);
+#else
+      csoundSpinLock(&pp->lock);
+      *(pp->data) = x.d;
+      csoundSpinUnLock(&pp->lock);
+#endif
+    }
+    return res;
+}
+
+PUBLIC int32_t csoundGetChangedControlChannels(CSOUND *csound,
+                                               CS_CHANNEL_HANDLE *h,
+                                               int32_t max)
+{
+    CHN_INDEX *t = (CHN_INDEX *) csound->chn_index;
+    int32_t   count, page, w, found = 0;
+
+    if (t == NULL || max <= 0)
+      return 0;
+    count = ATOMIC_GET(t->count);
+    for (page = 0; page * CHN_INDEX_PAGE < count; page++) {
+      int32_t nw = (count - page * CHN_INDEX_PAGE + 63) >> 6;
+      if (nw > CHN_INDEX_PAGE / 64) nw = CHN_INDEX_PAGE / 64;
+      for (w = 0; w < nw; w++) {
+        uint64_t bits = CHN_BITS_GET(t->changed[page][w]), taken = 0;
+        int32_t  b;
+        for (b = 0; bits != 0 && found < max; b++, bits >>= 1) {
+          if (bits & 1) {
+            h[found++] = t->entry[page][(w << 6) + b];
+            taken |= (uint64_t) 1 << b;
+          }
+        }
+        /* bits set after the read are kept for the next call */
+        if (taken)
+          CHN_BITS_AND(t->changed[page][w], ~taken);
+        if (found == max)
+          return found;
+      }
+    }
+    return found;
+}
+
 static int32_t cmp_func(const void *p1, const void *p2)
 {
     return strcmp(((controlChannelInfo_t*) p1)->name,
@@ -1253,6 +1441,7 @@ static int32_t chnset_opcode_perf_k(CSOUND *csound, CHNGET *p)
                                           CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
         if(err == 0) {
             p->lock = (spin_lock_t *) csoundGetChannelLock(csound, (char*) p->iname->data);
+            p->index = channel_index(csound, (char*) p->iname->data);
             strNcpy(p->chname, p->iname->data, MAX_CHAN_NAME);
         }
         else
@@ -1265,17 +1454,23 @@ static int32_t chnset_opcode_perf_k(CSOUND *csound, CHNGET *p)
       MYFLT_INT_TYPE i;
     } x;
     x.d = *(p->arg);
-    InterlockedExchange64((MYFLT_INT_TYPE *) p->fp, x.i);
+    if (InterlockedExchange64((MYFLT_INT_TYPE *) p->fp, x.i) != x.i)
+      chn_mark_changed(csound, p->index);
 #elif defined(HAVE_ATOMIC_BUILTIN)
     union {
         MYFLT d;
         MYFLT_INT_TYPE i;
     } x;
     x.d = *(p->arg);
-    __atomic_store_n((MYFLT_INT_TYPE *)(p->fp),x.i, __ATOMIC_SEQ_CST);
+    if (__atomic_exchange_n((MYFLT_INT_TYPE *)(p->fp),x.i, __ATOMIC_SEQ_CST)
+        != x.i)
+      chn_mark_changed(csound, p->index);
 #else
     csoundSpinLock(p->lock);
-    *(p->fp) = *(p->arg);
+    if (*(p->fp) != *(p->arg)) {
+      *(p->fp) = *(p->arg);
+      chn_mark_changed(csound, p->index);
+    }
     csoundSpinUnLock(p->lock);
 #endif
     return OK;
@@ -1355,6 +1550,7 @@ int32_t chnset_opcode_init_i(CSOUND *csound, CHNGET *p)
                               CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (UNLIKELY(err))
         return print_chn_err(p, err);
+    p->index = channel_index(csound, (char*) p->iname->data);
 
 
 #if defined(MSVC)
@@ -1363,21 +1559,27 @@ int32_t chnset_opcode_init_i(CSOUND *csound, CHNGET *p)
       MYFLT_INT_TYPE i;
     } x;
     x.d = *(p->arg);
-    InterlockedExchange64((MYFLT_INT_TYPE *) p->fp, x.i);
+    if (InterlockedExchange64((MYFLT_INT_TYPE *) p->fp, x.i) != x.i)
+      chn_mark_changed(csound, p->index);
 #elif defined(HAVE_ATOMIC_BUILTIN)
     union {
         MYFLT d;
         MYFLT_INT_TYPE i;
     } x;
     x.d = *(p->arg);
-    __atomic_store_n((MYFLT_INT_TYPE *)(p->fp),x.i, __ATOMIC_SEQ_CST);
+    if (__atomic_exchange_n((MYFLT_INT_TYPE *)(p->fp),x.i, __ATOMIC_SEQ_CST)
+        != x.i)
+      chn_mark_changed(csound, p->index);
 #else
     {
       spin_lock_t *lock;       /* Need lock for the channel */
       p->lock = lock =  (spin_lock_t *)
         csoundGetChannelLock(csound, (char*) p->iname->data);
       csoundSpinLock(lock);
-      *(p->fp) = *(p->arg);
+      if (*(p->fp) != *(p->arg)) {
+        *(p->fp) = *(p->arg);
+        chn_mark_changed(csound, p->index);
+      }
       csoundSpinUnLock(lock);
     }
 #endif
@@ -1390,10 +1592,12 @@ int32_t chnset_opcode_init_k(CSOUND* csound, CHNGET* p)
 {
     int32_t err;
 
+    p->index = -1;
     err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
                               CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (LIKELY(!err)) {
         p->lock = (spin_lock_t*) csoundGetChannelLock(csound, (char*) p->iname->data);
+        p->index = channel_index(csound, (char*) p->iname->data);
     }
 
     p->h.opadr = (SUBR) chnset_opcode_perf_k;
@@ -27,12 +27,410 @@
 #include <math.h>
 #include <inttypes.h>
 
-typedef struct DISKIN_INST_ {
-  CSOUND *csound;
-  DISKIN2 *diskin;
-  struct DISKIN_INST_ *nxt;
-} DISKIN_INST;
+/* Asynchronous streaming (diskin2 with --realtime and iforceSync == 0)
+
+   The opcode still resamples on the performance thread from its two
+   buffers of bufSize frames, as in synchronous mode, so a kpitch change
+   is heard at once; only the file reads move off that thread.  Each
+   stream keeps a cache of source blocks (bufSize frames starting at a
+   multiple of bufSize) holding about csoundSetDiskinReadAhead() seconds
+   of the file, DISKIN2_READAHEAD by default.  When diskin2 moves on to
+   a new block it copies it from the cache, notes where it is and which
+   way it plays, and queues the stream for a small pool of IO threads.
+   They read the blocks that come next into the cache, so one slow file
+   only holds up the thread that serves it.  A block that is not there
+   in time is played as silence and counts an underrun; hosts can read
+   the counters with csoundGetDiskinStreamStats().
+
+   The IO thread rewrites a cache slot under a sequence count that is
+   odd while it writes, so the performance thread copies blocks without
+   a lock and checks afterwards that the slot did not change.  Closing a
+   stream hands it to the IO threads together with its file, which they
+   may still be reading; the threads run until the instance is reset. */
+
+#define DISKIN2_READAHEAD   0.5         /* seconds */
+#define DISKIN2_IO_THREADS  4
+
+struct DISKIN_IO_;
+
+typedef struct {
+  volatile long seq;                    /* odd while being written */
+  volatile long pos;                    /* first frame, -1 if empty */
+  MYFLT   *data;
+} DISKIN_BLOCK;
+
+typedef struct DISKIN_STREAM_ {
+  CSOUND  *csound;
+  struct DISKIN_IO_ *io;
+  SNDFILE *sf;
+  void    *fd;                          /* file to close with the stream */
+  int32_t chans;
+  int32_t block;                        /* frames per block, power of two */
+  int32_t fileLength;                   /* in frames */
+  int     wrap;
+  int     nblocks;
+  DISKIN_BLOCK *blocks;
+  long    *plan;                        /* blocks wanted, nearest first */
+  volatile long want;                   /* block being played */
+  volatile long dir;                    /* 1 forwards, -1 backwards */
+  volatile long queued;                 /* queued or being refilled */
+  volatile long closing;
+  uint64_t underruns;
+  uint64_t refills;
+  char    name[128];
+  struct DISKIN_STREAM_ *nxt;           /* all open streams */
+  struct DISKIN_STREAM_ *qnxt;          /* refill queue */
+} DISKIN_STREAM;
+
+typedef struct DISKIN_IO_ {
+  void    *lock;
+  void    *cond;
+  DISKIN_STREAM *streams;
+  DISKIN_STREAM *qhead, *qtail;
+  void    *threads[DISKIN2_IO_THREADS];
+  int     nthreads;
+  volatile long running;
+  double  readahead;
+} DISKIN_IO;
+
+/* start of the block after (dir 1) or before (dir -1) the one at pos,
+   -1 past either end of the file unless it wraps */
+static long diskin_block_step(DISKIN_STREAM *s, long pos, long dir)
+{
+    pos += dir * s->block;
+    if (pos >= s->fileLength)
+      return (s->wrap ? 0 : -1);
+    if (pos < 0)
+      return (s->wrap ? ((s->fileLength - 1) & ~((long) s->block - 1)) : -1);
+    return pos;
+}
+
+static int diskin_block_find(DISKIN_STREAM *s, long pos)
+{
+    int i;
+    for (i = 0; i < s->nblocks; i++)
+      if (ATOMIC_GET(s->blocks[i].pos) == pos) return i;
+    return -1;
+}
+
+/* reads the block at pos into slot b, on the refilling thread */
+static void diskin_block_read(DISKIN_STREAM *s, DISKIN_BLOCK *b, long pos)
+{
+    long n = s->fileLength - pos, i = 0;
+
+    ATOMIC_INCR(b->seq);
+    ATOMIC_SET(b->pos, pos);
+    if (n > s->block) n = s->block;
+    n *= s->chans;
+    if (sf_seek(s->sf, (sf_count_t) pos, SEEK_SET) >= 0)
+      i = (long) sf_read_MYFLT(s->sf, b->data, (sf_count_t) n);
+    if (UNLIKELY(i < 0)) i = 0;
+    memset(&b->data[i], 0,
+           sizeof(MYFLT) * ((long) s->block * s->chans - i));
+    ATOMIC_INCR(b->seq);
+    s->refills++;
+}
+
+/* reads the blocks from the one being played onwards, in the direction
+   it plays, until the cache holds all it can; returns the block it
+   read ahead of, or -2 if it was stopped */
+static long diskin_stream_refill(DISKIN_STREAM *s)
+{
+    for (;;) {
+      long  want = ATOMIC_GET(s->want), dir = ATOMIC_GET(s->dir), pos;
+      long  last = (s->fileLength - 1) & ~((long) s->block - 1);
+      int   i, j, k, n = 0;
+
+      if (!ATOMIC_GET(s->io->running) || ATOMIC_GET(s->closing))
+        return -2;
+      pos = want;
+      if (pos < 0 || pos >= s->fileLength)  /* before or after the file */
+        pos = ((pos < 0) == (dir > 0) && s->fileLength > 0 ?
+               (dir > 0 ? 0 : last) : -1);
+      while (n < s->nblocks && pos >= 0) {
+        s->plan[n++] = pos;
+        if ((pos = diskin_block_step(s, pos, dir)) == s->plan[0])
+          break;                        /* all of a short file */
+      }
+      for (k = 0; k < n && diskin_block_find(s, s->plan[k]) >= 0; k++)
+        ;
+      if (k == n)
+        return want;
+      /* a slot that does not hold one of the blocks wanted */
+      for (i = 0; i < s->nblocks; i++) {
+        long p = ATOMIC_GET(s->blocks[i].pos);
+        for (j = 0; p >= 0 && j < n && s->plan[j] != p; j++)
+          ;
+        if (p < 0 || j == n) break;
+      }
+      if (UNLIKELY(i == s->nblocks))
+        return want;
+      diskin_block_read(s, &s->blocks[i], s->plan[k]);
+    }
+}
+
+/* called with io->lock held */
+static void diskin_stream_enqueue(DISKIN_IO *io, DISKIN_STREAM *s)
+{
+    ATOMIC_SET(s->queued, 1);
+    s->qnxt = NULL;
+    if (io->qtail != NULL) io->qtail->qnxt = s;
+    else io->qhead = s;
+    io->qtail = s;
+    csoundCondSignal(io->cond);
+}
 
+/* called with io->lock held */
+static void diskin_stream_unlink(DISKIN_IO *io, DISKIN_STREAM *s)
+{
+    DISKIN_STREAM **pp;
+    for (pp = &io->streams; *pp != NULL; pp = &(*pp)->nxt)
+      if (*pp == s) { *pp = s->nxt; break; }
+}
+
+/* frees a closed stream and closes its file */
+static void diskin_stream_free(CSOUND *csound, DISKIN_STREAM *s)
+{
+    if (s->fd != NULL)
+      csound->FileClose(csound, s->fd);
+    csound->Free(csound, s->blocks[0].data);
+    csound->Free(csound, s->blocks);
+    csound->Free(csound, s->plan);
+    csound->Free(csound, s);
+}
+
+static uintptr_t diskin_io_thread(void *data)
+{
+    DISKIN_IO *io = (DISKIN_IO *) data;
+    DISKIN_STREAM *s;
+    long      done;
+
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    csoundLockMutex(io->lock);
+    while (ATOMIC_GET(io->running)) {
+      if ((s = io->qhead) == NULL) {
+        csoundCondWait(io->cond, io->lock);
+        continue;
+      }
+      if ((io->qhead = s->qnxt) == NULL) io->qtail = NULL;
+      if (ATOMIC_GET(s->closing)) {
+        diskin_stream_unlink(io, s);
+        csoundUnlockMutex(io->lock);
+        diskin_stream_free(s->csound, s);
+        csoundLockMutex(io->lock);
+        continue;
+      }
+      csoundUnlockMutex(io->lock);
+      done = diskin_stream_refill(s);
+      csoundLockMutex(io->lock);
+      /* the stream moved on meanwhile, or was closed: go round again */
+      if (ATOMIC_GET(s->closing) || ATOMIC_GET(s->want) != done)
+        diskin_stream_enqueue(io, s);
+      else
+        ATOMIC_SET(s->queued, 0);
+    }
+    csoundUnlockMutex(io->lock);
+    return 0;
+}
+
+/* asks the IO threads to read ahead; never blocks the caller */
+static void diskin_stream_request(DISKIN_STREAM *s)
+{
+    DISKIN_IO *io = s->io;
+
+    if (ATOMIC_GET(s->queued)) return;
+    if (io->nthreads == 0) {          /* no threads: refill inline */
+      diskin_stream_refill(s);
+      return;
+    }
+    if (csoundLockMutexNoWait(io->lock) != 0)
+      return;                         /* contended, try at the next block */
+    if (!ATOMIC_GET(s->queued))
+      diskin_stream_enqueue(io, s);
+    csoundUnlockMutex(io->lock);
+}
+
+/* copies the block starting at frame pos into buf, or silence if it has
+   not been read ahead, then asks for the blocks after it in direction
+   dir; on the performance thread */
+static void diskin_stream_get(DISKIN_STREAM *s, long pos, long dir,
+                              MYFLT *buf)
+{
+    long n = (long) s->block * s->chans;
+    int  i, found = 0;
+
+    ATOMIC_SET(s->want, pos);
+    ATOMIC_SET(s->dir, dir);
+    if (pos < 0 || pos >= s->fileLength) {
+      memset(buf, 0, n * sizeof(MYFLT));
+      found = 1;
+    }
+    for (i = 0; i < s->nblocks && !found; i++) {
+      DISKIN_BLOCK *b = &s->blocks[i];
+      long seq = ATOMIC_GET(b->seq);
+      if ((seq & 1) || ATOMIC_GET(b->pos) != pos) continue;
+      memcpy(buf, b->data, n * sizeof(MYFLT));
+      found = (ATOMIC_GET(b->seq) == seq);
+    }
+    if (UNLIKELY(!found)) {
+      memset(buf, 0, n * sizeof(MYFLT));
+      s->underruns++;
+    }
+    diskin_stream_request(s);
+}
+
+/* joins the IO threads before their lock and condition variable go,
+   then frees the streams they were left to close */
+static int32_t diskin_io_reset(CSOUND *csound, void *data)
+{
+    DISKIN_IO     *io = (DISKIN_IO *) data;
+    DISKIN_STREAM *s;
+    int           i;
+
+    csoundLockMutex(io->lock);
+    ATOMIC_SET(io->running, 0);
+    for (i = 0; i < io->nthreads; i++)
+      csoundCondSignal(io->cond);
+    csoundUnlockMutex(io->lock);
+    for (i = 0; i < io->nthreads; i++)
+      csound->JoinThread(io->threads[i]);
+    io->nthreads = 0;
+    while ((s = io->streams) != NULL) {
+      io->streams = s->nxt;
+      if (s->closing)
+        diskin_stream_free(csound, s);
+    }
+    csoundDestroyCondVar(io->cond);
+    csoundDestroyMutex(io->lock);
+    return OK;
+}
+
+static DISKIN_IO *diskin_io_get(CSOUND *csound)
+{
+    DISKIN_IO *io = (DISKIN_IO *) csound->QueryGlobalVariable(csound,
+                                                              "DISKIN_IO");
+    if (io == NULL) {
+      if (UNLIKELY(csound->CreateGlobalVariable(csound, "DISKIN_IO",
+                                                sizeof(DISKIN_IO)) != 0))
+        return NULL;
+      io = (DISKIN_IO *) csound->QueryGlobalVariable(csound, "DISKIN_IO");
+      io->lock = csoundCreateMutex(0);
+      io->cond = csoundCreateCondVar();
+      io->readahead = DISKIN2_READAHEAD;
+      csound->RegisterResetCallback(csound, io, diskin_io_reset);
+    }
+    return io;
+}
+
+/* opens a stream on sf, in blocks of block frames, and reads ahead of
+   frame pos before returning; sr is the file's sample rate */
+static DISKIN_STREAM *diskin_stream_open(CSOUND *csound, SNDFILE *sf,
+                                         int32_t chans, int32_t block,
+                                         int32_t fileLength, int wrap,
+                                         double sr, long pos,
+                                         const char *name)
+{
+    DISKIN_IO     *io = diskin_io_get(csound);
+    DISKIN_STREAM *s;
+    MYFLT         *data;
+    int           i, nblocks;
+
+    if (UNLIKELY(io == NULL)) return NULL;
+    nblocks = (int) (io->readahead * sr / block) + 2;
+    if (nblocks < 4) nblocks = 4;
+    s = (DISKIN_STREAM *) csound->Calloc(csound, sizeof(DISKIN_STREAM));
+    s->blocks = (DISKIN_BLOCK *) csound->Calloc(csound,
+                                               nblocks * sizeof(DISKIN_BLOCK));
+    s->plan = (long *) csound->Calloc(csound, nblocks * sizeof(long));
+    data = (MYFLT *) csound->Calloc(csound, (size_t) nblocks * block * chans
+                                            * sizeof(MYFLT));
+    for (i = 0; i < nblocks; i++) {
+      s->blocks[i].pos = -1;
+      s->blocks[i].data = data + (size_t) i * block * chans;
+    }
+    s->csound = csound;
+    s->io = io;
+    s->sf = sf;
+    s->chans = chans;
+    s->block = block;
+    s->fileLength = fileLength;
+    s->wrap = wrap;
+    s->nblocks = nblocks;
+    s->want = pos & ~((long) block - 1);
+    s->dir = 1;
+    strNcpy(s->name, name != NULL ? name : "", sizeof(s->name));
+    /* prime the cache before the first k-period */
+    ATOMIC_SET(io->running, 1);
+    diskin_stream_refill(s);
+
+    csoundLockMutex(io->lock);
+    s->nxt = io->streams;
+    io->streams = s;
+#ifndef __EMSCRIPTEN__
+    if (io->nthreads == 0) {
+      for (i = 0; i < DISKIN2_IO_THREADS; i++)
+        if ((io->threads[i] = csound->CreateThread(diskin_io_thread,
+                                                   io)) == NULL)
+          break;
+      io->nthreads = i;
+    }
+#endif
+    csoundUnlockMutex(io->lock);
+    return s;
+}
+
+/* hands s to the IO threads, which close it and fd, the file it
+   reads, once they are done with it; never waits for them */
+static void diskin_stream_close(CSOUND *csound, DISKIN_STREAM *s, void *fd)
+{
+    DISKIN_IO *io = s->io;
+
+    s->fd = fd;
+    csoundLockMutex(io->lock);
+    ATOMIC_SET(s->closing, 1);
+    if (io->nthreads == 0) {
+      diskin_stream_unlink(io, s);
+      csoundUnlockMutex(io->lock);
+      diskin_stream_free(csound, s);
+      return;
+    }
+    if (!ATOMIC_GET(s->queued))
+      diskin_stream_enqueue(io, s);
+    csoundUnlockMutex(io->lock);
+}
+
+PUBLIC void csoundSetDiskinReadAhead(CSOUND *csound, double seconds)
+{
+    DISKIN_IO *io = diskin_io_get(csound);
+    if (io != NULL && seconds > 0.0)
+      io->readahead = seconds;
+}
+
+PUBLIC int csoundGetDiskinStreamStats(CSOUND *csound,
+                                      CS_DISKIN_STREAM_STATS *stats, int max)
+{
+    DISKIN_IO     *io;
+    DISKIN_STREAM *s;
+    int           i, n = 0;
+
+    io = (DISKIN_IO *) csound->QueryGlobalVariable(csound, "DISKIN_IO");
+    if (io == NULL || stats == NULL) return 0;
+    csoundLockMutex(io->lock);
+    for (s = io->streams; s != NULL && n < max; s = s->nxt) {
+      if (ATOMIC_GET(s->closing)) continue;
+      strNcpy(stats[n].name, s->name, sizeof(stats[n].name));
+      stats[n].underruns = s->underruns;
+      stats[n].refills = s->refills;
+      stats[n].buffered = 0;
+      for (i = 0; i < s->nblocks; i++)
+        if (ATOMIC_GET(s->blocks[i].pos) >= 0)
+          stats[n].buffered += (uint32_t) (s->block * s->chans);
+      stats[n].capacity = (uint32_t) (s->nblocks * s->block * s->chans);
+      n++;
+    }
+    csoundUnlockMutex(io->lock);
+    return n;
+}
 
 static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
                                             DISKIN2 *p, int32_t bufReadPos)
@@ -60,6 +458,11 @@ static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
     /* calculate new buffer frame start position */
     p->bufStartPos = p->bufStartPos + (int32_t) bufReadPos;
     p->bufStartPos &= (~((int32_t) (p->bufSize - 1)));
+    if (p->stream != NULL) {  /* read ahead by the IO threads */
+      diskin_stream_get((DISKIN_STREAM *) p->stream, p->bufStartPos,
+                        p->pos_frac_inc < 0 ? -1 : 1, p->buf);
+      return;
+    }
     i = 0;
     if (p->bufStartPos >= 0L) {
       /* number of sample frames to read */
@@ -90,6 +493,7 @@ static inline void diskin2_get_sample(CSOUND *csound,
                                       MYFLT scl)
 {
     int32_t  bufPos, i;
+    MYFLT    **aOut = p->aOut;
 
     if (p->wrapMode) {
       if (UNLIKELY(fPos >= p->fileLength)){
@@ -107,46 +511,21 @@ static inline void diskin2_get_sample(CSOUND *csound,
       bufPos = (int32_t)(fPos - p->bufStartPos);
     }
 
-    if (p->aOut_buf == NULL){
-      MYFLT **aOut = p->aOut;
-      /* copy all channels from buffer */
-      if (p->nChannels == 1) {
-        aOut[0][n] +=  scl * p->buf[bufPos];
-      }
-      else if (p->nChannels == 2) {
-        bufPos += bufPos;
-        aOut[0][n] += scl * p->buf[bufPos];
-        aOut[1][n] += scl * p->buf[bufPos + 1];
-      }
-      else {
-        bufPos *= p->nChannels;
-        i = 0;
-        /* p->aOut[i++][n] += scl * p->buf[bufPos++]; */
-        /* p->aOut[i++][n] += scl * p->buf[bufPos++]; */
-        do {
-          aOut[i++][n] += scl * p->buf[bufPos++];
-        } while (i < p->nChannels);
-      }
-    } else{
-      MYFLT *aOut = p->aOut_buf;
-      int32_t chans = p->nChannels;
-      /* copy all channels from buffer */
-      if (chans == 1) {
-        aOut[n] += scl * p->buf[bufPos];
-      }
-      else if (chans == 2) {
-        bufPos += bufPos;
-        aOut[n*2] +=  scl * p->buf[bufPos];
-        aOut[n*2+1] += scl * p->buf[bufPos+1];
-      }
-      else {
-        bufPos *= chans;//p->nChannels;
-        i = 0;
-        do {
-          aOut[n*chans+i] += scl * p->buf[bufPos++];
-        } while (++i < chans);
-      }
-
+    /* copy all channels from buffer */
+    if (p->nChannels == 1) {
+      aOut[0][n] +=  scl * p->buf[bufPos];
+    }
+    else if (p->nChannels == 2) {
+      bufPos += bufPos;
+      aOut[0][n] += scl * p->buf[bufPos];
+      aOut[1][n] += scl * p->buf[bufPos + 1];
+    }
+    else {
+      bufPos *= p->nChannels;
+      i = 0;
+      do {
+        aOut[i++][n] += scl * p->buf[bufPos++];
+      } while (i < p->nChannels);
     }
 }
 
@@ -315,6 +694,12 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
       /* skip initialisation if requested */
       if (p->SkipInit != FL(0.0))
         return OK;
+      if (p->stream != NULL) {
+        /* the IO threads may still be reading it: they close the file */
+        diskin_stream_close(csound, (DISKIN_STREAM *) p->stream, p->fdch.fd);
+        p->stream = NULL;
+        p->fdch.fd = NULL;
+      }
       csound_fd_close(csound, &(p->fdch));
     }
     /* set default format parameters */
@@ -417,58 +802,15 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
 
     memset(p->buf, 0, n*sizeof(MYFLT));
 
-    // create circular buffer, on fail set mode to synchronous
-    if (csound->oparms->realtime==1 && p->fforceSync==0 &&
-        (p->cb = csound->CreateCircularBuffer(csound,
-                                              p->bufSize*p->nChannels*2,
-                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-#ifndef __EMSCRIPTEN__
-      int32_t *start;
-#endif
-      // allocate buffer
-      p->aOut_bufsize =  ((unsigned int)p->bufSize) < CS_KSMPS ?
-        ((MYFLT)CS_KSMPS) : ((MYFLT)p->bufSize);
-      n = p->aOut_bufsize*sizeof(MYFLT)*p->nChannels;
-      if (n != (int32_t)p->auxData2.size)
-        csound->AuxAlloc(csound, (int32_t) n, &(p->auxData2));
-      p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
-      memset(p->aOut_buf, 0, n);
-      top = (DISKIN_INST **)csound->QueryGlobalVariable(csound, "DISKIN_INST");
-#ifndef __EMSCRIPTEN__
-      if (top == NULL){
-        csound->CreateGlobalVariable(csound, "DISKIN_INST", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound, "DISKIN_INST");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound, "DISKIN_PTHREAD", sizeof(void**));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START", sizeof(int32_t));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt = (DISKIN_INST *) csound->Calloc(csound,
-                                                        sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin = p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if ( *(start = csound->QueryGlobalVariable(csound,
-                                                 "DISKIN_THREAD_START")) == 0) {
-        uintptr_t diskin_io_thread(void *p);
-        void **thread = csound->QueryGlobalVariable(csound, "DISKIN_PTHREAD");
-        *thread = csound->CreateThread(diskin_io_thread, *top);
-        *start = 1;
-      }
-#endif
+    // open a read-ahead stream, on fail set mode to synchronous
+    p->stream = NULL;
+    if (csound->oparms->realtime==1 && p->fforceSync==0)
+      p->stream = diskin_stream_open(csound, p->sf, p->nChannels, p->bufSize,
+                                     p->fileLength, p->wrapMode,
+                                     csound->esr * p->warpScale,
+                                     (long) (p->pos_frac >> POS_FRAC_SHIFT),
+                                     csound->GetFileName(fd));
+    if (p->stream != NULL) {
       csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
       p->async = 1;
 
@@ -485,8 +827,6 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
       }
     }
     else {
-      p->aOut_buf = NULL;
-      p->aOut_bufsize = 0;
       p->async = 0;
       /* print file information */
       if (UNLIKELY((csound->oparms_.msglevel & 7) == 7)) {
@@ -508,36 +848,13 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
 
 int32_t diskin2_async_deinit(CSOUND *csound,  void *p){
 
-    DISKIN_INST **top, *current, *prv;
-
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST")) == NULL) return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
-    }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int32_t *start; void **pt;
-
-      start = (int32_t *) csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      *start = 0;
-      pt = csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      csound->JoinThread(*pt);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST");
-    }
-#endif
-    csound->Free(csound, current);
-    csound->DestroyCircularBuffer(csound, ((DISKIN2 *)p)->cb);
+    DISKIN2 *pp = (DISKIN2 *) p;
 
+    if (pp->stream == NULL) return NOTOK;
+    /* runs before the note's files are closed: the stream takes its file */
+    diskin_stream_close(csound, (DISKIN_STREAM *) pp->stream, pp->fdch.fd);
+    pp->fdch.fd = NULL;
+    pp->stream = NULL;
     return OK;
 }
 
@@ -723,276 +1040,29 @@ int32_t diskin2_perf_synchronous(CSOUND *csound, DISKIN2 *p)
               ndx++;
               a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
               a1 = -(a1 * a1 / (MYFLT)d);
-              diskin2_get_sample(csound, p, ndx, nn, a1*a0);
-              d += 1.0;
-              ndx++;
-            } while (--i);
-          }
-        }
-        /* update file position */
-        diskin2_file_pos_inc(p, &ndx);
-      }
-    }
-    /* apply 0dBFS scale */
-    for (chn = 0; chn < p->nChannels; chn++)
-      for (nn = offset; nn < nsmps; nn++)
-        p->aOut[chn][nn] *= csound->e0dbfs;
-    return OK;
- file_error:
-    csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
-    return NOTOK;
-}
-
-
-int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p)
-{
-    /* nsmps is bufsize in frames */
-    int32_t nsmps = p->aOut_bufsize;// - p->h.insdshead->ksmps_offset;
-    int32_t i, nn;
-    int32_t chn, chans = p->nChannels;
-    double  d, frac_d, x, c, v, pidwarp_d;
-    MYFLT   frac, a0, a1, a2, a3, onedwarp, winFact;
-    int32_t ndx;
-    int32_t wsized2, warp;
-    MYFLT   *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
-
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
-    if (!p->initDone && !p->SkipInit) {
-      return csound->PerfError(csound, &(p->h),
-                               Str("diskin2: not initialised"));
-    }
-    if (*(p->kTranspose) != p->prv_kTranspose) {
-      double  f;
-      p->prv_kTranspose = *(p->kTranspose);
-      f = (double)p->prv_kTranspose * p->warpScale * (double)POS_FRAC_SCALE;
-#ifdef HAVE_C99
-      p->pos_frac_inc = (int64_t)llrint(f);
-#else
-      p->pos_frac_inc = (int64_t)(f + (f < 0.0 ? -0.5 : 0.5));
-#endif
-    }
-    /* clear outputs to zero first */
-    for (chn = 0; chn < chans; chn++)
-      for (nn = 0; nn < nsmps; nn++)
-        aOut[chn + nn*chans] = FL(0.0);
-    /* file read position */
-    ndx = (int32_t) (p->pos_frac >> POS_FRAC_SHIFT);
-    switch (p->winSize) {
-    case 1:                   /* ---- no interpolation ---- */
-      for (nn = 0; nn < nsmps; nn++) {
-        if (p->pos_frac & ((int64_t)POS_FRAC_SCALE >> 1))
-          ndx++;                      /* round to nearest sample */
-        diskin2_get_sample(csound, p, ndx, nn, FL(1.0));
-        /* update file position */
-        diskin2_file_pos_inc(p, &ndx);
-      }
-      break;
-    case 2:                   /* ---- linear interpolation ---- */
-      for (nn = 0; nn < nsmps; nn++) {
-        a1 = (MYFLT)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (FL(1.0) / (MYFLT)POS_FRAC_SCALE);
-        a0 = FL(1.0) - a1;
-        diskin2_get_sample(csound, p, ndx, nn, a0);
-        ndx++;
-        diskin2_get_sample(csound, p, ndx, nn, a1);
-        /* update file position */
-        diskin2_file_pos_inc(p, &ndx);
-      }
-      break;
-    case 4:                   /* ---- cubic interpolation ---- */
-      for (nn = 0; nn < nsmps; nn++) {
-        frac = (MYFLT)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (FL(1.0) / (MYFLT)POS_FRAC_SCALE);
-        a3 = frac * frac; a3 -= FL(1.0); a3 *= (FL(1.0) / FL(6.0));
-        a2 = frac; a2 += FL(1.0); a0 = (a2 *= FL(0.5)); a0 -= FL(1.0);
-        a1 = FL(3.0) * a3; a2 -= a1; a0 -= a3; a1 -= frac;
-        a0 *= frac; a1 *= frac; a2 *= frac; a3 *= frac; a1 += FL(1.0);
-        ndx--;                                /* sample -1 */
-        diskin2_get_sample(csound, p, ndx, nn, a0);
-        ndx++;                                /* sample 0 */
-        diskin2_get_sample(csound, p, ndx, nn, a1);
-        ndx++;                                /* sample +1 */
-        diskin2_get_sample(csound, p, ndx, nn, a2);
-        ndx++;                                /* sample +2 */
-        diskin2_get_sample(csound, p, ndx, nn, a3);
-        /* update file position */
-        diskin2_file_pos_inc(p, &ndx);
-      }
-      break;
-    default:                  /* ---- sinc interpolation ---- */
-      wsized2 = p->winSize >> 1;
-      nn = POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12);
-      if (p->pos_frac_inc > (int64_t) nn ||
-          p->pos_frac_inc < (int64_t) (-nn)) {
-        warp = 1;                     /* enable warp */
-        onedwarp = (p->pos_frac_inc >= (int64_t) 0 ?
-                    ((MYFLT)nn / (MYFLT)p->pos_frac_inc)
-                    : ((MYFLT)(-nn) / (MYFLT)p->pos_frac_inc));
-        pidwarp_d = PI * (double)onedwarp;
-        c = 2.0 * cos(pidwarp_d) - 2.0;
-        /* correct window for kwarp */
-        x = v = (double)wsized2; x *= x; x = 1.0 / x;
-        v *= (double)onedwarp; v -= (double)((int32_t)v) + 0.5; v *= 4.0 * v;
-        winFact = (MYFLT)(((double)p->winFact - x) * v + x);
-      }
-      else {
-        warp = 0;
-        onedwarp = FL(0.0);
-        pidwarp_d = c = 0.0;
-        winFact = p->winFact;
-      }
-      for (nn = 0; nn < nsmps; nn++) {
-        frac_d = (double)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (1.0 / (double)POS_FRAC_SCALE);
-        ndx += (int32_t)(1 - wsized2);
-        d = (double)(1 - wsized2) - frac_d;
-        if (warp) {                           /* ---- warp enabled ---- */
-          init_sine_gen((1.0 / PI), pidwarp_d, (pidwarp_d * d), c, &x, &v);
-          /* samples -(window size / 2 - 1) to -1 */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-          /* sample 0 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d < 0.00003)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* sample 1 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d > 0.99997)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* samples 2 to (window size / 2) */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-        }
-        else {                                /* ---- warp disabled ---- */
-          /* avoid division by zero */
-          if (frac_d < 0.00001 || frac_d > 0.99999) {
-            ndx += (int32_t) (wsized2 - (frac_d < 0.5 ? 1 : 0));
-            diskin2_get_sample(csound, p, ndx, nn, FL(1.0));
-          }
-          else {
-            a0 = (MYFLT)(sin(PI * frac_d) / PI);
-            i = wsized2;
-            do {
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = a0 * a1 * a1 / (MYFLT)d;
-              diskin2_get_sample(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = -(a0 * a1 * a1 / (MYFLT)d);
-              diskin2_get_sample(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-            } while (--i);
-          }
-        }
-        /* update file position */
-        diskin2_file_pos_inc(p, &ndx);
-      }
-    }
-    {
-      /* write to circular buffer */
-      int32_t lc, mc=0, nc=nsmps*p->nChannels;
-      int32_t *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc =  csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
-    }
-    return OK;
- file_error:
-    csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
-    return NOTOK;
-}
-
-
-int32_t diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
-{
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS;
-    MYFLT samp;
-    int32_t chn;
-    void *cb = p->cb;
-    int32_t chans = p->nChannels;
-
-    if (offset || early) {
-      for (chn = 0; chn < chans; chn++)
-        for (nn = 0; nn < nsmps; nn++)
-          p->aOut[chn][nn] = FL(0.0);
-      if (UNLIKELY(early)) nsmps -= early;
-    }
-
-    if (UNLIKELY(p->fdch.fd == NULL)) return NOTOK;
-    if (!p->initDone && !p->SkipInit){
-      return csound->PerfError(csound, &(p->h),
-                               Str("diskin2: not initialised"));
-    }
-    for (nn = offset; nn < nsmps; nn++){
-
-      for (chn = 0; chn < chans; chn++) {
-        //int32_t i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        p->aOut[chn][nn] = csound->e0dbfs*samp;
+              diskin2_get_sample(csound, p, ndx, nn, a1*a0);
+              d += 1.0;
+              ndx++;
+            } while (--i);
+          }
+        }
+        /* update file position */
+        diskin2_file_pos_inc(p, &ndx);
       }
     }
+    /* apply 0dBFS scale */
+    for (chn = 0; chn < p->nChannels; chn++)
+      for (nn = offset; nn < nsmps; nn++)
+        p->aOut[chn][nn] *= csound->e0dbfs;
     return OK;
-}
-
-
-uintptr_t diskin_io_thread(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int32_t wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int32_t *start =
-      current->csound->QueryGlobalVariable(current->csound,"DISKIN_THREAD_START");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read(current->csound, current->diskin);
-        current = current->nxt;
-      }
-    }
-    return 0;
+ file_error:
+    csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
+    return NOTOK;
 }
 
 
 int32_t diskin2_perf(CSOUND *csound, DISKIN2 *p) {
-    if (!p->async) return diskin2_perf_synchronous(csound, p);
-    else return diskin2_perf_asynchronous(csound, p);
+    return diskin2_perf_synchronous(csound, p);
 }
 
 
@@ -1183,6 +1253,11 @@ static CS_NOINLINE void diskin2_read_buffer_array(CSOUND *csound,
     /* calculate new buffer frame start position */
     p->bufStartPos = p->bufStartPos + (int32_t) bufReadPos;
     p->bufStartPos &= (~((int32_t) (p->bufSize - 1)));
+    if (p->stream != NULL) {  /* read ahead by the IO threads */
+      diskin_stream_get((DISKIN_STREAM *) p->stream, p->bufStartPos,
+                        p->pos_frac_inc < 0 ? -1 : 1, p->buf);
+      return;
+    }
     i = 0;
     if (p->bufStartPos >= 0L) {
       /* number of sample frames to read */
@@ -1269,289 +1344,33 @@ static inline void diskin2_get_sample_array(CSOUND *csound,
     }
 
     /* copy all channels from buffer */
-    if (p->aOut_buf == NULL){
-      if (p->nChannels == 1) {
-        aOut[n] +=  scl * p->buf[bufPos];
-      }
-      else if (p->nChannels == 2) {
-        bufPos += bufPos;
-        aOut[n] += scl * p->buf[bufPos];
-        aOut[n+ksmps] += scl * p->buf[bufPos + 1];
-      }
-      else {
-        bufPos *= p->nChannels;
-        i = 0;
-        do {
-          aOut[i*ksmps+n] += scl * p->buf[bufPos++];
-        } while (++i < p->nChannels);
-      }
-    } else{
-      MYFLT *aOut = p->aOut_buf;
-      int32_t chans = p->nChannels;
-      /* copy all channels from buffer */
-      if (chans == 1) {
-        aOut[n] += scl * p->buf[bufPos];
-      }
-      else if (chans == 2) {
-        bufPos += bufPos;
-        aOut[n*2] +=  scl * p->buf[bufPos];
-        aOut[n*2+1] += scl * p->buf[bufPos+1];
-      }
-      else {
-        bufPos *= chans;//p->nChannels;
-        i = 0;
-        do {
-          aOut[n*chans+i] += scl * p->buf[bufPos++];
-        } while (++i < chans);
-      }
-
+    if (p->nChannels == 1) {
+      aOut[n] +=  scl * p->buf[bufPos];
     }
-}
-
-int32_t diskin2_async_deinit_array(CSOUND *csound,  void *p){
-
-    DISKIN_INST **top, *current, *prv;
-
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY")) == NULL)
-      return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
+    else if (p->nChannels == 2) {
+      bufPos += bufPos;
+      aOut[n] += scl * p->buf[bufPos];
+      aOut[n+ksmps] += scl * p->buf[bufPos + 1];
     }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int32_t *start; void **pt;
-      start = (int32_t *) csound->QueryGlobalVariable(csound,
-                                                  "DISKIN_THREAD_START_ARRAY");
-      *start = 0;
-      pt = csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD_ARRAY");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      csound->JoinThread(*pt);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST_ARRAY");
+    else {
+      bufPos *= p->nChannels;
+      i = 0;
+      do {
+        aOut[i*ksmps+n] += scl * p->buf[bufPos++];
+      } while (++i < p->nChannels);
     }
-#endif
-
-    csound->Free(csound, current);
-    csound->DestroyCircularBuffer(csound, ((DISKIN2_ARRAY *)p)->cb);
-
-    return OK;
 }
 
+int32_t diskin2_async_deinit_array(CSOUND *csound,  void *p){
 
-int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
-{
-    /* nsmps is bufsize in frames */
-  int32_t nsmps = p->aOut_bufsize;// - p->h.insdshead->ksmps_offset;
-    int32_t i, nn;
-    int32_t chn, chans = p->nChannels;
-    double  d, frac_d, x, c, v, pidwarp_d;
-    MYFLT   frac, a0, a1, a2, a3, onedwarp, winFact;
-    int32_t   ndx;
-    int32_t     wsized2, warp;
-    MYFLT  *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
+    DISKIN2_ARRAY *pp = (DISKIN2_ARRAY *) p;
 
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
-    if (!p->initDone && !p->SkipInit) {
-      return csound->PerfError(csound, &(p->h),
-                               Str("diskin2: not initialised"));
-    }
-    if (*(p->kTranspose) != p->prv_kTranspose) {
-      double  f;
-      p->prv_kTranspose = *(p->kTranspose);
-      f = (double)p->prv_kTranspose * p->warpScale * (double)POS_FRAC_SCALE;
-#ifdef HAVE_C99
-      p->pos_frac_inc = (int64_t)llrint(f);
-#else
-      p->pos_frac_inc = (int64_t)(f + (f < 0.0 ? -0.5 : 0.5));
-#endif
-    }
-    /* clear outputs to zero first */
-    for (chn = 0; chn < chans; chn++)
-      for (nn = 0; nn < nsmps; nn++)
-        aOut[chn + nn*chans] = FL(0.0);
-    /* file read position */
-    ndx = (int32_t) (p->pos_frac >> POS_FRAC_SHIFT);
-    switch (p->winSize) {
-    case 1:                   /* ---- no interpolation ---- */
-      for (nn = 0; nn < nsmps; nn++) {
-        if (p->pos_frac & ((int64_t)POS_FRAC_SCALE >> 1))
-          ndx++;                      /* round to nearest sample */
-        diskin2_get_sample_array(csound, p, ndx, nn, FL(1.0));
-        /* update file position */
-        diskin2_file_pos_inc_array(p, &ndx);
-      }
-      break;
-    case 2:                   /* ---- linear interpolation ---- */
-      for (nn = 0; nn < nsmps; nn++) {
-        a1 = (MYFLT)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (FL(1.0) / (MYFLT)POS_FRAC_SCALE);
-        a0 = FL(1.0) - a1;
-        diskin2_get_sample_array(csound, p, ndx, nn, a0);
-        ndx++;
-        diskin2_get_sample_array(csound, p, ndx, nn, a1);
-        /* update file position */
-        diskin2_file_pos_inc_array(p, &ndx);
-      }
-      break;
-    case 4:                   /* ---- cubic interpolation ---- */
-      for (nn = 0; nn < nsmps; nn++) {
-        frac = (MYFLT)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (FL(1.0) / (MYFLT)POS_FRAC_SCALE);
-        a3 = frac * frac; a3 -= FL(1.0); a3 *= (FL(1.0) / FL(6.0));
-        a2 = frac; a2 += FL(1.0); a0 = (a2 *= FL(0.5)); a0 -= FL(1.0);
-        a1 = FL(3.0) * a3; a2 -= a1; a0 -= a3; a1 -= frac;
-        a0 *= frac; a1 *= frac; a2 *= frac; a3 *= frac; a1 += FL(1.0);
-        ndx--;                                /* sample -1 */
-        diskin2_get_sample_array(csound, p, ndx, nn, a0);
-        ndx++;                                /* sample 0 */
-        diskin2_get_sample_array(csound, p, ndx, nn, a1);
-        ndx++;                                /* sample +1 */
-        diskin2_get_sample_array(csound, p, ndx, nn, a2);
-        ndx++;                                /* sample +2 */
-        diskin2_get_sample_array(csound, p, ndx, nn, a3);
-        /* update file position */
-        diskin2_file_pos_inc_array(p, &ndx);
-      }
-      break;
-    default:                  /* ---- sinc interpolation ---- */
-      wsized2 = p->winSize >> 1;
-      nn = POS_FRAC_SCALE + (POS_FRAC_SCALE >> 12);
-      if (p->pos_frac_inc > (int64_t) nn ||
-          p->pos_frac_inc < (int64_t) (-nn)) {
-        warp = 1;                     /* enable warp */
-        onedwarp = (p->pos_frac_inc >= (int64_t) 0 ?
-                    ((MYFLT)nn / (MYFLT)p->pos_frac_inc)
-                    : ((MYFLT)(-nn) / (MYFLT)p->pos_frac_inc));
-        pidwarp_d = PI * (double)onedwarp;
-        c = 2.0 * cos(pidwarp_d) - 2.0;
-        /* correct window for kwarp */
-        x = v = (double)wsized2; x *= x; x = 1.0 / x;
-        v *= (double)onedwarp; v -= (double)((int32_t)v) + 0.5; v *= 4.0 * v;
-        winFact = (MYFLT)(((double)p->winFact - x) * v + x);
-      }
-      else {
-        warp = 0;
-        onedwarp = FL(0.0);
-        pidwarp_d = c = 0.0;
-        winFact = p->winFact;
-      }
-      for (nn = 0; nn < nsmps; nn++) {
-        frac_d = (double)((int32_t)(p->pos_frac & (int64_t)POS_FRAC_MASK))
-          * (1.0 / (double)POS_FRAC_SCALE);
-        ndx += (int32_t)(1 - wsized2);
-        d = (double)(1 - wsized2) - frac_d;
-        if (warp) {                           /* ---- warp enabled ---- */
-          init_sine_gen((1.0 / PI), pidwarp_d, (pidwarp_d * d), c, &x, &v);
-          /* samples -(window size / 2 - 1) to -1 */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample_array(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-          /* sample 0 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d < 0.00003)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample_array(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* sample 1 */
-          /* avoid division by zero */
-          if (UNLIKELY(frac_d > 0.99997)) {
-            a1 = onedwarp;
-          }
-          else {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-          }
-          diskin2_get_sample_array(csound, p, ndx, nn, a1);
-          ndx++;
-          d += 1.0; v += c * x; x += v;
-          /* samples 2 to (window size / 2) */
-          i = wsized2 - 1;
-          do {
-            a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-            a1 = (MYFLT)x * a1 * a1 / (MYFLT)d;
-            diskin2_get_sample_array(csound, p, ndx, nn, a1);
-            ndx++;
-            d += 1.0; v += c * x; x += v;
-          } while (--i);
-        }
-        else {                                /* ---- warp disabled ---- */
-          /* avoid division by zero */
-          if (frac_d < 0.00001 || frac_d > 0.99999) {
-            ndx += (int32_t) (wsized2 - (frac_d < 0.5 ? 1 : 0));
-            diskin2_get_sample_array(csound, p, ndx, nn, FL(1.0));
-          }
-          else {
-            a0 = (MYFLT)(sin(PI * frac_d) / PI);
-            i = wsized2;
-            do {
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = a0 * a1 * a1 / (MYFLT)d;
-              diskin2_get_sample_array(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-              a1 = (MYFLT)d; a1 = FL(1.0) - a1 * a1 * winFact;
-              a1 = -(a0 * a1 * a1 / (MYFLT)d);
-              diskin2_get_sample_array(csound, p, ndx, nn, a1);
-              d += 1.0;
-              ndx++;
-            } while (--i);
-          }
-        }
-        /* update file position */
-        diskin2_file_pos_inc_array(p, &ndx);
-      }
-    }
-    {
-      /* write to circular buffer */
-      int32_t lc, mc=0, nc=nsmps*p->nChannels;
-      int32_t *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
-    }
+    if (pp->stream == NULL) return NOTOK;
+    /* runs before the note's files are closed: the stream takes its file */
+    diskin_stream_close(csound, (DISKIN_STREAM *) pp->stream, pp->fdch.fd);
+    pp->fdch.fd = NULL;
+    pp->stream = NULL;
     return OK;
- file_error:
-    csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
-    return NOTOK;
-}
-
-uintptr_t diskin_io_thread_array(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int32_t wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int32_t *start =
-      current->csound->QueryGlobalVariable(current->csound,
-                                           "DISKIN_THREAD_START_ARRAY");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read_array(current->csound, (DISKIN2_ARRAY *)current->diskin);
-        current = current->nxt;
-      }
-    }
-    return 0;
 }
 
 
@@ -1570,6 +1389,12 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
       /* skip initialisation if requested */
       if (p->SkipInit != FL(0.0))
         return OK;
+      if (p->stream != NULL) {
+        /* the IO threads may still be reading it: they close the file */
+        diskin_stream_close(csound, (DISKIN_STREAM *) p->stream, p->fdch.fd);
+        p->stream = NULL;
+        p->fdch.fd = NULL;
+      }
       csound_fd_close(csound, &(p->fdch));
     }
     // to handle raw files number of channels
@@ -1693,68 +1518,15 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
 
     memset(p->buf, 0, n*sizeof(MYFLT));
 
-    // create circular buffer, on fail set mode to synchronous
-    if (csound->oparms->realtime==1 && p->fforceSync==0 &&
-        (p->cb = csound->CreateCircularBuffer(csound,
-                                              p->bufSize*p->nChannels*2,
-                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-#ifndef __EMSCRIPTEN__
-      int32_t *start;
-#endif
-      // allocate buffer
-      p->aOut_bufsize =
-        ((unsigned int)p->bufSize) < CS_KSMPS ?
-        ((MYFLT)CS_KSMPS) : ((MYFLT)p->bufSize);
-      n = p->aOut_bufsize*sizeof(MYFLT)*p->nChannels;
-      if (n != (int32_t)p->auxData2.size)
-        csound->AuxAlloc(csound, (int32_t) n, &(p->auxData2));
-      p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
-      memset(p->aOut_buf, 0, n);
-      top =
-        (DISKIN_INST **)csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY");
-#ifndef __EMSCRIPTEN__
-      if (top == NULL){
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_INST_ARRAY", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound,
-                                                           "DISKIN_INST_ARRAY");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_PTHREAD_ARRAY", sizeof(void**));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START_ARRAY", sizeof(int32_t));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt =
-            (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin =  (DISKIN2 *) p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if (*(start =
-            csound->QueryGlobalVariable(csound,
-                                        "DISKIN_THREAD_START_ARRAY")) == 0) {
-        uintptr_t diskin_io_thread_array(void *p);
-        // TOFIX: this variable (thread) is not referenced
-        #if 0
-        void **thread = csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_PTHREAD_ARRAY");
-        #endif
-        *start = 1;
-        csound->CreateThread(diskin_io_thread_array, *top);
-      }
-#endif
+    // open a read-ahead stream, on fail set mode to synchronous
+    p->stream = NULL;
+    if (csound->oparms->realtime==1 && p->fforceSync==0)
+      p->stream = diskin_stream_open(csound, p->sf, p->nChannels, p->bufSize,
+                                     p->fileLength, p->wrapMode,
+                                     csound->esr * p->warpScale,
+                                     (long) (p->pos_frac >> POS_FRAC_SHIFT),
+                                     csound->GetFileName(fd));
+    if (p->stream != NULL) {
       csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
                                      diskin2_async_deinit_array);
       p->async = 1;
@@ -1772,8 +1544,6 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
       }
     }
     else {
-      p->aOut_buf = NULL;
-      p->aOut_bufsize = 0;
       p->async = 0;
       /* print file information */
       if (UNLIKELY((csound->oparms_.msglevel & 7) == 7)) {
@@ -1983,43 +1753,6 @@ int32_t diskin2_perf_synchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
 
 
 
-int32_t diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
-{
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS, ksmps = CS_KSMPS;
-    MYFLT samp;
-    int32_t chn;
-    void *cb = p->cb;
-    int32_t chans = p->nChannels;
-    MYFLT *aOut = (MYFLT *) p->aOut->data;
-
-    if (offset || early) {
-      for (chn = 0; chn < chans; chn++)
-        for (nn = 0; nn < nsmps; nn++)
-          aOut[chn*ksmps+nn] = FL(0.0);
-      if (UNLIKELY(early)) nsmps -= early;
-    }
-
-    if (UNLIKELY(p->fdch.fd == NULL)) return NOTOK;
-    if (!p->initDone && !p->SkipInit){
-      return csound->PerfError(csound, &(p->h),
-                               Str("diskin2: not initialised"));
-    }
-    for (nn = offset; nn < nsmps; nn++){
-
-      for (chn = 0; chn < chans; chn++) {
-        //int32_t i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        aOut[chn*ksmps+nn] = csound->e0dbfs*samp;
-      }
-    }
-    return OK;
-}
-
 int32_t diskin2_init_array_I(CSOUND *csound, DISKIN2_ARRAY *p) {
     p->SkipInit = *p->iSkipInit;
     p->WinSize = *p->iWinSize;
@@ -2055,8 +1788,7 @@ int32_t diskin_init_array_S(CSOUND *csound, DISKIN2_ARRAY *p){
 }
 
 int32_t diskin2_perf_array(CSOUND *csound, DISKIN2_ARRAY *p) {
-    if (!p->async) return diskin2_perf_synchronous_array(csound, p);
-    else return diskin2_perf_asynchronous_array(csound, p);
+    return diskin2_perf_synchronous_array(csound, p);
 }
 
 #if 0 // OLD SOUNDIN code VL 24-12-2016
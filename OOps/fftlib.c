@@ -34,6 +34,13 @@
 #include "csound.h"
 #include "fftlib.h"
 #include "pffft.h"
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || !defined(USE_DOUBLE))
+#include <arm_neon.h>
+#endif
 
 
 
@@ -3349,6 +3356,132 @@ void csoundRealFFTMult(CSOUND *csound, MYFLT *outbuf,
   }
 }
 
+/* outbuf[k] += buf1[k] * buf2[k] over n interleaved (re, im) pairs.
+   This is the inner loop of partitioned convolution, so it uses the
+   widest vectors the build targets; all loads and stores are
+   unaligned. */
+
+static void complex_mult_acc(MYFLT *outbuf, const MYFLT *buf1,
+                             const MYFLT *buf2, int32_t n)
+{
+  MYFLT re, im;
+  int32_t   i = 0;
+
+#if defined(__AVX__)
+# ifdef USE_DOUBLE
+  for ( ; i + 2 <= n; i += 2) {
+    __m256d a = _mm256_loadu_pd(buf1 + 2*i);
+    __m256d b = _mm256_loadu_pd(buf2 + 2*i);
+    __m256d t1 = _mm256_mul_pd(a, _mm256_movedup_pd(b));
+    __m256d t2 = _mm256_mul_pd(_mm256_permute_pd(a, 0x5),
+                               _mm256_permute_pd(b, 0xF));
+    _mm256_storeu_pd(outbuf + 2*i,
+                     _mm256_add_pd(_mm256_loadu_pd(outbuf + 2*i),
+                                   _mm256_addsub_pd(t1, t2)));
+  }
+# else
+  for ( ; i + 4 <= n; i += 4) {
+    __m256 a = _mm256_loadu_ps(buf1 + 2*i);
+    __m256 b = _mm256_loadu_ps(buf2 + 2*i);
+    __m256 t1 = _mm256_mul_ps(a, _mm256_moveldup_ps(b));
+    __m256 t2 = _mm256_mul_ps(_mm256_permute_ps(a, 0xB1),
+                              _mm256_movehdup_ps(b));
+    _mm256_storeu_ps(outbuf + 2*i,
+                     _mm256_add_ps(_mm256_loadu_ps(outbuf + 2*i),
+                                   _mm256_addsub_ps(t1, t2)));
+  }
+# endif
+#elif defined(__SSE2__) || defined(_M_X64)
+  /* no addsub before SSE3: flip the sign of the real lane instead */
+# ifdef USE_DOUBLE
+  const __m128d sgn = _mm_set_pd(0.0, -0.0);
+  for ( ; i < n; i++) {
+    __m128d a = _mm_loadu_pd(buf1 + 2*i);
+    __m128d b = _mm_loadu_pd(buf2 + 2*i);
+    __m128d t1 = _mm_mul_pd(a, _mm_unpacklo_pd(b, b));
+    __m128d t2 = _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_unpackhi_pd(b, b));
+    _mm_storeu_pd(outbuf + 2*i,
+                  _mm_add_pd(_mm_loadu_pd(outbuf + 2*i),
+                             _mm_add_pd(t1, _mm_xor_pd(t2, sgn))));
+  }
+# else
+  const __m128 sgn = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
+  for ( ; i + 2 <= n; i += 2) {
+    __m128 a = _mm_loadu_ps(buf1 + 2*i);
+    __m128 b = _mm_loadu_ps(buf2 + 2*i);
+    __m128 t1 = _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2,2,0,0)));
+    __m128 t2 = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2,3,0,1)),
+                           _mm_shuffle_ps(b, b, _MM_SHUFFLE(3,3,1,1)));
+    _mm_storeu_ps(outbuf + 2*i,
+                  _mm_add_ps(_mm_loadu_ps(outbuf + 2*i),
+                             _mm_add_ps(t1, _mm_xor_ps(t2, sgn))));
+  }
+# endif
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || !defined(USE_DOUBLE))
+  /* de-interleaving loads keep re and im in separate registers */
+# ifdef USE_DOUBLE
+  for ( ; i + 2 <= n; i += 2) {
+    float64x2x2_t a = vld2q_f64(buf1 + 2*i);
+    float64x2x2_t b = vld2q_f64(buf2 + 2*i);
+    float64x2x2_t o = vld2q_f64(outbuf + 2*i);
+    o.val[0] = vmlsq_f64(vmlaq_f64(o.val[0], a.val[0], b.val[0]),
+                         a.val[1], b.val[1]);
+    o.val[1] = vmlaq_f64(vmlaq_f64(o.val[1], a.val[0], b.val[1]),
+                         a.val[1], b.val[0]);
+    vst2q_f64(outbuf + 2*i, o);
+  }
+# else
+  for ( ; i + 4 <= n; i += 4) {
+    float32x4x2_t a = vld2q_f32(buf1 + 2*i);
+    float32x4x2_t b = vld2q_f32(buf2 + 2*i);
+    float32x4x2_t o = vld2q_f32(outbuf + 2*i);
+    o.val[0] = vmlsq_f32(vmlaq_f32(o.val[0], a.val[0], b.val[0]),
+                         a.val[1], b.val[1]);
+    o.val[1] = vmlaq_f32(vmlaq_f32(o.val[1], a.val[0], b.val[1]),
+                         a.val[1], b.val[0]);
+    vst2q_f32(outbuf + 2*i, o);
+  }
+# endif
+#endif
+  for ( ; i < n; i++) {
+    re = buf1[2*i] * buf2[2*i] - buf1[2*i+1] * buf2[2*i+1];
+    im = buf1[2*i] * buf2[2*i+1] + buf2[2*i] * buf1[2*i+1];
+    outbuf[2*i] += re;
+    outbuf[2*i+1] += im;
+  }
+}
+
+/**
+ * Multiply two arrays (buf1 and buf2) of complex data in the format
+ * returned by csoundRealFFT(), and add the result to outbuf, which
+ * must not overlap either input.
+ * The arrays should contain 'FFTsize' MYFLT values.
+ */
+
+void csoundRealFFTMultAcc(CSOUND *csound, MYFLT *outbuf,
+                          const MYFLT *buf1, const MYFLT *buf2,
+                          int32_t FFTsize)
+{
+  IGN(csound);
+  outbuf[0] += buf1[0] * buf2[0];       /* DC and Nyquist are real */
+  if (FFTsize < 2)
+    return;
+  outbuf[1] += buf1[1] * buf2[1];
+  complex_mult_acc(outbuf + 2, buf1 + 2, buf2 + 2, (FFTsize - 2) >> 1);
+}
+
+/**
+ * Multiply two arrays of 'n' interleaved complex values and add the
+ * result to outbuf, which must not overlap either input.
+ */
+
+void csoundComplexMultAcc(CSOUND *csound, MYFLT *outbuf,
+                          const MYFLT *buf1, const MYFLT *buf2, int32_t n)
+{
+  IGN(csound);
+  complex_mult_acc(outbuf, buf1, buf2, n);
+}
+
 
 
 /*
@@ -27,6 +27,7 @@
 #include "insert.h"     /* for goto's */
 #include "aops.h"       /* for cond's */
 extern int32_t strarg2insno(CSOUND *, void *p, int32_t is_string);
+extern int async_init_reinit(CSOUND *, INSDS *, OPDS *);
 
 int32_t igoto(CSOUND *csound, GOTO *p)
 {
@@ -102,6 +103,8 @@ int32_t rireturn(CSOUND *csound, LINK *p)
 int32_t reinit(CSOUND *csound, GOTO *p)
 {
     csound->reinitflag = p->h.insdshead->reinitflag = 1;
+    if (csound->async_init != NULL)     /* init worker, see insert.c */
+      return async_init_reinit(csound, p->h.insdshead, p->lblblk->prvi);
     if (csound->oparms->realtime == 0) {
       csound->curip = p->h.insdshead;
       csound->ids = p->lblblk->prvi;        /* now, despite ANSI C warning:  */
@@ -109,6 +112,7 @@ int32_t reinit(CSOUND *csound, GOTO *p)
              (csound->ids->iopadr != (SUBR) rireturn))
         (*csound->ids->iopadr)(csound, csound->ids);
       csound->reinitflag = p->h.insdshead->reinitflag = 0;
+      INS_OPRUNS(p->h.insdshead)->stale = 1;
     }
     else {
       uint64_t wp = csound->alloc_queue_wp;
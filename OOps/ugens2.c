@@ -1203,6 +1203,35 @@ int32_t oscset(CSOUND *csound, OSC *p)
     return NOTOK;
 }
 
+/* oscili and oscil3: iblim asks for the copy of the table band-limited
+   for the frequency being played, see csoundFTMipmap() */
+
+int32_t oscseti(CSOUND *csound, OSC *p)
+{
+    p->blim = (*p->iblim != FL(0.0));
+    if (UNLIKELY(oscset(csound, p) != OK))
+      return NOTOK;
+    if (p->blim)
+      csound->FTMipmap(csound, p->ftp, -FL(1.0));  /* make the levels now */
+    return OK;
+}
+
+/* the table data to read for cps[n .. nsmps-1] */
+
+static inline MYFLT *osc_ftable(CSOUND *csound, OSC *p, const MYFLT *cps,
+                                uint32_t n, uint32_t nsmps, MYFLT cvt)
+{
+    FUNC    *ftp = p->ftp;
+    MYFLT   c, mx = FL(0.0);
+
+    if (LIKELY(!p->blim))
+      return ftp->ftable;
+    for ( ; n < nsmps; n++)
+      if ((c = FABS(cps[n])) > mx)
+        mx = c;
+    return csound->FTMipmap(csound, ftp, mx * cvt * ftp->lodiv);
+}
+
 int32_t koscil(CSOUND *csound, OSC *p)
 {
     FUNC    *ftp;
@@ -1372,7 +1401,7 @@ int32_t koscli(CSOUND *csound, OSC   *p)
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
     fract = PFRAC(phs);
-    ftab = ftp->ftable + (phs >> ftp->lobits);
+    ftab = osc_ftable(csound, p, p->xcps, 0, 1, CS_KICVT) + (phs >> ftp->lobits);
     v1 = ftab[0];
     *p->sr = (v1 + (ftab[1] - v1) * fract) * *p->xamp;
     inc = (int32_t)(*p->xcps * CS_KICVT);
@@ -1405,7 +1434,7 @@ int32_t osckki(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
+    ft = osc_ftable(csound, p, p->xcps, 0, 1, csound->sicvt);
     for (n=offset; n<nsmps; n++) {
       fract = PFRAC(phs);
       ftab = ft + (phs >> lobits);
@@ -1442,7 +1471,7 @@ int32_t osckai(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
+    ft = osc_ftable(csound, p, cpsp, offset, nsmps, sicvt);
     for (n=offset;n<nsmps;n++) {
       int32_t inc;
       inc = MYFLT2LONG(cpsp[n] * sicvt);
@@ -1481,7 +1510,7 @@ int32_t oscaki(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
+    ft = osc_ftable(csound, p, p->xcps, 0, 1, csound->sicvt);
     for (n=offset;n<nsmps;n++) {
       fract = (MYFLT) PFRAC(phs);
       ftab = ft + (phs >> lobits);
@@ -1508,7 +1537,6 @@ int32_t oscaai(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ft = ftp->ftable;
     lobits = ftp->lobits;
     phs = p->lphs;
     ampp = p->xamp;
@@ -1519,6 +1547,7 @@ int32_t oscaai(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
+    ft = osc_ftable(csound, p, cpsp, offset, nsmps, sicvt);
     for (n=offset;n<nsmps;n++) {
       int32_t inc;
       inc = MYFLT2LONG(cpsp[n] * sicvt);
@@ -1546,7 +1575,7 @@ int32_t koscl3(CSOUND *csound, OSC   *p)
     phs = p->lphs;
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_ftable(csound, p, p->xcps, 0, 1, CS_KICVT);
     fract = PFRAC(phs);
     x0 = (phs >> ftp->lobits);
     x0--;
@@ -1589,7 +1618,7 @@ int32_t osckk3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_ftable(csound, p, p->xcps, 0, 1, csound->sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
@@ -1649,7 +1678,6 @@ int32_t oscka3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
     lobits = ftp->lobits;
     amp = *p->xamp;
     cpsp = p->xcps;
@@ -1660,6 +1688,7 @@ int32_t oscka3(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
+    ftab = osc_ftable(csound, p, cpsp, offset, nsmps, sicvt);
     for (n=offset;n<nsmps;n++) {
       int32_t inc;
       inc = MYFLT2LONG(cpsp[n] * sicvt);
@@ -1704,7 +1733,7 @@ int32_t oscak3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
+    ftab = osc_ftable(csound, p, p->xcps, 0, 1, csound->sicvt);
     lobits = ftp->lobits;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
@@ -1758,7 +1787,6 @@ int32_t oscaa3(CSOUND *csound, OSC   *p)
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftab = ftp->ftable;
     lobits = ftp->lobits;
     phs = p->lphs;
     ampp = p->xamp;
@@ -1769,6 +1797,7 @@ int32_t oscaa3(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
+    ftab = osc_ftable(csound, p, cpsp, offset, nsmps, sicvt);
     for (n=offset;n<nsmps;n++) {
       int32_t inc = MYFLT2LONG(cpsp[n] * sicvt);
       fract = (MYFLT) PFRAC(phs);
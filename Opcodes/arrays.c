@@ -428,6 +428,29 @@ typedef struct {
   MYFLT  *kstart, *kend;
 } TABSCALE;
 
+/* r[n] = a[n] op b[n] for lo <= n < hi with the SIMD kernels of aops.c,
+   where a or b may be a scalar (tab_ak, tab_ka) */
+static inline void tab_aa(int32_t op, MYFLT *r, MYFLT *a, MYFLT *b,
+                          int32_t lo, int32_t hi)
+{
+    if (hi > lo)
+      aops_simd_kernels()->aa[op](&r[lo], &a[lo], &b[lo], hi-lo);
+}
+
+static inline void tab_ak(int32_t op, MYFLT *r, MYFLT *a, MYFLT b,
+                          int32_t lo, int32_t hi)
+{
+    if (hi > lo)
+      aops_simd_kernels()->ak[op](&r[lo], &a[lo], &b, hi-lo);
+}
+
+static inline void tab_ka(int32_t op, MYFLT *r, MYFLT a, MYFLT *b,
+                          int32_t lo, int32_t hi)
+{
+    if (hi > lo)
+      aops_simd_kernels()->ka[op](&r[lo], &a, &b[lo], hi-lo);
+}
+
 static int32_t tabarithset(CSOUND *csound, TABARITH *p)
 {
     if (LIKELY(p->left->data && p->right->data)) {
@@ -498,8 +521,7 @@ static int32_t tabadd(CSOUND *csound, TABARITH *p)
       sizer*=r->sizes[i];
     }
     if (sizer<sizel) sizel= sizer;
-    for (i=0; i<sizel; i++)
-      ans->data[i] = l->data[i] + r->data[i];
+    tab_aa(AOPS_ADD, ans->data, l->data, r->data, 0, sizel);
     return OK;
 }
 
@@ -521,8 +543,7 @@ static int32_t tabsub(CSOUND *csound, TABARITH *p)
       sizer*=r->sizes[i];
     }
     if (sizer<sizel) sizel= sizer;
-    for (i=0; i<sizel; i++)
-      ans->data[i] = l->data[i] - r->data[i];
+    tab_aa(AOPS_SUB, ans->data, l->data, r->data, 0, sizel);
     return OK;
 }
 
@@ -544,8 +565,7 @@ static int32_t tabmult(CSOUND *csound, TABARITH *p)
       sizer*=r->sizes[i];
     }
     if (sizer<sizel) sizel= sizer;
-    for (i=0; i<sizel; i++)
-      ans->data[i] = l->data[i] * r->data[i];
+    tab_aa(AOPS_MUL, ans->data, l->data, r->data, 0, sizel);
     return OK;
 }
 
@@ -568,12 +588,11 @@ static int32_t tabdiv(CSOUND *csound, TABARITH *p)
     }
     if (sizer<sizel) sizel = sizer;
     for (i=0; i<sizel; i++)
-      if (LIKELY(r->data[i]!=0))
-        ans->data[i] = l->data[i] / r->data[i];
-      else
+      if (UNLIKELY(r->data[i]==0))
         return
           csound->PerfError(csound, &(p->h),
                             Str("division by zero in array-var at index %d"), i);
+    tab_aa(AOPS_DIV, ans->data, l->data, r->data, 0, sizel);
     return OK;
 }
 
@@ -663,8 +682,7 @@ static int32_t tabiadd(CSOUND *csound, ARRAYDAT *ans, ARRAYDAT *l, MYFLT r, void
    for (i=1; i<l->dimensions; i++) {
       sizel*=l->sizes[i];
     }
-    for (i=0; i<sizel; i++)
-      ans->data[i] = l->data[i] + r;
+    tab_ak(AOPS_ADD, ans->data, l->data, r, 0, sizel);
     return OK;
 }
 
@@ -716,8 +734,7 @@ static int32_t tabaddinkk(CSOUND *csound, TABARITHIN *p)
       sizer*=r->sizes[i];
     }
     if (sizer<sizel) sizel= sizer;
-    for (i=0; i<sizel; i++)
-      ans->data[i] += r->data[i];
+    tab_aa(AOPS_ADD, ans->data, ans->data, r->data, 0, sizel);
     return OK;
 }
 
@@ -730,7 +747,7 @@ static int32_t tabaaddin(CSOUND *csound, TABARITHIN *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS;
+    int32_t i, nsmps = CS_KSMPS;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -754,8 +771,7 @@ static int32_t tabaaddin(CSOUND *csound, TABARITHIN *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] += b[n];
+      tab_aa(AOPS_ADD, aa, aa, b, offset, nsmps);
     }
     return OK;
 }
@@ -769,7 +785,7 @@ static int32_t tabaasubin(CSOUND *csound, TABARITHIN *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -793,8 +809,7 @@ static int32_t tabaasubin(CSOUND *csound, TABARITHIN *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] -= b[n];
+      tab_aa(AOPS_SUB, aa, aa, b, offset, nsmps);
     }
     return OK;
 }
@@ -808,7 +823,7 @@ static int32_t tabarkrddin(CSOUND *csound, TABARITHIN *p)
     int32_t sizer  = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -829,8 +844,7 @@ static int32_t tabarkrddin(CSOUND *csound, TABARITHIN *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] += b;
+      tab_ak(AOPS_ADD, aa, aa, b, offset, nsmps);
     }
     return OK;
 }
@@ -844,7 +858,7 @@ static int32_t tabarkrsbin(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -865,8 +879,7 @@ static int32_t tabarkrsbin(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] -= b;
+      tab_ak(AOPS_SUB, aa, aa, b, offset, nsmps);
     }
     return OK;
 }
@@ -879,7 +892,7 @@ static int32_t tabakaddin(CSOUND *csound, TABARITHIN1 *p)
     int32_t sizel   = ans->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL))
@@ -896,8 +909,7 @@ static int32_t tabakaddin(CSOUND *csound, TABARITHIN1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] += l;
+      tab_ak(AOPS_ADD, aa, aa, l, offset, nsmps);
     }
     return OK;
 }
@@ -910,7 +922,7 @@ static int32_t tabaksubin(CSOUND *csound, TABARITHIN1 *p)
     int32_t sizel   = ans->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL))
@@ -927,8 +939,7 @@ static int32_t tabaksubin(CSOUND *csound, TABARITHIN1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] -= l;
+      tab_ak(AOPS_SUB, aa, aa, l, offset, nsmps);
     }
     return OK;
 }
@@ -942,7 +953,7 @@ static int32_t tabaksub(CSOUND *csound, TABARITH1 *p)
     int32_t sizel   = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -960,8 +971,7 @@ static int32_t tabaksub(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = b[n] - l;
+      tab_ak(AOPS_SUB, aa, b, l, offset, nsmps);
     }
     return OK;
 }
@@ -985,8 +995,7 @@ static int32_t subinAA(CSOUND *csound, TABARITHIN *p)
       sizer*=r->sizes[i];
     }
     if (sizer<sizel) sizel= sizer;
-    for (i=0; i<sizel; i++)
-      ans->data[i] -=r->data[i];
+    tab_aa(AOPS_SUB, ans->data, ans->data, r->data, 0, sizel);
     return OK;
 }
 
@@ -1009,8 +1018,7 @@ static int32_t tabsubinkk(CSOUND *csound, TABARITHIN *p)
       sizer*=r->sizes[i];
     }
     if (sizer<sizel) sizel= sizer;
-    for (i=0; i<sizel; i++)
-      ans->data[i] -= r->data[i];
+    tab_aa(AOPS_SUB, ans->data, ans->data, r->data, 0, sizel);
     return OK;
 }
 
@@ -1033,8 +1041,7 @@ static int32_t tabaisub(CSOUND *csound, TABARITH1 *p)
    for (i=1; i<l->dimensions; i++) {
       sizel*=l->sizes[i];
     }
-    for (i=0; i<sizel; i++)
-      ans->data[i] = l->data[i] - r;
+    tab_ak(AOPS_SUB, ans->data, l->data, r, 0, sizel);
     return OK;
 }
 
@@ -1054,8 +1061,7 @@ static int32_t tabiasub(CSOUND *csound, TABARITH2 *p)
    for (i=1; i<l->dimensions; i++) {
       sizel*=l->sizes[i];
     }
-    for (i=0; i<sizel; i++)
-      ans->data[i] = r - l->data[i];
+    tab_ka(AOPS_SUB, ans->data, r, l->data, 0, sizel);
     return OK;
 }
 
@@ -1073,8 +1079,7 @@ static int32_t tabimult(CSOUND *csound, ARRAYDAT *ans, ARRAYDAT *l,
     for (i=1; i<l->dimensions; i++) {
       sizel*=l->sizes[i];
     }
-    for (i=0; i<sizel; i++)
-      ans->data[i] = l->data[i] * r;
+    tab_ak(AOPS_MUL, ans->data, l->data, r, 0, sizel);
     return OK;
 }
 
@@ -1115,8 +1120,7 @@ static int32_t tabaidiv(CSOUND *csound, TABARITH1 *p)
     for (i=1; i<l->dimensions; i++) {
       sizel*=l->sizes[i];
     }
-    for (i=0; i<sizel; i++)
-      ans->data[i] = l->data[i] / r;
+    tab_ak(AOPS_DIV, ans->data, l->data, r, 0, sizel);
     return OK;
 }
 
@@ -1136,12 +1140,11 @@ static int32_t tabiadiv(CSOUND *csound, TABARITH2 *p)
     for (i=1; i<l->dimensions; i++) {
       sizel*=l->sizes[i];
     }
-    for (i=0; i<sizel; i++) {
+    for (i=0; i<sizel; i++)
       if (UNLIKELY(l->data[i]==FL(0.0)))
         return csound->PerfError(csound, &(p->h),
                                  Str("division by zero in array-var"));
-      ans->data[i] = r / l->data[i];
-    }
+    tab_ka(AOPS_DIV, ans->data, r, l->data, 0, sizel);
     return OK;
 }
 
@@ -1292,7 +1295,7 @@ static int32_t tabaadd(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS;
+    int32_t i, nsmps = CS_KSMPS;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -1316,8 +1319,7 @@ static int32_t tabaadd(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] + b[n];
+      tab_aa(AOPS_ADD, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1332,7 +1334,7 @@ static int32_t tabasub(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -1356,8 +1358,7 @@ static int32_t tabasub(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] - b[n];
+      tab_aa(AOPS_SUB, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1372,7 +1373,7 @@ static int32_t tabamul(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -1396,8 +1397,7 @@ static int32_t tabamul(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] * b[n];
+      tab_aa(AOPS_MUL, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1456,7 +1456,7 @@ static int32_t tabkamult(CSOUND *csound, TABARITH2 *p)
     int32_t sizel        = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1474,8 +1474,7 @@ static int32_t tabkamult(CSOUND *csound, TABARITH2 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = l * b[n];
+      tab_ka(AOPS_MUL, aa, l, b, offset, nsmps);
     }
     return OK;
 }
@@ -1489,7 +1488,7 @@ static int32_t tabakmult(CSOUND *csound, TABARITH1 *p)
     int32_t sizel        = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1507,8 +1506,7 @@ static int32_t tabakmult(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = l * b[n];
+      tab_ka(AOPS_MUL, aa, l, b, offset, nsmps);
     }
     return OK;
 }
@@ -1522,7 +1520,7 @@ static int32_t tabkaadd(CSOUND *csound, TABARITH2 *p)
     int32_t sizel   = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1540,8 +1538,7 @@ static int32_t tabkaadd(CSOUND *csound, TABARITH2 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = l + b[n];
+      tab_ka(AOPS_ADD, aa, l, b, offset, nsmps);
     }
     return OK;
 }
@@ -1555,7 +1552,7 @@ static int32_t tabakadd(CSOUND *csound, TABARITH1 *p)
     int32_t sizel   = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1573,8 +1570,7 @@ static int32_t tabakadd(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = l + b[n];
+      tab_ka(AOPS_ADD, aa, l, b, offset, nsmps);
     }
     return OK;
 }
@@ -1588,7 +1584,7 @@ static int32_t tabkasub(CSOUND *csound, TABARITH2 *p)
     int32_t sizel   = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1606,8 +1602,7 @@ static int32_t tabkasub(CSOUND *csound, TABARITH2 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = l - b[n];
+      tab_ka(AOPS_SUB, aa, l, b, offset, nsmps);
     }
     return OK;
 }
@@ -1659,7 +1654,7 @@ static int32_t tabakdiv(CSOUND *csound, TABARITH1 *p)
     int32_t sizel    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1680,8 +1675,7 @@ static int32_t tabakdiv(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = b[n] / l;
+      tab_ak(AOPS_DIV, aa, b, l, offset, nsmps);
     }
     return OK;
 }
@@ -1764,7 +1758,7 @@ static int32_t tabaardd(CSOUND *csound, TABARITH2 *p)
     int32_t sizel = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1782,8 +1776,7 @@ static int32_t tabaardd(CSOUND *csound, TABARITH2 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] + b[n];
+      tab_aa(AOPS_ADD, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1797,7 +1790,7 @@ static int32_t tabaarsb(CSOUND *csound, TABARITH2 *p)
     int32_t sizel   = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1815,8 +1808,7 @@ static int32_t tabaarsb(CSOUND *csound, TABARITH2 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] - b[n];
+      tab_aa(AOPS_SUB, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1830,7 +1822,7 @@ static int32_t tabaarml(CSOUND *csound, TABARITH2 *p)
     int32_t sizel = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1848,8 +1840,7 @@ static int32_t tabaarml(CSOUND *csound, TABARITH2 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] * b[n];
+      tab_aa(AOPS_MUL, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1863,7 +1854,7 @@ static int32_t tabaardv(CSOUND *csound, TABARITH2 *p)
     int32_t sizel = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || r->data==NULL))
@@ -1881,8 +1872,7 @@ static int32_t tabaardv(CSOUND *csound, TABARITH2 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] / b[n];
+      tab_aa(AOPS_DIV, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1896,7 +1886,7 @@ static int32_t tabaradd(CSOUND *csound, TABARITH1 *p)
     int32_t sizel = l->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL))
@@ -1914,8 +1904,7 @@ static int32_t tabaradd(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] + b[n];
+      tab_aa(AOPS_ADD, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1929,7 +1918,7 @@ static int32_t tabarasb(CSOUND *csound, TABARITH1 *p)
     int32_t sizel = l->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL))
@@ -1947,8 +1936,7 @@ static int32_t tabarasb(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] - b[n];
+      tab_aa(AOPS_SUB, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1962,7 +1950,7 @@ static int32_t tabaraml(CSOUND *csound, TABARITH1 *p)
     int32_t sizel = l->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL))
@@ -1980,8 +1968,7 @@ static int32_t tabaraml(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] * b[n];
+      tab_aa(AOPS_MUL, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -1995,7 +1982,7 @@ static int32_t tabaradv(CSOUND *csound, TABARITH1 *p)
     int32_t sizel = l->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL))
@@ -2013,8 +2000,7 @@ static int32_t tabaradv(CSOUND *csound, TABARITH1 *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] / b[n];
+      tab_aa(AOPS_DIV, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2030,7 +2016,7 @@ static int32_t tabkrardd(CSOUND *csound, TABARITH *p)
     int32_t sizer = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2051,8 +2037,7 @@ static int32_t tabkrardd(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a + b[n];
+      tab_ka(AOPS_ADD, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2067,7 +2052,7 @@ static int32_t tabkrarsb(CSOUND *csound, TABARITH *p)
     int32_t sizer = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2088,8 +2073,7 @@ static int32_t tabkrarsb(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a - b[n];
+      tab_ka(AOPS_SUB, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2104,7 +2088,7 @@ static int32_t tabkrarml(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2125,8 +2109,7 @@ static int32_t tabkrarml(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a * b[n];
+      tab_ka(AOPS_MUL, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2141,7 +2124,7 @@ static int32_t tabkrardv(CSOUND *csound, TABARITH *p)
     int32_t sizer       = r->sizes[0];
     uint32_t offset     = p->h.insdshead->ksmps_offset;
     uint32_t early      = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span        = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2162,8 +2145,7 @@ static int32_t tabkrardv(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a / b[n];
+      tab_ka(AOPS_DIV, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2215,7 +2197,7 @@ static int32_t tabarkrdd(CSOUND *csound, TABARITH *p)
     int32_t sizer  = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2236,8 +2218,7 @@ static int32_t tabarkrdd(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] + b;
+      tab_ak(AOPS_ADD, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2252,7 +2233,7 @@ static int32_t tabarkrsb(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2273,8 +2254,7 @@ static int32_t tabarkrsb(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] - b;
+      tab_ak(AOPS_SUB, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2289,7 +2269,7 @@ static int32_t tabarkrml(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2310,8 +2290,7 @@ static int32_t tabarkrml(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] * b;
+      tab_ak(AOPS_MUL, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2326,7 +2305,7 @@ static int32_t tabarkrdv(CSOUND *csound, TABARITH *p)
     int32_t sizer    = r->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -2347,8 +2326,7 @@ static int32_t tabarkrdv(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] / b;
+      tab_ak(AOPS_DIV, aa, a, b, offset, nsmps);
     }
     return OK;
 }
@@ -2450,7 +2428,7 @@ static int32_t tabqset1(CSOUND *csound, TABQUERY1 *p)
 static int32_t tabmax(CSOUND *csound, TABQUERY *p)
 {
     ARRAYDAT *t = p->tab;
-    int32_t i, size = 0, pos = 0;;
+    int32_t i, size = 0, pos = 0;
     MYFLT ans;
 
     if (UNLIKELY(t->data == NULL))
@@ -2461,12 +2439,15 @@ static int32_t tabmax(CSOUND *csound, TABQUERY *p)
     /*      Str("array-variable not vector")); */
 
     for (i=0; i<t->dimensions; i++) size += t->sizes[i];
-    ans = t->data[0];
-    for (i=1; i<size; i++)
-      if (t->data[i]>ans) {
-        ans = t->data[i];
+    ans = size > 1 ? aops_simd_kernels()->max(t->data, size) : t->data[0];
+    /* the first element with that value, as it may be a zero of the
+       other sign */
+    for (i=0; i<size; i++)
+      if (t->data[i] == ans) {
         pos = i;
+        break;
       }
+    ans = t->data[pos];
     *p->ans = ans;
     if (p->OUTOCOUNT>1) *p->pos = (MYFLT)pos;
     return OK;
@@ -2492,12 +2473,15 @@ static int32_t tabmin(CSOUND *csound, TABQUERY *p)
          &(p->h), Str("array-variable not a vector")); */
 
     for (i=0; i<t->dimensions; i++) size += t->sizes[i];
-    ans = t->data[0];
-    for (i=1; i<size; i++)
-      if (t->data[i]<ans) {
-        ans = t->data[i];
+    ans = size > 1 ? aops_simd_kernels()->min(t->data, size) : t->data[0];
+    /* the first element with that value, as it may be a zero of the
+       other sign */
+    for (i=0; i<size; i++)
+      if (t->data[i] == ans) {
         pos = i;
+        break;
       }
+    ans = t->data[pos];
     *p->ans = ans;
     if (p->OUTOCOUNT>1) *p->pos = (MYFLT)pos;
     return OK;
@@ -2535,11 +2519,10 @@ static int32_t tabsuma(CSOUND *csound, TABQUERY1 *p)
            sizeof(MYFLT)*nsmps);
     for (i=0; i<t->dimensions; i++) size += t->sizes[i];
     for (i=1; i<size; i++) {
-      int j, k = i*span;
+      int k = i*span;
       in = &(t->data[k]);
-      for(j=offset; j < nsmps; j++)
-        ans[j] += in[j];
-        }
+      tab_aa(AOPS_ADD, ans, ans, in, offset, nsmps);
+    }
     return OK;
 }
 
@@ -2555,10 +2538,8 @@ static int32_t tabsum(CSOUND *csound, TABQUERY1 *p)
     if (UNLIKELY(t->dimensions!=1))
       return csound->PerfError(csound, &(p->h),
                                Str("array-variable not a vector"));
-    ans = t->data[0];
     for (i=0; i<t->dimensions; i++) size += t->sizes[i];
-    for (i=1; i<size; i++)
-      ans += t->data[i];
+    ans = size > 1 ? aops_simd_kernels()->sum(t->data, size) : t->data[0];
     *p->ans = ans;
     return OK;
 }
@@ -2647,6 +2628,27 @@ static int32_t get_array_total_size(ARRAYDAT* dat)
     return size;
 }
 
+/* give dst the shape of src; its data is only reallocated to grow, see
+   tabgrow() */
+static void tabcopy_resize(CSOUND *csound, ARRAYDAT *dst, ARRAYDAT *src,
+                           int32_t arrayTotalSize)
+{
+    size_t ss = src->arrayMemberSize * (size_t) arrayTotalSize;
+
+    if (dst->sizes == NULL || dst->dimensions != src->dimensions)
+      dst->sizes = csound->ReAlloc(csound, dst->sizes,
+                                   sizeof(int32_t) * src->dimensions);
+    dst->dimensions = src->dimensions;
+    memcpy(dst->sizes, src->sizes, sizeof(int32_t) * src->dimensions);
+
+    if (dst->data == NULL) {
+      dst->data = csound->Calloc(csound, ss);
+      dst->allocated = ss;
+    }
+    else if (ss > dst->allocated)
+      tabgrow(csound, dst, ss);
+}
+
 static int32_t tabcopy(CSOUND *csound, TABCPY *p)
 {
     int32_t i, arrayTotalSize, memMyfltSize;
@@ -2667,22 +2669,8 @@ static int32_t tabcopy(CSOUND *csound, TABCPY *p)
     memMyfltSize = p->src->arrayMemberSize / sizeof(MYFLT);
     p->dst->arrayMemberSize = p->src->arrayMemberSize;
 
-    if (arrayTotalSize != get_array_total_size(p->dst)) {
-      p->dst->dimensions = p->src->dimensions;
-
-      p->dst->sizes = csound->Malloc(csound, sizeof(int32_t) * p->src->dimensions);
-      memcpy(p->dst->sizes, p->src->sizes, sizeof(int32_t) * p->src->dimensions);
-
-      if (p->dst->data == NULL) {
-        p->dst->data = csound->Calloc(csound,
-                                      p->src->arrayMemberSize * arrayTotalSize);
-        p->dst->allocated = p->src->arrayMemberSize * arrayTotalSize;
-      } else {
-        p->dst->data = csound->ReAlloc(csound, p->dst->data,
-                        p->src->arrayMemberSize * arrayTotalSize);
-        memset(p->dst->data, 0, p->src->arrayMemberSize * arrayTotalSize);
-      }
-    }
+    if (arrayTotalSize != get_array_total_size(p->dst))
+      tabcopy_resize(csound, p->dst, p->src, arrayTotalSize);
 
     for (i = 0; i < arrayTotalSize; i++) {
       int32_t index = (i * memMyfltSize);
@@ -2713,22 +2701,8 @@ static int32_t tabcopy1(CSOUND *csound, TABCPY *p)
     memMyfltSize = p->src->arrayMemberSize / sizeof(MYFLT);
     p->dst->arrayMemberSize = p->src->arrayMemberSize;
 
-    if (arrayTotalSize != get_array_total_size(p->dst)) {
-      p->dst->dimensions = p->src->dimensions;
-
-      p->dst->sizes = csound->Malloc(csound, sizeof(int32_t) * p->src->dimensions);
-      memcpy(p->dst->sizes, p->src->sizes, sizeof(int32_t) * p->src->dimensions);
-
-      if (p->dst->data == NULL) {
-        p->dst->data = csound->Calloc(csound,
-                                      p->src->arrayMemberSize * arrayTotalSize);
-        p->dst->allocated = p->src->arrayMemberSize * arrayTotalSize;
-      } else {
-        p->dst->data = csound->ReAlloc(csound, p->dst->data,
-                        p->src->arrayMemberSize * arrayTotalSize);
-        memset(p->dst->data, 0, p->src->arrayMemberSize * arrayTotalSize);
-      }
-    }
+    if (arrayTotalSize != get_array_total_size(p->dst))
+      tabcopy_resize(csound, p->dst, p->src, arrayTotalSize);
 
 
     for (i = 0; i < arrayTotalSize; i++) {
@@ -2765,22 +2739,8 @@ static int32_t tabcopy2(CSOUND *csound, TABCPY *p)
     arrayTotalSize = get_array_total_size(p->src);
     p->dst->arrayMemberSize = p->src->arrayMemberSize;
 
-    if (arrayTotalSize != get_array_total_size(p->dst)) {
-      p->dst->dimensions = p->src->dimensions;
-
-      p->dst->sizes = csound->Malloc(csound, sizeof(int32_t) * p->src->dimensions);
-      memcpy(p->dst->sizes, p->src->sizes, sizeof(int32_t) * p->src->dimensions);
-
-      if (p->dst->data == NULL) {
-        p->dst->data = csound->Calloc(csound,
-                                      p->src->arrayMemberSize * arrayTotalSize);
-        p->dst->allocated = p->src->arrayMemberSize * arrayTotalSize;
-      } else {
-        p->dst->data = csound->ReAlloc(csound, p->dst->data,
-                        p->src->arrayMemberSize * arrayTotalSize);
-        memset(p->dst->data, 0, p->src->arrayMemberSize * arrayTotalSize);
-      }
-    }
+    if (arrayTotalSize != get_array_total_size(p->dst))
+      tabcopy_resize(csound, p->dst, p->src, arrayTotalSize);
     dest = (MYFLT*)p->dst->data;
     src = (MYFLT*)p->src->data;
     for (i=0;i<p->dst->dimensions; i++) {
@@ -3854,10 +3814,12 @@ static inline void tabensure2D(CSOUND *csound, ARRAYDAT *p,
       ss = p->arrayMemberSize*rows*columns;
       if (p->data==NULL) {
         p->data = (MYFLT*)csound->Calloc(csound, ss);
+        p->allocated = ss;
         p->dimensions = 2;
         p->sizes = (int32_t*)csound->Malloc(csound, sizeof(int32_t)*2);
       }
-      else p->data = (MYFLT*) csound->ReAlloc(csound, p->data, ss);
+      else if (ss > p->allocated)
+        tabgrow(csound, p, ss);
       p->sizes[0] = rows;  p->sizes[1] = columns;
     }
 }
@@ -35,6 +35,7 @@ typedef struct {
     MYFLT   *iSkipSamples;
     MYFLT   *iTotLen;
     MYFLT   *iSkipInit;
+    MYFLT   *iTailLen;
  /* ------------------------- */
     int32_t     initDone;
     int32_t     nChannels;
@@ -48,68 +49,52 @@ typedef struct {
     MYFLT   *outBuffers[FTCONV_MAXCHN]; /* output buffer (size=partSize*2)  */
     void  *fwdsetup, *invsetup;
     AUXCH   auxData;
+ /* non-uniform mode: the IR past the head partitions is convolved in  */
+ /* tailSize blocks on a worker thread, one tail block behind          */
+    int32_t     tailSize;       /* tail partition length, 0: uniform mode   */
+    int32_t     tailParts;      /* number of tail partitions                */
+    int32_t     tailCnt;        /* tail block position, 0 to tailSize - 1   */
+    int32_t     tailRbCnt;      /* tail ring buffer index (worker only)     */
+    int32_t     tailRd;         /* tailOut half being played                */
+    int32_t     tailMisses;     /* blocks the audio thread had to wait for  */
+    int32_t     tailCallback;   /* deinit callback registered               */
+    volatile long tailPosted;   /* tail blocks handed to the worker         */
+    volatile long tailDone;     /* tail blocks finished by the worker       */
+    volatile long tailRunning;
+    MYFLT   *tailTmp;
+    MYFLT   *tailRing;
+    MYFLT   *tailIn[2];         /* input blocks, filled / being convolved   */
+    MYFLT   *tailIR[FTCONV_MAXCHN];
+    MYFLT   *tailOut[2][FTCONV_MAXCHN];     /* played / being written       */
+    MYFLT   *tailOvl[FTCONV_MAXCHN];        /* second half of last IFFT     */
+    void    *tailFwd, *tailInv;
+    void    *tailThread, *tailWake, *tailReady;
+    AUXCH   tailData;
 } FTCONV;
 
-static void multiply_fft_buffers(MYFLT *outBuf, MYFLT *ringBuf,
-                                 MYFLT *IR_Data, int32_t partSize,
-                                 int32_t nPartitions,
+static void multiply_fft_buffers(CSOUND *csound, MYFLT *outBuf,
+                                 MYFLT *ringBuf, MYFLT *IR_Data,
+                                 int32_t partSize, int32_t nPartitions,
                                  int32_t ringBuf_startPos)
 {
-    MYFLT   re, im, re1, re2, im1, im2;
-    MYFLT   *rbPtr, *irPtr, *outBufPtr, *outBufEndPm2, *rbEndP;
+    MYFLT   *rbPtr, *irPtr, *rbEndP;
 
     /* note: partSize must be at least 2 samples */
     partSize <<= 1;
-    outBufEndPm2 = (MYFLT*) outBuf + (int32_t) (partSize - 2);
     rbEndP = (MYFLT*) ringBuf + (int32_t) (partSize * nPartitions);
     rbPtr = &(ringBuf[ringBuf_startPos]);
     irPtr = IR_Data;
-    //outBufPtr = outBuf;
     /* clear output buffer to zero */
     memset(outBuf, 0, sizeof(MYFLT)*(partSize));
-    /* do { */
-    /*   *(outBufPtr++) = FL(0.0); */
-    /*   *(outBufPtr++) = FL(0.0); */
-    /* } while (outBufPtr <= outBufEndPm2); */
     /* multiply FFTs for each partition, and mix to output buffer */
     /* note: IRs are stored in reverse partition order */
     do {
       /* wrap ring buffer position */
       if (rbPtr >= rbEndP)
         rbPtr = ringBuf;
-      outBufPtr = outBuf;
-      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);    /* convolve DC */
-      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);    /* convolve Nyquist */
-      re1 = *(rbPtr++);
-      im1 = *(rbPtr++);
-      re2 = *(irPtr++);
-      im2 = *(irPtr++);
-      re = re1 * re2 - im1 * im2;
-      im = re1 * im2 + re2 * im1;
-      while (outBufPtr < outBufEndPm2) {
-        /* complex multiply */
-        re1 = rbPtr[0];
-        im1 = rbPtr[1];
-        re2 = irPtr[0];
-        im2 = irPtr[1];
-        outBufPtr[0] += re;
-        outBufPtr[1] += im;
-        re = re1 * re2 - im1 * im2;
-        im = re1 * im2 + re2 * im1;
-        re1 = rbPtr[2];
-        im1 = rbPtr[3];
-        re2 = irPtr[2];
-        im2 = irPtr[3];
-        outBufPtr[2] += re;
-        outBufPtr[3] += im;
-        re = re1 * re2 - im1 * im2;
-        im = re1 * im2 + re2 * im1;
-        outBufPtr += 4;
-        rbPtr += 4;
-        irPtr += 4;
-      }
-      outBufPtr[0] += re;
-      outBufPtr[1] += im;
+      csound->RealFFTMultAcc(csound, outBuf, rbPtr, irPtr, partSize);
+      rbPtr += partSize;
+      irPtr += partSize;
     } while (--nPartitions);
 }
 
@@ -148,10 +133,203 @@ static void set_buf_pointers(FTCONV *p,
     }
 }
 
+static inline int32_t tail_bytes_alloc(int32_t nChannels,
+                                       int32_t tailSize, int32_t tailParts)
+{
+    int32_t nSmps;
+
+    nSmps = (tailSize << 1);                                /* tailTmp    */
+    nSmps += ((tailSize << 1) * tailParts);                 /* tailRing   */
+    nSmps += (tailSize << 1);                               /* tailIn     */
+    nSmps += ((tailSize << 1) * nChannels * tailParts);     /* tailIR     */
+    nSmps += ((tailSize << 1) * nChannels);                 /* tailOut    */
+    nSmps += (tailSize * nChannels);                        /* tailOvl    */
+
+    return ((int32_t) sizeof(MYFLT) * nSmps);
+}
+
+static void set_tail_pointers(FTCONV *p, int32_t nChannels,
+                              int32_t tailSize, int32_t tailParts)
+{
+    MYFLT *ptr;
+    int32_t   i;
+
+    ptr = (MYFLT*) (p->tailData.auxp);
+    p->tailTmp = ptr;
+    ptr += (tailSize << 1);
+    p->tailRing = ptr;
+    ptr += ((tailSize << 1) * tailParts);
+    p->tailIn[0] = ptr;
+    p->tailIn[1] = ptr + tailSize;
+    ptr += (tailSize << 1);
+    for (i = 0; i < nChannels; i++) {
+      p->tailIR[i] = ptr;
+      ptr += ((tailSize << 1) * tailParts);
+    }
+    for (i = 0; i < nChannels; i++) {
+      p->tailOut[0][i] = ptr;
+      p->tailOut[1][i] = ptr + tailSize;
+      ptr += (tailSize << 1);
+    }
+    for (i = 0; i < nChannels; i++) {
+      p->tailOvl[i] = ptr;
+      ptr += tailSize;
+    }
+}
+
+/* calculate FFT of impulse response partitions, in reverse order, */
+/* reading channel chn of the table from sample frame 'start';     */
+/* frames at or beyond 'end' are taken as zero                     */
+
+static void load_ir_partitions(CSOUND *csound, FUNC *ftp, MYFLT *irData,
+                               void *fwdsetup, int32_t chn, int32_t nChannels,
+                               int32_t start, int32_t end,
+                               int32_t partSize, int32_t nPartitions)
+{
+    int32_t i, k, n, frm;
+
+    i = (start * nChannels) + chn;                  /* table read position */
+    frm = start;
+    n = (partSize << 1) * (nPartitions - 1);        /* IR write position */
+    do {
+      for (k = 0; k < partSize; k++, frm++) {
+        if (i >= 0 && i < (int32_t) ftp->flen && frm < end)
+          irData[n + k] = ftp->ftable[i];
+        else
+          irData[n + k] = FL(0.0);
+        i += nChannels;
+      }
+      /* pad second half of IR to zero */
+      for (k = partSize; k < (partSize << 1); k++)
+        irData[n + k] = FL(0.0);
+      /* calculate FFT */
+      csound->RealFFT2(csound, fwdsetup, &(irData[n]));
+      n -= (partSize << 1);
+    } while (n >= 0);
+}
+
+/* convolve tail block k: runs on the worker thread, or inline if */
+/* there is none                                                  */
+
+static void ftconv_tail_block(CSOUND *csound, FTCONV *p, long k)
+{
+    MYFLT   *rBuf, *out, *x;
+    int32_t i, n, rBufPos, nSamples = p->tailSize;
+
+    rBuf = &(p->tailRing[p->tailRbCnt * (nSamples << 1)]);
+    memcpy(rBuf, p->tailIn[k & 1], nSamples * sizeof(MYFLT));
+    memset(rBuf + nSamples, 0, nSamples * sizeof(MYFLT));
+    csound->RealFFT2(csound, p->tailFwd, rBuf);
+    if (++p->tailRbCnt >= p->tailParts)
+      p->tailRbCnt = 0;
+    rBufPos = p->tailRbCnt * (nSamples << 1);
+    for (n = 0; n < p->nChannels; n++) {
+      multiply_fft_buffers(csound, p->tailTmp, p->tailRing, p->tailIR[n],
+                           nSamples, p->tailParts, rBufPos);
+      csound->RealFFT2(csound, p->tailInv, p->tailTmp);
+      out = p->tailOut[k & 1][n];
+      x = p->tailOvl[n];
+      for (i = 0; i < nSamples; i++) {
+        out[i] = p->tailTmp[i] + x[i];
+        x[i] = p->tailTmp[i + nSamples];
+      }
+    }
+}
+
+static uintptr_t ftconv_tail_thread(void *data)
+{
+    FTCONV  *p = (FTCONV*) data;
+    CSOUND  *csound = p->h.insdshead->csound;
+    long    k;
+
+    for (;;) {
+      csound->WaitThreadLockNoTimeout(p->tailWake);
+      while ((k = ATOMIC_GET(p->tailDone)) < ATOMIC_GET(p->tailPosted)) {
+        ftconv_tail_block(csound, p, k);
+        ATOMIC_INCR(p->tailDone);
+        csound->NotifyThreadLock(p->tailReady);
+      }
+      if (!ATOMIC_GET(p->tailRunning))
+        break;
+    }
+    return 0;
+}
+
+/* a complete tail input block: the output of the previous one is */
+/* due now, then the worker gets this one                         */
+
+static void ftconv_tail_post(CSOUND *csound, FTCONV *p)
+{
+    long    k = p->tailPosted;
+
+    if (p->tailThread == NULL) {
+      ftconv_tail_block(csound, p, k);
+      p->tailDone = k + 1;
+    }
+    else if (UNLIKELY(ATOMIC_GET(p->tailDone) < k)) {
+      p->tailMisses++;
+      do {
+        csound->WaitThreadLockNoTimeout(p->tailReady);
+      } while (ATOMIC_GET(p->tailDone) < k);
+    }
+    p->tailRd = (int32_t) ((k - 1) & 1);
+    ATOMIC_INCR(p->tailPosted);
+    if (p->tailThread != NULL)
+      csound->NotifyThreadLock(p->tailWake);
+}
+
+static void ftconv_tail_stop(CSOUND *csound, FTCONV *p)
+{
+    if (p->tailThread == NULL)
+      return;
+    ATOMIC_SET(p->tailRunning, 0);
+    csound->NotifyThreadLock(p->tailWake);
+    csound->JoinThread(p->tailThread);
+    csound->DestroyThreadLock(p->tailWake);
+    csound->DestroyThreadLock(p->tailReady);
+    p->tailThread = p->tailWake = p->tailReady = NULL;
+    /* offline rendering runs ahead of the worker, only report rt */
+    if (p->tailMisses && csound->oparms->realtime)
+      csound->Warning(csound, Str("ftconv: tail convolution was late "
+                                  "for %d blocks"), p->tailMisses);
+    p->tailMisses = 0;
+}
+
+static int32_t ftconv_deinit(CSOUND *csound, void *pp)
+{
+    FTCONV  *p = (FTCONV*) pp;
+
+    p->tailCallback = 0;
+    ftconv_tail_stop(csound, p);
+    return OK;
+}
+
+static void ftconv_tail_start(CSOUND *csound, FTCONV *p)
+{
+    if (p->tailSize == 0 || p->tailThread != NULL)
+      return;
+    p->tailWake = csound->CreateThreadLock();
+    p->tailReady = csound->CreateThreadLock();
+    p->tailRunning = 1;
+    if (p->tailWake != NULL && p->tailReady != NULL)
+      p->tailThread = csound->CreateThread(ftconv_tail_thread, (void*) p);
+    if (p->tailThread == NULL) {
+      /* no worker: convolve the tail inline */
+      if (p->tailWake != NULL) csound->DestroyThreadLock(p->tailWake);
+      if (p->tailReady != NULL) csound->DestroyThreadLock(p->tailReady);
+      p->tailWake = p->tailReady = NULL;
+      return;
+    }
+    if (!p->tailCallback) {
+      csound->RegisterDeinitCallback(csound, (void*) p, ftconv_deinit);
+      p->tailCallback = 1;
+    }
+}
+
 static int32_t ftconv_init(CSOUND *csound, FTCONV *p)
 {
     FUNC    *ftp;
-    int32_t     i, j, k, n, nBytes, skipSamples;
+    int32_t     i, j, n, nBytes, tBytes, skipSamples, irLen, headParts;
     //MYFLT   FFTscale;
 
     /* check parameters */
@@ -165,6 +343,14 @@ static int32_t ftconv_init(CSOUND *csound, FTCONV *p)
       return csound->InitError(csound, Str("ftconv: invalid impulse response "
                                            "partition length"));
     }
+    /* tail partition length: 0 for uniform partitioning */
+    p->tailSize = MYFLT2LRND(*(p->iTailLen));
+    if (UNLIKELY(p->tailSize != 0 &&
+                 (p->tailSize < p->partSize ||
+                  (p->tailSize & (p->tailSize - 1)) != 0))) {
+      return csound->InitError(csound, Str("ftconv: invalid tail "
+                                           "partition length"));
+    }
     ftp = csound->FTnp2Finde(csound, p->iFTNum);
     if (UNLIKELY(ftp == NULL))
       return NOTOK; /* ftfind should already have printed the error message */
@@ -180,12 +366,37 @@ static int32_t ftconv_init(CSOUND *csound, FTCONV *p)
                                    " IR data for convolution"));
     }
     p->nPartitions = (n + (p->partSize - 1)) / p->partSize;
+    irLen = p->nPartitions * p->partSize;
+    /* non-uniform: the tail is heard 2 * tailSize late, so the head */
+    /* covers the first 2 * tailSize - partSize frames of the IR     */
+    headParts = p->nPartitions;
+    p->tailParts = 0;
+    if (p->tailSize) {
+      headParts = ((p->tailSize << 1) - p->partSize) / p->partSize;
+      if (headParts >= p->nPartitions) {
+        headParts = p->nPartitions;         /* short IR: no tail needed */
+        p->tailSize = 0;
+      }
+      else
+        p->tailParts = (irLen - headParts * p->partSize
+                        + (p->tailSize - 1)) / p->tailSize;
+    }
+    p->nPartitions = headParts;
     /* calculate the amount of aux space to allocate (in bytes) */
     nBytes = buf_bytes_alloc(p->nChannels, p->partSize, p->nPartitions);
+    tBytes = (p->tailSize ?
+              tail_bytes_alloc(p->nChannels, p->tailSize, p->tailParts) : 0);
+    if (p->initDone > 0 && *(p->iSkipInit) != FL(0.0) &&
+        nBytes == (int32_t) p->auxData.size &&
+        tBytes == (int32_t) p->tailData.size) {
+      ftconv_tail_start(csound, p);
+      return OK;    /* skip initialisation if requested */
+    }
+    ftconv_tail_stop(csound, p);
     if (nBytes != (int32_t) p->auxData.size)
       csound->AuxAlloc(csound, (int32) nBytes, &(p->auxData));
-    else if (p->initDone > 0 && *(p->iSkipInit) != FL(0.0))
-      return OK;    /* skip initialisation if requested */
+    if (tBytes && tBytes != (int32_t) p->tailData.size)
+      csound->AuxAlloc(csound, (int32) tBytes, &(p->tailData));
     /* if skipping samples: check for possible truncation of IR */
     /*
       if (skipSamples > 0 && (csound->oparms->msglevel & WARNMSG)) {
@@ -216,31 +427,38 @@ static int32_t ftconv_init(CSOUND *csound, FTCONV *p)
     //FFTscale = csound->GetInverseRealFFTScale(csound, (p->partSize << 1));
     p->fwdsetup = csound->RealFFT2Setup(csound,(p->partSize << 1), FFT_FWD);
     p->invsetup = csound->RealFFT2Setup(csound,(p->partSize << 1), FFT_INV);
-    for (j = 0; j < p->nChannels; j++) {
-      i = (skipSamples * p->nChannels) + j;           /* table read position */
-      n = (p->partSize << 1) * (p->nPartitions - 1);  /* IR write position */
-      do {
-        for (k = 0; k < p->partSize; k++) {
-          if (i >= 0 && i < (int32_t) ftp->flen)
-            p->IR_Data[j][n + k] = ftp->ftable[i];// * FFTscale;
-          else
-            p->IR_Data[j][n + k] = FL(0.0);
-          i += p->nChannels;
-        }
-        /* pad second half of IR to zero */
-        for (k = p->partSize; k < (p->partSize << 1); k++)
-          p->IR_Data[j][n + k] = FL(0.0);
-        /* calculate FFT */
-        csound->RealFFT2(csound, p->fwdsetup, &(p->IR_Data[j][n]));
-        n -= (p->partSize << 1);
-      } while (n >= 0);
-    }
+    for (j = 0; j < p->nChannels; j++)
+      load_ir_partitions(csound, ftp, p->IR_Data[j], p->fwdsetup,
+                         j, p->nChannels, skipSamples, skipSamples + irLen,
+                         p->partSize, p->nPartitions);
     /* clear output buffers to zero */
     /*memset(p->outBuffers, 0, p->nChannels*(p->partSize << 1)*sizeof(MYFLT));*/
     for (j = 0; j < p->nChannels; j++) {
       for (i = 0; i < (p->partSize << 1); i++)
         p->outBuffers[j][i] = FL(0.0);
     }
+    if (p->tailSize) {
+      /* tail: same layout with tailSize partitions, starting where */
+      /* the head partitions end                                    */
+      set_tail_pointers(p, p->nChannels, p->tailSize, p->tailParts);
+      memset(p->tailData.auxp, 0, p->tailData.size);
+      p->tailCnt = p->tailRbCnt = 0;
+      p->tailRd = 1;                /* tailOut[1]: silence until due */
+      p->tailPosted = p->tailDone = 0;
+      p->tailMisses = 0;
+      p->tailFwd = csound->RealFFT2Setup(csound, (p->tailSize << 1), FFT_FWD);
+      p->tailInv = csound->RealFFT2Setup(csound, (p->tailSize << 1), FFT_INV);
+      for (j = 0; j < p->nChannels; j++)
+        load_ir_partitions(csound, ftp, p->tailIR[j], p->tailFwd,
+                           j, p->nChannels,
+                           skipSamples + p->nPartitions * p->partSize,
+                           skipSamples + irLen, p->tailSize, p->tailParts);
+      /* one inverse transform here, so the worker finds every table */
+      /* it uses already built                                       */
+      csound->RealFFT2(csound, p->tailInv, p->tailTmp);
+      memset(p->tailTmp, 0, (p->tailSize << 1) * sizeof(MYFLT));
+      ftconv_tail_start(csound, p);
+    }
     p->initDone = 1;
 
     return OK;
@@ -271,6 +489,16 @@ static int32_t ftconv_perf(CSOUND *csound, FTCONV *p)
       /* copy output signals from buffer */
       for (n = 0; n < p->nChannels; n++)
         p->aOut[n][nn] = p->outBuffers[n][p->cnt];
+      if (p->tailSize) {
+        /* mix in the tail and feed its input block */
+        for (n = 0; n < p->nChannels; n++)
+          p->aOut[n][nn] += p->tailOut[p->tailRd][n][p->tailCnt];
+        p->tailIn[p->tailPosted & 1][p->tailCnt] = p->aIn[nn];
+        if (++p->tailCnt >= p->tailSize) {
+          p->tailCnt = 0;
+          ftconv_tail_post(csound, p);
+        }
+      }
       /* is input buffer full ? */
       if (++p->cnt < nSamples)
         continue;                   /* no, continue with next sample */
@@ -289,7 +517,7 @@ static int32_t ftconv_perf(CSOUND *csound, FTCONV *p)
       /* for each channel: */
       for (n = 0; n < p->nChannels; n++) {
         /* multiply complex arrays */
-        multiply_fft_buffers(p->tmpBuf, p->ringBuf, p->IR_Data[n],
+        multiply_fft_buffers(csound, p->tmpBuf, p->ringBuf, p->IR_Data[n],
                              nSamples, p->nPartitions, rBufPos);
         /* inverse FFT */
         csound->RealFFT2(csound, p->invsetup, p->tmpBuf);
@@ -313,7 +541,7 @@ int32_t ftconv_init_(CSOUND *csound)
 {
     return csound->AppendOpcode(csound, "ftconv",
                                 (int32_t) sizeof(FTCONV), TR, 3,
-                                "mmmmmmmm", "aiiooo",
+                                "mmmmmmmm", "aiioooo",
                                 (int32_t (*)(CSOUND *, void *)) ftconv_init,
                                 (int32_t (*)(CSOUND *, void *)) ftconv_perf,
                                 NULL);
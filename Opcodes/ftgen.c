@@ -42,6 +42,11 @@ typedef struct {
     int32_t fno;
 } FTDELETE;
 
+typedef struct {
+    OPDS    h;
+    MYFLT   *kr, *kfn;
+} FTREADY;
+
 typedef struct namedgen {
     char    *name;
     int32_t genum;
@@ -69,7 +74,8 @@ static int32_t register_ftable_delete(CSOUND *csound, void *p, int32_t tableNum)
 }
 
 /* set up and call any GEN routine */
-static int32_t ftgen_(CSOUND *csound, FTGEN *p, int32_t istring1, int32_t istring2)
+static int32_t ftgen_(CSOUND *csound, FTGEN *p, int32_t istring1, int32_t istring2,
+                      int32_t async)
 {
     MYFLT   *fp;
     FUNC    *ftp;
@@ -138,6 +144,14 @@ static int32_t ftgen_(CSOUND *csound, FTGEN *p, int32_t istring1, int32_t istrin
         *fp++ = **argp++;                               /* copy rem arglist */
       } while (--n);
     }
+    if (async) {                        /* GEN runs on another thread */
+      n = csound->hfgensAsync(csound, ftevt, 1);
+      csound->Free(csound, ftevt);
+      if (UNLIKELY(n < 0))
+        return csound->InitError(csound, Str("ftgen error"));
+      *p->ifno = (MYFLT) n;
+      return OK;
+    }
     n = csound->hfgens(csound, &ftp, ftevt, 1);         /* call the fgen */
     csound->Free(csound, ftevt);
     if (UNLIKELY(n != 0))
@@ -148,19 +162,47 @@ static int32_t ftgen_(CSOUND *csound, FTGEN *p, int32_t istring1, int32_t istrin
 }
 
 static int32_t ftgen(CSOUND *csound, FTGEN *p) {
-    return ftgen_(csound,p,0,0);
+    return ftgen_(csound, p, 0, 0, 0);
 }
 
 static int32_t ftgen_S(CSOUND *csound, FTGEN *p) {
-    return ftgen_(csound,p,1,0);
+    return ftgen_(csound, p, 1, 0, 0);
 }
 
 static int32_t ftgen_iS(CSOUND *csound, FTGEN *p) {
-    return ftgen_(csound,p,0,1);
+    return ftgen_(csound, p, 0, 1, 0);
 }
 
 static int32_t ftgen_SS(CSOUND *csound, FTGEN *p) {
-    return ftgen_(csound,p,1,1);
+    return ftgen_(csound, p, 1, 1, 0);
+}
+
+/* ftgenasync: the table is made in the background and replaces any
+   previous version when it is ready, see ftready */
+
+static int32_t ftgenasync(CSOUND *csound, FTGEN *p) {
+    return ftgen_(csound, p, 0, 0, 1);
+}
+
+static int32_t ftgenasync_S(CSOUND *csound, FTGEN *p) {
+    return ftgen_(csound, p, 1, 0, 1);
+}
+
+static int32_t ftgenasync_iS(CSOUND *csound, FTGEN *p) {
+    return ftgen_(csound, p, 0, 1, 1);
+}
+
+static int32_t ftgenasync_SS(CSOUND *csound, FTGEN *p) {
+    return ftgen_(csound, p, 1, 1, 1);
+}
+
+/* 1 when the table exists and is not being made, 0 while ftgenasync is
+   making it, -1 if there is no such table */
+
+static int32_t ftready(CSOUND *csound, FTREADY *p)
+{
+    *p->kr = (MYFLT) csound->FTReady(csound, (int) MYFLT2LRND(*p->kfn));
+    return OK;
 }
 
 static int32_t ftgentmp(CSOUND *csound, FTGEN *p)
@@ -181,7 +223,7 @@ static int32_t ftgentmp_S(CSOUND *csound, FTGEN *p)
 {
     int32_t   p1, fno;
 
-    if (UNLIKELY(ftgen_(csound, p,0,1) != OK))
+    if (UNLIKELY(ftgen_(csound, p, 0, 1, 0) != OK))
       return NOTOK;
     p1 = (int32_t) MYFLT2LRND(*p->p1);
     if (p1)
@@ -194,7 +236,7 @@ static int32_t ftgentmp_Si(CSOUND *csound, FTGEN *p)
 {
     int32_t   p1, fno;
 
-    if (UNLIKELY(ftgen_(csound, p,1,0) != OK))
+    if (UNLIKELY(ftgen_(csound, p, 1, 0, 0) != OK))
       return NOTOK;
     p1 = (int32_t) MYFLT2LRND(*p->p1);
     if (p1)
@@ -207,7 +249,7 @@ static int32_t ftgentmp_SS(CSOUND *csound, FTGEN *p)
 {
     int32_t   p1, fno;
 
-    if (UNLIKELY(ftgen_(csound, p,1,1) != OK))
+    if (UNLIKELY(ftgen_(csound, p, 1, 1, 0) != OK))
       return NOTOK;
     p1 = (int32_t) MYFLT2LRND(*p->p1);
     if (p1)
@@ -693,6 +735,16 @@ static OENTRY localops[] = {
   { "ftgen.SS",    S(FTGEN),  TW, 1,  "i",  "iiiSSm", (SUBR) ftgen_SS, NULL, NULL },
   { "ftgen",    S(FTGEN),     TW, 1,  "i",  "iiiii[]", (SUBR) ftgen_list_i, NULL  },
   { "ftgen",    S(FTGEN),     TW, 1,  "i",  "iiiSi[]", (SUBR) ftgen_list_S, NULL  },
+  { "ftgenasync",    S(FTGEN),  TW, 1, "i", "iiiiim", (SUBR) ftgenasync, NULL, NULL},
+  { "ftgenasync.S",  S(FTGEN),  TW, 1, "i", "iiiSim", (SUBR) ftgenasync_S,
+    NULL, NULL },
+  { "ftgenasync.iS", S(FTGEN),  TW, 1, "i", "iiiiSm", (SUBR) ftgenasync_iS,
+    NULL, NULL },
+  { "ftgenasync.SS", S(FTGEN),  TW, 1, "i", "iiiSSm", (SUBR) ftgenasync_SS,
+    NULL, NULL },
+  { "ftready.i", S(FTREADY),  TR, 1,  "i",  "i",      (SUBR) ftready, NULL, NULL  },
+  { "ftready.k", S(FTREADY),  TR, 3,  "k",  "k",      (SUBR) ftready, (SUBR) ftready,
+    NULL },
   { "ftgentmp.i", S(FTGEN),   TW, 1,  "i",  "iiiiim", (SUBR) ftgentmp, NULL, NULL },
   { "ftgentmp.iS", S(FTGEN),  TW, 1,  "i",  "iiiiSm", (SUBR) ftgentmp_S, NULL,NULL},
   { "ftgentmp.Si", S(FTGEN),  TW, 1,  "i",  "iiiSim", (SUBR) ftgentmp_Si,NULL,NULL},
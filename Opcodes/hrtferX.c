@@ -67,11 +67,28 @@ static const int32_t elevation_data[N_ELEV] = {56, 60, 72, 72, 72, 72, 72,
 #define ROUND(x) ((int32_t)floor((x)+FL(0.5)))
 #define GET_NFAZ(el_index)      ((elevation_data[el_index] / 2) + 1)
 
+/* the data set is big-endian: byte reverse it once, on loading */
+static int32_t hrtf_swap2bytes(CSOUND *csound, MEMFIL *mfp)
+{
+    int32_t bytrev_test = 0x1234;
+    IGN(csound);
+    if (*((unsigned char*) &bytrev_test) == (unsigned char) 0x34) {
+      int16 *x = (int16*) mfp->beginp;
+      int32 len = (mfp->length)/sizeof(int16);
+      while (len != 0) {
+        int16 v = *x;
+        v = ((v & 0xFF) << 8) + ((v >> 8) & 0xFF);  /* Swap bytes */
+        *x = v;
+        x++; len--;
+      }
+    }
+    return OK;
+}
+
 static int32_t hrtferxkSet(CSOUND *csound, HRTFER *p)
 {
     // int32_t    i; /* standard loop counter */
     char   filename[MAXNAME];
-    int32_t    bytrev_test;
     MEMFIL *mfp;
 
         /* first check if orchestra's sampling rate is compatible with HRTF
@@ -94,21 +111,12 @@ static int32_t hrtferxkSet(CSOUND *csound, HRTFER *p)
     }
 
     if ((mfp = p->mfp) == NULL)
-      mfp = csound->ldmemfile2withCB(csound, filename, CSFTYPE_HRTF, NULL);
+      mfp = csound->ldmemfile2withCB(csound, filename, CSFTYPE_HRTF,
+                                     hrtf_swap2bytes);
+    if (UNLIKELY(mfp == NULL))
+      return csound->InitError(csound, Str("hrtfer: cannot load %s"), filename);
     p->mfp = mfp;
     p->fpbegin = (int16*) mfp->beginp;
-    bytrev_test = 0x1234;
-    if (*((unsigned char*) &bytrev_test) == (unsigned char) 0x34) {
-      /* Byte reverse on data set if necessary */
-      int16 *x = p->fpbegin;
-      int32 len = (mfp->length)/sizeof(int16);
-      while (len != 0) {
-        int16 v = *x;
-        v = ((v & 0xFF) << 8) + ((v >> 8) & 0xFF);  /* Swap bytes */
-        *x = v;
-        x++; len--;
-      }
-    }
         /* initialize counters and indices */
     p->outcount = 0;
     p->incount = 0;
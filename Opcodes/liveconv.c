@@ -128,22 +128,19 @@ typedef struct {
 **                       (corresponds to the start of the partition after the
 **                        last filled partition)
 */
-static void multiply_fft_buffers(MYFLT *outBuf, MYFLT *ringBuf, MYFLT *IR_Data,
+static void multiply_fft_buffers(CSOUND *csound, MYFLT *outBuf,
+                                 MYFLT *ringBuf, MYFLT *IR_Data,
                                  int32_t partSize, int nPartitions,
                                  int32_t ringBuf_startPos)
 {
-    MYFLT   re, im, re1, re2, im1, im2;
-    MYFLT   *rbPtr, *irPtr, *outBufPtr, *outBufEndPm2, *rbEndP;
+    MYFLT   *rbPtr, *irPtr, *rbEndP;
 
     /* note: partSize must be at least 2 samples */
     partSize <<= 1; /* locale partsize is twice the size of the partition size */
-             /* Finding the index of the last sample pair in the output buffer */
-    outBufEndPm2 = (MYFLT*) outBuf + (int32_t) (partSize - 2);
                                                  /* The end of the ring buffer */
     rbEndP = (MYFLT*) ringBuf + (int32_t) (partSize * nPartitions);
     rbPtr = &(ringBuf[ringBuf_startPos]);    /* Initialize ring buffer pointer */
     irPtr = IR_Data;                        /* Initialize impulse data pointer */
-    outBufPtr = outBuf;                    /* Initialize output buffer pointer */
 
     /* clear output buffer to zero */
     memset(outBuf, 0, sizeof(MYFLT)*partSize);
@@ -156,54 +153,10 @@ static void multiply_fft_buffers(MYFLT *outBuf, MYFLT *ringBuf, MYFLT *IR_Data,
       /* wrap ring buffer position */
       if (rbPtr >= rbEndP)
         rbPtr = ringBuf;
-      outBufPtr = outBuf;
-      *(outBufPtr++) +=
-        *(rbPtr++) * *(irPtr++); /* convolve DC - real part only */
-      *(outBufPtr++) +=
-        *(rbPtr++) * *(irPtr++); /* convolve Nyquist - real part only */
-      re1 = *(rbPtr++);
-      im1 = *(rbPtr++);
-      re2 = *(irPtr++);
-      im2 = *(irPtr++);
-
-      /*
-      ** Status:
-      ** outBuf + 2, ringBuf + 4, irBuf + 4
-      ** re = buf + 2, im = buf + 3
-      */
-
-      re = re1 * re2 - im1 * im2;
-      im = re1 * im2 + re2 * im1;
-      while (outBufPtr < outBufEndPm2) {
-        /* complex multiply */
-        re1 = rbPtr[0];
-        im1 = rbPtr[1];
-        re2 = irPtr[0];
-        im2 = irPtr[1];
-        outBufPtr[0] += re;
-        outBufPtr[1] += im;
-        re = re1 * re2 - im1 * im2;
-        im = re1 * im2 + re2 * im1;
-        re1 = rbPtr[2];
-        im1 = rbPtr[3];
-        re2 = irPtr[2];
-        im2 = irPtr[3];
-        outBufPtr[2] += re;
-        outBufPtr[3] += im;
-        re = re1 * re2 - im1 * im2;
-        im = re1 * im2 + re2 * im1;
-        outBufPtr += 4;
-        rbPtr += 4;
-        irPtr += 4;
-        /*
-        ** Status:
-        ** outBuf + 2 + 4n, ringBuf + 4 + 4n, irBuf + 4 + 4n
-        ** re = buf + 2 + 4n, im = buf + 3 + 4n
-        */
-      }
-      outBufPtr[0] += re;
-      outBufPtr[1] += im;
-
+      /* DC and Nyquist are real only, the rest complex (fftlib.c) */
+      csound->RealFFTMultAcc(csound, outBuf, rbPtr, irPtr, partSize);
+      rbPtr += partSize;
+      irPtr += partSize;
     } while (--nPartitions);
 }
 static inline int32_t buf_bytes_alloc(int32_t partSize, int32_t nPartitions)
@@ -479,7 +432,7 @@ static int32_t liveconv_perf(CSOUND *csound, liveconv_t *p)
       rBuf = &(p->ringBuf[rBufPos]);
 
       /* multiply complex arrays --> multiplication in the frequency domain */
-      multiply_fft_buffers(p->tmpBuf, p->ringBuf, p->IR_Data,
+      multiply_fft_buffers(csound, p->tmpBuf, p->ringBuf, p->IR_Data,
                            nSamples, p->nPartitions, rBufPos);
 
       /* inverse FFT */
@@ -35,11 +35,92 @@ typedef struct SNDLOAD_OPCODE_ {
     MYFLT   *iLoopMode1, *iLoopStart1, *iLoopEnd1;
 } SNDLOAD_OPCODE;
 
+/* Sampler parameters of a file loaded with csoundLoadSoundFile().  The
+   SNDMEMFILE may be shared with other instances and is read-only, so the
+   parameters sndload sets are kept here, one entry per file and instance. */
+
+typedef struct SNDLOAD_PARAMS_ {
+    struct SNDLOAD_PARAMS_ *nxt;
+    const SNDMEMFILE *sf;
+    int32_t loopMode;
+    double  startOffs, loopStart, loopEnd, baseFreq, scaleFac;
+} SNDLOAD_PARAMS;
+
+static void sndload_params_loop(SNDLOAD_PARAMS *prm)
+{
+    if (prm->loopMode < 2 || prm->loopStart == prm->loopEnd) {
+      prm->loopStart = 0.0;
+      prm->loopEnd = (double) ((int32) prm->sf->nFrames);
+    }
+    else if (prm->loopStart > prm->loopEnd) {
+      double  tmp = prm->loopStart;
+      prm->loopStart = prm->loopEnd;
+      prm->loopEnd = tmp;
+    }
+}
+
+/* the parameters of sf set by sndload, NULL if none unless create is set */
+
+static SNDLOAD_PARAMS *sndload_params_find(CSOUND *csound,
+                                           const SNDMEMFILE *sf, int create)
+{
+    SNDLOAD_PARAMS  **pp, *prm;
+
+    pp = (SNDLOAD_PARAMS**) csound->QueryGlobalVariable(csound,
+                                                        "sndloadParams_");
+    if (pp == NULL) {
+      if (!create ||
+          csound->CreateGlobalVariable(csound, "sndloadParams_",
+                                       sizeof(SNDLOAD_PARAMS*)) != 0)
+        return NULL;
+      pp = (SNDLOAD_PARAMS**) csound->QueryGlobalVariable(csound,
+                                                          "sndloadParams_");
+    }
+    for (prm = *pp; prm != NULL; prm = prm->nxt)
+      if (prm->sf == sf)
+        return prm;
+    if (!create)
+      return NULL;
+    prm = (SNDLOAD_PARAMS*) csound->Calloc(csound, sizeof(SNDLOAD_PARAMS));
+    prm->sf = sf;
+    prm->loopMode = sf->loopMode;
+    prm->startOffs = sf->startOffs;
+    prm->loopStart = sf->loopStart;
+    prm->loopEnd = sf->loopEnd;
+    prm->baseFreq = sf->baseFreq;
+    prm->scaleFac = sf->scaleFac;
+    prm->nxt = *pp;
+    *pp = prm;
+    return prm;
+}
+
+/* copies the parameters loscilx plays sf with into prm */
+
+static void sndload_params_get(CSOUND *csound, const SNDMEMFILE *sf,
+                               SNDLOAD_PARAMS *prm)
+{
+    SNDLOAD_PARAMS  *p = sndload_params_find(csound, sf, 0);
+
+    if (p != NULL) {
+      *prm = *p;
+      return;
+    }
+    prm->sf = sf;
+    prm->loopMode = sf->loopMode;
+    prm->startOffs = sf->startOffs;
+    prm->loopStart = sf->loopStart;
+    prm->loopEnd = sf->loopEnd;
+    prm->baseFreq = sf->baseFreq;
+    prm->scaleFac = sf->scaleFac;
+    sndload_params_loop(prm);
+}
+
 static int32_t sndload_opcode_init_(CSOUND *csound, SNDLOAD_OPCODE *p,
                                     int32_t isstring)
 {
     char        *fname;
     SNDMEMFILE  *sf;
+    SNDLOAD_PARAMS *prm;
     SF_INFO     sfinfo;
     int32_t         sampleFormat, loopMode;
 
@@ -84,30 +165,25 @@ static int32_t sndload_opcode_init_(CSOUND *csound, SNDLOAD_OPCODE *p,
       return xx;
     }
     csound->Free(csound, fname);
+    loopMode = (int32_t) MYFLT2LRND(*(p->iLoopMode1));
+    if (UNLIKELY(loopMode > 3))
+      return csound->InitError(csound, Str("invalid loop mode: %d"),
+                                       loopMode);
+    prm = sndload_params_find(csound, sf, 1);
+    if (UNLIKELY(prm == NULL))
+      return csound->InitError(csound, Str("sndload: not enough memory"));
     if (*(p->iBaseFreq) > FL(0.0))
-      sf->baseFreq = (double) *(p->iBaseFreq);
+      prm->baseFreq = (double) *(p->iBaseFreq);
     if (*(p->iAmpScale) != FL(0.0))
-      sf->scaleFac = (double) *(p->iAmpScale);
+      prm->scaleFac = (double) *(p->iAmpScale);
     if (*(p->iStartOffset) >= FL(0.0))
-      sf->startOffs = (double) *(p->iStartOffset);
-    loopMode = (int32_t) MYFLT2LRND(*(p->iLoopMode1));
+      prm->startOffs = (double) *(p->iStartOffset);
     if (loopMode >= 0) {
-      if (UNLIKELY(loopMode > 3))
-        return csound->InitError(csound, Str("invalid loop mode: %d"),
-                                         loopMode);
-      sf->loopMode = loopMode + 1;
-      sf->loopStart = *(p->iLoopStart1);
-      sf->loopEnd = *(p->iLoopEnd1);
-    }
-    if (sf->loopMode < 2 || sf->loopStart == sf->loopEnd) {
-      sf->loopStart = 0.0;
-      sf->loopEnd = (double) ((int32) sf->nFrames);
-    }
-    else if (sf->loopStart > sf->loopEnd) {
-      double  tmp = sf->loopStart;
-      sf->loopStart = sf->loopEnd;
-      sf->loopEnd = tmp;
+      prm->loopMode = loopMode + 1;
+      prm->loopStart = *(p->iLoopStart1);
+      prm->loopEnd = *(p->iLoopEnd1);
     }
+    sndload_params_loop(prm);
 
     return OK;
 }
@@ -215,6 +291,7 @@ static int32_t loscilx_opcode_init(CSOUND *csound, LOSCILX_OPCODE *p)
     p->nChannels = nChannels;
     if (csound->ISSTRCOD(*p->ifn)) {
       SNDMEMFILE  *sf;
+      SNDLOAD_PARAMS prm;
 
       p->usingFtable = 0;
       sf = csound->LoadSoundFile(csound,
@@ -223,35 +300,27 @@ static int32_t loscilx_opcode_init(CSOUND *csound, LOSCILX_OPCODE *p)
       if (UNLIKELY(sf == NULL))
         return csound->InitError(csound, Str("could not load '%s'"),
                                          (char*) p->ifn);
-      if (sf->loopMode < 2 || sf->loopStart == sf->loopEnd) {
-        sf->loopStart = 0.0;
-        sf->loopEnd = (double) ((int32) sf->nFrames);
-      }
-      else if (sf->loopStart > sf->loopEnd) {
-        double  tmp = sf->loopStart;
-        sf->loopStart = sf->loopEnd;
-        sf->loopEnd = tmp;
-      }
+      sndload_params_get(csound, sf, &prm);
       if (UNLIKELY(sf->nChannels != nChannels))
         return csound->InitError(csound, Str("number of output arguments "
                                              "inconsistent with number of "
                                              "sound file channels"));
       dataPtr = (void*) &(sf->data[0]);
-      p->curPos = loscilx_convert_phase(sf->startOffs);
-      p->curLoopMode = sf->loopMode - 1;
+      p->curPos = loscilx_convert_phase(prm.startOffs);
+      p->curLoopMode = prm.loopMode - 1;
       if (p->curLoopMode < 1 || p->curLoopMode > 3)
         p->curLoopMode = 0;
       else {
-        p->curLoopStart = loscilx_convert_phase(sf->loopStart);
-        p->curLoopEnd = loscilx_convert_phase(sf->loopEnd);
+        p->curLoopStart = loscilx_convert_phase(prm.loopStart);
+        p->curLoopEnd = loscilx_convert_phase(prm.loopEnd);
       }
       if (*(p->ibas) > FL(0.0)) {
         frqScale = sf->sampleRate
                    / ((double) CS_ESR * (double) *(p->ibas));
       }
       else
-        frqScale = sf->sampleRate / ((double) CS_ESR * sf->baseFreq);
-      p->ampScale = (MYFLT) sf->scaleFac * csound->e0dbfs;
+        frqScale = sf->sampleRate / ((double) CS_ESR * prm.baseFreq);
+      p->ampScale = (MYFLT) prm.scaleFac * csound->e0dbfs;
       p->nFrames = (int32) sf->nFrames;
     }
     else {
@@ -364,6 +433,7 @@ static int32_t loscilxa_opcode_init(CSOUND *csound, LOSCILXA_OPCODE *p)
     p->dataPtr = NULL;
     if (csound->ISSTRCOD(*p->ifn)) {
       SNDMEMFILE  *sf;
+      SNDLOAD_PARAMS prm;
 
       p->usingFtable = 0;
       sf = csound->LoadSoundFile(csound,
@@ -372,33 +442,25 @@ static int32_t loscilxa_opcode_init(CSOUND *csound, LOSCILXA_OPCODE *p)
       if (UNLIKELY(sf == NULL))
         return csound->InitError(csound, Str("could not load '%s'"),
                                          (char*) p->ifn);
-      if (sf->loopMode < 2 || sf->loopStart == sf->loopEnd) {
-        sf->loopStart = 0.0;
-        sf->loopEnd = (double) ((int32) sf->nFrames);
-      }
-      else if (sf->loopStart > sf->loopEnd) {
-        double  tmp = sf->loopStart;
-        sf->loopStart = sf->loopEnd;
-        sf->loopEnd = tmp;
-      }
+      sndload_params_get(csound, sf, &prm);
       p->nChannels = sf->nChannels;
       tabinit(csound, p->arr, p->nChannels);
       dataPtr = (void*) &(sf->data[0]);
-      p->curPos = loscilx_convert_phase(sf->startOffs);
-      p->curLoopMode = sf->loopMode - 1;
+      p->curPos = loscilx_convert_phase(prm.startOffs);
+      p->curLoopMode = prm.loopMode - 1;
       if (p->curLoopMode < 1 || p->curLoopMode > 3)
         p->curLoopMode = 0;
       else {
-        p->curLoopStart = loscilx_convert_phase(sf->loopStart);
-        p->curLoopEnd = loscilx_convert_phase(sf->loopEnd);
+        p->curLoopStart = loscilx_convert_phase(prm.loopStart);
+        p->curLoopEnd = loscilx_convert_phase(prm.loopEnd);
       }
       if (*(p->ibas) > FL(0.0)) {
         frqScale = sf->sampleRate
                    / ((double) CS_ESR * (double) *(p->ibas));
       }
       else
-        frqScale = sf->sampleRate / ((double) CS_ESR * sf->baseFreq);
-      p->ampScale = (MYFLT) sf->scaleFac * csound->e0dbfs;
+        frqScale = sf->sampleRate / ((double) CS_ESR * prm.baseFreq);
+      p->ampScale = (MYFLT) prm.scaleFac * csound->e0dbfs;
       p->nFrames = (int32) sf->nFrames;
     }
     else {
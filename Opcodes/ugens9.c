@@ -562,13 +562,9 @@ static int32_t pconvolve(CSOUND *csound, PCONVOLVE *p)
 
         /* for every IR partition convolve and add to previous convolves */
         for (i = 0; i < p->numPartitions*p->nchanls; i++) {
-          MYFLT *src = workBuf;
-          int32_t n;
-          for (n = 0; n <= (int32_t) p->Hlenpadded; n += 2) {
-            dest[n + 0] += (h[n + 0] * src[n + 0]) - (h[n + 1] * src[n + 1]);
-            dest[n + 1] += (h[n + 1] * src[n + 0]) + (h[n + 0] * src[n + 1]);
-          }
-          h += n; dest += n;
+          csound->ComplexMultAcc(csound, dest, h, workBuf,
+                                 (p->Hlenpadded >> 1) + 1);
+          h += hlenpaddedplus2; dest += hlenpaddedplus2;
           if (UNLIKELY(dest == (MYFLT*)p->convBuf.endp))
             dest = (MYFLT*)p->convBuf.auxp;
         }
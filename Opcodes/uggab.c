@@ -243,6 +243,9 @@ static int32_t posc_set(CSOUND *csound, POSC *p)
     p->ftp        = ftp;
     p->tablen     = ftp->flen;
     p->tablenUPsr = p->tablen * csound->onedsr;
+    p->blim       = (*p->iblim != FL(0.0));
+    if (p->blim)
+      csound->FTMipmap(csound, ftp, -FL(1.0));  /* make the levels now */
     if (*p->iphs>=FL(0.0))
       p->phs      = *p->iphs * p->tablen;
     while (UNLIKELY(p->phs >= p->tablen))
@@ -250,6 +253,22 @@ static int32_t posc_set(CSOUND *csound, POSC *p)
     return OK;
 }
 
+/* with iblim set, the copy of the table band-limited for the highest
+   frequency in freq[n .. nsmps-1], see csoundFTMipmap() */
+
+static inline MYFLT *posc_ftable(CSOUND *csound, POSC *p, const MYFLT *freq,
+                                 uint32_t n, uint32_t nsmps, double cvt)
+{
+    MYFLT   c, mx = FL(0.0);
+
+    if (LIKELY(!p->blim))
+      return p->ftp->ftable;
+    for ( ; n < nsmps; n++)
+      if ((c = FABS(freq[n])) > mx)
+        mx = c;
+    return csound->FTMipmap(csound, p->ftp, (MYFLT) (mx * cvt));
+}
+
 static int32_t posckk(CSOUND *csound, POSC *p)
 {
     FUNC        *ftp = p->ftp;
@@ -265,7 +284,7 @@ static int32_t posckk(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
+    ft = posc_ftable(csound, p, p->freq, 0, 1, p->tablenUPsr);
     if (UNLIKELY(early)) nsmps -= early;
     for (n=offset; n<nsmps; n++) {
       curr_samp = ft + (int32)phs;
@@ -296,12 +315,12 @@ static int32_t poscaa(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    ft = posc_ftable(csound, p, freq, offset, nsmps, p->tablenUPsr);
     for (n=offset; n<nsmps; n++) {
       MYFLT ff = freq[n];
       curr_samp = ft + (int32)phs;
@@ -333,12 +352,12 @@ static int32_t poscka(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    ft = posc_ftable(csound, p, freq, offset, nsmps, p->tablenUPsr);
     for (n=offset; n<nsmps; n++) {
       MYFLT ff  = freq[n];
       curr_samp = ft + (int32)phs;
@@ -370,7 +389,7 @@ static int32_t poscak(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil: not initialised"));
-    ft = p->ftp->ftable;
+    ft = posc_ftable(csound, p, p->freq, 0, 1, p->tablenUPsr);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -393,10 +412,10 @@ static int32_t poscak(CSOUND *csound, POSC *p)
 
 static int32_t kposc(CSOUND *csound, POSC *p)
 {
-     IGN(csound);
     double      phs = p->phs;
     double      si = *p->freq * p->tablen * CS_ONEDKR;
-    MYFLT       *curr_samp = p->ftp->ftable + (int32)phs;
+    MYFLT       *curr_samp = posc_ftable(csound, p, p->freq, 0, 1, p->tablen * CS_ONEDKR) +
+                             (int32)phs;
     MYFLT       fract = (MYFLT)(phs - (double)((int32)phs));
 
     *p->out = *p->amp * (*curr_samp +(*(curr_samp+1)-*curr_samp)*fract);
@@ -426,7 +445,7 @@ static int32_t posc3kk(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
+    ftab = posc_ftable(csound, p, p->freq, 0, 1, p->tablenUPsr);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -481,7 +500,7 @@ static int32_t posc3ak(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
+    ftab = posc_ftable(csound, p, p->freq, 0, 1, p->tablenUPsr);
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
@@ -537,12 +556,12 @@ static int32_t posc3ka(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    ftab = posc_ftable(csound, p, freq, offset, nsmps, p->tablenUPsr);
     for (n=offset; n<nsmps; n++) {
       MYFLT ff = freq[n];
       x0    = (int32)phs;
@@ -594,12 +613,12 @@ static int32_t posc3aa(CSOUND *csound, POSC *p)
     if (UNLIKELY(ftp==NULL))
       return csound->PerfError(csound, &(p->h),
                                Str("poscil3: not initialised"));
-    ftab = p->ftp->ftable;
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    ftab = posc_ftable(csound, p, freq, offset, nsmps, p->tablenUPsr);
     for (n=offset; n<nsmps; n++) {
       MYFLT ff = freq[n];
       x0    = (int32)phs;
@@ -635,10 +654,9 @@ static int32_t posc3aa(CSOUND *csound, POSC *p)
 
 static int32_t kposc3(CSOUND *csound, POSC *p)
 {
-    IGN(csound);
     double      phs   = p->phs;
     double      si    = *p->freq * p->tablen * CS_ONEDKR;
-    MYFLT       *ftab = p->ftp->ftable;
+    MYFLT       *ftab = posc_ftable(csound, p, p->freq, 0, 1, p->tablen * CS_ONEDKR);
     int32_t     x0    = (int32_t)phs;
     MYFLT       fract = (MYFLT)(phs - (double)x0);
     MYFLT       y0, y1, ym1, y2;
@@ -2107,20 +2125,20 @@ static OENTRY localops[] = {
 { "duserrnd.a", S(DURAND),0,2, "a", "k",
                                 (SUBR)Cuserrnd_set,(SUBR)aDiscreteUserRand },
 //{ "poscil", 0xfffe, TR                                                          },
-{ "poscil.a", S(POSC), TR,3, "a", "kkjo", (SUBR)posc_set,(SUBR)posckk },
-{ "poscil.kk", S(POSC), TR,3, "k", "kkjo", (SUBR)posc_set,(SUBR)kposc,NULL },
-{ "poscil.ka", S(POSC), TR,3, "a", "kajo", (SUBR)posc_set,  (SUBR)poscka },
-{ "poscil.ak", S(POSC), TR,3, "a", "akjo", (SUBR)posc_set,  (SUBR)poscak },
-{ "poscil.aa", S(POSC), TR,3, "a", "aajo", (SUBR)posc_set,  (SUBR)poscaa },
+{ "poscil.a", S(POSC), TR,3, "a", "kkjoo", (SUBR)posc_set,(SUBR)posckk },
+{ "poscil.kk", S(POSC), TR,3, "k", "kkjoo", (SUBR)posc_set,(SUBR)kposc,NULL },
+{ "poscil.ka", S(POSC), TR,3, "a", "kajoo", (SUBR)posc_set,  (SUBR)poscka },
+{ "poscil.ak", S(POSC), TR,3, "a", "akjoo", (SUBR)posc_set,  (SUBR)poscak },
+{ "poscil.aa", S(POSC), TR,3, "a", "aajoo", (SUBR)posc_set,  (SUBR)poscaa },
 { "lposcil",  S(LPOSC), TR, 3, "a", "kkkkjo", (SUBR)lposc_set, (SUBR)lposc},
 //{ "poscil3", 0xfffe, TR                                                     },
-{ "poscil3.a",S(POSC), TR,3, "a", "kkjo",
+{ "poscil3.a",S(POSC), TR,3, "a", "kkjoo",
                                      (SUBR)posc_set,(SUBR)posc3kk },
-{ "poscil3.kk",S(POSC), TR,3, "k", "kkjo",
+{ "poscil3.kk",S(POSC), TR,3, "k", "kkjoo",
                                      (SUBR)posc_set,(SUBR)kposc3,NULL},
-{ "poscil3.ak", S(POSC), TR,3, "a", "akjo", (SUBR)posc_set, (SUBR)posc3ak },
-{ "poscil3.ka", S(POSC), TR,3, "a", "kajo", (SUBR)posc_set, (SUBR)posc3ka },
-{ "poscil3.aa", S(POSC), TR,3, "a", "aajo", (SUBR)posc_set, (SUBR)posc3aa },
+{ "poscil3.ak", S(POSC), TR,3, "a", "akjoo", (SUBR)posc_set, (SUBR)posc3ak },
+{ "poscil3.ka", S(POSC), TR,3, "a", "kajoo", (SUBR)posc_set, (SUBR)posc3ka },
+{ "poscil3.aa", S(POSC), TR,3, "a", "aajoo", (SUBR)posc_set, (SUBR)posc3aa },
 { "lposcil3", S(LPOSC), TR, 3, "a", "kkkkjo", (SUBR)lposc_set,(SUBR)lposc3},
 { "trigger",  S(TRIG),  0,3, "k", "kkk",  (SUBR)trig_set, (SUBR)trig,   NULL  },
 { "sum",      S(SUM),   0,2, "a", "y",    NULL, (SUBR)sum               },
@@ -46,9 +46,10 @@ typedef struct {
 
 typedef struct  {
     OPDS        h;
-    MYFLT       *out, *amp, *freq, *ift, *iphs;
+    MYFLT       *out, *amp, *freq, *ift, *iphs, *iblim;
     FUNC        *ftp;
     int32       tablen;
+    int32       blim;
     double      tablenUPsr;
     double      phs;
 } POSC;
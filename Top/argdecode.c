@@ -258,6 +258,7 @@ static const char *longUsageList[] = {
   Str_noop("--keep-sorted-score=FNAME"),
   Str_noop("--simple-sorted-score"),
   Str_noop("--simple-sorted-score=FNAME"),
+  Str_noop("--orc-cache=DIR         keep parsed orchestras in DIR"),
   Str_noop("--env:NAME=VALUE        set environment variable NAME to VALUE"),
   Str_noop("--env:NAME+=VALUE       append VALUE to environment variable NAME"),
   Str_noop("--strsetN=VALUE         set strset table at index N to VALUE"),
@@ -268,6 +269,8 @@ static const char *longUsageList[] = {
   Str_noop("--dither                dither output"),
   Str_noop("--dither-triangular     dither output with triangular distribution"),
   Str_noop("--dither-uniform        dither output with rectanular distribution"),
+  Str_noop("--sf-write-queue=N      queue N buffers for the sound file "
+                                   "writer thread (0: none)"),
   Str_noop("--sched                 set real-time scheduling priority and "
                                    "lock memory"),
   Str_noop("--sched=N               set priority to N and lock memory"),
@@ -293,6 +296,8 @@ static const char *longUsageList[] = {
   Str_noop("--no-default-paths      turn off relative paths from CSD/ORC/SCO"),
   Str_noop("--sample-accurate       use sample-accurate timing of score events"),
   Str_noop("--realtime              realtime priority mode"),
+  Str_noop("--rt-callback           run the performance in the audio driver "
+                                   "callback (implies --realtime)"),
   Str_noop("--nchnls=N              override number of audio channels"),
   Str_noop("--nchnls_i=N            override number of input audio channels"),
   Str_noop("--0dbfs=N               override 0dbfs (max positive signal amplitude)"),
@@ -884,6 +889,16 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       return 1;
     }
     /* -t0 */
+    else if (!(strncmp(s, "orc-cache=", 10))) {
+      s += 10;
+      csound->orc_cache = s;
+      return 1;
+    }
+    else if (!(strncmp(s, "sf-write-queue=", 15))) {
+      s += 15;
+      csound->sfwrite_queue = atoi(s);
+      return 1;
+    }
     else if (!(strncmp(s, "keep-sorted-score=", 18))) {
       s += 18;
       csound->score_srt = s;
@@ -1078,6 +1093,12 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       O->realtime = 1;
       return 1;
     }
+    else if (!(strcmp(s, "rt-callback"))) {
+      /* init passes must not run in the audio callback */
+      csound->rt_callback = 1;
+      O->realtime = 1;
+      return 1;
+    }
     else if (!(strncmp(s, "nchnls=", 7))) {
       s += 7;
       O->nchnls_override = atoi(s);
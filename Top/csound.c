@@ -49,6 +49,10 @@
 # include <winsock2.h>
 # include <windows.h>
 #endif
+#ifdef LINUX
+# include <semaphore.h>
+# include <errno.h>
+#endif
 #include <math.h>
 #include "oload.h"
 #include "fgens.h"
@@ -517,10 +521,16 @@ static const CSOUND cenviron_ = {
     csoundLPCeps,
     csoundCepsLP,
     csoundLPrms,
+    csoundRealFFTMultAcc,
+    csoundComplexMultAcc,
+    hfgens_async,
+    csoundFTReady,
+    csoundFTMipmap,
+    csoundRtCallbackMode,
+    csoundRtCallback,
     {
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL
+      NULL, NULL, NULL, NULL, NULL, NULL
     },
     /* ------- private data (not to be used by hosts or externals) ------- */
     /* callback function pointers */
@@ -829,6 +839,8 @@ static const CSOUND cenviron_ = {
       1U,           /*  nframes             */
       NULL, NULL,   /*  pin, pout           */
       0,            /*dither                */
+      NULL,         /*  dithfn              */
+      NULL          /*  writer              */
     },
     0,              /*  warped              */
     0,              /*  sstrlen             */
@@ -933,7 +945,6 @@ static const CSOUND cenviron_ = {
     0,              /* multiThreadedComplete */
     NULL,           /* multiThreadedThreadInfo */
     NULL,           /* multiThreadedDag */
-    NULL,           /* barrier1 */
     NULL,           /* barrier2 */
     NULL,           /* pointer1 was global_var_lock_root */
     NULL,           /* pointer2 was global_var_lock_cache */
@@ -979,10 +990,7 @@ static const CSOUND cenviron_ = {
     0,              /* print_version */
     1,              /* inZero */
     NULL,           /* msg_queue */
-    0,              /* msg_queue_wget */
-    0,              /* msg_queue_wput */
-    0,              /* msg_queue_rstart */
-    0,              /* msg_queue_items */
+    CSOUND_API_QUEUE_BLOCK, /* msg_queue_policy */
     127,            /* aftouch */
     NULL,           /* directory for corfiles */
     NULL,           /* alloc_queue */
@@ -999,10 +1007,32 @@ static const CSOUND cenviron_ = {
     NULL,           /* op */
     0,              /* mode */
     NULL,           /* opcodedir */
-    NULL            /* score_srt */
+    NULL,           /* score_srt */
+    NULL,           /* dag_deques */
+    NULL,           /* dag_wake */
+    0,              /* dag_remaining */
+    0,              /* dag_cycle */
+    0,              /* dag_idle */
+    NULL,           /* dag_cache */
+    NULL,           /* mem_pool */
+    NULL,           /* chn_index */
+    NULL,           /* insds_pool */
+    NULL,           /* bscore */
+    NULL,           /* evt_queue */
+    NULL,           /* ftgen_async */
+    NULL,           /* ft_mipmaps */
+    SPINLOCK_INIT,  /* ft_mipmap_lock */
+    NULL,           /* orc_cache */
+    NULL,           /* tree_arena */
+    NULL,           /* tree_arenas */
+    4,              /* sfwrite_queue */
+    0,              /* rt_callback */
+    NULL,           /* rtcb */
+    NULL            /* async_init */
 };
 
 void csound_aops_init_tables(CSOUND *cs);
+void aops_simd_init(void);
 
 typedef struct csInstance_s {
     CSOUND              *csound;
@@ -1292,6 +1322,7 @@ PUBLIC int csoundInitialize(int flags)
       csoundUnLock();
       return -1;
     }
+    aops_simd_init();
     if (!(flags & CSOUNDINIT_NO_SIGNAL_HANDLER)) {
       install_signal_handler();
     }
@@ -1511,14 +1542,96 @@ inline void advanceINSDSPointer(INSDS ***start, int num)
 }
 
 int dag_get_task(CSOUND *csound, int index, int numThreads, int next_task);
-int dag_end_task(CSOUND *csound, int task);
+int dag_end_task(CSOUND *csound, int index, int task);
 void dag_build(CSOUND *csound, INSDS *chain);
 void dag_reinit(CSOUND *csound);
+void dag_start_cycle(CSOUND *csound);
+void dag_end_cycle(CSOUND *csound);
+void dag_wake_workers(CSOUND *csound);
+
+/* Each instance keeps its perf chain as a flat array of its opcodes,
+   rebuilt after every init or reinit pass, so the k-cycle loop walks
+   one contiguous block instead of following nxtp through every
+   opcode's data.  opadr is still read from the opcode at each call,
+   as some opcodes replace their own perf function while running.  ip->pds is still set to the running opcode, so
+   opcodes that jump (kgoto, loop_lt, turnoff, ...) work as before:
+   when pds comes back changed, the target is found by address in the
+   array, which is in chain order.  A target outside the array (never
+   expected) drops back to walking the chain. */
+
+static void perf_ops_build(INSDS *ip, OPRUNS *runs)
+{
+    OPDS  **ops = runs->ops;
+    OPDS  *op = (OPDS*) ip;
+    int   n = 0;
+
+    while ((op = op->nxtp) != NULL && n < runs->max)
+      ops[n++] = op;
+    runs->nops = (op == NULL ? n : -1);
+    runs->stale = 0;
+}
+
+/* position of jump target in perf_ops: -1 for the instance head,
+   -2 if not found */
+static int perf_ops_find(INSDS *ip, OPRUNS *runs, OPDS *target)
+{
+    OPDS  **ops = runs->ops;
+    int   lo = 0, hi = runs->nops - 1;
+
+    if (target == (OPDS*) ip) return -1;
+    while (lo <= hi) {
+      int mid = (lo + hi) >> 1;
+      if (ops[mid] == target) return mid;
+      if ((char*) ops[mid] < (char*) target) lo = mid + 1;
+      else hi = mid - 1;
+    }
+    return -2;
+}
+
+static int perf_chain(CSOUND *csound, INSDS *ip, OPDS *opstart,
+                      int check, int error)
+{
+    while ((!check || error == 0) &&
+           (opstart = opstart->nxtp) != NULL &&
+           (!check || ip->actflg)) {
+      ip->pds = opstart;
+      error = (*opstart->opadr)(csound, opstart); /* run each opcode */
+      opstart = ip->pds;
+    }
+    return error;
+}
+
+/* run one k-period of an instance; with check set, stop on error or
+   when the instance is turned off */
+static inline int perf_instance(CSOUND *csound, INSDS *ip, int check)
+{
+    OPRUNS *runs = INS_OPRUNS(ip);
+    OPDS  **ops;
+    int   i, n, error = 0;
+
+    if (UNLIKELY(runs->stale)) perf_ops_build(ip, runs);
+    ops = runs->ops;
+    n = runs->nops;
+    if (UNLIKELY(n < 0))
+      return perf_chain(csound, ip, (OPDS*) ip, check, 0);
+    for (i = 0; i < n; i++) {
+      OPDS *op = ops[i];
+      ip->pds = op;
+      error = (*op->opadr)(csound, op);       /* run each opcode */
+      if (UNLIKELY(ip->pds != op)) {          /* jumped */
+        int k = perf_ops_find(ip, runs, ip->pds);
+        if (UNLIKELY(k == -2))
+          return perf_chain(csound, ip, ip->pds, check, error);
+        i = k;
+      }
+      if (check && (error != 0 || !ip->actflg)) break;
+    }
+    return error;
+}
 
 inline static int nodePerf(CSOUND *csound, int index, int numThreads)
 {
     INSDS *insds = NULL;
-    OPDS  *opstart = NULL;
     int played_count = 0;
     int which_task;
     INSDS **task_map = (INSDS**)csound->dag_task_map;
@@ -1526,13 +1639,11 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
 #define INVALID (-1)
 #define WAIT    (-2)
     int next_task = INVALID;
-    IGN(index);
 
     while (1) {
       int done;
       which_task = dag_get_task(csound, index, numThreads, next_task);
       //printf("******** Select task %d\n", which_task);
-      if (which_task==WAIT) continue;
       if (which_task==INVALID) return played_count;
          /* VL: the validity of icurTime needs to be checked */
         time_end = (csound->ksmps+csound->icurTime)/csound->esr;
@@ -1549,19 +1660,12 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
         done = insds->init_done;
 #endif
         if (done) {
-          opstart = (OPDS*)task_map[which_task];
           if (insds->ksmps == csound->ksmps) {
             insds->spin = csound->spin;
             insds->spout = csound->spraw;
             insds->kcounter =  csound->kcounter;
             csound->mode = 2;
-            while ((opstart = opstart->nxtp) != NULL) {
-              /* In case of jumping need this repeat of opstart */
-              opstart->insdshead->pds = opstart;
-              csound->op = opstart->optext->t.opcod;
-              (*opstart->opadr)(csound, opstart); /* run each opcode */
-              opstart = opstart->insdshead->pds;
-            }
+            (void) perf_instance(csound, insds, 0);
             csound->mode = 0;
           } else {
             int i, n = csound->nspout, start = 0;
@@ -1569,7 +1673,6 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
             int incr = csound->nchnls*lksmps;
             int offset =  insds->ksmps_offset;
             int early = insds->ksmps_no_end;
-            OPDS  *opstart;
             insds->spin = csound->spin;
             insds->spout = csound->spraw;
             insds->kcounter =  csound->kcounter*csound->ksmps;
@@ -1589,14 +1692,8 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
             }
 
             for (i=start; i < n; i+=incr, insds->spin+=incr, insds->spout+=incr) {
-              opstart = (OPDS*) insds;
               csound->mode = 2;
-              while ((opstart = opstart->nxtp) != NULL) {
-                opstart->insdshead->pds = opstart;
-                csound->op = opstart->optext->t.opcod;
-                (*opstart->opadr)(csound, opstart); /* run each opcode */
-                opstart = opstart->insdshead->pds;
-              }
+              (void) perf_instance(csound, insds, 0);
               csound->mode = 0;
               insds->kcounter++;
             }
@@ -1606,7 +1703,7 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
           played_count++;
         }
         //printf("******** finished task %d\n", which_task);
-        next_task = dag_end_task(csound, which_task);
+        next_task = dag_end_task(csound, index, which_task);
     }
     return played_count;
 }
@@ -1651,6 +1748,7 @@ unsigned long kperfThread(void * cs)
     void *threadId;
     int index;
     int numThreads;
+    int cycle;
     _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
 
     csound->WaitBarrier(csound->barrier2);
@@ -1670,25 +1768,22 @@ unsigned long kperfThread(void * cs)
       return ULONG_MAX;
     }
     index++;
+    cycle = ATOMIC_GET(csound->dag_cycle);
 
     while (1) {
+      /* park until the main thread opens the next k-cycle */
+      while (ATOMIC_GET(csound->dag_cycle) == cycle)
+        csoundWaitThreadLockNoTimeout(csound->dag_wake[index]);
+      cycle = ATOMIC_GET(csound->dag_cycle);
 
-      csound->WaitBarrier(csound->barrier1);
-
-      // FIXME:PTHREAD_WORK - need to check if this is necessary and, if so,
-      // use some other kind of locking mechanism as it isn't clear why a
-      //global mutex would be necessary versus a per-CSOUND instance mutex
-      /*csound_global_mutex_lock();*/
       if (csound->multiThreadedComplete == 1) {
-        /*csound_global_mutex_unlock();*/
         free(threadId);
         return 0UL;
       }
-      /*csound_global_mutex_unlock();*/
 
       nodePerf(csound, index, numThreads);
 
-      csound->WaitBarrier(csound->barrier2);
+      ATOMIC_INCR(csound->dag_idle);
     }
 }
 
@@ -1737,12 +1832,12 @@ int kperf_nodebug(CSOUND *csound)
         else dag_reinit(csound);     /* set to initial state */
 
         /* process this partition */
-        csound->WaitBarrier(csound->barrier1);
+        dag_start_cycle(csound);
 
-        (void) nodePerf(csound, 0, 1);
+        (void) nodePerf(csound, 0, csound->oparms->numThreads);
 
         /* wait until partition is complete */
-        csound->WaitBarrier(csound->barrier2);
+        dag_end_cycle(csound);
         csound->multiThreadedDag = NULL;
       }
       else {
@@ -1763,20 +1858,13 @@ int kperf_nodebug(CSOUND *csound)
           done = ATOMIC_GET(ip->init_done);
           if (done == 1) {/* if init-pass has been done */
             int error = 0;
-            OPDS  *opstart = (OPDS*) ip;
             ip->spin = csound->spin;
             ip->spout = csound->spraw;
             ip->kcounter =  csound->kcounter;
             if (ip->ksmps == csound->ksmps) {
               csound->mode = 2;
-              while (error == 0 &&
-                     (opstart = opstart->nxtp) != NULL &&
-                     ip->actflg) {
-                opstart->insdshead->pds = opstart;
-                csound->op = opstart->optext->t.opcod;
-                error = (*opstart->opadr)(csound, opstart); /* run each opcode */
-                opstart = opstart->insdshead->pds;
-              }
+              if (ip->actflg)
+                error = perf_instance(csound, ip, 1);
               csound->mode = 0;
             } else {
                 int error = 0;
@@ -1785,7 +1873,6 @@ int kperf_nodebug(CSOUND *csound)
                 int incr = csound->nchnls*lksmps;
                 int offset =  ip->ksmps_offset;
                 int early = ip->ksmps_no_end;
-                OPDS  *opstart;
                 ip->spin = csound->spin;
                 ip->spout = csound->spraw;
                 ip->kcounter =  csound->kcounter*csound->ksmps/lksmps;
@@ -1805,16 +1892,9 @@ int kperf_nodebug(CSOUND *csound)
                 }
 
                 for (i=start; i < n; i+=incr, ip->spin+=incr, ip->spout+=incr) {
-                  opstart = (OPDS*) ip;
                   csound->mode = 2;
-                  while (error ==  0 && (opstart = opstart->nxtp) != NULL
-                         && ip->actflg) {
-                    opstart->insdshead->pds = opstart;
-                    csound->op = opstart->optext->t.opcod;
-                    //csound->ids->optext->t.oentry->opname;
-                    error = (*opstart->opadr)(csound, opstart); /* run each opcode */
-                    opstart = opstart->insdshead->pds;
-                  }
+                  if (error == 0 && ip->actflg)
+                    error = perf_instance(csound, ip, 1);
                   csound->mode = 0;
                   ip->kcounter++;
                 }
@@ -2003,12 +2083,12 @@ int kperf_debug(CSOUND *csound)
         else dag_reinit(csound);     /* set to initial state */
 
         /* process this partition */
-        csound->WaitBarrier(csound->barrier1);
+        dag_start_cycle(csound);
 
-        (void) nodePerf(csound, 0, 1);
+        (void) nodePerf(csound, 0, csound->oparms->numThreads);
 
         /* wait until partition is complete */
-        csound->WaitBarrier(csound->barrier2);
+        dag_end_cycle(csound);
         csound->multiThreadedDag = NULL;
       }
       else {
@@ -2161,6 +2241,268 @@ int csoundReadScoreInternal(CSOUND *csound, const char *str)
 }
 
 
+/* Callback mode (--rt-callback).
+
+   An rtaudio module that can drive Csound from its driver callback asks
+   csoundRtCallbackMode() at open time and then calls csoundRtCallback()
+   for each period, which runs the k-cycles there and then, reading and
+   writing the driver's buffers: there is no buffer between the driver
+   and the performance, and no thread switch.  The host's performance
+   functions only wait for the callback (see rtcb_wait()) and must not
+   set exitjmp, which belongs to the callback thread while it runs.
+
+   Nothing that may block is done on the callback thread: --rt-callback
+   implies --realtime, so API calls are queued for the next k-cycle and
+   instrument init passes run on the event insert thread, and if the
+   period is not a multiple of ksmps the output is delayed by one k-cycle
+   rather than waiting for more input.  When the first period is not,
+   the output is delayed from the start, so the latency is the same
+   whenever a note starts.  The host is woken through a POSIX semaphore,
+   whose sem_post() does not block; elsewhere it polls. */
+
+typedef struct {
+#ifdef LINUX
+    sem_t   wake;               /* posted after a k-cycle if waiting */
+#endif
+    volatile int running, busy, waiting, done, kcount;
+    int     phase, delayed;     /* frames into the delayed k-cycle */
+    int     started;
+} RTCALLBACK;
+
+PUBLIC int csoundRtCallbackMode(CSOUND *csound)
+{
+    RTCALLBACK *cb;
+
+    if (!csound->rt_callback)
+      return 0;
+    if (csound->rtcb == NULL) {
+      cb = (RTCALLBACK*) csound->Calloc(csound, sizeof(RTCALLBACK));
+#ifdef LINUX
+      if (UNLIKELY(sem_init(&cb->wake, 0, 0) != 0)) {
+        csound->Free(csound, cb);
+        return 0;
+      }
+#endif
+      csound->rtcb = (void*) cb;
+      csound->Message(csound, Str("rtaudio: callback mode\n"));
+    }
+    return 1;
+}
+
+/* wakes the host if it is waiting; never blocks */
+
+static inline void rtcb_wake(RTCALLBACK *cb)
+{
+#ifdef LINUX
+    if (ATOMIC_GET(cb->waiting)) {
+      ATOMIC_SET(cb->waiting, 0);
+      sem_post(&cb->wake);
+    }
+#else
+    (void) cb;
+#endif
+}
+
+static void rtcb_kcycle(CSOUND *csound, RTCALLBACK *cb)
+{
+    int done;
+
+    do {
+      if (UNLIKELY((done = sensevents(csound)))) {
+        ATOMIC_SET(cb->done, done);
+        break;
+      }
+    } while (csound->kperf(csound));
+    if (LIKELY(!done))
+      ATOMIC_INCR(cb->kcount);
+    rtcb_wake(cb);
+}
+
+/* frames f..f+n-1 of the driver buffers to and from frames ph..ph+n-1 of
+   spin and spout */
+
+static void rtcb_in(CSOUND *csound, const float *const *in, int stride,
+                    int f, int ph, int n)
+{
+    int     nchnls = csound->inchnls, c, i;
+    MYFLT   *sp = csound->spin + ph * nchnls, scl = csound->e0dbfs;
+
+    for (c = 0; c < nchnls; c++) {
+      const float *p = in[c] + (size_t) f * stride;
+      for (i = 0; i < n; i++)
+        sp[i * nchnls + c] = (MYFLT) p[i * stride] * scl;
+    }
+}
+
+static void rtcb_out(CSOUND *csound, float *const *out, int stride,
+                     int f, int ph, int n)
+{
+    int     nchnls = csound->nchnls, c, i;
+    MYFLT   *sp = csound->spout + ph * nchnls, scl = csound->dbfs_to_float;
+
+    for (c = 0; c < nchnls; c++) {
+      float *p = out[c] + (size_t) f * stride;
+      for (i = 0; i < n; i++)
+        p[i * stride] = (float) (sp[i * nchnls + c] * scl);
+    }
+}
+
+static void rtcb_silence(CSOUND *csound, float *const *out, int stride,
+                         int f, int n)
+{
+    int     c, i;
+
+    for (c = 0; c < (int) csound->nchnls; c++) {
+      float *p = out[c] + (size_t) f * stride;
+      for (i = 0; i < n; i++)
+        p[i * stride] = 0.0f;
+    }
+}
+
+static void rtcb_run(CSOUND *csound, RTCALLBACK *cb,
+                     const float *const *in, int instride,
+                     float *const *out, int outstride, int nframes)
+{
+    int     ksmps = (int) csound->ksmps, f = 0, n;
+
+    if (UNLIKELY(!cb->started)) {
+      cb->started = 1;
+      if (nframes % ksmps != 0) {       /* delayed from the start */
+        memset(csound->spout, 0, csound->nspout * sizeof(MYFLT));
+        cb->delayed = 1;
+      }
+    }
+    while (f < nframes) {
+      if (UNLIKELY(ATOMIC_GET(cb->done))) {
+        rtcb_silence(csound, out, outstride, f, nframes - f);
+        return;
+      }
+      if (!cb->delayed && nframes - f >= ksmps) {
+        /* whole k-cycles: output computed from this period's input */
+        if (in != NULL)
+          rtcb_in(csound, in, instride, f, 0, ksmps);
+        rtcb_kcycle(csound, cb);
+        if (UNLIKELY(ATOMIC_GET(cb->done)))
+          continue;
+        rtcb_out(csound, out, outstride, f, 0, ksmps);
+        f += ksmps;
+        continue;
+      }
+      if (!cb->delayed) {
+        /* a period that is not a multiple of ksmps: from now on play the
+           previous k-cycle while collecting the input for the next one */
+        memset(csound->spout, 0, csound->nspout * sizeof(MYFLT));
+        cb->delayed = 1;
+      }
+      n = ksmps - cb->phase;
+      if (n > nframes - f)
+        n = nframes - f;
+      if (in != NULL)
+        rtcb_in(csound, in, instride, f, cb->phase, n);
+      rtcb_out(csound, out, outstride, f, cb->phase, n);
+      f += n;
+      if ((cb->phase += n) == ksmps) {
+        cb->phase = 0;
+        rtcb_kcycle(csound, cb);
+      }
+    }
+}
+
+PUBLIC int csoundRtCallback(CSOUND *csound, const float *const *in,
+                            int instride, float *const *out, int outstride,
+                            int nframes)
+{
+    RTCALLBACK  *cb = (RTCALLBACK*) csound->rtcb;
+    int         returnValue;
+
+    if (UNLIKELY(cb == NULL))
+      return CSOUND_ERROR;
+    ATOMIC_SET(cb->busy, 1);
+    if (!ATOMIC_GET(cb->running) || ATOMIC_GET(cb->done)) {
+      ATOMIC_SET(cb->busy, 0);
+      rtcb_silence(csound, out, outstride, 0, nframes);
+      return ATOMIC_GET(cb->done);
+    }
+    /* setup jmp for return after an exit() */
+    if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+      returnValue = ((returnValue - CSOUND_EXITJMP_SUCCESS)
+                     | CSOUND_EXITJMP_SUCCESS);
+      ATOMIC_SET(cb->done, returnValue);
+      ATOMIC_SET(cb->busy, 0);
+      rtcb_wake(cb);
+      rtcb_silence(csound, out, outstride, 0, nframes);
+      return returnValue;
+    }
+    rtcb_run(csound, cb, in, instride, out, outstride, nframes);
+    ATOMIC_SET(cb->busy, 0);
+    return ATOMIC_GET(cb->done);
+}
+
+/* Host side: let the callback run k-cycles, and wait for nk of them, or
+   if nk is 0 until the score ends or csoundStop() is called.  Returns
+   as the performance functions do. */
+
+static int rtcb_wait(CSOUND *csound, int nk)
+{
+    RTCALLBACK  *cb = (RTCALLBACK*) csound->rtcb;
+    int         k0 = ATOMIC_GET(cb->kcount), done;
+
+    ATOMIC_SET(cb->running, 1);
+    for (;;) {
+      /* set before testing, so that a k-cycle ending meanwhile notifies */
+      ATOMIC_SET(cb->waiting, 1);
+      if ((done = ATOMIC_GET(cb->done)) != 0)
+        break;
+      if (nk > 0 ? (int) ((unsigned) ATOMIC_GET(cb->kcount) - k0) >= nk
+                 : csound->performState != 0)
+        break;
+#ifdef LINUX
+      {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        if ((ts.tv_nsec += 20000000L) >= 1000000000L) {
+          ts.tv_sec++;
+          ts.tv_nsec -= 1000000000L;
+        }
+        while (sem_timedwait(&cb->wake, &ts) != 0 && errno == EINTR)
+          ;
+      }
+#else
+      csoundSleep(1);
+#endif
+    }
+    ATOMIC_SET(cb->waiting, 0);
+    return done;
+}
+
+/* stop running k-cycles in the callback, once the current one is done */
+
+void rtcallback_halt(CSOUND *csound)
+{
+    RTCALLBACK  *cb = (RTCALLBACK*) csound->rtcb;
+
+    if (cb == NULL)
+      return;
+    ATOMIC_SET(cb->running, 0);
+    while (ATOMIC_GET(cb->busy))
+      csoundSleep(1);
+}
+
+/* called when the stream is closed */
+
+void rtcallback_free(CSOUND *csound)
+{
+    RTCALLBACK  *cb = (RTCALLBACK*) csound->rtcb;
+
+    if (cb == NULL)
+      return;
+#ifdef LINUX
+    sem_destroy(&cb->wake);
+#endif
+    csound->Free(csound, cb);
+    csound->rtcb = NULL;
+}
+
 PUBLIC int csoundPerformKsmps(CSOUND *csound)
 {
     int done;
@@ -2171,6 +2513,13 @@ PUBLIC int csoundPerformKsmps(CSOUND *csound)
                           "has not been called\n"));
       return CSOUND_ERROR;
     }
+    if (csound->rtcb != NULL) {     /* k-cycles run in the audio callback */
+      if (UNLIKELY((done = rtcb_wait(csound, 1))))
+        csoundMessage(csound,
+                      Str("Score finished in csoundPerformKsmps() with %d.\n"),
+                      done);
+      return done;
+    }
     if (csound->jumpset == 0) {
       int returnValue;
       csound->jumpset = 1;
@@ -2237,6 +2586,10 @@ PUBLIC int csoundPerformBuffer(CSOUND *csound)
                           "has not been called\n"));
       return CSOUND_ERROR;
     }
+    if (csound->rtcb != NULL) {     /* k-cycles run in the audio callback */
+      int nk = (int) (csound->oparms_.outbufsamps / csound->nspout);
+      return rtcb_wait(csound, nk > 0 ? nk : 1);
+    }
     /* Setup jmp for return after an exit(). */
     if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
 #ifndef MACOSX
@@ -2280,6 +2633,20 @@ PUBLIC int csoundPerform(CSOUND *csound)
     }
 
     csound->performState = 0;
+    if (csound->rtcb != NULL) {     /* k-cycles run in the audio callback */
+      if ((done = rtcb_wait(csound, 0))) {
+        csoundMessage(csound, Str("Score finished in csoundPerform().\n"));
+        if (csound->oparms->numThreads > 1) {
+          csound->multiThreadedComplete = 1;
+          dag_wake_workers(csound);
+        }
+        return done;
+      }
+      rtcallback_halt(csound);
+      csoundMessage(csound, Str("csoundPerform(): stopped.\n"));
+      csound->performState = 0;
+      return 0;
+    }
     /* setup jmp for return after an exit() */
     if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
 #ifndef MACOSX
@@ -2297,7 +2664,7 @@ PUBLIC int csoundPerform(CSOUND *csound)
             csoundUnlockMutex(csound->API_lock);
           if (csound->oparms->numThreads > 1) {
             csound->multiThreadedComplete = 1;
-            csound->WaitBarrier(csound->barrier1);
+            dag_wake_workers(csound);
           }
           return done;
         }
@@ -2678,6 +3045,17 @@ void csoundErrMsgV(CSOUND *csound,
     csound->MessageS(csound, CSOUNDMSG_ERROR, "\n");
 }
 
+#if defined(_MSC_VER)
+#define CS_TLS __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define CS_TLS __thread
+#endif
+
+#ifdef CS_TLS
+/* set by csoundRunCaught() on the thread running it */
+static CS_TLS jmp_buf *thread_exitjmp = NULL;
+#endif
+
 void csoundLongJmp(CSOUND *csound, int retval)
 {
     int   n = CSOUND_EXITJMP_SUCCESS;
@@ -2686,6 +3064,10 @@ void csoundLongJmp(CSOUND *csound, int retval)
     //printf("**** n = %d\n", n);
     if (!n)
       n = CSOUND_EXITJMP_SUCCESS;
+#ifdef CS_TLS
+    if (thread_exitjmp != NULL)         /* on a helper thread */
+      longjmp(*thread_exitjmp, n);
+#endif
 
     csound->curip = NULL;
     csound->ids = NULL;
@@ -2698,6 +3080,30 @@ void csoundLongJmp(CSOUND *csound, int retval)
     longjmp(csound->exitjmp, n);
 }
 
+/* Runs func(csound, data) on a helper thread, such as the instance pool
+   or a table generation thread, so that a csoundDie() or an allocation
+   failure in it makes this return CSOUND_ERROR instead of jumping to
+   exitjmp, which belongs to the performance thread.  Otherwise returns
+   what func returned. */
+int csoundRunCaught(CSOUND *csound, int (*func)(CSOUND *, void *), void *data)
+{
+#ifdef CS_TLS
+    jmp_buf env, *saved = thread_exitjmp;
+    int     retval;
+
+    if (setjmp(env)) {
+      thread_exitjmp = saved;
+      return CSOUND_ERROR;
+    }
+    thread_exitjmp = &env;
+    retval = func(csound, data);
+    thread_exitjmp = saved;
+    return retval;
+#else
+    return func(csound, data);
+#endif
+}
+
 PUBLIC void csoundSetMessageLevel(CSOUND *csound, int messageLevel)
 {
     csound->oparms_.msglevel = messageLevel;
@@ -2798,6 +3204,74 @@ static void dummy_rtaudio_timer(CSOUND *csound, double *p)
       csoundSleep((size_t) i);
 }
 
+/* In callback mode the dummy module runs a thread in place of a driver,
+   calling csoundRtCallback() once per period in real time.  The input of
+   each period is the output of the one before, as if looped back with a
+   cable, so the round trip through the engine can be measured without
+   audio hardware. */
+
+typedef struct {
+    CSOUND  *csound;
+    void    *thread;
+    volatile int quit;
+    int     nframes, nchnls, inchnls;
+    float   *buf;               /* nchnls output, then inchnls input */
+    float   **out;
+} RTDUMMY_CB;
+
+static RTDUMMY_CB *get_dummy_callback_globals(CSOUND *csound)
+{
+    RTDUMMY_CB  *d;
+
+    d = (RTDUMMY_CB*) csound->QueryGlobalVariable(csound, "__rtaudio_null_cb");
+    if (d == NULL) {
+      if (UNLIKELY(csound->CreateGlobalVariable(csound, "__rtaudio_null_cb",
+                                                sizeof(RTDUMMY_CB)) != 0))
+        csound->Die(csound, Str("rtdummy: failed to allocate globals"));
+      d = (RTDUMMY_CB*) csound->QueryGlobalVariable(csound,
+                                                    "__rtaudio_null_cb");
+      d->csound = csound;
+    }
+    return d;
+}
+
+static uintptr_t dummy_callback_thread(void *arg)
+{
+    RTDUMMY_CB  *d = (RTDUMMY_CB*) arg;
+    CSOUND      *csound = d->csound;
+    float       **in = (d->inchnls > 0 ? d->out + d->nchnls : NULL);
+    double      p[2];
+    int         c;
+
+    p[0] = csoundGetRealTime(csound->csRtClock);
+    p[1] = (double) d->nframes / (double) csound->esr;
+    while (!ATOMIC_GET(d->quit)) {
+      for (c = 0; c < d->inchnls; c++)
+        memcpy(in[c], d->out[c % d->nchnls], d->nframes * sizeof(float));
+      csoundRtCallback(csound, (const float *const *) in, 1,
+                       d->out, 1, d->nframes);
+      p[0] += p[1];
+      dummy_rtaudio_timer(csound, p);
+    }
+    return 0;
+}
+
+static void dummy_callback_start(CSOUND *csound, const csRtAudioParams *parm)
+{
+    RTDUMMY_CB  *d = get_dummy_callback_globals(csound);
+    int         c, n;
+
+    d->nframes = (int) parm->bufSamp_SW;
+    d->nchnls = parm->nChannels;
+    n = d->nchnls + d->inchnls;
+    d->buf = (float*) csound->Calloc(csound,
+                                     (size_t) n * d->nframes * sizeof(float));
+    d->out = (float**) csound->Malloc(csound, n * sizeof(float*));
+    for (c = 0; c < n; c++)
+      d->out[c] = d->buf + (size_t) c * d->nframes;
+    d->thread = csoundCreateThread(dummy_callback_thread, (void*) d);
+}
+
 int playopen_dummy(CSOUND *csound, const csRtAudioParams *parm)
 {
     double  *p;
@@ -2824,6 +3298,8 @@ int playopen_dummy(CSOUND *csound, const csRtAudioParams *parm)
     p[0] = csound->GetRealTime(csound->csRtClock);
     p[1] = 1.0 / ((double) ((int) sizeof(MYFLT) * parm->nChannels)
                   * (double) parm->sampleRate);
+    if (csoundRtCallbackMode(csound))
+      dummy_callback_start(csound, parm);
     return CSOUND_SUCCESS;
 }
 
@@ -2861,6 +3337,9 @@ int recopen_dummy(CSOUND *csound, const csRtAudioParams *parm)
     p[0] = csound->GetRealTime(csound->csRtClock);
     p[1] = 1.0 / ((double) ((int) sizeof(MYFLT) * parm->nChannels)
                   * (double) parm->sampleRate);
+    /* input is opened first; the callback starts with the output */
+    if (csound->rt_callback)
+      get_dummy_callback_globals(csound)->inchnls = parm->nChannels;
     return CSOUND_SUCCESS;
 }
 
@@ -2880,6 +3359,18 @@ int rtrecord_dummy(CSOUND *csound, MYFLT *inBuf, int nbytes)
 
 void rtclose_dummy(CSOUND *csound)
 {
+    RTDUMMY_CB  *d;
+
+    d = (RTDUMMY_CB*) csound->QueryGlobalVariable(csound, "__rtaudio_null_cb");
+    if (d != NULL) {
+      if (d->thread != NULL) {
+        ATOMIC_SET(d->quit, 1);
+        csoundJoinThread(d->thread);
+      }
+      csound->Free(csound, d->out);
+      csound->Free(csound, d->buf);
+      csound->DestroyGlobalVariable(csound, "__rtaudio_null_cb");
+    }
     csound->rtPlay_userdata = NULL;
     csound->rtRecord_userdata = NULL;
 }
@@ -2939,6 +3430,21 @@ PUBLIC void csoundSetAudioDeviceListCallback(CSOUND *csound,
     csound->audio_dev_list_callback = audiodevlist__;
 }
 
+PUBLIC int csoundGetRtAudioStats(CSOUND *csound, CS_RTAUDIO_STATS *stats)
+{
+    CS_RTAUDIO_STATS *p;
+
+    p = (CS_RTAUDIO_STATS*) csoundQueryGlobalVariable(csound, "_rtaudioStats");
+    if (p == NULL)
+      return CSOUND_ERROR;
+    stats->xruns = ATOMIC_GET(p->xruns);
+    stats->late_wakes = ATOMIC_GET(p->late_wakes);
+    stats->fill = ATOMIC_GET(p->fill);
+    stats->min_fill = ATOMIC_GET(p->min_fill);
+    stats->nbuffers = p->nbuffers;
+    return CSOUND_SUCCESS;
+}
+
 PUBLIC void csoundSetMIDIDeviceListCallback(CSOUND *csound,
             int (*mididevlist__)(CSOUND *, CS_MIDIDEVICE *list, int isOutput))
 {
@@ -3299,7 +3805,9 @@ static void reset(CSOUND *csound)
     close_all_files(csound);
     /* delete temporary files created by this Csound instance */
     remove_tmpfiles(csound);
+    ftgen_async_stop(csound);
     rlsmemfiles(csound);
+    bscore_close(csound);
 
      while (csound->filedir[n])        /* Clear source directory */
        csound->Free(csound,csound->filedir[n++]);
@@ -3339,6 +3847,8 @@ static void reset(CSOUND *csound)
     csound->enableHostImplementedMIDIIO = saved_env->enableHostImplementedMIDIIO;
     memcpy(&(csound->exitjmp), &(saved_env->exitjmp), sizeof(jmp_buf));
     csound->memalloc_db = saved_env->memalloc_db;
+    csound->mem_pool = saved_env->mem_pool;
+    csound->msg_queue_policy = saved_env->msg_queue_policy;
     //csound->self = self;
     free(saved_env);
 
@@ -335,7 +335,15 @@ PUBLIC int csoundCompileArgs(CSOUND *csound, int argc, const char **argv)
       return -1;
     /* IV - Oct 31 2002: now we can read and sort the score */
 
-    if (csound->scorename != NULL &&
+    if (csound->scorename != NULL && csound->scorestr == NULL &&
+        bscore_open(csound, csound->scorename) == OK) {
+      /* pre-sorted binary score (see scbin): played as it is */
+      if (csound->xfilename != NULL) {
+        csound->Warning(csound, Str("cannot extract from a binary score"));
+        csound->xfilename = NULL;
+      }
+    }
+    else if (csound->scorename != NULL &&
         (n = strlen(csound->scorename)) > 4 &&  /* if score ?.srt or ?.xtr */
         (!strcmp(csound->scorename + (n - 4), ".srt") ||
          !strcmp(csound->scorename + (n - 4), ".xtr"))) {
@@ -524,11 +532,12 @@ PUBLIC int csoundStart(CSOUND *csound) // DEBUG
 
     if (O->numThreads > 1) {
       void csp_barrier_alloc(CSOUND *, void **, int);
+      void csp_dag_sched_alloc(CSOUND *, int);
       int i;
       THREADINFO *current = NULL;
 
-      csp_barrier_alloc(csound, &(csound->barrier1), O->numThreads);
       csp_barrier_alloc(csound, &(csound->barrier2), O->numThreads);
+      csp_dag_sched_alloc(csound, O->numThreads);
 
       csound->multiThreadedComplete = 0;
 
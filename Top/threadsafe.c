@@ -53,28 +53,48 @@ void set_channel_data_ptr(CSOUND *csound, const char *name,
 enum {INPUT_MESSAGE=1, READ_SCORE, SCORE_EVENT, SCORE_EVENT_ABS,
       TABLE_COPY_OUT, TABLE_COPY_IN, TABLE_SET, MERGE_STATE, KILL_INSTANCE};
 
-/* MAX QUEUE SIZE */
+/* MAX QUEUE SIZE, must be a power of two */
 #define API_MAX_QUEUE 1024
+#define API_QUEUE_MASK (API_MAX_QUEUE - 1)
 /* ARG LIST ALIGNMENT */
 #define ARG_ALIGN 8
-
-/* Message queue structure */
+/* slots are padded to a whole number of cache lines */
+#define API_CACHE_LINE 64
+#define API_SLOT_SIZE 128
+/* args up to this size are copied into the slot itself,
+   larger ones (long strings, many pfields) are spilled to the heap */
+#define API_INLINE_ARGS (API_SLOT_SIZE - 4*sizeof(int64_t) - 2*sizeof(char *))
+
+/* Message queue slot */
 typedef struct _message_queue {
+  volatile long seq;  /* position this slot is ready for */
   int64_t message;  /* message id */
-  char *args;   /* args, arg pointers */
+  char *args;   /* args, arg pointers: points to inl or a spill block */
   int64_t rtn;  /* return value */
+  int64_t argsiz;
+  char *spill;  /* heap args, freed by the reader */
+  char inl[API_INLINE_ARGS];
 } message_queue_t;
 
+/* Bounded multi-producer, single-consumer ring (after D. Vyukov).
+   Writers claim a position with a CAS on wput, fill the slot and
+   publish it by advancing its sequence number; the performance thread
+   is the only reader. The two indices live on separate cache lines
+   so that writers do not bounce the reader's line and vice-versa.
+*/
+typedef struct _message_ring {
+  volatile long wput;   /* Writer - Put index */
+  char pad0[API_CACHE_LINE - sizeof(long)];
+  volatile long rget;   /* Reader - Get index */
+  char pad1[API_CACHE_LINE - sizeof(long)];
+  volatile long peak;   /* counters, see csoundGetAPIQueueStats() */
+  volatile long spills;
+  volatile long drops;
+  volatile long rejects;
+  char pad2[API_CACHE_LINE - 4*sizeof(long)];
+  message_queue_t slot[API_MAX_QUEUE];
+} message_ring_t;
 
-/* atomicGetAndIncrementWithModulus */
-static long atomicGet_Incr_Mod(volatile long* val, long mod) {
-  volatile long oldVal, newVal;
-  do {
-    oldVal = *val;
-    newVal = (oldVal + 1) % mod;
-  } while (ATOMIC_CMP_XCH(val, newVal, oldVal));
-  return oldVal;
-}
 
 /* called by csoundCreate() at the start
    and also by csoundStart() to cover de-allocation
@@ -83,57 +103,117 @@ static long atomicGet_Incr_Mod(volatile long* val, long mod) {
 void allocate_message_queue(CSOUND *csound) {
   if (csound->msg_queue == NULL) {
     int i;
-    csound->msg_queue = (message_queue_t **)
-      csound->Calloc(csound, sizeof(message_queue_t*)*API_MAX_QUEUE);
-    for (i = 0; i < API_MAX_QUEUE; i++) {
-      csound->msg_queue[i] =
-        (message_queue_t*)
-        csound->Calloc(csound, sizeof(message_queue_t));
-    }
+    char *mem = (char *)
+      csound->Calloc(csound, sizeof(message_ring_t) + API_CACHE_LINE);
+    /* the block itself goes with the memory chain on reset */
+    message_ring_t *q = (message_ring_t *)
+      (((uintptr_t) mem + API_CACHE_LINE - 1) &
+       ~((uintptr_t) API_CACHE_LINE - 1));
+    for (i = 0; i < API_MAX_QUEUE; i++)
+      q->slot[i].seq = i;
+    csound->msg_queue = q;
   }
 }
 
+/* keep the high-water mark of the queue depth */
+static inline void message_queue_peak(message_ring_t *q, long pos) {
+  long depth = pos + 1 - ATOMIC_GET(q->rget);
+  long peak = ATOMIC_GET(q->peak);
+  while (depth > peak) {
+    if (!ATOMIC_CMP_XCH(&q->peak, depth, peak)) break;
+    peak = ATOMIC_GET(q->peak);
+  }
+}
+
+/* enqueue should be called by the relevant API function;
+   args are copied into the slot followed by an optional tail
+   (the pfield list of score events), internal messages (force != 0)
+   always wait for a free slot, host messages follow the policy set
+   by csoundSetAPIQueuePolicy()
+*/
+static void *message_enqueue_(CSOUND *csound, int32_t message,
+                              const char *args, int argsiz,
+                              const void *tail, int tailsiz, int force) {
+  message_ring_t *q = csound->msg_queue;
+  message_queue_t *msg;
+  long pos, seq, dif;
+  int spin = 0;
+
+  if (UNLIKELY(q == NULL)) return NULL;
+  pos = ATOMIC_GET(q->wput);
+  for (;;) {
+    msg = &q->slot[pos & API_QUEUE_MASK];
+    seq = ATOMIC_GET(msg->seq);
+    dif = seq - pos;
+    if (dif == 0) {
+      /* ATOMIC_CMP_XCH takes the new value by address */
+      long next = pos + 1;
+      if (!ATOMIC_CMP_XCH(&q->wput, next, pos)) break;
+      /* lost the race */
+      pos = ATOMIC_GET(q->wput);
+    }
+    else if (dif < 0) {
+      /* queue is full */
+      if (!force) {
+        if (csound->msg_queue_policy == CSOUND_API_QUEUE_DROP) {
+          ATOMIC_INCR(q->drops);
+          return NULL;
+        }
+        if (csound->msg_queue_policy == CSOUND_API_QUEUE_ERROR) {
+          ATOMIC_INCR(q->rejects);
+          csound->Warning(csound, Str("API message queue full, "
+                                      "message %d rejected\n"), message);
+          return NULL;
+        }
+      }
+      if (++spin > 64) {
+        csoundSleep(1);
+        spin = 0;
+      }
+      pos = ATOMIC_GET(q->wput);
+    }
+    else pos = ATOMIC_GET(q->wput);
+  }
+
+  /* the slot is ours until we publish it */
+  msg->message = message;
+  msg->argsiz = argsiz + tailsiz;
+  if (LIKELY((size_t) msg->argsiz <= API_INLINE_ARGS)) {
+    msg->spill = NULL;
+    msg->args = msg->inl;
+  }
+  else {
+    msg->spill = (char *) csound->Malloc(csound, (size_t) msg->argsiz);
+    msg->args = msg->spill;
+    ATOMIC_INCR(q->spills);
+  }
+  memcpy(msg->args, args, argsiz);
+  if (tailsiz > 0)
+    memcpy(msg->args + argsiz, tail, tailsiz);
+  message_queue_peak(q, pos);
+  ATOMIC_SET(msg->seq, pos + 1);
+  return (void *) &msg->rtn;
+}
 
-/* enqueue should be called by the relevant API function */
 void *message_enqueue(CSOUND *csound, int32_t message, char *args,
                       int argsiz) {
-  if(csound->msg_queue != NULL) {
-    int64_t *rtn;
-    volatile long items;
-
-    /* block if queue is full */
-    do {
-      items = ATOMIC_GET(csound->msg_queue_items);
-    } while(items >= API_MAX_QUEUE);
-
-    message_queue_t* msg =
-      csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wget,
-                                           API_MAX_QUEUE)];
-    msg->message = message;
-    if(msg->args != NULL)
-      csound->Free(csound, msg->args);
-    msg->args = (char *)csound->Calloc(csound, argsiz);
-    memcpy(msg->args, args, argsiz);
-    rtn = &msg->rtn;
-    csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wput,
-                                         API_MAX_QUEUE)] = msg;
-    ATOMIC_INCR(csound->msg_queue_items);
-    return (void *) rtn;
-  }
-  else return NULL;
+  return message_enqueue_(csound, message, args, argsiz, NULL, 0, 0);
 }
 
 /* dequeue should be called by kperf_*()
    NB: these calls are already in place
 */
 void message_dequeue(CSOUND *csound) {
-  if(csound->msg_queue != NULL) {
-    long rp = csound->msg_queue_rstart;
-    long items = csound->msg_queue_items;
-    long rend = rp + items;
+  message_ring_t *q = csound->msg_queue;
+  if(q != NULL) {
+    long rp = q->rget;
+    /* take at most one queue's worth per k-cycle, so busy
+       writers cannot hold up performance */
+    long rend = rp + API_MAX_QUEUE;
 
     while(rp < rend) {
-      message_queue_t* msg = csound->msg_queue[rp % API_MAX_QUEUE];
+      message_queue_t* msg = &q->slot[rp & API_QUEUE_MASK];
+      if (ATOMIC_GET(msg->seq) != rp + 1) break;  /* not published yet */
       switch(msg->message) {
       case INPUT_MESSAGE:
         {
@@ -154,10 +234,10 @@ void message_dequeue(CSOUND *csound) {
           const MYFLT *pfields;
           long numFields;
           type = msg->args[0];
-          memcpy(&pfields, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          memcpy(&numFields, msg->args + ARG_ALIGN*2,
+          memcpy(&numFields, msg->args + ARG_ALIGN,
                  sizeof(long));
+          /* pfields were copied in after the fixed args */
+          pfields = (const MYFLT *) (msg->args + ARG_ALIGN*2);
 
           csoundScoreEventInternal(csound, type, pfields, numFields);
         }
@@ -169,12 +249,11 @@ void message_dequeue(CSOUND *csound) {
           long numFields;
           double ofs;
           type = msg->args[0];
-          memcpy(&pfields, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          memcpy(&numFields, msg->args + ARG_ALIGN*2,
+          memcpy(&numFields, msg->args + ARG_ALIGN,
                  sizeof(long));
-          memcpy(&ofs, msg->args + ARG_ALIGN*3,
+          memcpy(&ofs, msg->args + ARG_ALIGN*2,
                  sizeof(double));
+          pfields = (const MYFLT *) (msg->args + ARG_ALIGN*3);
 
           csoundScoreEventAbsoluteInternal(csound, type, pfields, numFields,
                                              ofs);
@@ -244,10 +323,37 @@ void message_dequeue(CSOUND *csound) {
         break;
       }
       msg->message = 0;
+      if (msg->spill != NULL) {
+        csound->Free(csound, msg->spill);
+        msg->spill = NULL;
+      }
+      /* hand the slot back to the writers for the next lap */
+      ATOMIC_SET(msg->seq, rp + API_MAX_QUEUE);
       rp += 1;
+      ATOMIC_SET(q->rget, rp);
     }
-    ATOMIC_SUB(csound->msg_queue_items, items);
-    csound->msg_queue_rstart = rp % API_MAX_QUEUE;
+  }
+}
+
+void csoundSetAPIQueuePolicy(CSOUND *csound, int policy)
+{
+  if (policy < CSOUND_API_QUEUE_BLOCK || policy > CSOUND_API_QUEUE_ERROR)
+    policy = CSOUND_API_QUEUE_BLOCK;
+  csound->msg_queue_policy = policy;
+}
+
+void csoundGetAPIQueueStats(CSOUND *csound, CS_API_QUEUE_STATS *stats)
+{
+  message_ring_t *q = csound->msg_queue;
+  memset(stats, 0, sizeof(CS_API_QUEUE_STATS));
+  stats->capacity = API_MAX_QUEUE;
+  if (q != NULL) {
+    long depth = ATOMIC_GET(q->wput) - ATOMIC_GET(q->rget);
+    stats->depth = depth > 0 ? (uint64_t) depth : 0;
+    stats->peak_depth = (uint64_t) ATOMIC_GET(q->peak);
+    stats->spills = (uint64_t) ATOMIC_GET(q->spills);
+    stats->drops = (uint64_t) ATOMIC_GET(q->drops);
+    stats->rejects = (uint64_t) ATOMIC_GET(q->rejects);
   }
 }
 
@@ -295,12 +401,12 @@ static inline int64_t *csoundScoreEvent_enqueue(CSOUND *csound, char type,
                                                 const MYFLT *pfields,
                                                 long numFields)
 {
-  const int argsize = ARG_ALIGN*3;
-  char args[ARG_ALIGN*3];
+  const int argsize = ARG_ALIGN*2;
+  char args[ARG_ALIGN*2];
   args[0] = type;
-  memcpy(args+ARG_ALIGN, &pfields, sizeof(MYFLT *));
-  memcpy(args+2*ARG_ALIGN, &numFields, sizeof(long));
-  return message_enqueue(csound,SCORE_EVENT, args, argsize);
+  memcpy(args+ARG_ALIGN, &numFields, sizeof(long));
+  return message_enqueue_(csound, SCORE_EVENT, args, argsize,
+                          pfields, (int) (numFields*sizeof(MYFLT)), 0);
 }
 
 
@@ -309,13 +415,13 @@ static inline int64_t *csoundScoreEventAbsolute_enqueue(CSOUND *csound, char typ
                                                         long numFields,
                                                         double time_ofs)
 {
-  const int argsize = ARG_ALIGN*4;
-  char args[ARG_ALIGN*4];
+  const int argsize = ARG_ALIGN*3;
+  char args[ARG_ALIGN*3];
   args[0] = type;
-  memcpy(args+ARG_ALIGN, &pfields, sizeof(MYFLT *));
-  memcpy(args+2*ARG_ALIGN, &numFields, sizeof(long));
-  memcpy(args+3*ARG_ALIGN, &time_ofs, sizeof(double));
-  return message_enqueue(csound,SCORE_EVENT_ABS, args, argsize);
+  memcpy(args+ARG_ALIGN, &numFields, sizeof(long));
+  memcpy(args+2*ARG_ALIGN, &time_ofs, sizeof(double));
+  return message_enqueue_(csound, SCORE_EVENT_ABS, args, argsize,
+                          pfields, (int) (numFields*sizeof(MYFLT)), 0);
 }
 
 /* this is to be called from
@@ -326,12 +432,12 @@ void killInstance_enqueue(CSOUND *csound, MYFLT instr, int insno,
                           int allow_release) {
   const int argsize = ARG_ALIGN*5;
   char args[ARG_ALIGN*5];
-  memcpy(args, &instr, sizeof(int));
+  memcpy(args, &instr, sizeof(MYFLT));
   memcpy(args+ARG_ALIGN, &insno, sizeof(int));
   memcpy(args+ARG_ALIGN*2, &ip, sizeof(INSDS *));
   memcpy(args+ARG_ALIGN*3, &mode, sizeof(int));
   memcpy(args+ARG_ALIGN*4, &allow_release, sizeof(int));
-  message_enqueue(csound,KILL_INSTANCE,args,argsize);
+  message_enqueue_(csound, KILL_INSTANCE, args, argsize, NULL, 0, 1);
 }
 
 /* this is to be called from
@@ -343,7 +449,7 @@ void mergeState_enqueue(CSOUND *csound, ENGINE_STATE *e, TYPE_TABLE* t, OPDS *id
   memcpy(args, &e, sizeof(ENGINE_STATE *));
   memcpy(args+ARG_ALIGN, &t, sizeof(TYPE_TABLE *));
   memcpy(args+2*ARG_ALIGN, &ids, sizeof(OPDS *));
-  message_enqueue(csound,MERGE_STATE, args, argsize);
+  message_enqueue_(csound, MERGE_STATE, args, argsize, NULL, 0, 1);
 }
 
 /*  VL: These functions are slated to
@@ -511,7 +617,7 @@ MYFLT csoundGetControlChannel(CSOUND *csound, const char *name, int *err)
     MYFLT_INT_TYPE i;
   } x;
   x.d = FL(0.0);
-  if (UNLIKELY(strlen(name) == 0)) return FL(.0);
+  if (UNLIKELY(name[0] == '\0')) return FL(.0);
   if ((err_ = csoundGetChannelPtr(csound, &pval, name,
                                   CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL))
       == CSOUND_SUCCESS) {
@@ -263,6 +263,55 @@ PUBLIC int csoundScoreSort(CSOUND *csound, FILE *inFile, FILE *outFile)
     return 0;
 }
 
+/**
+ * Sorts score file 'inFile' and writes the result to 'outFile', which is
+ * the same as that of csoundScoreSort().  Each section is written out as
+ * soon as it is sorted rather than the whole sorted score being built in
+ * memory first, and large sections are sorted on 'nthreads' threads.
+ * On success, zero is returned.
+ */
+
+PUBLIC int csoundScoreSortParallel(CSOUND *csound, FILE *inFile, FILE *outFile,
+                                   int nthreads)
+{
+    int   err;
+    CORFIL *inf = corfile_create_w(csound);
+    int c;
+    if ((err = setjmp(csound->exitjmp)) != 0) {
+      return ((err - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
+    }
+    while ((c=getc(inFile))!=EOF) corfile_putc(csound, c, inf);
+    corfile_puts(csound, "\ne\n#exit\n", inf);
+    corfile_rewind(inf);
+    csound->scorestr = inf;
+    return scsortfile(csound, inf, outFile, nthreads < 1 ? 1 : nthreads);
+}
+
+/**
+ * Sorts score file 'inFile' like csoundScoreSort() and writes the result
+ * to 'outFile' as a binary score, which csound plays without parsing it
+ * again when given in place of a text score.  'outFile' must be seekable.
+ * On success, zero is returned.
+ */
+
+PUBLIC int csoundScoreToBinary(CSOUND *csound, FILE *inFile, FILE *outFile)
+{
+    int   err;
+    CORFIL *inf = corfile_create_w(csound);
+    int c;
+    if ((err = setjmp(csound->exitjmp)) != 0) {
+      return ((err - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
+    }
+    while ((c=getc(inFile))!=EOF) corfile_putc(csound, c, inf);
+    corfile_puts(csound, "\ne\n#exit\n", inf);
+    corfile_rewind(inf);
+    csound->scorestr = inf;
+    scsortstr(csound, inf);
+    err = bscore_write(csound, outFile);
+    corfile_rm(csound, &csound->scstr);
+    return err;
+}
+
 /**
  * Extracts from 'inFile', controlled by 'extractFile', and writes
  * the result to 'outFile'. The Csound instance should be initialised
@@ -24,6 +24,18 @@
 #ifndef __ARRAY_H__
 #define __ARRAY_H__
 
+/* Grow the data of p to at least ss bytes, zeroing the new space.  The
+   capacity at least doubles, so an array whose size keeps changing during
+   performance stops reallocating once it has reached its largest size. */
+static inline void tabgrow(CSOUND *csound, ARRAYDAT *p, size_t ss)
+{
+    size_t cap = p->allocated*2;
+    if (cap < ss) cap = ss;
+    p->data = (MYFLT*) csound->ReAlloc(csound, p->data, cap);
+    memset((char*)(p->data)+p->allocated, '\0', cap-p->allocated);
+    p->allocated = cap;
+}
+
 static inline void tabinit(CSOUND *csound, ARRAYDAT *p, int size)
 {
     size_t ss;
@@ -38,26 +50,26 @@ static inline void tabinit(CSOUND *csound, ARRAYDAT *p, int size)
         p->data = (MYFLT*)csound->Calloc(csound, ss);
         p->allocated = ss;
     } else if( (ss = p->arrayMemberSize*size) > p->allocated) {
-        p->data = (MYFLT*) csound->ReAlloc(csound, p->data, ss);
-        memset((char*)(p->data)+p->allocated, '\0', ss-p->allocated);
-        p->allocated = ss;
+        tabgrow(csound, p, ss);
     }
     if (p->dimensions==1) p->sizes[0] = size;
     //p->dimensions = 1;
 }
 static inline void tabinit_like(CSOUND *csound, ARRAYDAT *p, ARRAYDAT *tp)
 {
-    uint32_t ss = 1;
+    size_t ss = 1;
+    int i;
+    if (p->data != NULL && p->data == tp->data) return;
     if (p->dimensions != tp->dimensions) {
-      int i;
       p->sizes = (int32_t*)csound->ReAlloc(csound, p->sizes,
                                            sizeof(int32_t)*tp->dimensions);
-      for (i=0; i<tp->dimensions; i++) {
-        p->sizes[i] = tp->sizes[i];
-        ss *= tp->sizes[i];
-      }
       p->dimensions = tp->dimensions;
     }
+    /* follow the size of tp, which may change during performance */
+    for (i=0; i<tp->dimensions; i++) {
+      p->sizes[i] = tp->sizes[i];
+      ss *= tp->sizes[i];
+    }
     if (p->data == NULL) {
         CS_VARIABLE* var = p->arrayType->createVariable(csound, NULL);
         p->arrayMemberSize = var->memBlockSize;
@@ -65,8 +77,7 @@ static inline void tabinit_like(CSOUND *csound, ARRAYDAT *p, ARRAYDAT *tp)
         p->data = (MYFLT*)csound->Calloc(csound, ss);
         p->allocated = ss;
     } else if( (ss = p->arrayMemberSize*ss) > p->allocated) {
-        p->data = (MYFLT*) csound->ReAlloc(csound, p->data, ss);
-        p->allocated = ss;
+        tabgrow(csound, p, ss);
     }
 }
 
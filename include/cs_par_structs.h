@@ -67,4 +67,17 @@ typedef struct _watchList {
                      sizeof(struct _watchList *))) / sizeof(uint8_t)];
 } watchList;
 
+/* Per-thread deque of ready tasks for work-stealing dispatch.
+ * The owning thread pushes and pops at the bottom, idle threads
+ * steal from the top.  Each task is queued at most once per k-cycle,
+ * so the array never needs to wrap and is reset between cycles. */
+typedef struct _taskDeque {
+  volatile int top;
+  uint8_t padding1 [(CONCURRENTPADDING - sizeof(int)) / sizeof(uint8_t)];
+  volatile int bottom;
+  taskID *tasks;
+  uint8_t padding2 [(CONCURRENTPADDING -
+                     (sizeof(int) + sizeof(taskID *))) / sizeof(uint8_t)];
+} taskDeque;
+
 #endif
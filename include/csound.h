@@ -531,6 +531,96 @@ extern "C" {
     int isOutput;
   } CS_MIDIDEVICE;
 
+  /**
+   * Memory allocator statistics, see csoundGetMemoryStats()
+   */
+  typedef struct {
+    uint64_t system_allocs;  /* blocks and chunks obtained from the system */
+    uint64_t system_frees;   /* large blocks returned to the system */
+    uint64_t pool_refills;   /* thread free lists refilled from the pool */
+    uint64_t pool_bytes;     /* bytes held in size-class chunks */
+  } CS_MEMORY_STATS;
+
+  /**
+   * Full-queue policies, see csoundSetAPIQueuePolicy()
+   */
+  typedef enum {
+    CSOUND_API_QUEUE_BLOCK = 0,
+    CSOUND_API_QUEUE_DROP = 1,
+    CSOUND_API_QUEUE_ERROR = 2
+  } CSOUND_API_QUEUE_POLICY;
+
+  /**
+   * Asynchronous API message queue statistics, see csoundGetAPIQueueStats()
+   */
+  typedef struct {
+    uint64_t capacity;    /* number of slots */
+    uint64_t depth;       /* messages waiting for the performance thread */
+    uint64_t peak_depth;  /* high-water mark of depth */
+    uint64_t spills;      /* messages whose args did not fit in a slot */
+    uint64_t drops;       /* messages dropped on a full queue */
+    uint64_t rejects;     /* messages refused with a warning */
+  } CS_API_QUEUE_STATS;
+
+  /**
+   * Instance pool statistics for one instrument,
+   * see csoundGetInstrumentPoolStats()
+   */
+  typedef struct {
+    int allocated;   /* instances owned by the instrument */
+    int active;      /* instances currently active */
+    int high_water;  /* most instances active at once */
+    int warm;        /* instances built ahead, not yet handed out */
+    int misses;      /* instances that had to be allocated at note-on */
+    int warmed;      /* instances built by the pool thread */
+  } CS_INSTR_POOL_STATS;
+
+  /**
+   * Read-ahead state of one asynchronous diskin2 stream,
+   * see csoundGetDiskinStreamStats()
+   */
+  typedef struct {
+    char     name[128];  /* file name */
+    uint64_t underruns;  /* blocks not read ahead in time */
+    uint64_t refills;    /* blocks read by the IO threads */
+    uint32_t buffered;   /* samples read ahead */
+    uint32_t capacity;   /* cache size in samples */
+  } CS_DISKIN_STREAM_STATS;
+
+  /**
+   * Real time event queue statistics, see csoundGetEventQueueStats()
+   */
+  typedef struct {
+    uint64_t queued;       /* events waiting for their start time */
+    uint64_t peak_queued;  /* high-water mark of queued */
+    uint64_t scheduled;    /* events queued since the start */
+    uint64_t late;         /* events started after their k-cycle */
+    uint64_t late_init;    /* asyncinit notes started more than one
+                              k-cycle late, waiting for their init pass */
+  } CS_EVENT_QUEUE_STATS;
+
+  /**
+   * Process-wide sample cache statistics, see csoundGetSampleCacheStats()
+   */
+  typedef struct {
+    uint64_t hits;            /* loads served from the cache */
+    uint64_t misses;          /* loads that read the file */
+    uint64_t evictions;       /* idle files dropped to stay within budget */
+    uint64_t entries;         /* files in the cache */
+    uint64_t resident_bytes;  /* bytes of sample data they hold */
+  } CS_SAMPLE_CACHE_STATS;
+
+  /**
+   * Real-time audio stream statistics, see csoundGetRtAudioStats()
+   */
+  typedef struct {
+    uint64_t xruns;           /* driver periods with no buffer ready */
+    uint64_t late_wakes;      /* performance thread woke to >1 buffer */
+    int      fill;            /* buffers queued for the driver */
+    int      min_fill;        /* low-water mark of fill */
+    int      nbuffers;        /* buffers between Csound and the driver */
+  } CS_RTAUDIO_STATS;
+
 
   /**
    * Real-time audio parameters structure
@@ -656,6 +746,12 @@ extern "C" {
     controlChannelHints_t    hints;
   } controlChannelInfo_t;
 
+  /**
+   * Opaque handle to a channel, see csoundGetChannelHandle().
+   * Handles stay valid until csoundReset() or csoundDestroy().
+   */
+  typedef struct channelEntry_s *CS_CHANNEL_HANDLE;
+
   typedef void (*channelCallback_t)(CSOUND *csound,
                                     const char *channelName,
                                     void *channelValuePtr,
@@ -1363,6 +1459,37 @@ extern "C" {
                                                    CS_AUDIODEVICE *list,
                                                    int isOutput));
 
+  /**
+   * Fills 'stats' with the counters of the real-time audio stream, as
+   * kept by the rtaudio module (currently jack) in the global variable
+   * "_rtaudioStats" while the stream is open. Returns CSOUND_SUCCESS,
+   * or CSOUND_ERROR if there is no such stream.
+   */
+  PUBLIC int csoundGetRtAudioStats(CSOUND *csound, CS_RTAUDIO_STATS *stats);
+
+  /**
+   * Called by an rtaudio module from its open function. Returns non-zero
+   * if callback mode was asked for (--rt-callback), in which case the
+   * module must call csoundRtCallback() from its driver callback, and
+   * its rtplay and rtrecord functions will not be used.
+   */
+  PUBLIC int csoundRtCallbackMode(CSOUND *);
+
+  /**
+   * Runs the k-cycles for one period of a driver callback in callback
+   * mode, reading nframes frames of input from in[0..inchnls-1] (may be
+   * NULL) and writing output to out[0..nchnls-1]. Samples are
+   * instride/outstride floats apart, so both interleaved buffers (one
+   * pointer per channel into the same buffer, stride nchnls) and planar
+   * ones (stride 1) can be used without a copy. If nframes is a multiple
+   * of ksmps the output of a period is computed from its own input;
+   * otherwise it is one k-cycle later. Silence is written until the host
+   * calls a performance function, and after the score ends. Returns 0,
+   * or what the performance function will return once Csound has stopped.
+   */
+  PUBLIC int csoundRtCallback(CSOUND *, const float *const *in, int instride,
+                              float *const *out, int outstride, int nframes);
+
   /** @}*/
   /** @defgroup RTMIDI Realtime Midi I/O
    *
@@ -1539,6 +1666,25 @@ extern "C" {
    */
   PUBLIC int csoundScoreSort(CSOUND *, FILE *inFile, FILE *outFile);
 
+  /**
+   * Sorts score file 'inFile' as csoundScoreSort() does, with the same
+   * result, but writes each section to 'outFile' as soon as it is sorted
+   * instead of building the whole sorted score in memory, and sorts large
+   * sections on 'nthreads' threads.
+   * On success, zero is returned.
+   */
+  PUBLIC int csoundScoreSortParallel(CSOUND *, FILE *inFile, FILE *outFile,
+                                     int nthreads);
+
+  /**
+   * Sorts score file 'inFile' as csoundScoreSort() does and writes the
+   * result to 'outFile', which must be seekable, in the binary score
+   * format. Such a file can be given wherever a score file name is
+   * expected and is played without being parsed again.
+   * On success, zero is returned.
+   */
+  PUBLIC int csoundScoreToBinary(CSOUND *, FILE *inFile, FILE *outFile);
+
   /**
    * Extracts from 'inFile', controlled by 'extractFile', and writes
    * the result to 'outFile'. The Csound instance should be initialised
@@ -1768,6 +1914,52 @@ extern "C" {
   PUBLIC void csoundSetControlChannel(CSOUND *csound,
                                       const char *name, MYFLT val);
 
+  /**
+   * Looks up (or creates, as csoundGetChannelPtr() would) the channel
+   * called 'name' with the given type and returns a handle to it, or
+   * NULL if the name is invalid or the channel exists with another type.
+   * Resolving names once and using the handle functions below avoids
+   * a string lookup per access.
+   */
+  PUBLIC CS_CHANNEL_HANDLE csoundGetChannelHandle(CSOUND *,
+                                                  const char *name, int type);
+
+  /**
+   * Returns the name of the channel a handle refers to.
+   */
+  PUBLIC const char *csoundGetChannelHandleName(CS_CHANNEL_HANDLE h);
+
+  /**
+   * Reads the values of the 'n' control channels in 'handles' into
+   * 'values', with the same thread-safety as csoundGetControlChannel().
+   * Returns CSOUND_SUCCESS, or CSOUND_ERROR if any handle was NULL or
+   * not a control channel (its value is then set to zero).
+   */
+  PUBLIC int csoundGetControlChannels(CSOUND *,
+                                      const CS_CHANNEL_HANDLE *handles,
+                                      MYFLT *values, int n);
+
+  /**
+   * Sets the 'n' control channels in 'handles' from 'values', with the
+   * same thread-safety as csoundSetControlChannel().
+   * Returns CSOUND_SUCCESS, or CSOUND_ERROR if any handle was NULL or
+   * not a control channel.
+   */
+  PUBLIC int csoundSetControlChannels(CSOUND *,
+                                      const CS_CHANNEL_HANDLE *handles,
+                                      const MYFLT *values, int n);
+
+  /**
+   * Stores in 'handles' (at most 'max' of them) the control channels
+   * whose value was changed by chnset since the previous call, and
+   * returns how many were stored. Channels not returned because 'max'
+   * was reached are kept for the next call. Hosts can call this once
+   * per block and read only the channels returned.
+   */
+  PUBLIC int csoundGetChangedControlChannels(CSOUND *,
+                                             CS_CHANNEL_HANDLE *handles,
+                                             int max);
+
   /**
    * copies the audio channel identified by *name into array
    * *samples which should contain enough memory for ksmps MYFLTs
@@ -1875,6 +2067,23 @@ extern "C" {
    */
   PUBLIC void csoundInputMessageAsync(CSOUND *, const char *message);
 
+  /**
+   * Sets what the asynchronous API functions (the *Async() calls)
+   * do when the message queue to the performance thread is full:
+   * CSOUND_API_QUEUE_BLOCK waits for a free slot (the default),
+   * CSOUND_API_QUEUE_DROP discards the message and
+   * CSOUND_API_QUEUE_ERROR discards it and prints a warning.
+   * Dropped and rejected messages are counted, see
+   * csoundGetAPIQueueStats().
+   */
+  PUBLIC void csoundSetAPIQueuePolicy(CSOUND *, int policy);
+
+  /**
+   * Fills 'stats' with the current state of the asynchronous API
+   * message queue.
+   */
+  PUBLIC void csoundGetAPIQueueStats(CSOUND *, CS_API_QUEUE_STATS *stats);
+
   /**
    * Kills off one or more running instances of an instrument identified
    * by instr (number) or instrName (name). If instrName is NULL, the
@@ -2537,6 +2746,65 @@ extern "C" {
    */
   PUBLIC void csoundDestroyCircularBuffer(CSOUND *csound, void *circularbuffer);
 
+  /**
+   * Fills 'stats' with counters of the memory allocator of this instance,
+   * accumulated since it was created or last reset.  Small blocks are
+   * recycled through size-class free lists, so in steady-state
+   * performance system_allocs should not grow.
+   */
+  PUBLIC void csoundGetMemoryStats(CSOUND *, CS_MEMORY_STATS *stats);
+
+  /**
+   * Fills 'stats' with the instance pool statistics of instrument
+   * 'insno'. Each instrument keeps the most instances it has had active
+   * at once, and a background thread builds free instances ahead of that
+   * mark so that note-ons do not allocate. Returns CSOUND_SUCCESS, or
+   * CSOUND_ERROR if the instrument does not exist.
+   */
+  PUBLIC int csoundGetInstrumentPoolStats(CSOUND *, int insno,
+                                          CS_INSTR_POOL_STATS *stats);
+
+  /**
+   * Sets the look-ahead, in seconds, of diskin2 streams opened
+   * asynchronously (--realtime) after this call. Default 0.5 s.
+   */
+  PUBLIC void csoundSetDiskinReadAhead(CSOUND *, double seconds);
+
+  /**
+   * Fills up to max entries of stats with the state of the open
+   * asynchronous diskin2 streams, and returns the number filled.
+   * Underruns are counted per source block that had not been read
+   * ahead in time and was played as silence.
+   */
+  PUBLIC int csoundGetDiskinStreamStats(CSOUND *,
+                                        CS_DISKIN_STREAM_STATS *stats, int max);
+
+  /**
+   * Fills 'stats' with counters of the queue of real time events
+   * (event, schedule, csoundScoreEvent() and the like) waiting for their
+   * start time. An event is late if it could only be started after the
+   * k-cycle it was scheduled for, as when it was scheduled in the past.
+   * The notes of asyncinit instruments start at best one k-cycle after
+   * their time, once their init pass is done; late_init counts those
+   * that had to wait longer.
+   */
+  PUBLIC void csoundGetEventQueueStats(CSOUND *, CS_EVENT_QUEUE_STATS *stats);
+
+  /**
+   * Fills 'stats' with the counters of the sample cache shared by all
+   * Csound instances of the process. Files loaded into memory by
+   * csoundLoadSoundFile() and ldmemfile2withCB() are read once, mapped
+   * read-only and shared until the last instance using them is reset.
+   */
+  PUBLIC void csoundGetSampleCacheStats(CS_SAMPLE_CACHE_STATS *stats);
+
+  /**
+   * Sets the size in bytes the sample cache may grow to before files no
+   * instance uses any more are dropped, least recently used first
+   * (default 256 MB). Files in use are never dropped.
+   */
+  PUBLIC void csoundSetSampleCacheBudget(size_t bytes);
+
   /**
    * Platform-independent function to load a shared library.
    */
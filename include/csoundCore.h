@@ -346,6 +346,19 @@ typedef struct CORFIL {
     int     instcnt;                /* Count number of instances ever */
     int     isNew;                  /* is this a new definition */
     int     nocheckpcnt;            /* Control checks on pcnt */
+    /* instance pool, see instance_pool_update() in insert.c */
+    struct insds * warm;            /* Chain of instances built ahead by the
+                                       pool thread, not yet linked (nxtact) */
+    int     allocated;              /* instances in the instance chain */
+    int     active_hw;              /* most instances active at once */
+    int     warm_count;             /* instances in the warm chain */
+    int     warm_pending;           /* instances asked of the pool thread */
+    int     pool_queued;            /* has a request in the pool queue */
+    int     pool_misses;            /* instances allocated at note-on */
+    int     pool_warmed;            /* instances built by the pool thread */
+    int     async_init;             /* init pass on the init worker, see
+                                       asyncinit in insert.c */
+    size_t  perf_offset;            /* of the OPRUNS in each instance block */
   } INSTRTXT;
 
   typedef struct namedInstr {
@@ -592,6 +605,19 @@ typedef struct CORFIL {
 #define CS_SPOUT     (p->h.insdshead->spout)
   typedef int (*SUBR)(CSOUND *, void *);
 
+  /**
+   * An instance's perf-time chain as a flat array of its opcodes, built
+   * after init (see kperf).  It sits at the end of the instance's memory block,
+   * instr->perf_offset bytes from the INSDS, found with INS_OPRUNS().
+   */
+  typedef struct opruns {
+    int         nops, max, stale;
+    struct opds *ops[1];
+  } OPRUNS;
+
+#define INS_OPRUNS(ip) \
+  ((OPRUNS*) ((char*) (ip) + (ip)->instr->perf_offset))
+
   /**
    * This struct holds the info for one opcode in a concrete
    * instrument instance in performance.
@@ -690,6 +716,9 @@ typedef struct CORFIL {
     int32   flen;
     int     fno, guardreq;
     EVTBLK  e;
+    /** table being made by hfgens_async(), not in flist yet */
+    FUNC    *async_ftp;
+    int     async;
   } FGDATA;
 
   typedef struct {
@@ -1402,11 +1431,21 @@ typedef struct _message_queue_t_ {
     MYFLT* (*LPCeps)(CSOUND *, MYFLT *, MYFLT *, int, int);
     MYFLT* (*CepsLP)(CSOUND *, MYFLT *, MYFLT *, int, int);
     MYFLT (*LPrms)(CSOUND *, void *);
+    void (*RealFFTMultAcc)(CSOUND *, MYFLT *outbuf, const MYFLT *buf1,
+                           const MYFLT *buf2, int FFTsize);
+    void (*ComplexMultAcc)(CSOUND *, MYFLT *outbuf, const MYFLT *buf1,
+                           const MYFLT *buf2, int n);
+    int (*hfgensAsync)(CSOUND *, const EVTBLK *, int);
+    int (*FTReady)(CSOUND *, int);
+    MYFLT *(*FTMipmap)(CSOUND *, FUNC *, MYFLT);
+    int (*RtCallbackMode)(CSOUND *);
+    int (*RtCallback)(CSOUND *, const float *const *in, int instride,
+                      float *const *out, int outstride, int nframes);
     /**@}*/
     /** @name Placeholders
         To allow the API to grow while maintining backward binary compatibility. */
     /**@{ */
-    SUBR dummyfn_2[23];
+    SUBR dummyfn_2[16];
     /**@}*/
 #ifdef __BUILDING_LIBCSOUND
     /* ------- private data (not to be used by hosts or externals) ------- */
@@ -1679,6 +1718,8 @@ typedef struct _message_queue_t_ {
       uint32        nframes               /* = 1UL */;
       FILE          *pin, *pout;
       int           dither;
+      void          (*dithfn)(CSOUND *, MYFLT *, int);
+      void          *writer;              /* sound file writer thread     */
     } libsndStatics;
 
     int           warped;               /* rdscor.c */
@@ -1758,8 +1799,7 @@ typedef struct _message_queue_t_ {
     int           multiThreadedComplete;
     THREADINFO    *multiThreadedThreadInfo;
     struct dag_t        *multiThreadedDag;
-    void          *barrier1;
-    void          *barrier2;
+    void          *barrier2;    /* thread start-up only */
     /* Statics from cs_par_dispatch; */
     /* ********These are no longer used******** */
     void          *pointer1; //struct global_var_lock_t *global_var_lock_root;
@@ -1806,11 +1846,8 @@ typedef struct _message_queue_t_ {
     CS_HASH_TABLE* symbtab;
     int           print_version;
     int           inZero;       /* flag compilation of instr0 */
-    struct _message_queue **msg_queue;
-    volatile long msg_queue_wget; /* Writer - Get index */
-    volatile long msg_queue_wput; /* Writer - Put Index */
-    volatile long msg_queue_rstart; /* Reader - start index */
-    volatile long msg_queue_items;
+    struct _message_ring *msg_queue; /* API messages, see threadsafe.c */
+    int      msg_queue_policy;  /* what writers do when it is full */
     int      aftouch;
     void     *directory;
     ALLOC_DATA *alloc_queue;
@@ -1830,6 +1867,28 @@ typedef struct _message_queue_t_ {
     int  mode;
     char *opcodedir;
     char *score_srt;
+    /* work-stealing dispatch for multicore performance */
+    taskDeque     *dag_deques;    /* one ready queue per thread */
+    void          **dag_wake;     /* per-worker locks to park on */
+    volatile int  dag_remaining;  /* tasks not yet done this k-cycle */
+    volatile int  dag_cycle;      /* k-cycle generation seen by workers */
+    volatile int  dag_idle;       /* workers finished with this k-cycle */
+    void          *dag_cache;     /* memoised dependencies, see dag_build */
+    void          *mem_pool;      /* size-class allocator, see memalloc.c */
+    void          *chn_index;     /* control channel handles, see bus.c */
+    void          *insds_pool;    /* instance pool thread, see insert.c */
+    void          *bscore;        /* binary score being played, see bscore.c */
+    void          *evt_queue;     /* real time event wheel, see musmon.c */
+    void          *ftgen_async;   /* table generation threads, see fgens.c */
+    void          *ft_mipmaps;    /* band-limited tables, see fgens.c */
+    spin_lock_t   ft_mipmap_lock; /* guards ft_mipmaps */
+    char          *orc_cache;     /* --orc-cache directory, see orc_cache.c */
+    void          *tree_arena;    /* arena of the tree being parsed */
+    void          *tree_arenas;   /* arenas of parsed trees not yet deleted */
+    int           sfwrite_queue;  /* --sf-write-queue depth, see libsnd.c */
+    int           rt_callback;    /* --rt-callback was given */
+    void          *rtcb;          /* callback mode state, see csound.c */
+    void          *async_init;    /* init worker thread, see insert.c */
     /*struct CSOUND_ **self;*/
     /**@}*/
 #endif  /* __BUILDING_LIBCSOUND */
@@ -0,0 +1,124 @@
+/*
+  aops_bench.c:
+
+  Per-opcode throughput of the a-rate arithmetic opcodes (OOps/aops.c).
+  For each expression an instrument evaluates it NSTMT times per
+  k-period on two oscillator signals, and the time per sample and
+  statement is reported, next to a plain a-rate copy as the baseline.
+  The kernel set is the one the library picked for this CPU; set
+  CSOUND_SIMD=scalar (or sse2, avx2, avx512) to force another.
+
+  usage: benchAops [k-periods] [-w file | -c file]
+
+  -w writes a checksum of each opcode's output to file, -c compares
+  against such a file and fails on any difference.  "make benchmark"
+  writes the checksums with the scalar kernels and then compares the
+  default ones against them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csound.h"
+
+#define NSTMT   32
+
+static const char *exprs[] = {
+    "a1",                       /* baseline: copy */
+    "a1 + a2", "a1 - a2", "a1 * a2", "a1 / a2",
+    "a1 + k1", "a1 - k1", "a1 * k1", "a1 / k1",
+    "k1 + a2", "k1 - a2", "k1 * a2", "k1 / a2",
+    "abs(a1)",
+    "(a1 * k1 + a2 * k2) * 0.5",
+    NULL
+};
+
+static const char *orc_head =
+    "sr = 48000\n"
+    "ksmps = 64\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "a1 poscil 0.5, 110\n"
+    "a2 poscil 0.25, 230\n"
+    "a2 = a2 + 1.5\n"
+    "k1 = 0.75\n"
+    "k2 = 1.25\n";
+
+static double run(const char *expr, int cycles, double *sum)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+    RTCLOCK clk;
+    char    *orc = malloc(strlen(orc_head) + NSTMT * (strlen(expr) + 8) + 64);
+    MYFLT   *spout;
+    int     i, n, ksmps;
+    double  t0, t1;
+
+    strcpy(orc, orc_head);
+    for (i = 0; i < NSTMT; i++) {
+      strcat(orc, "a3 = ");
+      strcat(orc, expr);
+      strcat(orc, "\n");
+    }
+    strcat(orc, "out a3\nendin\n");
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, "-d");
+    if (csoundCompileOrc(csound, orc) != 0 || csoundStart(csound) != 0) {
+      fprintf(stderr, "cannot compile: %s\n", expr);
+      exit(1);
+    }
+    csoundInputMessage(csound, "i 1 0 -1");
+    spout = csoundGetSpout(csound);
+    ksmps = csoundGetKsmps(csound);
+    csoundPerformKsmps(csound);
+    *sum = 0.0;
+    csoundInitTimerStruct(&clk);
+    t0 = csoundGetRealTime(&clk);
+    for (i = 0; i < cycles; i++) {
+      csoundPerformKsmps(csound);
+      for (n = 0; n < ksmps; n++) *sum += spout[n];
+    }
+    t1 = csoundGetRealTime(&clk);
+    csoundDestroy(csound);
+    free(orc);
+    return 1.0e9 * (t1 - t0) / ((double) cycles * ksmps * NSTMT);
+}
+
+int main(int argc, char **argv)
+{
+    int     cycles = 20000, i, fail = 0;
+    FILE    *wf = NULL, *cf = NULL;
+    const char *simd = getenv("CSOUND_SIMD");
+
+    for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+        wf = fopen(argv[++i], "w");
+      else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+        if ((cf = fopen(argv[++i], "r")) == NULL) {
+          fprintf(stderr, "cannot read %s\n", argv[i]);
+          return 1;
+        }
+      }
+      else cycles = atoi(argv[i]);
+    }
+    csoundInitialize(CSOUNDINIT_NO_SIGNAL_HANDLER | CSOUNDINIT_NO_ATEXIT);
+    printf("kernels: %s, sizeof(MYFLT) = %d, %d statements per instrument\n",
+           simd != NULL ? simd : "default", (int) sizeof(MYFLT), NSTMT);
+    printf("%-28s %12s %22s\n", "expression", "ns/sample", "checksum");
+    for (i = 0; exprs[i] != NULL; i++) {
+      double sum, ns = run(exprs[i], cycles, &sum);
+      printf("%-28s %12.3f %22.17g\n", exprs[i], ns, sum);
+      if (wf != NULL) fprintf(wf, "%.17g\n", sum);
+      if (cf != NULL) {
+        double ref;
+        if (fscanf(cf, "%lf", &ref) != 1 || ref != sum) {
+          fprintf(stderr, "%s: checksum differs from reference\n", exprs[i]);
+          fail = 1;
+        }
+      }
+    }
+    if (wf != NULL) fclose(wf);
+    if (cf != NULL) fclose(cf);
+    return fail;
+}
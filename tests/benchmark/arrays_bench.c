@@ -0,0 +1,156 @@
+/*
+  arrays_bench.c:
+
+  Throughput of the k-rate array opcodes (Opcodes/arrays.c) on arrays of
+  a few thousand elements, as used for spectral feature processing.  For
+  each expression an instrument evaluates it NSTMT times per k-period
+  and the time per element and statement is reported.  "kC = kE" copies
+  an array whose length alternates every k-period, which reallocated the
+  destination on each copy before arrays grew by doubling (see tabgrow
+  in include/arrays.h).  The kernel set is the one the library picked
+  for this CPU; set CSOUND_SIMD=scalar (or sse2, avx2, avx512) to force
+  another.
+
+  usage: benchArrays [k-periods] [size] [-w file | -c file]
+
+  -w writes a checksum of each expression to file, -c compares against
+  such a file and fails on any difference.  The sums are added in lanes
+  by the vector kernels, so sumarray only has to agree to 1e-9.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "csound.h"
+
+#define NSTMT   16
+
+static const struct {
+    const char  *stmt;
+    int         exact;          /* 0 for sums */
+} exprs[] = {
+    { "kC = kA", 1 },           /* baseline: copy */
+    { "kC = kA + kB", 1 }, { "kC = kA - kB", 1 },
+    { "kC = kA * kB", 1 }, { "kC = kA / kB", 1 },
+    { "kC = kA + k1", 1 }, { "kC = k1 - kA", 1 },
+    { "kC = kA * k1", 1 }, { "kC = k1 / kB", 1 },
+    { "kC += kB", 1 },
+    { "kC = kE", 1 },
+    { "kr = sumarray(kA)", 0 },
+    { "kr = maxarray(kA)", 1 },
+    { "kr = minarray(kA)", 1 },
+    { NULL, 0 }
+};
+
+static const char *orc_head =
+    "sr = 48000\n"
+    "ksmps = 64\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "iN = p4\n"
+    "kA[] init iN\n"
+    "kB[] init iN\n"
+    "kC[] init iN\n"
+    "kfill init 0\n"
+    "if kfill == 0 then\n"
+    "  kn = 0\n"
+    "  while kn < iN do\n"
+    "    kA[kn] = sin(kn * 0.01)\n"
+    "    kB[kn] = 1.5 + cos(kn * 0.013)\n"
+    "    kn += 1\n"
+    "  od\n"
+    "  kfill = 1\n"
+    "endif\n"
+    "kcycle init 0\n"
+    "kcycle += 1\n"
+    "kE[] genarray 1, (kcycle % 2 == 0 ? iN : iN / 2)\n"
+    "k1 = 0.75\n"
+    "kr = 0\n";
+
+static double run(const char *stmt, int cycles, int size, double *sum)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+    RTCLOCK clk;
+    char    *orc = malloc(strlen(orc_head) + NSTMT * (strlen(stmt) + 2) + 128);
+    char    ev[64];
+    MYFLT   *spout;
+    int     i, n, ksmps;
+    double  t0, t1;
+
+    strcpy(orc, orc_head);
+    for (i = 0; i < NSTMT; i++) {
+      strcat(orc, stmt);
+      strcat(orc, "\n");
+    }
+    if (stmt[1] == 'C')
+      strcat(orc, "kr = kC[7] + kC[lenarray(kC) - 1]\n");
+    strcat(orc, "out a(kr)\nendin\n");
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, "-d");
+    if (csoundCompileOrc(csound, orc) != 0 || csoundStart(csound) != 0) {
+      fprintf(stderr, "cannot compile: %s\n", stmt);
+      exit(1);
+    }
+    sprintf(ev, "i 1 0 -1 %d", size);
+    csoundInputMessage(csound, ev);
+    spout = csoundGetSpout(csound);
+    ksmps = csoundGetKsmps(csound);
+    csoundPerformKsmps(csound);
+    *sum = 0.0;
+    csoundInitTimerStruct(&clk);
+    t0 = csoundGetRealTime(&clk);
+    for (i = 0; i < cycles; i++) {
+      csoundPerformKsmps(csound);
+      for (n = 0; n < ksmps; n++) *sum += spout[n];
+    }
+    t1 = csoundGetRealTime(&clk);
+    csoundDestroy(csound);
+    free(orc);
+    return 1.0e9 * (t1 - t0) / ((double) cycles * size * NSTMT);
+}
+
+int main(int argc, char **argv)
+{
+    int     cycles = 2000, size = 4096, i, fail = 0, nargs = 0;
+    FILE    *wf = NULL, *cf = NULL;
+    const char *simd = getenv("CSOUND_SIMD");
+
+    for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+        wf = fopen(argv[++i], "w");
+      else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+        if ((cf = fopen(argv[++i], "r")) == NULL) {
+          fprintf(stderr, "cannot read %s\n", argv[i]);
+          return 1;
+        }
+      }
+      else if (nargs++ == 0) cycles = atoi(argv[i]);
+      else size = atoi(argv[i]);
+    }
+    csoundInitialize(CSOUNDINIT_NO_SIGNAL_HANDLER | CSOUNDINIT_NO_ATEXIT);
+    printf("kernels: %s, sizeof(MYFLT) = %d, %d elements, "
+           "%d statements per instrument\n",
+           simd != NULL ? simd : "default", (int) sizeof(MYFLT), size, NSTMT);
+    printf("%-28s %12s %22s\n", "statement", "ns/element", "checksum");
+    for (i = 0; exprs[i].stmt != NULL; i++) {
+      double sum, ns = run(exprs[i].stmt, cycles, size, &sum);
+      printf("%-28s %12.3f %22.17g\n", exprs[i].stmt, ns, sum);
+      if (wf != NULL) fprintf(wf, "%.17g\n", sum);
+      if (cf != NULL) {
+        double ref;
+        if (fscanf(cf, "%lf", &ref) != 1 ||
+            (exprs[i].exact ? ref != sum :
+             fabs(ref - sum) > 1.0e-9 * fabs(ref))) {
+          fprintf(stderr, "%s: checksum differs from reference\n",
+                  exprs[i].stmt);
+          fail = 1;
+        }
+      }
+    }
+    if (wf != NULL) fclose(wf);
+    if (cf != NULL) fclose(cf);
+    return fail;
+}
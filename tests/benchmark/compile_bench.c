@@ -0,0 +1,83 @@
+/*
+  compile_bench.c:
+
+  Orchestra compile latency, as seen by a live-coding host that sends
+  csoundCompileOrc() the same instruments again and again.  The
+  orchestra has ninstr instruments of expression-heavy statements and
+  is compiled ncompile times into one running instance; the mean, best
+  and worst time per compilation are reported.  Parse trees are built in
+  an arena (see tree_arena_begin in Engine/csound_orc_semantics.c); set
+  CSOUND_TREE_ARENA=0 to allocate each node on its own for comparison.
+
+  usage: benchCompile [ncompile] [ninstr]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csound.h"
+
+static const char *body =
+    "k1 = p4 * 0.5 + p5 * 0.25\n"
+    "k2 = (k1 + 1) * (k1 - 1) / (abs(k1) + 2)\n"
+    "if k2 > 0.5 then\n"
+    "  k3 = sqrt(k2) * 3 + int(k1 * 10) % 7\n"
+    "elseif k2 > 0.1 then\n"
+    "  k3 = log(k2 + 1) * 2\n"
+    "else\n"
+    "  k3 = 0\n"
+    "endif\n"
+    "a1 poscil 0.1 + k3 * 0.01, 220 + k2 * 10\n"
+    "a2 poscil 0.1, 330 * (1 + k1 * 0.01)\n"
+    "a3 = (a1 + a2) * 0.5 - a1 * a2 * 0.25\n"
+    "out a3\n"
+    "endin\n";
+
+int main(int argc, char **argv)
+{
+    int     ncompile = (argc > 1 ? atoi(argv[1]) : 200);
+    int     ninstr = (argc > 2 ? atoi(argv[2]) : 100), i;
+    const char *arena = getenv("CSOUND_TREE_ARENA");
+    CSOUND  *csound;
+    RTCLOCK clk;
+    char    *orc, *p;
+    double  t, total = 0.0, best = 1.0e9, worst = 0.0;
+
+    csoundInitialize(CSOUNDINIT_NO_SIGNAL_HANDLER | CSOUNDINIT_NO_ATEXIT);
+    orc = p = malloc((size_t) ninstr * (strlen(body) + 32) + 1);
+    for (i = 1; i <= ninstr; i++) {
+      p += sprintf(p, "instr %d\n", i);
+      strcpy(p, body);
+      p += strlen(body);
+    }
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, "-d");
+    if (csoundCompileOrc(csound, orc) != 0 || csoundStart(csound) != 0) {
+      fprintf(stderr, "cannot compile\n");
+      return 1;
+    }
+    csoundInitTimerStruct(&clk);
+    for (i = 0; i < ncompile; i++) {
+      t = csoundGetRealTime(&clk);
+      if (csoundCompileOrc(csound, orc) != 0) {
+        fprintf(stderr, "compilation %d failed\n", i);
+        return 1;
+      }
+      t = csoundGetRealTime(&clk) - t;
+      total += t;
+      if (t < best) best = t;
+      if (t > worst) worst = t;
+      csoundPerformKsmps(csound);
+    }
+    csoundDestroy(csound);
+    free(orc);
+    printf("tree arena: %s, %d instruments, %d compilations\n",
+           (arena != NULL && strcmp(arena, "0") == 0) ? "off" : "on",
+           ninstr, ncompile);
+    printf("%12s %12s %12s\n", "mean ms", "best ms", "worst ms");
+    printf("%12.3f %12.3f %12.3f\n",
+           1.0e3 * total / ncompile, 1.0e3 * best, 1.0e3 * worst);
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+  fft_mult_acc_bench.c:
+
+  Microbenchmark for the spectral multiply-accumulate used by
+  partitioned convolution (ftconv, liveconv, pconvolve).  For each
+  partition size it times csound->RealFFTMultAcc against the scalar
+  loop the opcodes used before, over an IR of the given length, and
+  checks that both give the same result.
+
+  usage: benchFFTMultAcc [IR seconds] [channels]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#define __BUILDING_LIBCSOUND
+#include "csoundCore.h"
+
+#define SR      44100
+
+/* the unrolled loop formerly in ftconv.c and liveconv.c */
+static void mult_acc_scalar(MYFLT *outBuf, MYFLT *ringBuf, MYFLT *IR_Data,
+                            int32_t partSize, int32_t nPartitions)
+{
+    MYFLT   re, im, re1, re2, im1, im2;
+    MYFLT   *rbPtr = ringBuf, *irPtr = IR_Data, *outBufPtr, *outBufEndPm2;
+
+    partSize <<= 1;
+    outBufEndPm2 = outBuf + (partSize - 2);
+    memset(outBuf, 0, sizeof(MYFLT)*partSize);
+    do {
+      outBufPtr = outBuf;
+      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);
+      *(outBufPtr++) += *(rbPtr++) * *(irPtr++);
+      re1 = *(rbPtr++);
+      im1 = *(rbPtr++);
+      re2 = *(irPtr++);
+      im2 = *(irPtr++);
+      re = re1 * re2 - im1 * im2;
+      im = re1 * im2 + re2 * im1;
+      while (outBufPtr < outBufEndPm2) {
+        re1 = rbPtr[0];
+        im1 = rbPtr[1];
+        re2 = irPtr[0];
+        im2 = irPtr[1];
+        outBufPtr[0] += re;
+        outBufPtr[1] += im;
+        re = re1 * re2 - im1 * im2;
+        im = re1 * im2 + re2 * im1;
+        re1 = rbPtr[2];
+        im1 = rbPtr[3];
+        re2 = irPtr[2];
+        im2 = irPtr[3];
+        outBufPtr[2] += re;
+        outBufPtr[3] += im;
+        re = re1 * re2 - im1 * im2;
+        im = re1 * im2 + re2 * im1;
+        outBufPtr += 4;
+        rbPtr += 4;
+        irPtr += 4;
+      }
+      outBufPtr[0] += re;
+      outBufPtr[1] += im;
+    } while (--nPartitions);
+}
+
+static void mult_acc_lib(CSOUND *csound, MYFLT *outBuf, MYFLT *ringBuf,
+                         MYFLT *IR_Data, int32_t partSize, int32_t nPartitions)
+{
+    partSize <<= 1;
+    memset(outBuf, 0, sizeof(MYFLT)*partSize);
+    do {
+      csound->RealFFTMultAcc(csound, outBuf, ringBuf, IR_Data, partSize);
+      ringBuf += partSize;
+      IR_Data += partSize;
+    } while (--nPartitions);
+}
+
+int main(int argc, char **argv)
+{
+    CSOUND  *csound;
+    RTCLOCK clk;
+    double  seconds = (argc > 1 ? atof(argv[1]) : 3.0);
+    int     nchnls = (argc > 2 ? atoi(argv[2]) : 8);
+    int     partSize, fail = 0;
+
+    csound = csoundCreate(NULL);
+    csoundInitTimerStruct(&clk);
+    printf("IR %.1f s, %d channels, sizeof(MYFLT) = %d\n",
+           seconds, nchnls, (int) sizeof(MYFLT));
+    printf("%8s %8s %12s %12s %8s %10s\n",
+           "part", "nparts", "scalar us", "simd us", "speedup", "max err");
+    for (partSize = 64; partSize <= 4096; partSize <<= 1) {
+      int32_t nParts = (int32_t) ceil(seconds * SR / partSize);
+      size_t  len = (size_t) 2 * partSize * nParts;
+      MYFLT   *rb = malloc(len * sizeof(MYFLT));
+      MYFLT   *ir = malloc(len * sizeof(MYFLT));
+      MYFLT   *o1 = malloc(2 * partSize * sizeof(MYFLT));
+      MYFLT   *o2 = malloc(2 * partSize * sizeof(MYFLT));
+      /* about 0.2 s of work per variant and size */
+      int     i, reps = (int) (2.0e7 / (double) len) + 1;
+      double  t0, t1, t2, err = 0.0;
+      size_t  k;
+
+      for (k = 0; k < len; k++) {
+        rb[k] = (MYFLT) rand() / RAND_MAX - FL(0.5);
+        ir[k] = (MYFLT) rand() / RAND_MAX - FL(0.5);
+      }
+      t0 = csoundGetRealTime(&clk);
+      for (i = 0; i < reps; i++)
+        mult_acc_scalar(o1, rb, ir, partSize, nParts);
+      t1 = csoundGetRealTime(&clk);
+      for (i = 0; i < reps; i++)
+        mult_acc_lib(csound, o2, rb, ir, partSize, nParts);
+      t2 = csoundGetRealTime(&clk);
+      for (k = 0; k < (size_t) 2 * partSize; k++)
+        if (fabs(o1[k] - o2[k]) > err) err = fabs(o1[k] - o2[k]);
+      /* only rounding differences (fused multiply-add) are allowed */
+      if (err > 1.0e-3 * sqrt((double) nParts))
+        fail = 1;
+      printf("%8d %8d %12.2f %12.2f %7.2fx %10.3g\n", partSize, nParts,
+             1.0e6 * (t1 - t0) / reps * nchnls,
+             1.0e6 * (t2 - t1) / reps * nchnls,
+             (t1 - t0) / (t2 - t1), err);
+      free(rb); free(ir); free(o1); free(o2);
+    }
+    csoundDestroy(csound);
+    if (fail)
+      fprintf(stderr, "RealFFTMultAcc does not match the scalar loop\n");
+    return fail;
+}
@@ -0,0 +1,123 @@
+/*
+  score_bench.c:
+
+  Text score against binary score (Engine/bscore.c).  Writes a score of
+  nevents notes, a tenth of them to a named instrument, converts it with
+  csoundScoreToBinary() and renders both with -n, timing the compile
+  (which sorts the text score) and the performance separately.  The
+  instruments sum their p4 into a channel, and the benchmark fails if the
+  two renderings disagree.
+
+  usage: benchScore [nevents]
+
+  The score, orchestra and binary score are written to the current
+  directory and removed afterwards.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csound.h"
+
+static const char *orc =
+    "sr = 48000\n"
+    "ksmps = 480\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "gisum init 0\n"
+    "instr 1\n"
+    "gisum = gisum + p4\n"
+    "chnset gisum, \"sum\"\n"
+    "endin\n"
+    "instr two\n"
+    "gisum = gisum + p4 * p5\n"
+    "chnset gisum, \"sum\"\n"
+    "endin\n";
+
+static double render(const char *score, double *compile, double *perform)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+    RTCLOCK clk;
+    const char *argv[] = { "benchScore", "-n", "-d", "-m0",
+                           "bench_score.orc", NULL };
+    double  t0, t1, t2, sum;
+    int     err;
+
+    argv[5] = score;
+    csoundInitTimerStruct(&clk);
+    t0 = csoundGetRealTime(&clk);
+    if (csoundCompileArgs(csound, 6, argv) != 0 || csoundStart(csound) != 0) {
+      fprintf(stderr, "cannot compile %s\n", score);
+      exit(1);
+    }
+    t1 = csoundGetRealTime(&clk);
+    while (csoundPerformKsmps(csound) == 0);
+    t2 = csoundGetRealTime(&clk);
+    sum = csoundGetControlChannel(csound, "sum", &err);
+    csoundDestroy(csound);
+    *compile = t1 - t0;
+    *perform = t2 - t1;
+    return sum;
+}
+
+int main(int argc, char **argv)
+{
+    int     nevents = (argc > 1 ? atoi(argv[1]) : 500000), i;
+    FILE    *f, *in, *out;
+    CSOUND  *csound;
+    RTCLOCK clk;
+    double  t0, tconv, tc[2], tp[2], sum[2];
+    long    sztext, szbin;
+
+    csoundInitialize(CSOUNDINIT_NO_SIGNAL_HANDLER | CSOUNDINIT_NO_ATEXIT);
+    f = fopen("bench_score.orc", "w");
+    fputs(orc, f);
+    fclose(f);
+    /* notes written in reverse so the sorter has work to do */
+    f = fopen("bench_score.sco", "w");
+    for (i = nevents - 1; i >= 0; i--) {
+      if (i % 10 == 0)
+        fprintf(f, "i \"two\" %.3f 0.001 %d %d\n", i * 0.001, i % 97, i % 3);
+      else
+        fprintf(f, "i 1 %.3f 0.001 %d\n", i * 0.001, i % 101);
+    }
+    sztext = ftell(f);
+    fclose(f);
+
+    csoundInitTimerStruct(&clk);
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-m0");
+    in = fopen("bench_score.sco", "r");
+    out = fopen("bench_score.csb", "w+b");
+    t0 = csoundGetRealTime(&clk);
+    if (csoundScoreToBinary(csound, in, out) != 0) {
+      fprintf(stderr, "conversion failed\n");
+      return 1;
+    }
+    tconv = csoundGetRealTime(&clk) - t0;
+    fseek(out, 0L, SEEK_END);
+    szbin = ftell(out);
+    fclose(in);
+    fclose(out);
+    csoundDestroy(csound);
+
+    sum[0] = render("bench_score.sco", &tc[0], &tp[0]);
+    sum[1] = render("bench_score.csb", &tc[1], &tp[1]);
+
+    printf("%d events, text %ld bytes, binary %ld bytes, "
+           "conversion %.3f s\n", nevents, sztext, szbin, tconv);
+    printf("%-8s %12s %12s %12s %16s\n",
+           "score", "compile s", "perform s", "total s", "sum");
+    printf("%-8s %12.3f %12.3f %12.3f %16.1f\n", "text",
+           tc[0], tp[0], tc[0] + tp[0], sum[0]);
+    printf("%-8s %12.3f %12.3f %12.3f %16.1f\n", "binary",
+           tc[1], tp[1], tc[1] + tp[1], sum[1]);
+    remove("bench_score.orc");
+    remove("bench_score.sco");
+    remove("bench_score.csb");
+    if (sum[0] != sum[1]) {
+      fprintf(stderr, "binary score renders differently\n");
+      return 1;
+    }
+    return 0;
+}
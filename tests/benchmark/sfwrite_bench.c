@@ -0,0 +1,79 @@
+/*
+  sfwrite_bench.c:
+
+  Sound file output throughput of an offline render.  A multichannel
+  orchestra of noise is rendered to 16-bit WAV, FLAC and 32-bit float
+  WAV files, and for each the render time, the speed relative to real
+  time and the longest k-cycle (the longest the performance thread
+  waited) are reported.  Output goes through the sound file writer
+  thread (see sfwriter_start in InOut/libsnd.c) with a ring of queue
+  buffers; queue 0 writes on the performance thread for comparison.
+
+  usage: benchSfWrite [seconds] [nchnls] [queue]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csound.h"
+
+static const char *formats[][2] = {
+    { "--format=wav:short", "sfwrite_bench.wav" },
+    { "--format=flac:short", "sfwrite_bench.flac" },
+    { "--format=wav:float", "sfwrite_bench_float.wav" }
+};
+
+int main(int argc, char **argv)
+{
+    double  secs = (argc > 1 ? atof(argv[1]) : 10.0);
+    int     nchnls = (argc > 2 ? atoi(argv[2]) : 32);
+    int     queue = (argc > 3 ? atoi(argv[3]) : 4), i, f;
+    char    *orc, *p, opt[64];
+    RTCLOCK clk;
+
+    csoundInitialize(CSOUNDINIT_NO_SIGNAL_HANDLER | CSOUNDINIT_NO_ATEXIT);
+    orc = p = malloc((size_t) nchnls * 16 + 256);
+    p += sprintf(p, "sr = 96000\nksmps = 64\nnchnls = %d\n0dbfs = 1\n"
+                 "instr 1\na1 noise 0.5, 0\nouth ", nchnls);
+    for (i = 1; i <= nchnls; i++)
+      p += sprintf(p, "a1%s", i < nchnls ? ", " : "\n");
+    strcpy(p, "endin\n");
+    printf("%d channels at 96 kHz, %.1f seconds, queue %d\n",
+           nchnls, secs, queue);
+    printf("%-24s %10s %12s %14s\n",
+           "format", "render s", "x real time", "worst kcyc ms");
+    for (f = 0; f < (int) (sizeof(formats) / sizeof(formats[0])); f++) {
+      CSOUND  *csound = csoundCreate(NULL);
+      double  t, t0, kmax = 0.0;
+      char    sco[64];
+
+      csoundSetOption(csound, "-m0");
+      csoundSetOption(csound, "-d");
+      csoundSetOption(csound, (char*) formats[f][0]);
+      sprintf(opt, "-o%s", formats[f][1]);
+      csoundSetOption(csound, opt);
+      sprintf(opt, "--sf-write-queue=%d", queue);
+      csoundSetOption(csound, opt);
+      sprintf(sco, "i1 0 %f\n", secs);
+      if (csoundCompileOrc(csound, orc) != 0 ||
+          csoundReadScore(csound, sco) != 0 || csoundStart(csound) != 0) {
+        fprintf(stderr, "cannot render %s\n", formats[f][1]);
+        return 1;
+      }
+      csoundInitTimerStruct(&clk);
+      t0 = t = csoundGetRealTime(&clk);
+      while (csoundPerformKsmps(csound) == 0) {
+        double  t1 = csoundGetRealTime(&clk);
+        if (t1 - t > kmax) kmax = t1 - t;
+        t = t1;
+      }
+      csoundCleanup(csound);            /* flushes and closes the file */
+      t = csoundGetRealTime(&clk) - t0;
+      csoundDestroy(csound);
+      remove(formats[f][1]);
+      printf("%-24s %10.3f %12.1f %14.3f\n",
+             formats[f][0] + 9, t, secs / t, 1.0e3 * kmax);
+    }
+    free(orc);
+    return 0;
+}
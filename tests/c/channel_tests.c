@@ -63,6 +63,60 @@ void test_control_channel(void)
 
 const char orc2[] = "chn_k \"testing\", 3, 1, 1, 0, 10\n  chn_a \"testing2\", 3\n  instr 1\n  endin\n";
 
+const char orc_handles[] = "chn_k \"in\", 1\n"
+        "chn_k \"a\", 2\n"
+        "chn_k \"b\", 2\n"
+        "instr 1\n"
+        "kin chnget \"in\"\n"
+        "chnset kin * 2, \"a\"\n"
+        "chnset 7, \"b\"\n"
+        "endin\n";
+
+void test_channel_handles(void)
+{
+    CS_CHANNEL_HANDLE h[3], changed[3];
+    MYFLT vals[3] = { 3.0, 0, 0 };
+    int n;
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=null");
+    csoundCompileOrc(csound, orc_handles);
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+    h[0] = csoundGetChannelHandle(csound, "in",
+                                  CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
+    h[1] = csoundGetChannelHandle(csound, "a", CSOUND_CONTROL_CHANNEL);
+    h[2] = csoundGetChannelHandle(csound, "b", CSOUND_CONTROL_CHANNEL);
+    CU_ASSERT_PTR_NOT_NULL(h[0]);
+    CU_ASSERT_STRING_EQUAL(csoundGetChannelHandleName(h[1]), "a");
+    CU_ASSERT_PTR_NULL(csoundGetChannelHandle(csound, "a",
+                                              CSOUND_AUDIO_CHANNEL));
+    CU_ASSERT_EQUAL(csoundSetControlChannels(csound, h, vals, 1),
+                    CSOUND_SUCCESS);
+    csoundInputMessage(csound, "i 1 0 1");
+    csoundPerformKsmps(csound);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetControlChannels(csound, h, vals, 3),
+                    CSOUND_SUCCESS);
+    CU_ASSERT_DOUBLE_EQUAL(vals[1], 6.0, 0.0001);
+    CU_ASSERT_DOUBLE_EQUAL(vals[2], 7.0, 0.0001);
+    n = csoundGetChangedControlChannels(csound, changed, 3);
+    CU_ASSERT_EQUAL(n, 2);
+    /* values do not change any more */
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetChangedControlChannels(csound, changed, 3), 0);
+    vals[0] = 4.0;
+    csoundSetControlChannels(csound, h, vals, 1);
+    csoundPerformKsmps(csound);
+    n = csoundGetChangedControlChannels(csound, changed, 3);
+    CU_ASSERT_EQUAL(n, 1);
+    CU_ASSERT(changed[0] == h[1]);
+
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
 void test_channel_list(void)
 {
     csoundSetGlobalEnv("OPCODE6DIR64", "../../");
@@ -383,6 +437,7 @@ int main(void)
            || (NULL == CU_add_test(pSuite, "Invalid channels", test_invalid_channel))
            || (NULL == CU_add_test(pSuite, "Channel hints", test_chn_hints))
            || (NULL == CU_add_test(pSuite, "String channel", test_string_channel))
+           || (NULL == CU_add_test(pSuite, "Channel handles", test_channel_handles))
        )
    {
       CU_cleanup_registry();
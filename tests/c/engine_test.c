@@ -1,6 +1,11 @@
 #include "csound.h"
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include <CUnit/Basic.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "time.h"
 
@@ -54,6 +59,605 @@ void test_compile_async(void)
     csoundDestroy(csound);
 }
 
+void test_memory_stats(void)
+{
+    CSOUND  *csound;
+    CS_MEMORY_STATS before, after;
+    int i;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "instr 1\n"
+                             "a1 oscili 0.1, 440\n"
+                             "out a1\n"
+                             "endin\n"
+                             "schedule 1,0,10\n");
+    csoundStart(csound);
+    for (i = 0; i < 16; i++) csoundPerformKsmps(csound);
+    csoundGetMemoryStats(csound, &before);
+    CU_ASSERT(before.system_allocs > 0);
+    for (i = 0; i < 256; i++) csoundPerformKsmps(csound);
+    csoundGetMemoryStats(csound, &after);
+    CU_ASSERT_EQUAL(after.system_allocs, before.system_allocs);
+    csoundDestroy(csound);
+}
+
+void test_api_queue(void)
+{
+    CSOUND  *csound;
+    CS_API_QUEUE_STATS stats;
+    MYFLT pfields[3] = { 1, 0, 0.1 };
+    char line[256];
+    int i;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "instr 1\n"
+                             "endin\n");
+    csoundStart(csound);
+    csoundSetAPIQueuePolicy(csound, CSOUND_API_QUEUE_DROP);
+    for (i = 0; i < 1100; i++)
+      csoundScoreEventAsync(csound, 'i', pfields, 3);
+    csoundGetAPIQueueStats(csound, &stats);
+    CU_ASSERT_EQUAL(stats.depth, stats.capacity);
+    CU_ASSERT_EQUAL(stats.drops, 1100 - stats.capacity);
+    CU_ASSERT_EQUAL(stats.spills, 0);
+    csoundPerformKsmps(csound);
+    csoundGetAPIQueueStats(csound, &stats);
+    CU_ASSERT_EQUAL(stats.depth, 0);
+    CU_ASSERT_EQUAL(stats.peak_depth, stats.capacity);
+    /* long line events do not fit in a slot */
+    memset(line, ' ', sizeof(line));
+    memcpy(line, "i 1 0 0.1", 9);
+    line[sizeof(line)-1] = '\0';
+    csoundInputMessageAsync(csound, line);
+    csoundPerformKsmps(csound);
+    csoundGetAPIQueueStats(csound, &stats);
+    CU_ASSERT_EQUAL(stats.spills, 1);
+    CU_ASSERT_EQUAL(stats.depth, 0);
+    csoundDestroy(csound);
+}
+
+void test_instance_pool(void)
+{
+    CSOUND  *csound;
+    CS_INSTR_POOL_STATS stats;
+    int i, misses;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "instr 1\n"
+                             "a1 oscili 0.1, 440\n"
+                             "out a1\n"
+                             "endin\n");
+    csoundStart(csound);
+    for (i = 0; i < 8; i++) csoundInputMessage(csound, "i 1 0 0.01");
+    for (i = 0; i < 4; i++) csoundPerformKsmps(csound);
+    csoundGetInstrumentPoolStats(csound, 1, &stats);
+    CU_ASSERT_EQUAL(stats.high_water, 8);
+    CU_ASSERT(stats.misses >= 1);
+    /* the pool thread tops up to the high-water mark plus headroom */
+    for (i = 0; i < 1000 && stats.allocated + stats.warm < 11; i++) {
+      csoundSleep(1);
+      csoundGetInstrumentPoolStats(csound, 1, &stats);
+    }
+    CU_ASSERT_EQUAL(stats.allocated + stats.warm, 11);
+    misses = stats.misses;
+    for (i = 0; i < 64; i++) csoundPerformKsmps(csound);
+    for (i = 0; i < 10; i++) csoundInputMessage(csound, "i 1 0 0.01");
+    for (i = 0; i < 4; i++) csoundPerformKsmps(csound);
+    csoundGetInstrumentPoolStats(csound, 1, &stats);
+    CU_ASSERT_EQUAL(stats.high_water, 10);
+    CU_ASSERT_EQUAL(stats.misses, misses);
+    CU_ASSERT_EQUAL(csoundGetInstrumentPoolStats(csound, 99, &stats),
+                    CSOUND_ERROR);
+    csoundDestroy(csound);
+}
+
+void test_diskin_streams(void)
+{
+    CSOUND  *csound;
+    CS_DISKIN_STREAM_STATS stats[4];
+    MYFLT   buf[64];
+    double  incr = 0.5 / 44100;
+    int     i, n, frame = -1, bad = 0;
+    /* a float file holding a ramp, so that each sample tells its frame */
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-odiskin_test.wav");
+    csoundSetOption(csound, "-W");
+    csoundSetOption(csound, "-f");
+    csoundCompileOrc(csound, "sr = 44100\n"
+                             "ksmps = 64\n"
+                             "nchnls = 1\n"
+                             "0dbfs = 1\n"
+                             "instr 1\n"
+                             "out line(0.25, 1, 0.75)\n"
+                             "endin\n");
+    csoundReadScore(csound, "i 1 0 1\n");
+    csoundStart(csound);
+    while (csoundPerformKsmps(csound) == 0);
+    csoundDestroy(csound);
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "--realtime");
+    CU_ASSERT_EQUAL(csoundGetDiskinStreamStats(csound, stats, 4), 0);
+    csoundSetDiskinReadAhead(csound, 0.25);
+    csoundCompileOrc(csound, "sr = 44100\n"
+                             "ksmps = 64\n"
+                             "nchnls = 1\n"
+                             "0dbfs = 1\n"
+                             "instr 1\n"
+                             "a1 diskin2 \"diskin_test.wav\", 1\n"
+                             "chnset a1, \"diskin\"\n"
+                             "endin\n");
+    csoundStart(csound);
+    csoundInputMessage(csound, "i 1 0 0.1");
+    for (i = 0; i < 200 && frame < 2048; i++) {
+      csoundPerformKsmps(csound);
+      csoundGetAudioChannel(csound, "diskin", buf);
+      if (frame < 0 && buf[0] == 0.0)
+        continue;                       /* not started yet */
+      if (frame < 0) {
+        frame = 0;
+        CU_ASSERT_EQUAL(csoundGetDiskinStreamStats(csound, stats, 4), 1);
+        CU_ASSERT(strstr(stats[0].name, "diskin_test.wav") != NULL);
+        CU_ASSERT(stats[0].capacity >= 11025);
+      }
+      for (n = 0; n < 64; n++, frame++)
+        if (fabs(buf[n] - (0.25 + frame * incr)) > 1.0e-6)
+          bad++;
+    }
+    CU_ASSERT(frame >= 2048);
+    CU_ASSERT_EQUAL(bad, 0);
+    CU_ASSERT_EQUAL(csoundGetDiskinStreamStats(csound, stats, 4), 1);
+    CU_ASSERT_EQUAL(stats[0].underruns, 0);
+    /* the stream goes with the note */
+    for (i = 0; i < 200; i++)
+      csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetDiskinStreamStats(csound, stats, 4), 0);
+    csoundDestroy(csound);
+    remove("diskin_test.wav");
+}
+
+void test_expression_fusion(void)
+{
+    CSOUND  *csound;
+    int err;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "instr 1\n"
+                             "a2 init 0.5\n"
+                             "a3 init 0.25\n"
+                             "k1 = 2\n"
+                             "k2 = 4\n"
+                             "a1 = (a2*k1 + a3*k2) * 0.5\n"
+                             "chnset k(a1), \"fused\"\n"
+                             "a4 = sqrt(abs(-a1 - a1)) / 2\n"
+                             "chnset k(a4), \"fused2\"\n"
+                             "endin\n");
+    csoundStart(csound);
+    csoundInputMessage(csound, "i 1 0 1");
+    csoundPerformKsmps(csound);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "fused", &err),
+                           1.0, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "fused2", &err),
+                           sqrt(2.0) / 2, 1e-12);
+    csoundDestroy(csound);
+}
+
+void test_binary_score(void)
+{
+    CSOUND  *csound;
+    FILE    *f;
+    int     i, err;
+    const char *argv[] = { "csound", "-n", "bscore_test.orc", "bscore_test.csb" };
+    f = fopen("bscore_test.orc", "w");
+    fputs("gisum init 0\n"
+          "instr 1\n"
+          "gisum = gisum + p4\n"
+          "chnset gisum, \"sum\"\n"
+          "endin\n"
+          "instr two\n"
+          "gisum = gisum + 100*p4\n"
+          "chnset gisum, \"sum\"\n"
+          "endin\n", f);
+    fclose(f);
+    f = fopen("bscore_test.sco", "w");
+    for (i = 20; i > 0; i--)                    /* unsorted on purpose */
+      fprintf(f, "i %s %d 0.5 %d\n", i % 5 ? "1" : "\"two\"", i, i);
+    fclose(f);
+    csound = csoundCreate(NULL);
+    {
+      FILE *in = fopen("bscore_test.sco", "r");
+      FILE *out = fopen("bscore_test.csb", "w+b");
+      CU_ASSERT_EQUAL(csoundScoreToBinary(csound, in, out), 0);
+      fclose(in);
+      fclose(out);
+    }
+    csoundDestroy(csound);
+    csound = csoundCreate(NULL);
+    CU_ASSERT_EQUAL(csoundCompileArgs(csound, 4, argv), 0);
+    csoundStart(csound);
+    while (csoundPerformKsmps(csound) == 0);
+    /* 1..20, with multiples of 5 counted by "two" */
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "sum", &err),
+                           160.0 + 100.0 * 50.0, 1e-9);
+    csoundDestroy(csound);
+    remove("bscore_test.orc");
+    remove("bscore_test.sco");
+    remove("bscore_test.csb");
+}
+
+void test_parallel_score_sort(void)
+{
+    CSOUND  *csound;
+    FILE    *in = tmpfile(), *out1 = tmpfile(), *out2 = tmpfile();
+    int     i, c1, c2, same = 1;
+    /* two sections, big enough for several runs, with plenty of ties */
+    fputs("t 0 120 10 90\n", in);
+    for (i = 0; i < 50000; i++)
+      fprintf(in, "i %d %d %d %d\n", 1 + i % 3, (i * 7919) % 101, i % 4, i);
+    fputs("f 1 0 1024 10 1\ns\n", in);
+    for (i = 0; i < 40000; i++)
+      fprintf(in, "i 2 %d 1 %d\n", (i * 31) % 17, i);
+    fputs("e\n", in);
+    rewind(in);
+    csound = csoundCreate(NULL);
+    CU_ASSERT_EQUAL(csoundScoreSort(csound, in, out1), 0);
+    csoundDestroy(csound);
+    rewind(in);
+    csound = csoundCreate(NULL);
+    CU_ASSERT_EQUAL(csoundScoreSortParallel(csound, in, out2, 4), 0);
+    csoundDestroy(csound);
+    rewind(out1);
+    rewind(out2);
+    do {
+      c1 = getc(out1);
+      c2 = getc(out2);
+      if (c1 != c2) same = 0;
+    } while (c1 != EOF && same);
+    CU_ASSERT(same);
+    fclose(in);
+    fclose(out1);
+    fclose(out2);
+}
+
+void test_event_queue(void)
+{
+    CSOUND  *csound;
+    CS_EVENT_QUEUE_STATS stats;
+    MYFLT   p[3] = { 1, 0, 0.01 };
+    int     i;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "instr 1\n"
+                             "endin\n");
+    csoundStart(csound);
+    /* near, far and very far events, several at the same time */
+    for (i = 0; i < 300; i++) {
+      p[1] = (MYFLT) (i % 100) * (i < 200 ? 0.005 : 40.0);
+      csoundScoreEvent(csound, 'i', p, 3);
+    }
+    csoundPerformKsmps(csound);
+    csoundGetEventQueueStats(csound, &stats);
+    CU_ASSERT_EQUAL(stats.scheduled, 300);
+    CU_ASSERT_EQUAL(stats.peak_queued, 300);
+    CU_ASSERT(stats.queued < 300);
+    /* two seconds: every near event has started */
+    for (i = 0; i < (int) (2 * csoundGetKr(csound)); i++)
+      csoundPerformKsmps(csound);
+    csoundGetEventQueueStats(csound, &stats);
+    CU_ASSERT_EQUAL(stats.queued, 99);
+    CU_ASSERT_EQUAL(stats.late, 0);
+    /* an event scheduled at time 0 can only start late now */
+    p[1] = 0;
+    csoundScoreEventAbsolute(csound, 'i', p, 3, 0.0);
+    csoundPerformKsmps(csound);
+    csoundGetEventQueueStats(csound, &stats);
+    CU_ASSERT_EQUAL(stats.late, 1);
+    CU_ASSERT_EQUAL(stats.queued, 99);
+    csoundRewindScore(csound);
+    csoundGetEventQueueStats(csound, &stats);
+    CU_ASSERT_EQUAL(stats.queued, 0);
+    csoundDestroy(csound);
+}
+
+void test_sample_cache(void)
+{
+    CSOUND  *csound, *a, *b;
+    CS_SAMPLE_CACHE_STATS s0, s;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-osmpcache_test.wav");
+    csoundSetOption(csound, "-W");
+    csoundCompileOrc(csound, "sr = 44100\n"
+                             "nchnls = 2\n"
+                             "instr 1\n"
+                             "outs oscili(1000, 440), oscili(1000, 220)\n"
+                             "endin\n");
+    csoundReadScore(csound, "i 1 0 0.5\n");
+    csoundStart(csound);
+    while (csoundPerformKsmps(csound) == 0);
+    csoundDestroy(csound);
+
+    csoundGetSampleCacheStats(&s0);
+    a = csoundCreate(NULL);
+    b = csoundCreate(NULL);
+    csoundSetOption(a, "-n");
+    csoundSetOption(b, "-n");
+    csoundCompileOrc(a, "sndload \"smpcache_test.wav\"\n");
+    csoundCompileOrc(b, "sndload \"smpcache_test.wav\"\n");
+    csoundStart(a);
+    csoundStart(b);
+    csoundGetSampleCacheStats(&s);
+    CU_ASSERT_EQUAL(s.misses, s0.misses + 1);
+    CU_ASSERT_EQUAL(s.hits, s0.hits + 1);
+    CU_ASSERT_EQUAL(s.entries, s0.entries + 1);
+    CU_ASSERT(s.resident_bytes >= s0.resident_bytes + 22050 * 2 * 4);
+    /* still in use by b, then idle but resident */
+    csoundDestroy(a);
+    csoundGetSampleCacheStats(&s);
+    CU_ASSERT_EQUAL(s.entries, s0.entries + 1);
+    csoundDestroy(b);
+    csoundGetSampleCacheStats(&s);
+    CU_ASSERT_EQUAL(s.entries, s0.entries + 1);
+    csoundSetSampleCacheBudget(0);
+    csoundGetSampleCacheStats(&s);
+    CU_ASSERT_EQUAL(s.entries, 0);
+    CU_ASSERT_EQUAL(s.resident_bytes, 0);
+    CU_ASSERT(s.evictions >= s0.evictions + 1);
+    csoundSetSampleCacheBudget((size_t) 256 << 20);
+    remove("smpcache_test.wav");
+}
+
+void test_sndload_cached(void)
+{
+    static const char *play = "sr = 44100\n"
+                              "ksmps = 64\n"
+                              "instr 1\n"
+                              "a1 loscilx 1, 1, \"sndload_test.wav\", 4, 1\n"
+                              "chnset a1, \"out\"\n"
+                              "endin\n";
+    CSOUND  *csound, *a, *b;
+    MYFLT   bufa[64], bufb[64];
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-osndload_test.wav");
+    csoundSetOption(csound, "-W");
+    csoundCompileOrc(csound, "sr = 44100\n"
+                             "ksmps = 64\n"
+                             "nchnls = 1\n"
+                             "instr 1\n"
+                             "out oscili(1000, 440)\n"
+                             "endin\n");
+    csoundReadScore(csound, "i 1 0 0.5\n");
+    csoundStart(csound);
+    while (csoundPerformKsmps(csound) == 0);
+    csoundDestroy(csound);
+
+    /* a sets a start offset with sndload on the shared, read-only file;
+       b, loading it from the cache after a, still starts at frame 0 */
+    a = csoundCreate(NULL);
+    b = csoundCreate(NULL);
+    csoundSetOption(a, "-n");
+    csoundSetOption(b, "-n");
+    csoundCompileOrc(a, "sndload \"sndload_test.wav\", -1, 0, 0, 0, 0, 1000, "
+                        "1, 100, 2000\n");
+    csoundCompileOrc(a, play);
+    csoundCompileOrc(b, play);
+    csoundStart(a);
+    csoundStart(b);
+    csoundInputMessage(a, "i 1 0 1");
+    csoundInputMessage(b, "i 1 0 1");
+    csoundPerformKsmps(a);
+    csoundPerformKsmps(b);
+    csoundGetAudioChannel(a, "out", bufa);
+    csoundGetAudioChannel(b, "out", bufb);
+    CU_ASSERT(fabs(bufa[0] - 1000 * sin(2 * M_PI * 440 * 1000 / 44100)) < 1.0);
+    CU_ASSERT(fabs(bufb[0]) < 1.0e-6);
+    CU_ASSERT(fabs(bufb[1] - 1000 * sin(2 * M_PI * 440 / 44100)) < 1.0);
+    csoundDestroy(a);
+    csoundDestroy(b);
+    remove("sndload_test.wav");
+}
+
+void test_async_ftgen(void)
+{
+    CSOUND  *csound;
+    MYFLT   *t1, *t2;
+    int     fs, fa, n1, n2, cnt = 0;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "gisync ftgen 0, 0, 262144, 10, 1, .5, .3, .2\n"
+                             "giasync ftgenasync 0, 0, 262144, 10, 1, .5, .3, .2\n"
+                             "chnset gisync, \"sync\"\n"
+                             "chnset giasync, \"async\"\n");
+    csoundReadScore(csound, "f 0 10\n");
+    csoundStart(csound);
+    fs = (int) csoundGetControlChannel(csound, "sync", NULL);
+    fa = (int) csoundGetControlChannel(csound, "async", NULL);
+    CU_ASSERT(fs > 0);
+    CU_ASSERT(fa > 0);
+    CU_ASSERT(fs != fa);
+    while (csoundGetTable(csound, &t2, fa) <= 0 && cnt++ < 100000)
+      csoundPerformKsmps(csound);
+    n1 = csoundGetTable(csound, &t1, fs);
+    n2 = csoundGetTable(csound, &t2, fa);
+    CU_ASSERT_EQUAL(n1, 262144);
+    CU_ASSERT_EQUAL(n1, n2);
+    if (n1 == n2 && n1 > 0)
+      CU_ASSERT(memcmp(t1, t2, (n1 + 1) * sizeof(MYFLT)) == 0);
+    csoundDestroy(csound);
+}
+
+void test_bandlimited_osc(void)
+{
+    CSOUND  *csound;
+    MYFLT   bl, pbl, plain;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "sr = 44100\n"
+                             "ksmps = 32\n"
+                             "0dbfs = 1\n"
+                             "gi1 ftgen 1, 0, 4096, -9, 1, 1, 0, 40, 1, 0\n"
+                             "gi2 ftgen 2, 0, 4096, -10, 1\n"
+                             "instr 1\n"
+                             "as oscili 1, 1000, 2\n"
+                             "a1 oscili 1, 1000, 1, 0, 1\n"
+                             "a2 poscil 1, 1000, 1, 0, 1\n"
+                             "a3 oscili 1, 1000, 1\n"
+                             "k1 peak a1 - as\n"
+                             "k2 peak a2 - as\n"
+                             "k3 peak a3 - as\n"
+                             "chnset k1, \"bl\"\n"
+                             "chnset k2, \"pbl\"\n"
+                             "chnset k3, \"plain\"\n"
+                             "endin\n");
+    csoundReadScore(csound, "i 1 0 0.1\n");
+    csoundStart(csound);
+    while (csoundPerformKsmps(csound) == 0);
+    bl = csoundGetControlChannel(csound, "bl", NULL);
+    pbl = csoundGetControlChannel(csound, "pbl", NULL);
+    plain = csoundGetControlChannel(csound, "plain", NULL);
+    /* harmonic 40 folds back unless the band-limited copy is used */
+    CU_ASSERT(bl < 0.001);
+    CU_ASSERT(pbl < 0.001);
+    CU_ASSERT(plain > 0.5);
+    csoundDestroy(csound);
+}
+
+void test_orc_cache(void)
+{
+    CSOUND  *csound;
+    DIR     *d;
+    struct dirent *e;
+    char    name[512];
+    int     i, err, n = 0;
+    const char *orc = "opcode twice, k, k\n"
+                      "kx xin\n"
+                      "xout 2*kx\n"
+                      "endop\n"
+                      "instr 1\n"
+                      "kv twice p4\n"
+                      "chnset kv, \"val\"\n"
+                      "endin\n";
+    mkdir("orc_cache_test", 0755);
+    /* first run parses and saves, the second loads the saved tree */
+    for (i = 0; i < 2; i++) {
+      csound = csoundCreate(NULL);
+      csoundSetOption(csound, "-n");
+      csoundSetOption(csound, "--orc-cache=orc_cache_test");
+      CU_ASSERT_EQUAL(csoundCompileOrc(csound, orc), 0);
+      csoundReadScore(csound, "i 1 0 0.1 21\n");
+      csoundStart(csound);
+      while (csoundPerformKsmps(csound) == 0);
+      CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "val", &err),
+                             42.0, 1e-9);
+      csoundDestroy(csound);
+    }
+    if ((d = opendir("orc_cache_test")) != NULL) {
+      while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        snprintf(name, sizeof(name), "orc_cache_test/%s", e->d_name);
+        remove(name);
+        n++;
+      }
+      closedir(d);
+    }
+    rmdir("orc_cache_test");
+    CU_ASSERT_EQUAL(n, 1);
+}
+
+void test_rt_callback(void)
+{
+    /* the dummy module loops each period's output back as the input of
+       the next, so an impulse returns after one period, plus a k-cycle
+       when the period is not a multiple of ksmps */
+    const char *bufopt[2] = { "-b64", "-b40" };
+    const MYFLT expect[2] = { 64.0, 56.0 };
+    CSOUND  *csound;
+    int     i, err;
+    for (i = 0; i < 2; i++) {
+      csound = csoundCreate(NULL);
+      csoundSetOption(csound, "-odac");
+      csoundSetOption(csound, "-iadc");
+      csoundSetOption(csound, "-+rtaudio=null");
+      csoundSetOption(csound, "--rt-callback");
+      csoundSetOption(csound, bufopt[i]);
+      csoundCompileOrc(csound, "sr = 48000\n"
+                               "ksmps = 16\n"
+                               "nchnls = 1\n"
+                               "0dbfs = 1\n"
+                               "instr 1\n"
+                               "kcycle init 0\n"
+                               "klat init -1\n"
+                               "aimp mpulse 1, 0\n"
+                               "ain inch 1\n"
+                               "kn = 0\n"
+                               "while kn < ksmps do\n"
+                               "  ks vaget kn, ain\n"
+                               "  if klat < 0 && ks > 0.5 then\n"
+                               "    klat = kcycle * ksmps + kn\n"
+                               "  endif\n"
+                               "  kn += 1\n"
+                               "od\n"
+                               "kcycle += 1\n"
+                               "chnset klat, \"latency\"\n"
+                               "out aimp\n"
+                               "endin\n");
+      csoundReadScore(csound, "i 1 0 0.1\n");
+      CU_ASSERT_EQUAL(csoundStart(csound), 0);
+      CU_ASSERT(csoundPerform(csound) > 0);
+      CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "latency", &err),
+                             expect[i], 1e-9);
+      csoundDestroy(csound);
+    }
+}
+
+void test_async_init(void)
+{
+    /* the init pass runs on the worker: the note is performed from the
+       k-cycle after it was collected, one after its time at best; a
+       note of another instrument due meanwhile is queued behind it
+       rather than wait for the worker, so never starts before it */
+    CSOUND  *csound;
+    CS_EVENT_QUEUE_STATS stats;
+    MYFLT   k = 0, k2;
+    int     i, err;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "asyncinit 1\n"
+                             "instr 1\n"
+                             "itab ftgen 0, 0, 65536, 10, 1, 0.5, 0.25\n"
+                             "kcnt init 0\n"
+                             "kcnt += 1\n"
+                             "chnset kcnt, \"kcycles\"\n"
+                             "endin\n"
+                             "instr 2\n"
+                             "kcnt init 0\n"
+                             "kcnt += 1\n"
+                             "chnset kcnt, \"kcycles2\"\n"
+                             "endin\n");
+    csoundReadScore(csound, "i 1 0 10\ni 2 0 10\n");
+    CU_ASSERT_EQUAL(csoundStart(csound), 0);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(csound, "kcycles", &err),
+                           0.0, 1e-9);
+    for (i = 1; i < 1000 && k == 0; i++) {
+      csoundSleep(1);
+      csoundPerformKsmps(csound);
+      k = csoundGetControlChannel(csound, "kcycles", &err);
+    }
+    CU_ASSERT_DOUBLE_EQUAL(k, 1.0, 1e-9);
+    k2 = csoundGetControlChannel(csound, "kcycles2", &err);
+    CU_ASSERT(k2 >= k);
+    csoundGetEventQueueStats(csound, &stats);
+    if (i - k > 1) {            /* instr 2 may have waited as well */
+      CU_ASSERT(stats.late_init >= 1);
+    }
+    else {
+      CU_ASSERT_EQUAL(stats.late_init, 0);
+    }
+    csoundDestroy(csound);
+}
+
 int main()
 {
     CU_pSuite pSuite = NULL;
@@ -73,6 +677,21 @@ int main()
     if ((NULL == CU_add_test(pSuite, "Test daemon mode", test_daemon))
         || (NULL == CU_add_test(pSuite, "Test evalcode", test_eval_code))
 	|| (NULL == CU_add_test(pSuite, "Test compileAsync", test_compile_async)) 
+	|| (NULL == CU_add_test(pSuite, "Test memory stats", test_memory_stats))
+	|| (NULL == CU_add_test(pSuite, "Test API queue", test_api_queue))
+	|| (NULL == CU_add_test(pSuite, "Test instance pool", test_instance_pool))
+	|| (NULL == CU_add_test(pSuite, "Test diskin streams", test_diskin_streams))
+	|| (NULL == CU_add_test(pSuite, "Test expression fusion", test_expression_fusion))
+	|| (NULL == CU_add_test(pSuite, "Test binary score", test_binary_score))
+	|| (NULL == CU_add_test(pSuite, "Test parallel score sort", test_parallel_score_sort))
+	|| (NULL == CU_add_test(pSuite, "Test event queue", test_event_queue))
+	|| (NULL == CU_add_test(pSuite, "Test sample cache", test_sample_cache))
+	|| (NULL == CU_add_test(pSuite, "Test sndload on a cached file", test_sndload_cached))
+	|| (NULL == CU_add_test(pSuite, "Test async ftgen", test_async_ftgen))
+	|| (NULL == CU_add_test(pSuite, "Test band-limited oscillators", test_bandlimited_osc))
+	|| (NULL == CU_add_test(pSuite, "Test orchestra cache", test_orc_cache))
+	|| (NULL == CU_add_test(pSuite, "Test rt callback latency", test_rt_callback))
+	|| (NULL == CU_add_test(pSuite, "Test async init", test_async_init))
 	)
     {
         CU_cleanup_registry();
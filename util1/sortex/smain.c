@@ -22,6 +22,9 @@
 */
 
 #include "csound.h"                                    /*   SMAIN.C  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if defined(LINUX) || defined(SGI) || defined(sol) || \
     defined(__MACH__) || defined(__EMX__)
@@ -37,10 +40,18 @@ static void msg_callback(CSOUND *csound,
     }
 }
 
-int main(void)                          /* stdio stub for standalone scsort */
+int main(int argc, char **argv)          /* stdio stub for standalone scsort */
 {
     CSOUND *csound;
-    int    err;
+    int    err, nthreads = 0;
+
+    /* scsort -j N: sort large sections on N threads, streaming the output */
+    if (argc == 3 && strcmp(argv[1], "-j") == 0)
+      nthreads = atoi(argv[2]);
+    if (argc != 1 && nthreads <= 0) {
+      fprintf(stderr, "usage: scsort [-j threads] < infile > outfile\n");
+      return 1;
+    }
 
     csound = csoundCreate(NULL);
 #if defined(LINUX) || defined(SGI) || defined(sol) || \
@@ -48,7 +59,10 @@ int main(void)                          /* stdio stub for standalone scsort */
     signal(SIGPIPE, SIG_DFL);
 #endif
     csoundSetMessageCallback(csound, msg_callback);
-    err = csoundScoreSort(csound, stdin, stdout);
+    if (nthreads > 0)
+      err = csoundScoreSortParallel(csound, stdin, stdout, nthreads);
+    else
+      err = csoundScoreSort(csound, stdin, stdout);
     csoundDestroy(csound);
 
     return err;